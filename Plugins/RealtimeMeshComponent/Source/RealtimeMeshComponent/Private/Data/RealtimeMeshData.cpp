@@ -90,6 +90,35 @@ namespace RealtimeMesh
 		return Promise->GetFuture();
 	}
 
+	TFuture<ERealtimeMeshCollisionUpdateResult> FRealtimeMesh::UpdateSectionGroupCollision(const FRealtimeMeshSectionGroupKey& SectionGroupKey, FRealtimeMeshCollisionData&& InCollisionData)
+	{
+		const auto Promise = MakeShared<TPromise<ERealtimeMeshCollisionUpdateResult>>();
+		auto CollisionData = MakeShared<FRealtimeMeshCollisionData>(MoveTemp(InCollisionData));
+
+		auto Handler = [Promise, SharedResources = SharedResources, SectionGroupKey, CollisionData]() mutable
+		{
+			FRealtimeMeshScopeGuardWrite ScopeGuard(SharedResources->GetGuard());
+			if (ensure(SharedResources->GetSectionGroupCollisionUpdateHandler().IsBound()))
+			{
+				SharedResources->GetSectionGroupCollisionUpdateHandler().Execute(Promise, SectionGroupKey, CollisionData, false);
+			}
+			else
+			{
+				Promise->SetValue(ERealtimeMeshCollisionUpdateResult::Error);
+			}
+		};
+
+		if (IsInGameThread())
+		{
+			Handler();
+		}
+		else
+		{
+			AsyncTask(ENamedThreads::GameThread, MoveTemp(Handler));
+		}
+		return Promise->GetFuture();
+	}
+
 	TFuture<ERealtimeMeshProxyUpdateStatus> FRealtimeMesh::InitializeLODs(const TFixedLODArray<FRealtimeMeshLODConfig>& InLODConfigs)
 	{
 		FRealtimeMeshProxyCommandBatch Commands(SharedResources->GetOwner());
@@ -226,7 +255,7 @@ namespace RealtimeMesh
 	FRealtimeMeshProxyPtr FRealtimeMesh::GetRenderProxy(bool bCreateIfNotExists) const
 	{
 		FRealtimeMeshScopeGuardReadWrite ScopeGuard(SharedResources->GetGuard(), ERealtimeMeshGuardLockType::Read);
-		if (RenderProxy.IsValid() || !bCreateIfNotExists)
+		if (RenderProxy.IsValid() || !bCreateIfNotExists || SharedResources->IsCollisionOnly())
 		{
 			return RenderProxy;
 		}
@@ -2,10 +2,11 @@
 
 #include "RealtimeMesh.h"
 #include "RealtimeMeshComponent.h"
+#include "RealtimeMeshCollisionCache.h"
+#include "RealtimeMeshEngineSubsystem.h"
 #include "Data/RealtimeMeshData.h"
 #include "Data/RealtimeMeshLOD.h"
 #include "Interface_CollisionDataProviderCore.h"
-#include "Misc/LazySingleton.h"
 #include "PhysicsEngine/BodySetup.h"
 #include "Logging/MessageLog.h"
 #if RMC_ENGINE_ABOVE_5_2
@@ -24,6 +25,52 @@ DECLARE_CYCLE_STAT(TEXT("RealtimeMeshDelayedActions - Finish Collision Async Coo
 DECLARE_CYCLE_STAT(TEXT("RealtimeMeshDelayedActions - Finalize Collision Cooked Data"), STAT_RealtimeMesh_FinalizeCollisionCookedData, STATGROUP_RealtimeMesh);
 
 
+//////////////////////////////////////////////////////////////////////////
+//	URealtimeMeshCollisionBody
+
+URealtimeMeshCollisionBody::URealtimeMeshCollisionBody(const FObjectInitializer& ObjectInitializer)
+	: UObject(ObjectInitializer)
+	, BodySetup(nullptr)
+	, PendingBodySetup(nullptr)
+	, bPendingFastCook(false)
+	, bPendingDeformableMesh(false)
+	, UpdateVersionCounter(0)
+	, CurrentVersion(INDEX_NONE)
+{
+}
+
+bool URealtimeMeshCollisionBody::GetPhysicsTriMeshData(struct FTriMeshCollisionData* CollisionData, bool InUseAllTriData)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RealtimeMesh_GetPhysicsTriMesh);
+
+	if (PendingTriMeshData.IsSet())
+	{
+		const auto& MeshData = PendingTriMeshData.GetValue();
+
+		CollisionData->Vertices = MeshData.GetVertices();
+		CollisionData->Indices = MeshData.GetTriangles();
+		CollisionData->UVs = MeshData.GetUVs();
+		CollisionData->MaterialIndices = MeshData.GetMaterials();
+
+		CollisionData->bFlipNormals = true;
+		// Keeps the map from source to cooked vertices in the cooked mesh, which refitting moves the vertices through
+		CollisionData->bDeformableMesh = bPendingDeformableMesh;
+		CollisionData->bFastCook = bPendingFastCook;
+		CollisionData->bDisableActiveEdgePrecompute = false;
+		return true;
+	}
+
+	return false;
+}
+
+bool URealtimeMeshCollisionBody::ContainsPhysicsTriMeshData(bool InUseAllTriData) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_RealtimeMesh_HasPhysicsTriMesh);
+
+	return PendingTriMeshData.IsSet() && PendingTriMeshData.GetValue().GetTriangles().Num() > 0;
+}
+
+
 //////////////////////////////////////////////////////////////////////////
 //	URealtimeMesh
 
@@ -33,6 +80,8 @@ URealtimeMesh::URealtimeMesh(const FObjectInitializer& ObjectInitializer)
 	, PendingBodySetup(nullptr)
 	, CollisionUpdateVersionCounter(0)
 	, CurrentCollisionVersion(INDEX_NONE)
+	, bCollisionOnly(false)
+	, bQueuedForEndOfFrameUpdate(false)
 {
 }
 
@@ -41,6 +90,11 @@ void URealtimeMesh::BroadcastCollisionBodyUpdatedEvent(UBodySetup* NewBodySetup)
 	CollisionBodyUpdatedEvent.Broadcast(this, NewBodySetup);
 }
 
+void URealtimeMesh::BroadcastSectionGroupCollisionBodyUpdatedEvent(const FRealtimeMeshSectionGroupKey& SectionGroupKey, UBodySetup* NewBodySetup)
+{
+	SectionGroupCollisionBodyUpdatedEvent.Broadcast(this, SectionGroupKey, NewBodySetup);
+}
+
 void URealtimeMesh::Initialize(const TSharedRef<RealtimeMesh::FRealtimeMeshSharedResources>& InSharedResources)
 {
 	if (SharedResources)
@@ -50,12 +104,14 @@ void URealtimeMesh::Initialize(const TSharedRef<RealtimeMesh::FRealtimeMeshShare
 	}
 
 	SharedResources = InSharedResources;
+	SharedResources->SetCollisionOnly(bCollisionOnly);
 
 	SharedResources->OnMeshBoundsChanged().AddUObject(this, &URealtimeMesh::HandleBoundsUpdated);
 	SharedResources->OnMeshRenderDataChanged().AddUObject(this, &URealtimeMesh::HandleMeshRenderingDataChanged);
 
 	SharedResources->GetEndOfFrameRequestHandler() = RealtimeMesh::FRealtimeMeshRequestEndOfFrameUpdateDelegate::CreateUObject(this, &URealtimeMesh::MarkForEndOfFrameUpdate);
 	SharedResources->GetCollisionUpdateHandler() = RealtimeMesh::FRealtimeMeshCollisionUpdateDelegate::CreateUObject(this, &URealtimeMesh::InitiateCollisionUpdate);
+	SharedResources->GetSectionGroupCollisionUpdateHandler() = RealtimeMesh::FRealtimeMeshSectionGroupCollisionUpdateDelegate::CreateUObject(this, &URealtimeMesh::InitiateSectionGroupCollisionUpdate);
 
 	MeshRef = SharedResources->CreateRealtimeMesh();
 	SharedResources->SetOwnerMesh(MeshRef.ToSharedRef());
@@ -75,12 +131,31 @@ void URealtimeMesh::Reset(bool bCreateNewMeshData)
 	}
 
 	BodySetup = nullptr;
+	CollisionRefit.Reset();
+	RemoveSectionGroupCollisionBodies();
 
 	BroadcastBoundsChangedEvent();
 	BroadcastRenderDataChangedEvent(true);
 	BroadcastCollisionBodyUpdatedEvent(nullptr);
 }
 
+void URealtimeMesh::SetCollisionOnly(bool bInCollisionOnly)
+{
+	if (bCollisionOnly == bInCollisionOnly)
+	{
+		return;
+	}
+
+	bCollisionOnly = bInCollisionOnly;
+	if (SharedResources)
+	{
+		SharedResources->SetCollisionOnly(bCollisionOnly);
+	}
+
+	// Components recreate their scene proxy, which a collision only mesh no longer gives them
+	BroadcastRenderDataChangedEvent(true);
+}
+
 FBoxSphereBounds URealtimeMesh::GetLocalBounds() const
 {
 	return FBoxSphereBounds(GetMesh()->GetLocalBounds());
@@ -213,6 +288,12 @@ void URealtimeMesh::PostDuplicate(bool bDuplicateForPIE)
 	UObject::PostDuplicate(bDuplicateForPIE);
 }
 
+UBodySetup* URealtimeMesh::GetSectionGroupBodySetup(const FRealtimeMeshSectionGroupKey& SectionGroupKey) const
+{
+	const TObjectPtr<URealtimeMeshCollisionBody>* Body = SectionGroupCollisionBodies.Find(SectionGroupKey);
+	return Body ? (*Body)->BodySetup : nullptr;
+}
+
 bool URealtimeMesh::GetPhysicsTriMeshData(struct FTriMeshCollisionData* CollisionData, bool InUseAllTriData)
 {
 	SCOPE_CYCLE_COUNTER(STAT_RealtimeMesh_GetPhysicsTriMesh);
@@ -229,7 +310,8 @@ bool URealtimeMesh::GetPhysicsTriMeshData(struct FTriMeshCollisionData* Collisio
 
 
 		CollisionData->bFlipNormals = true;
-		CollisionData->bDeformableMesh = false;
+		// Keeps the map from source to cooked vertices in the cooked mesh, which refitting moves the vertices through
+		CollisionData->bDeformableMesh = PendingCollisionUpdate.GetValue().bDeformableMesh;
 		CollisionData->bFastCook = PendingCollisionUpdate.GetValue().bFastCook;
 		CollisionData->bDisableActiveEdgePrecompute = false;
 		return true;
@@ -253,8 +335,14 @@ void URealtimeMesh::InitiateCollisionUpdate(const TSharedRef<TPromise<ERealtimeM
 
 	RealtimeMesh::FRealtimeMeshScopeGuardWrite Guard(SharedResources->GetGuard());
 
+	// The whole mesh body carries every section group's triangles again
+	if (!CollisionUpdate->Config.bCookPerSectionGroup)
+	{
+		RemoveSectionGroupCollisionBodies();
+	}
+
 	const int32 UpdateKey = CollisionUpdateVersionCounter++;
-	PendingCollisionUpdate = {MoveTemp(CollisionUpdate->ComplexGeometry), UpdateKey};
+	PendingCollisionUpdate = {MoveTemp(CollisionUpdate->ComplexGeometry), UpdateKey, CollisionUpdate->Config.bShouldFastCookMeshes, CollisionUpdate->Config.bDeformableMesh};
 
 	UBodySetup* NewBodySetup = NewObject<UBodySetup>(this, NAME_None, (IsTemplate() ? RF_Public : RF_NoFlags));
 	NewBodySetup->BodySetupGuid = FGuid::NewGuid();
@@ -271,14 +359,60 @@ void URealtimeMesh::InitiateCollisionUpdate(const TSharedRef<TPromise<ERealtimeM
 		PendingBodySetup = nullptr;
 	}
 
+	const FRealtimeMeshTriMeshData& TriMeshData = PendingCollisionUpdate.GetValue().TriMeshData;
+	const bool bDeformableMesh = CollisionUpdate->Config.bDeformableMesh;
+	if (bDeformableMesh && CollisionRefit.Refit(TriMeshData, BodySetup, NewBodySetup))
+	{
+		// Only the vertices moved, the cooked mesh moves with them and keeps its triangles
+		BodySetup = NewBodySetup;
+		CurrentCollisionVersion = UpdateKey;
+		PendingCollisionUpdate.Reset();
+
+		Promise->SetValue(ERealtimeMeshCollisionUpdateResult::Updated);
+
+		BroadcastCollisionBodyUpdatedEvent(BodySetup);
+		return;
+	}
+
+	const TOptional<FSHAHash> CookHash = GetCookCacheHash(CollisionUpdate->Config, TriMeshData, NewBodySetup);
 	if (!bForceSyncUpdate && GetWorld() && GetWorld()->IsGameWorld() && CollisionUpdate->Config.bUseAsyncCook)
 	{
 		// Copy source info and reset pending
 		PendingBodySetup = NewBodySetup;
 
-		// Kick the cook off asynchronously
-		NewBodySetup->CreatePhysicsMeshesAsync(
-			FOnAsyncPhysicsCookFinished::CreateUObject(this, &URealtimeMesh::FinishPhysicsAsyncCook, Promise, NewBodySetup, UpdateKey));
+		if (CookHash.IsSet())
+		{
+			// The cache is read off the game thread like the cook would run, a miss kicks the cook off once it is known
+			RealtimeMesh::FRealtimeMeshCollisionCache::Get().LoadAsync(CookHash.GetValue(), NewBodySetup,
+				[WeakThis = MakeWeakObjectPtr(this), Promise, WeakBodySetup = MakeWeakObjectPtr(NewBodySetup), UpdateKey, CookHash](bool bLoaded)
+				{
+					URealtimeMesh* This = WeakThis.Get();
+					if (!This)
+					{
+						Promise->SetValue(ERealtimeMeshCollisionUpdateResult::Ignored);
+						return;
+					}
+					This->FinishCookCacheLoad(bLoaded, Promise, WeakBodySetup.Get(), UpdateKey, CookHash);
+				});
+		}
+		else
+		{
+			// Kick the cook off asynchronously
+			NewBodySetup->CreatePhysicsMeshesAsync(
+				FOnAsyncPhysicsCookFinished::CreateUObject(this, &URealtimeMesh::FinishPhysicsAsyncCook, Promise, NewBodySetup, UpdateKey, CookHash));
+		}
+	}
+	else if (CookHash.IsSet() && RealtimeMesh::FRealtimeMeshCollisionCache::Get().Load(CookHash.GetValue(), NewBodySetup))
+	{
+		// Cooked before, the cache hands over the cooked meshes and there is nothing left to cook
+		UpdateCollisionRefit(CollisionRefit, bDeformableMesh, TriMeshData, NewBodySetup);
+		BodySetup = NewBodySetup;
+		CurrentCollisionVersion = UpdateKey;
+		PendingCollisionUpdate.Reset();
+
+		Promise->SetValue(ERealtimeMeshCollisionUpdateResult::Updated);
+
+		BroadcastCollisionBodyUpdatedEvent(BodySetup);
 	}
 	else
 	{
@@ -287,6 +421,12 @@ void URealtimeMesh::InitiateCollisionUpdate(const TSharedRef<TPromise<ERealtimeM
 		NewBodySetup->InvalidatePhysicsData();
 		NewBodySetup->CreatePhysicsMeshes();
 
+		if (CookHash.IsSet())
+		{
+			RealtimeMesh::FRealtimeMeshCollisionCache::Get().Store(CookHash.GetValue(), NewBodySetup);
+		}
+
+		UpdateCollisionRefit(CollisionRefit, bDeformableMesh, TriMeshData, NewBodySetup);
 		BodySetup = NewBodySetup;
 		PendingCollisionUpdate.Reset();
 
@@ -297,13 +437,43 @@ void URealtimeMesh::InitiateCollisionUpdate(const TSharedRef<TPromise<ERealtimeM
 }
 
 // ReSharper disable once CppPassValueParameterByConstReference
-void URealtimeMesh::FinishPhysicsAsyncCook(bool bSuccess, TSharedRef<TPromise<ERealtimeMeshCollisionUpdateResult>> Promise, UBodySetup* FinishedBodySetup, int32 UpdateKey)
+void URealtimeMesh::FinishCookCacheLoad(bool bLoaded, TSharedRef<TPromise<ERealtimeMeshCollisionUpdateResult>> Promise, UBodySetup* LoadedBodySetup, int32 UpdateKey,
+                                        TOptional<FSHAHash> CookHash)
+{
+	check(IsInGameThread());
+
+	if (bLoaded)
+	{
+		// Cooked before, applied as a finished cook would be, and already in the cache
+		FinishPhysicsAsyncCook(true, Promise, LoadedBodySetup, UpdateKey, TOptional<FSHAHash>());
+	}
+	else if (LoadedBodySetup && PendingBodySetup == LoadedBodySetup)
+	{
+		LoadedBodySetup->CreatePhysicsMeshesAsync(
+			FOnAsyncPhysicsCookFinished::CreateUObject(this, &URealtimeMesh::FinishPhysicsAsyncCook, Promise, LoadedBodySetup, UpdateKey, CookHash));
+	}
+	else
+	{
+		// A newer update replaced this one while the cache was read, there is nothing to cook for it
+		Promise->SetValue(ERealtimeMeshCollisionUpdateResult::Ignored);
+	}
+}
+
+// ReSharper disable once CppPassValueParameterByConstReference
+void URealtimeMesh::FinishPhysicsAsyncCook(bool bSuccess, TSharedRef<TPromise<ERealtimeMeshCollisionUpdateResult>> Promise, UBodySetup* FinishedBodySetup, int32 UpdateKey,
+                                           TOptional<FSHAHash> CookHash)
 {
 	check(IsInGameThread());
 	check(SharedResources && MeshRef);
 
 	RealtimeMesh::FRealtimeMeshScopeGuardWrite Guard(SharedResources->GetGuard());
 
+	// Even a superseded cook is what its triangles cook to
+	if (bSuccess && CookHash.IsSet())
+	{
+		RealtimeMesh::FRealtimeMeshCollisionCache::Get().Store(CookHash.GetValue(), FinishedBodySetup);
+	}
+
 	bool bSendEvent = false;
 
 	// Apply body setup if newer and succeeded build
@@ -311,6 +481,16 @@ void URealtimeMesh::FinishPhysicsAsyncCook(bool bSuccess, TSharedRef<TPromise<ER
 	{
 		if (UpdateKey > CurrentCollisionVersion)
 		{
+			// The triangles of the cook are still pending unless a newer update replaced them
+			if (PendingCollisionUpdate.IsSet() && PendingCollisionUpdate.GetValue().UpdateKey == UpdateKey)
+			{
+				UpdateCollisionRefit(CollisionRefit, PendingCollisionUpdate.GetValue().bDeformableMesh, PendingCollisionUpdate.GetValue().TriMeshData, FinishedBodySetup);
+			}
+			else
+			{
+				CollisionRefit.Reset();
+			}
+
 			BodySetup = FinishedBodySetup;
 			CurrentCollisionVersion = UpdateKey;
 			Promise->SetValue(ERealtimeMeshCollisionUpdateResult::Updated);
@@ -341,73 +521,275 @@ void URealtimeMesh::FinishPhysicsAsyncCook(bool bSuccess, TSharedRef<TPromise<ER
 }
 
 
-void URealtimeMesh::HandleBoundsUpdated()
+void URealtimeMesh::UpdateCollisionRefit(RealtimeMesh::FRealtimeMeshCollisionRefit& Refit, bool bDeformableMesh, const FRealtimeMeshTriMeshData& TriMeshData, const UBodySetup* CookedBodySetup)
 {
-	BroadcastBoundsChangedEvent();
+	if (bDeformableMesh)
+	{
+		Refit.Capture(TriMeshData, CookedBodySetup);
+	}
+	else
+	{
+		Refit.Reset();
+	}
 }
 
-void URealtimeMesh::HandleMeshRenderingDataChanged()
+TOptional<FSHAHash> URealtimeMesh::GetCookCacheHash(const FRealtimeMeshCollisionConfiguration& Config, const FRealtimeMeshTriMeshData& TriMeshData, const UBodySetup* NewBodySetup)
 {
-	Modify(true);
-	BroadcastRenderDataChangedEvent(true);
-}
+	// Convex elements cook on their own, only a body of complex collision and primitives is whole from the cache
+	if (!Config.bUseCookCache || NewBodySetup->AggGeom.ConvexElems.Num() > 0 || TriMeshData.GetTriangles().Num() == 0)
+	{
+		return TOptional<FSHAHash>();
+	}
 
+	return RealtimeMesh::FRealtimeMeshCollisionCache::HashTriMeshData(TriMeshData, Config.bShouldFastCookMeshes);
+}
 
-struct FRealtimeMeshEndOfFrameUpdateManager
+void URealtimeMesh::InitiateSectionGroupCollisionUpdate(const TSharedRef<TPromise<ERealtimeMeshCollisionUpdateResult>>& Promise, const FRealtimeMeshSectionGroupKey& SectionGroupKey,
+                                                        const TSharedRef<FRealtimeMeshCollisionData>& CollisionUpdate, bool bForceSyncUpdate)
 {
-private:
-	FCriticalSection SyncRoot;
-	TSet<TWeakObjectPtr<URealtimeMesh>> MeshesToUpdate;
-	FDelegateHandle EndOfFrameUpdateHandle;
+	check(IsInGameThread());
+	check(SharedResources && MeshRef);
+
+	RealtimeMesh::FRealtimeMeshScopeGuardWrite Guard(SharedResources->GetGuard());
 
-	void OnPreSendAllEndOfFrameUpdates(UWorld* World)
+	// A group without triangles, or removed, drops its body
+	if (CollisionUpdate->ComplexGeometry.GetTriangles().Num() == 0)
 	{
-		SyncRoot.Lock();
-		auto MeshesCopy = MoveTemp(MeshesToUpdate);
-		SyncRoot.Unlock();
+		RemoveSectionGroupCollisionBody(SectionGroupKey);
+		Promise->SetValue(ERealtimeMeshCollisionUpdateResult::Updated);
+		return;
+	}
+
+	TObjectPtr<URealtimeMeshCollisionBody>& Body = SectionGroupCollisionBodies.FindOrAdd(SectionGroupKey);
+	if (!Body)
+	{
+		Body = NewObject<URealtimeMeshCollisionBody>(this);
+		Body->SectionGroupKey = SectionGroupKey;
+	}
+
+	const int32 UpdateKey = Body->UpdateVersionCounter++;
+	Body->PendingTriMeshData = MoveTemp(CollisionUpdate->ComplexGeometry);
+	Body->bPendingFastCook = CollisionUpdate->Config.bShouldFastCookMeshes;
+	Body->bPendingDeformableMesh = CollisionUpdate->Config.bDeformableMesh;
+
+	UBodySetup* NewBodySetup = NewObject<UBodySetup>(Body, NAME_None, (IsTemplate() ? RF_Public : RF_NoFlags));
+	NewBodySetup->BodySetupGuid = FGuid::NewGuid();
+
+	NewBodySetup->bGenerateMirroredCollision = false;
+	NewBodySetup->bDoubleSidedGeometry = true;
+	NewBodySetup->CollisionTraceFlag = CollisionUpdate->Config.bUseComplexAsSimpleCollision ? CTF_UseComplexAsSimple : CTF_UseDefault;
+
+	// Abort any pending update of this group, the other groups' cooks carry on
+	if (Body->PendingBodySetup)
+	{
+		Body->PendingBodySetup->AbortPhysicsMeshAsyncCreation();
+		Body->PendingBodySetup = nullptr;
+	}
 
-		for (const auto& Mesh : MeshesCopy)
+	const FRealtimeMeshTriMeshData& TriMeshData = Body->PendingTriMeshData.GetValue();
+	const bool bDeformableMesh = CollisionUpdate->Config.bDeformableMesh;
+	if (bDeformableMesh && Body->Refit.Refit(TriMeshData, Body->BodySetup, NewBodySetup))
+	{
+		// Only the vertices moved, such as a smoothing stroke that kept every triangle
+		Body->BodySetup = NewBodySetup;
+		Body->CurrentVersion = UpdateKey;
+		Body->PendingTriMeshData.Reset();
+
+		Promise->SetValue(ERealtimeMeshCollisionUpdateResult::Updated);
+
+		BroadcastSectionGroupCollisionBodyUpdatedEvent(SectionGroupKey, NewBodySetup);
+		return;
+	}
+
+	const TOptional<FSHAHash> CookHash = GetCookCacheHash(CollisionUpdate->Config, TriMeshData, NewBodySetup);
+	if (!bForceSyncUpdate && GetWorld() && GetWorld()->IsGameWorld() && CollisionUpdate->Config.bUseAsyncCook)
+	{
+		Body->PendingBodySetup = NewBodySetup;
+
+		if (CookHash.IsSet())
 		{
-			if (Mesh.IsValid())
-			{
-				Mesh->ProcessEndOfFrameUpdates();
-			}
+			// A chunk generated again cooks to what it cooked to before, read back off the game thread
+			RealtimeMesh::FRealtimeMeshCollisionCache::Get().LoadAsync(CookHash.GetValue(), NewBodySetup,
+				[WeakThis = MakeWeakObjectPtr(this), Promise, WeakBody = MakeWeakObjectPtr(Body.Get()), WeakBodySetup = MakeWeakObjectPtr(NewBodySetup), UpdateKey, CookHash](bool bLoaded)
+				{
+					URealtimeMesh* This = WeakThis.Get();
+					if (!This)
+					{
+						Promise->SetValue(ERealtimeMeshCollisionUpdateResult::Ignored);
+						return;
+					}
+					This->FinishSectionGroupCookCacheLoad(bLoaded, Promise, WeakBody, WeakBodySetup.Get(), UpdateKey, CookHash);
+				});
+		}
+		else
+		{
+			NewBodySetup->CreatePhysicsMeshesAsync(
+				FOnAsyncPhysicsCookFinished::CreateUObject(this, &URealtimeMesh::FinishSectionGroupPhysicsAsyncCook, Promise, MakeWeakObjectPtr(Body.Get()), NewBodySetup, UpdateKey, CookHash));
 		}
 	}
+	else if (CookHash.IsSet() && RealtimeMesh::FRealtimeMeshCollisionCache::Get().Load(CookHash.GetValue(), NewBodySetup))
+	{
+		// A chunk generated again cooks to what it cooked to before
+		UpdateCollisionRefit(Body->Refit, bDeformableMesh, TriMeshData, NewBodySetup);
+		Body->BodySetup = NewBodySetup;
+		Body->CurrentVersion = UpdateKey;
+		Body->PendingTriMeshData.Reset();
 
-public:
-	~FRealtimeMeshEndOfFrameUpdateManager()
+		Promise->SetValue(ERealtimeMeshCollisionUpdateResult::Updated);
+
+		BroadcastSectionGroupCollisionBodyUpdatedEvent(SectionGroupKey, NewBodySetup);
+	}
+	else
 	{
-		if (EndOfFrameUpdateHandle.IsValid())
+		NewBodySetup->bHasCookedCollisionData = true;
+		NewBodySetup->InvalidatePhysicsData();
+		NewBodySetup->CreatePhysicsMeshes();
+
+		if (CookHash.IsSet())
 		{
-			FWorldDelegates::OnWorldPostActorTick.Remove(EndOfFrameUpdateHandle);
-			EndOfFrameUpdateHandle.Reset();
+			RealtimeMesh::FRealtimeMeshCollisionCache::Get().Store(CookHash.GetValue(), NewBodySetup);
 		}
+
+		UpdateCollisionRefit(Body->Refit, bDeformableMesh, TriMeshData, NewBodySetup);
+		Body->BodySetup = NewBodySetup;
+		Body->CurrentVersion = UpdateKey;
+		Body->PendingTriMeshData.Reset();
+
+		Promise->SetValue(ERealtimeMeshCollisionUpdateResult::Updated);
+
+		BroadcastSectionGroupCollisionBodyUpdatedEvent(SectionGroupKey, NewBodySetup);
 	}
+}
 
-	void MarkComponentForUpdate(URealtimeMesh* RealtimeMesh)
+// ReSharper disable once CppPassValueParameterByConstReference
+void URealtimeMesh::FinishSectionGroupCookCacheLoad(bool bLoaded, TSharedRef<TPromise<ERealtimeMeshCollisionUpdateResult>> Promise, TWeakObjectPtr<URealtimeMeshCollisionBody> WeakBody,
+                                                    UBodySetup* LoadedBodySetup, int32 UpdateKey, TOptional<FSHAHash> CookHash)
+{
+	check(IsInGameThread());
+
+	URealtimeMeshCollisionBody* Body = WeakBody.Get();
+	if (bLoaded)
+	{
+		// Applied as a finished cook would be, which also drops it if the group is gone or superseded
+		FinishSectionGroupPhysicsAsyncCook(true, Promise, WeakBody, LoadedBodySetup, UpdateKey, TOptional<FSHAHash>());
+	}
+	else if (Body && LoadedBodySetup && Body->PendingBodySetup == LoadedBodySetup && SectionGroupCollisionBodies.FindRef(Body->SectionGroupKey) == Body)
+	{
+		LoadedBodySetup->CreatePhysicsMeshesAsync(
+			FOnAsyncPhysicsCookFinished::CreateUObject(this, &URealtimeMesh::FinishSectionGroupPhysicsAsyncCook, Promise, WeakBody, LoadedBodySetup, UpdateKey, CookHash));
+	}
+	else
 	{
-		FScopeLock Lock(&SyncRoot);
-		if (!EndOfFrameUpdateHandle.IsValid())
+		Promise->SetValue(ERealtimeMeshCollisionUpdateResult::Ignored);
+	}
+}
+
+// ReSharper disable once CppPassValueParameterByConstReference
+void URealtimeMesh::FinishSectionGroupPhysicsAsyncCook(bool bSuccess, TSharedRef<TPromise<ERealtimeMeshCollisionUpdateResult>> Promise, TWeakObjectPtr<URealtimeMeshCollisionBody> WeakBody,
+                                                      UBodySetup* FinishedBodySetup, int32 UpdateKey, TOptional<FSHAHash> CookHash)
+{
+	check(IsInGameThread());
+	check(SharedResources && MeshRef);
+
+	RealtimeMesh::FRealtimeMeshScopeGuardWrite Guard(SharedResources->GetGuard());
+
+	// Even a cook whose group is gone or superseded is what its triangles cook to
+	if (bSuccess && CookHash.IsSet())
+	{
+		RealtimeMesh::FRealtimeMeshCollisionCache::Get().Store(CookHash.GetValue(), FinishedBodySetup);
+	}
+
+	// The group may have been removed, or emptied and cooked anew, while this cook ran
+	URealtimeMeshCollisionBody* Body = WeakBody.Get();
+	if (!Body || SectionGroupCollisionBodies.FindRef(Body->SectionGroupKey) != Body)
+	{
+		Promise->SetValue(ERealtimeMeshCollisionUpdateResult::Ignored);
+		return;
+	}
+
+	bool bSendEvent = false;
+
+	if (bSuccess)
+	{
+		if (UpdateKey > Body->CurrentVersion)
 		{
-			// TODO: Moved this to post actor tick from OnWorldPreSendAlLEndOfFrameUpdates... Is this the best option?
-			// Servers were not getting events but ever ~60 seconds
-			EndOfFrameUpdateHandle = FWorldDelegates::OnWorldPostActorTick.AddLambda([this](UWorld* World, ELevelTick TickType, float DeltaSeconds) { OnPreSendAllEndOfFrameUpdates(World); });
+			// The triangles of the cook are still pending unless a newer update replaced them
+			if (Body->PendingBodySetup == FinishedBodySetup && Body->PendingTriMeshData.IsSet())
+			{
+				UpdateCollisionRefit(Body->Refit, Body->bPendingDeformableMesh, Body->PendingTriMeshData.GetValue(), FinishedBodySetup);
+			}
+			else
+			{
+				Body->Refit.Reset();
+			}
+
+			Body->BodySetup = FinishedBodySetup;
+			Body->CurrentVersion = UpdateKey;
+			Promise->SetValue(ERealtimeMeshCollisionUpdateResult::Updated);
+			bSendEvent = true;
+		}
+		else
+		{
+			Promise->SetValue(ERealtimeMeshCollisionUpdateResult::Ignored);
 		}
-		MeshesToUpdate.Add(RealtimeMesh);
 	}
+	else
+	{
+		Body->CurrentVersion = UpdateKey;
+		Promise->SetValue(ERealtimeMeshCollisionUpdateResult::Error);
+	}
+
+	if (Body->PendingBodySetup == FinishedBodySetup)
+	{
+		Body->PendingBodySetup = nullptr;
+		Body->PendingTriMeshData.Reset();
+	}
+
+	Guard.Unlock();
 
-	void ClearComponentForUpdate(URealtimeMesh* RealtimeMesh)
+	if (bSendEvent)
 	{
-		FScopeLock Lock(&SyncRoot);
-		MeshesToUpdate.Remove(RealtimeMesh);
+		BroadcastSectionGroupCollisionBodyUpdatedEvent(Body->SectionGroupKey, FinishedBodySetup);
 	}
+}
 
-	static FRealtimeMeshEndOfFrameUpdateManager& Get()
+void URealtimeMesh::RemoveSectionGroupCollisionBody(const FRealtimeMeshSectionGroupKey& SectionGroupKey)
+{
+	TObjectPtr<URealtimeMeshCollisionBody> Body;
+	if (SectionGroupCollisionBodies.RemoveAndCopyValue(SectionGroupKey, Body))
 	{
-		return TLazySingleton<FRealtimeMeshEndOfFrameUpdateManager>::Get();
+		if (Body->PendingBodySetup)
+		{
+			Body->PendingBodySetup->AbortPhysicsMeshAsyncCreation();
+			Body->PendingBodySetup = nullptr;
+		}
+
+		BroadcastSectionGroupCollisionBodyUpdatedEvent(SectionGroupKey, nullptr);
 	}
-};
+}
+
+void URealtimeMesh::RemoveSectionGroupCollisionBodies()
+{
+	TArray<FRealtimeMeshSectionGroupKey> SectionGroupKeys;
+	SectionGroupCollisionBodies.GetKeys(SectionGroupKeys);
+
+	for (const FRealtimeMeshSectionGroupKey& SectionGroupKey : SectionGroupKeys)
+	{
+		RemoveSectionGroupCollisionBody(SectionGroupKey);
+	}
+}
+
+
+void URealtimeMesh::HandleBoundsUpdated()
+{
+	BroadcastBoundsChangedEvent();
+}
+
+void URealtimeMesh::HandleMeshRenderingDataChanged()
+{
+	Modify(true);
+	BroadcastRenderDataChangedEvent(true);
+}
 
 
 void URealtimeMesh::ProcessEndOfFrameUpdates()
@@ -420,7 +802,7 @@ void URealtimeMesh::ProcessEndOfFrameUpdates()
 
 void URealtimeMesh::MarkForEndOfFrameUpdate()
 {
-	FRealtimeMeshEndOfFrameUpdateManager::Get().MarkComponentForUpdate(this);
+	URealtimeMeshSubsystem::MarkMeshForEndOfFrameUpdate(this);
 }
 
 #undef LOCTEXT_NAMESPACE
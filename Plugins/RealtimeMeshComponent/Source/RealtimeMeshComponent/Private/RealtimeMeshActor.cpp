@@ -38,7 +38,7 @@ ARealtimeMeshActor::~ARealtimeMeshActor()
 void ARealtimeMeshActor::OnConstruction(const FTransform& Transform)
 {
 	Super::OnConstruction(Transform);
-	bGeneratedMeshRebuildPending = true;
+	MarkGeneratedMeshRebuildPending();
 }
 
 void ARealtimeMeshActor::PostLoad()
@@ -144,6 +144,33 @@ void ARealtimeMeshActor::UnregisterWithGenerationManager()
 }
 
 
+void ARealtimeMeshActor::MarkGeneratedMeshRebuildPending()
+{
+	bGeneratedMeshRebuildPending = true;
+
+	if (bIsRegisteredWithGenerationManager)
+	{
+		if (URealtimeMeshSubsystem* Subsystem = URealtimeMeshSubsystem::GetInstance(GetWorld()))
+		{
+			Subsystem->MarkGeneratedMeshActorPending(this);
+		}
+	}
+}
+
+
+void ARealtimeMeshActor::SetFrozen(bool bInFrozen)
+{
+	const bool bThawed = bFrozen && !bInFrozen;
+	bFrozen = bInFrozen;
+
+	// The subsystem dropped the rebuild while frozen, in the editor OnConstruction queues it again instead
+	if (bThawed && bGeneratedMeshRebuildPending)
+	{
+		MarkGeneratedMeshRebuildPending();
+	}
+}
+
+
 void ARealtimeMeshActor::ExecuteRebuildGeneratedMeshIfPending()
 {
 	if (bFrozen ||
@@ -70,6 +70,22 @@ FArchive& operator<<(FArchive& Ar, FRealtimeMeshCollisionConfiguration& Config)
 		Ar << Config.bFlipNormals;
 		Ar << Config.bDeformableMesh;
 	}
+
+	if (Ar.CustomVer(RealtimeMesh::FRealtimeMeshVersion::GUID) >= RealtimeMesh::FRealtimeMeshVersion::CollisionConfigCooksPerSectionGroup)
+	{
+		Ar << Config.bCookPerSectionGroup;
+	}
+
+	if (Ar.CustomVer(RealtimeMesh::FRealtimeMeshVersion::GUID) >= RealtimeMesh::FRealtimeMeshVersion::CollisionConfigSelectsSource)
+	{
+		Ar << Config.CollisionLOD;
+		Ar << Config.CollisionSectionGroup;
+	}
+
+	if (Ar.CustomVer(RealtimeMesh::FRealtimeMeshVersion::GUID) >= RealtimeMesh::FRealtimeMeshVersion::CollisionConfigUsesCookCache)
+	{
+		Ar << Config.bUseCookCache;
+	}
 	return Ar;
 }
 
@@ -0,0 +1,369 @@
+// Copyright TriAxis Games, L.L.C. All Rights Reserved.
+
+#include "RealtimeMeshCollisionCache.h"
+#include "RealtimeMeshCollision.h"
+#include "Async/Async.h"
+#include "Chaos/ChaosArchive.h"
+#include "Chaos/TriangleMeshImplicitObject.h"
+#include "HAL/FileManager.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/EngineVersion.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "Serialization/CustomVersion.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+
+namespace RealtimeMesh::CollisionCache::Private
+{
+	using FTriMeshGeometries = decltype(UBodySetup::TriMeshGeometries);
+
+	static const TCHAR* FileExtension = TEXT("rmcol");
+	static constexpr uint32 FileMagic = 0x524D4343;
+
+	// Bump when what is hashed or written changes, files of the previous format then never hit and age out
+	static constexpr uint32 FormatVersion = 2;
+
+	/**
+	 * @brief What a cook leaves on a body setup, the face remap and UV info are what hit results read face indices and UVs from
+	 */
+	struct FCookedCollision
+	{
+		FTriMeshGeometries Geometries;
+		TArray<int32> FaceRemap;
+		FBodySetupUVInfo UVInfo;
+	};
+
+	void SerializeGeometries(FCookedCollision& Cooked, TArray<uint8>& OutData)
+	{
+		TArray<uint8> Payload;
+		FMemoryWriter PayloadWriter(Payload);
+		Chaos::FChaosArchive ChaosWriter(PayloadWriter);
+		ChaosWriter << Cooked.Geometries;
+
+		// The Chaos objects version what they write, the reader needs the same versions set
+		FCustomVersionContainer CustomVersions = PayloadWriter.GetCustomVersions();
+
+		FMemoryWriter Writer(OutData);
+		uint32 Magic = FileMagic;
+		Writer << Magic;
+		CustomVersions.Serialize(Writer);
+		Writer << Payload;
+		Writer << Cooked.FaceRemap;
+		Writer << Cooked.UVInfo;
+	}
+
+	bool DeserializeGeometries(const TArray<uint8>& Data, FCookedCollision& OutCooked)
+	{
+		FMemoryReader Reader(Data);
+		uint32 Magic = 0;
+		Reader << Magic;
+		if (Magic != FileMagic)
+		{
+			return false;
+		}
+
+		FCustomVersionContainer CustomVersions;
+		CustomVersions.Serialize(Reader);
+		TArray<uint8> Payload;
+		Reader << Payload;
+		Reader << OutCooked.FaceRemap;
+		Reader << OutCooked.UVInfo;
+		if (Reader.IsError())
+		{
+			return false;
+		}
+
+		FMemoryReader PayloadReader(Payload);
+		PayloadReader.SetCustomVersions(CustomVersions);
+		Chaos::FChaosArchive ChaosReader(PayloadReader);
+		ChaosReader << OutCooked.Geometries;
+		return !PayloadReader.IsError() && OutCooked.Geometries.Num() > 0;
+	}
+
+	template <typename ElementType>
+	void UpdateWithArray(FSHA1& Sha, const TArray<ElementType>& Array)
+	{
+		const int32 Num = Array.Num();
+		Sha.Update(reinterpret_cast<const uint8*>(&Num), sizeof(Num));
+		Sha.Update(reinterpret_cast<const uint8*>(Array.GetData()), Array.Num() * sizeof(ElementType));
+	}
+}
+
+namespace RealtimeMesh
+{
+	FRealtimeMeshCollisionCache::FRealtimeMeshCollisionCache(const FString& InDirectory, int64 InMaxSize)
+		: Directory(InDirectory)
+		, MaxSize(InMaxSize)
+		, TotalSize(0)
+		, NumHits(0)
+		, NumMisses(0)
+	{
+		using namespace CollisionCache::Private;
+
+		IFileManager::Get().MakeDirectory(*Directory, true);
+
+		// Files written by earlier sessions, their timestamps are when they were last used
+		IFileManager::Get().IterateDirectoryStat(*Directory, [this](const TCHAR* Filename, const FFileStatData& StatData)
+		{
+			const FString Name = FPaths::GetBaseFilename(Filename);
+			if (!StatData.bIsDirectory && FPaths::GetExtension(Filename) == FileExtension && Name.Len() == 40)
+			{
+				FSHAHash Hash;
+				Hash.FromString(Name);
+				Entries.Add(Hash, {StatData.FileSize, StatData.ModificationTime.GetTicks()});
+				TotalSize += StatData.FileSize;
+			}
+			return true;
+		});
+
+		FScopeLock Lock(&Mutex);
+		EvictLocked();
+	}
+
+	FRealtimeMeshCollisionCache::~FRealtimeMeshCollisionCache()
+	{
+		WaitForWrites();
+	}
+
+	FRealtimeMeshCollisionCache& FRealtimeMeshCollisionCache::Get()
+	{
+		static FRealtimeMeshCollisionCache Cache(FPaths::ProjectSavedDir() / TEXT("RealtimeMeshCollision"));
+
+		// Writes run on the thread pool, which is gone by the time statics are destroyed
+		static FDelegateHandle PreExitHandle = FCoreDelegates::OnPreExit.AddLambda([]() { Cache.WaitForWrites(); });
+		return Cache;
+	}
+
+	FSHAHash FRealtimeMeshCollisionCache::HashTriMeshData(const FRealtimeMeshTriMeshData& TriMeshData, bool bFastCook)
+	{
+		using namespace CollisionCache::Private;
+
+		FSHA1 Sha;
+
+		// Cooked data is only read back by the Chaos that wrote it
+		const FString EngineVersion = FEngineVersion::Current().ToString();
+		Sha.UpdateWithString(*EngineVersion, EngineVersion.Len());
+		Sha.Update(reinterpret_cast<const uint8*>(&FormatVersion), sizeof(FormatVersion));
+
+		const uint8 FastCook = bFastCook ? 1 : 0;
+		Sha.Update(&FastCook, sizeof(FastCook));
+
+		UpdateWithArray(Sha, TriMeshData.GetVertices());
+		UpdateWithArray(Sha, TriMeshData.GetTriangles());
+		UpdateWithArray(Sha, TriMeshData.GetMaterials());
+		for (const TArray<FVector2D>& UVChannel : TriMeshData.GetUVs())
+		{
+			UpdateWithArray(Sha, UVChannel);
+		}
+
+		Sha.Final();
+		FSHAHash Hash;
+		Sha.GetHash(Hash.Hash);
+		return Hash;
+	}
+
+	bool FRealtimeMeshCollisionCache::Load(const FSHAHash& Hash, UBodySetup* BodySetup)
+	{
+		CollisionCache::Private::FCookedCollision Cooked;
+		if (!Read(Hash, Cooked))
+		{
+			return false;
+		}
+
+		Apply(Cooked, BodySetup);
+		return true;
+	}
+
+	void FRealtimeMeshCollisionCache::LoadAsync(const FSHAHash& Hash, UBodySetup* BodySetup, TUniqueFunction<void(bool bLoaded)> OnLoaded)
+	{
+		using namespace CollisionCache::Private;
+
+		check(IsInGameThread());
+
+		Async(EAsyncExecution::ThreadPool, [this, Hash, WeakBodySetup = MakeWeakObjectPtr(BodySetup), OnLoaded = MoveTemp(OnLoaded)]() mutable
+		{
+			TSharedRef<FCookedCollision> Cooked = MakeShared<FCookedCollision>();
+			const bool bRead = Read(Hash, *Cooked);
+
+			AsyncTask(ENamedThreads::GameThread, [WeakBodySetup, Cooked, bRead, OnLoaded = MoveTemp(OnLoaded)]()
+			{
+				// The body setup is the caller's, it may have been superseded and collected while the file was read
+				UBodySetup* LoadedBodySetup = WeakBodySetup.Get();
+				const bool bLoaded = bRead && LoadedBodySetup;
+				if (bLoaded)
+				{
+					Apply(*Cooked, LoadedBodySetup);
+				}
+
+				OnLoaded(bLoaded);
+			});
+		});
+	}
+
+	bool FRealtimeMeshCollisionCache::Read(const FSHAHash& Hash, CollisionCache::Private::FCookedCollision& OutCooked)
+	{
+		using namespace CollisionCache::Private;
+
+		{
+			FScopeLock Lock(&Mutex);
+			FEntry* Entry = Entries.Find(Hash);
+			if (!Entry)
+			{
+				++NumMisses;
+				return false;
+			}
+			Entry->LastUsed = FDateTime::UtcNow().GetTicks();
+		}
+
+		const FString Path = GetPath(Hash);
+		TArray<uint8> Data;
+		if (!FFileHelper::LoadFileToArray(Data, *Path, FILEREAD_Silent) || !DeserializeGeometries(Data, OutCooked))
+		{
+			// Deleted from outside, or unreadable, it is cooked and written again
+			FScopeLock Lock(&Mutex);
+			if (const FEntry* Entry = Entries.Find(Hash))
+			{
+				TotalSize -= Entry->Size;
+				Entries.Remove(Hash);
+			}
+			IFileManager::Get().Delete(*Path, false, true, true);
+			++NumMisses;
+			return false;
+		}
+
+		// Keeps the file's place in the eviction order for the next session
+		IFileManager::Get().SetTimeStamp(*Path, FDateTime::UtcNow());
+
+		++NumHits;
+		return true;
+	}
+
+	void FRealtimeMeshCollisionCache::Apply(CollisionCache::Private::FCookedCollision& Cooked, UBodySetup* BodySetup)
+	{
+		BodySetup->TriMeshGeometries = MoveTemp(Cooked.Geometries);
+		BodySetup->FaceRemap = MoveTemp(Cooked.FaceRemap);
+		BodySetup->UVInfo = MoveTemp(Cooked.UVInfo);
+		BodySetup->bHasCookedCollisionData = true;
+		BodySetup->bCreatedPhysicsMeshes = true;
+	}
+
+	void FRealtimeMeshCollisionCache::Store(const FSHAHash& Hash, const UBodySetup* BodySetup)
+	{
+		using namespace CollisionCache::Private;
+
+		if (BodySetup->TriMeshGeometries.Num() == 0)
+		{
+			return;
+		}
+
+		FScopeLock Lock(&Mutex);
+		if (Entries.Contains(Hash) || PendingWrites.Contains(Hash))
+		{
+			return;
+		}
+		PendingWrites.Add(Hash);
+
+		Writes.RemoveAll([](const TFuture<void>& Write) { return Write.IsReady(); });
+
+		// Cooked meshes are not changed once cooked, the write holds on to them until they are on disk
+		FCookedCollision Cooked{BodySetup->TriMeshGeometries, BodySetup->FaceRemap, BodySetup->UVInfo};
+		Writes.Add(Async(EAsyncExecution::ThreadPool, [this, Hash, Cooked = MoveTemp(Cooked)]() mutable
+		{
+			TArray<uint8> Data;
+			SerializeGeometries(Cooked, Data);
+			const bool bSaved = FFileHelper::SaveArrayToFile(Data, *GetPath(Hash));
+
+			FScopeLock WriteLock(&Mutex);
+			PendingWrites.Remove(Hash);
+			if (bSaved)
+			{
+				Entries.Add(Hash, {Data.Num(), FDateTime::UtcNow().GetTicks()});
+				TotalSize += Data.Num();
+				EvictLocked();
+			}
+		}));
+	}
+
+	void FRealtimeMeshCollisionCache::WaitForWrites()
+	{
+		TArray<TFuture<void>> PendingFutures;
+		{
+			FScopeLock Lock(&Mutex);
+			PendingFutures = MoveTemp(Writes);
+		}
+
+		for (const TFuture<void>& Write : PendingFutures)
+		{
+			Write.Wait();
+		}
+	}
+
+	void FRealtimeMeshCollisionCache::Clear()
+	{
+		WaitForWrites();
+
+		FScopeLock Lock(&Mutex);
+		for (const TPair<FSHAHash, FEntry>& Entry : Entries)
+		{
+			IFileManager::Get().Delete(*GetPath(Entry.Key), false, true, true);
+		}
+		Entries.Reset();
+		TotalSize = 0;
+	}
+
+	void FRealtimeMeshCollisionCache::SetMaxSize(int64 InMaxSize)
+	{
+		FScopeLock Lock(&Mutex);
+		MaxSize = InMaxSize;
+		EvictLocked();
+	}
+
+	int64 FRealtimeMeshCollisionCache::GetMaxSize() const
+	{
+		FScopeLock Lock(&Mutex);
+		return MaxSize;
+	}
+
+	int64 FRealtimeMeshCollisionCache::GetSize() const
+	{
+		FScopeLock Lock(&Mutex);
+		return TotalSize;
+	}
+
+	int32 FRealtimeMeshCollisionCache::Num() const
+	{
+		FScopeLock Lock(&Mutex);
+		return Entries.Num();
+	}
+
+	FString FRealtimeMeshCollisionCache::GetPath(const FSHAHash& Hash) const
+	{
+		return Directory / Hash.ToString() + TEXT(".") + CollisionCache::Private::FileExtension;
+	}
+
+	void FRealtimeMeshCollisionCache::EvictLocked()
+	{
+		if (TotalSize <= MaxSize)
+		{
+			return;
+		}
+
+		TArray<TPair<FSHAHash, FEntry>> ByLastUse = Entries.Array();
+		ByLastUse.Sort([](const TPair<FSHAHash, FEntry>& A, const TPair<FSHAHash, FEntry>& B) { return A.Value.LastUsed < B.Value.LastUsed; });
+
+		for (const TPair<FSHAHash, FEntry>& Entry : ByLastUse)
+		{
+			if (TotalSize <= MaxSize)
+			{
+				break;
+			}
+
+			IFileManager::Get().Delete(*GetPath(Entry.Key), false, true, true);
+			Entries.Remove(Entry.Key);
+			TotalSize -= Entry.Value.Size;
+		}
+	}
+}
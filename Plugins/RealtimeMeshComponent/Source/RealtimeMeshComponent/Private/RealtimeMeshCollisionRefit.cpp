@@ -0,0 +1,122 @@
+// Copyright TriAxis Games, L.L.C. All Rights Reserved.
+
+#include "RealtimeMeshCollisionRefit.h"
+#include "RealtimeMeshCollision.h"
+#include "Chaos/TriangleMeshImplicitObject.h"
+#include "PhysicsEngine/BodySetup.h"
+
+
+namespace RealtimeMesh::CollisionRefit::Private
+{
+	using FTriMeshGeometryPtr = decltype(UBodySetup::TriMeshGeometries)::ElementType;
+
+	// Cooked vertices are stored as floats, a refit vertex further than this from where it should be means the maps disagree
+	static constexpr float VertexTolerance = 1.e-4f;
+
+	template <typename ElementType>
+	uint32 HashArray(const TArray<ElementType>& Array, uint32 Crc)
+	{
+		const int32 Num = Array.Num();
+		Crc = FCrc::MemCrc32(&Num, sizeof(Num), Crc);
+		return FCrc::MemCrc32(Array.GetData(), Array.Num() * sizeof(ElementType), Crc);
+	}
+}
+
+namespace RealtimeMesh
+{
+	void FRealtimeMeshCollisionRefit::Capture(const FRealtimeMeshTriMeshData& TriMeshData, const UBodySetup* CookedBodySetup)
+	{
+		Reset();
+
+		if (!CookedBodySetup || CookedBodySetup->TriMeshGeometries.Num() != 1)
+		{
+			return;
+		}
+
+		// The cook welds and drops vertices, find where each source vertex went by its position
+		const auto& Particles = CookedBodySetup->TriMeshGeometries[0]->Particles();
+		const int32 NumCookedVertices = static_cast<int32>(Particles.Size());
+		TMap<FVector3f, int32> CookedVertices;
+		CookedVertices.Reserve(NumCookedVertices);
+		for (int32 Index = 0; Index < NumCookedVertices; Index++)
+		{
+			CookedVertices.Add(FVector3f(Particles.X(Index)), Index);
+		}
+
+		const TArray<FVector3f>& Vertices = TriMeshData.GetVertices();
+		VertexMap.SetNumUninitialized(Vertices.Num());
+		for (int32 Index = 0; Index < Vertices.Num(); Index++)
+		{
+			const int32* CookedIndex = CookedVertices.Find(Vertices[Index]);
+			VertexMap[Index] = CookedIndex ? *CookedIndex : INDEX_NONE;
+		}
+
+		TopologyHash = HashTopology(TriMeshData);
+	}
+
+	bool FRealtimeMeshCollisionRefit::Refit(const FRealtimeMeshTriMeshData& TriMeshData, const UBodySetup* CookedBodySetup, UBodySetup* NewBodySetup) const
+	{
+		using namespace CollisionRefit::Private;
+
+		// Convex elements are cooked with the body, only complex collision and primitives can skip it
+		if (!IsCaptured() || !CookedBodySetup || CookedBodySetup->TriMeshGeometries.Num() != 1 || NewBodySetup->AggGeom.ConvexElems.Num() > 0)
+		{
+			return false;
+		}
+
+		const TArray<FVector3f>& Vertices = TriMeshData.GetVertices();
+		if (Vertices.Num() != VertexMap.Num() || HashTopology(TriMeshData) != TopologyHash)
+		{
+			return false;
+		}
+
+		TArray<FVector> Positions;
+		Positions.SetNumUninitialized(Vertices.Num());
+		for (int32 Index = 0; Index < Vertices.Num(); Index++)
+		{
+			Positions[Index] = FVector(Vertices[Index]);
+		}
+
+		// The cooked mesh may be in use by the physics scene, move the vertices of a copy
+		TUniquePtr<Chaos::FTriangleMeshImplicitObject> TriMesh = CookedBodySetup->TriMeshGeometries[0]->CopySlow();
+		TriMesh->UpdateVertices(Positions);
+
+		// Vertices welded by the cook that moved apart, or a cook that kept no vertex map, leave the copy wrong
+		const auto& Particles = TriMesh->Particles();
+		for (int32 Index = 0; Index < Vertices.Num(); Index++)
+		{
+			if (VertexMap[Index] != INDEX_NONE && !FVector3f(Particles.X(VertexMap[Index])).Equals(Vertices[Index], VertexTolerance))
+			{
+				return false;
+			}
+		}
+
+		NewBodySetup->TriMeshGeometries.Add(FTriMeshGeometryPtr(TriMesh.Release()));
+		NewBodySetup->FaceRemap = CookedBodySetup->FaceRemap;
+		NewBodySetup->UVInfo = CookedBodySetup->UVInfo;
+		NewBodySetup->bHasCookedCollisionData = true;
+		NewBodySetup->bCreatedPhysicsMeshes = true;
+		return true;
+	}
+
+	void FRealtimeMeshCollisionRefit::Reset()
+	{
+		TopologyHash = 0;
+		VertexMap.Empty();
+	}
+
+	uint32 FRealtimeMeshCollisionRefit::HashTopology(const FRealtimeMeshTriMeshData& TriMeshData)
+	{
+		using namespace CollisionRefit::Private;
+
+		const int32 NumVertices = TriMeshData.GetVertices().Num();
+		uint32 Crc = FCrc::MemCrc32(&NumVertices, sizeof(NumVertices));
+		Crc = HashArray(TriMeshData.GetTriangles(), Crc);
+		Crc = HashArray(TriMeshData.GetMaterials(), Crc);
+		for (const TArray<FVector2D>& UVChannel : TriMeshData.GetUVs())
+		{
+			Crc = HashArray(UVChannel, Crc);
+		}
+		return Crc;
+	}
+}
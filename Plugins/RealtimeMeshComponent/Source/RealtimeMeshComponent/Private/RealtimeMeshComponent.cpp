@@ -7,6 +7,7 @@
 #include "RealtimeMeshCore.h"
 #include "RealtimeMesh.h"
 #include "NavigationSystem.h"
+#include "AI/NavigationSystemHelpers.h"
 
 
 DECLARE_CYCLE_STAT(TEXT("RealtimeMeshComponent - Collision Data Received"), STAT_RealtimeMeshComponent_NewCollisionMeshReceived, STATGROUP_RealtimeMesh);
@@ -15,6 +16,9 @@ DECLARE_CYCLE_STAT(TEXT("RealtimeMeshComponent - Create Scene Proxy"), STAT_Real
 URealtimeMeshComponent::URealtimeMeshComponent()
 {
 	SetNetAddressable();
+
+	// Section group bodies are exported alongside the component's own body
+	bHasCustomNavigableGeometry = EHasCustomNavigableGeometry::Yes;
 }
 
 void URealtimeMeshComponent::SetRealtimeMesh(URealtimeMesh* NewMesh)
@@ -120,6 +124,112 @@ UBodySetup* URealtimeMeshComponent::GetBodySetup()
 }
 
 
+bool URealtimeMeshComponent::DoCustomNavigableGeometryExport(FNavigableGeometryExport& GeomExport) const
+{
+	if (const URealtimeMesh* Mesh = GetRealtimeMesh())
+	{
+		for (const auto& Body : Mesh->GetSectionGroupCollisionBodies())
+		{
+			if (Body.Value->BodySetup)
+			{
+				GeomExport.ExportRigidBodySetup(*Body.Value->BodySetup, GetComponentTransform());
+			}
+		}
+	}
+
+	// The component's own body, if any, exports as usual
+	return true;
+}
+
+void URealtimeMeshComponent::OnCreatePhysicsState()
+{
+	Super::OnCreatePhysicsState();
+
+	CreateSectionGroupBodies();
+}
+
+void URealtimeMeshComponent::OnDestroyPhysicsState()
+{
+	DestroySectionGroupBodies();
+
+	Super::OnDestroyPhysicsState();
+}
+
+void URealtimeMeshComponent::OnUpdateTransform(EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	Super::OnUpdateTransform(UpdateTransformFlags, Teleport);
+
+	if (!EnumHasAnyFlags(UpdateTransformFlags, EUpdateTransformFlags::SkipPhysicsUpdate))
+	{
+		for (const auto& Body : SectionGroupBodies)
+		{
+			Body.Value->SetBodyTransform(GetComponentTransform(), Teleport);
+			Body.Value->UpdateBodyScale(GetComponentTransform().GetScale3D());
+		}
+	}
+}
+
+void URealtimeMeshComponent::OnComponentCollisionSettingsChanged(bool bUpdateOverlaps)
+{
+	// Section group bodies copy the component's settings when they are created
+	if (SectionGroupBodies.Num() > 0)
+	{
+		DestroySectionGroupBodies();
+		CreateSectionGroupBodies();
+	}
+
+	Super::OnComponentCollisionSettingsChanged(bUpdateOverlaps);
+}
+
+void URealtimeMeshComponent::CreateSectionGroupBody(const FRealtimeMeshSectionGroupKey& SectionGroupKey, UBodySetup* BodySetup)
+{
+	UWorld* World = GetWorld();
+	if (!BodySetup || !World || !World->GetPhysicsScene())
+	{
+		return;
+	}
+
+	FBodyInstance* Body = new FBodyInstance();
+	Body->CopyBodyInstancePropertiesFrom(&BodyInstance);
+	Body->bAutoWeld = false;
+	Body->bSimulatePhysics = false;
+	Body->InitBody(BodySetup, GetComponentTransform(), this, World->GetPhysicsScene());
+
+	SectionGroupBodies.Add(SectionGroupKey, Body);
+}
+
+void URealtimeMeshComponent::DestroySectionGroupBody(const FRealtimeMeshSectionGroupKey& SectionGroupKey)
+{
+	FBodyInstance* Body = nullptr;
+	if (SectionGroupBodies.RemoveAndCopyValue(SectionGroupKey, Body))
+	{
+		Body->TermBody();
+		delete Body;
+	}
+}
+
+void URealtimeMeshComponent::CreateSectionGroupBodies()
+{
+	if (const URealtimeMesh* Mesh = GetRealtimeMesh())
+	{
+		for (const auto& Body : Mesh->GetSectionGroupCollisionBodies())
+		{
+			CreateSectionGroupBody(Body.Key, Body.Value->BodySetup);
+		}
+	}
+}
+
+void URealtimeMeshComponent::DestroySectionGroupBodies()
+{
+	for (const auto& Body : SectionGroupBodies)
+	{
+		Body.Value->TermBody();
+		delete Body.Value;
+	}
+	SectionGroupBodies.Empty();
+}
+
+
 int32 URealtimeMeshComponent::GetMaterialIndex(FName MaterialSlotName) const
 {
 	if (const URealtimeMesh* Mesh = GetRealtimeMesh())
@@ -195,6 +305,7 @@ void URealtimeMeshComponent::BindToEvents(URealtimeMesh* RealtimeMesh)
 	RealtimeMesh->OnBoundsChanged().AddUObject(this, &URealtimeMeshComponent::HandleBoundsUpdated);
 	RealtimeMesh->OnRenderDataChanged().AddUObject(this, &URealtimeMeshComponent::HandleMeshRenderingDataChanged);
 	RealtimeMesh->OnCollisionBodyUpdated().AddUObject(this, &URealtimeMeshComponent::HandleCollisionBodyUpdated);
+	RealtimeMesh->OnSectionGroupCollisionBodyUpdated().AddUObject(this, &URealtimeMeshComponent::HandleSectionGroupCollisionBodyUpdated);
 }
 
 void URealtimeMeshComponent::UnbindFromEvents(URealtimeMesh* RealtimeMesh)
@@ -202,6 +313,7 @@ void URealtimeMeshComponent::UnbindFromEvents(URealtimeMesh* RealtimeMesh)
 	RealtimeMesh->OnBoundsChanged().RemoveAll(this);
 	RealtimeMesh->OnRenderDataChanged().RemoveAll(this);
 	RealtimeMesh->OnCollisionBodyUpdated().RemoveAll(this);
+	RealtimeMesh->OnSectionGroupCollisionBodyUpdated().RemoveAll(this);
 }
 
 
@@ -223,6 +335,18 @@ void URealtimeMeshComponent::HandleCollisionBodyUpdated(URealtimeMesh* RealtimeM
 	UpdateCollision();
 }
 
+void URealtimeMeshComponent::HandleSectionGroupCollisionBodyUpdated(URealtimeMesh* RealtimeMesh, const FRealtimeMeshSectionGroupKey& SectionGroupKey, UBodySetup* BodySetup)
+{
+	// Only this group's body is replaced, the rest of the component's physics state is left alone
+	DestroySectionGroupBody(SectionGroupKey);
+	if (IsPhysicsStateCreated())
+	{
+		CreateSectionGroupBody(SectionGroupKey, BodySetup);
+	}
+
+	FNavigationSystem::UpdateComponentData(*this);
+}
+
 void URealtimeMeshComponent::UpdateCollision()
 {
 	if (KeepMomentumOnCollisionUpdate)
@@ -113,7 +113,8 @@ FRealtimeMeshSectionGroupKey FRealtimeMeshSectionGroupKey::CreateUnique(const FR
 
 bool FRealtimeMeshSectionKey::IsPolyGroupKey() const
 {
-	return GroupName.ToString().StartsWith("Section_PolyGroup");
+	// CreateForPolyGroup names the section, not the group
+	return SectionName.ToString().StartsWith("Section_PolyGroup");
 }
 
 FRealtimeMeshSectionKey FRealtimeMeshSectionKey::Create(const FRealtimeMeshSectionGroupKey& SectionGroupKey, FName SectionName)
@@ -2,9 +2,86 @@
 
 #include "RealtimeMeshEngineSubsystem.h"
 
+#include "RealtimeMesh.h"
 #include "RealtimeMeshActor.h"
 #include "Engine/Engine.h"
 #include "Engine/Level.h"
+#include "Engine/World.h"
+#include "Misc/LazySingleton.h"
+
+
+/* Meshes with end of frame work, across every world since meshes can be marked from any thread and need not be in one */
+struct FRealtimeMeshEndOfFrameUpdateManager
+{
+private:
+	FCriticalSection SyncRoot;
+	TArray<TWeakObjectPtr<URealtimeMesh>> MeshesToUpdate;
+	TAtomic<int32> NumMeshesToUpdate;
+	FDelegateHandle EndOfFrameUpdateHandle;
+
+	void OnPreSendAllEndOfFrameUpdates(UWorld* World)
+	{
+		// Every world's actor tick ends here, leave without taking the lock when nothing is queued
+		if (NumMeshesToUpdate == 0)
+		{
+			return;
+		}
+
+		SyncRoot.Lock();
+		auto MeshesCopy = MoveTemp(MeshesToUpdate);
+		NumMeshesToUpdate = 0;
+		SyncRoot.Unlock();
+
+		for (const auto& Mesh : MeshesCopy)
+		{
+			if (URealtimeMesh* RealtimeMesh = Mesh.Get())
+			{
+				// Cleared first so a mesh marked again while it processes is queued for the next frame
+				RealtimeMesh->bQueuedForEndOfFrameUpdate = false;
+				RealtimeMesh->ProcessEndOfFrameUpdates();
+			}
+		}
+	}
+
+public:
+	FRealtimeMeshEndOfFrameUpdateManager()
+		: NumMeshesToUpdate(0)
+	{
+	}
+
+	~FRealtimeMeshEndOfFrameUpdateManager()
+	{
+		if (EndOfFrameUpdateHandle.IsValid())
+		{
+			FWorldDelegates::OnWorldPostActorTick.Remove(EndOfFrameUpdateHandle);
+			EndOfFrameUpdateHandle.Reset();
+		}
+	}
+
+	void MarkMeshForUpdate(URealtimeMesh* RealtimeMesh)
+	{
+		if (RealtimeMesh->bQueuedForEndOfFrameUpdate.Exchange(true))
+		{
+			return;
+		}
+
+		FScopeLock Lock(&SyncRoot);
+		if (!EndOfFrameUpdateHandle.IsValid())
+		{
+			// TODO: Moved this to post actor tick from OnWorldPreSendAlLEndOfFrameUpdates... Is this the best option?
+			// Servers were not getting events but ever ~60 seconds
+			EndOfFrameUpdateHandle = FWorldDelegates::OnWorldPostActorTick.AddLambda([this](UWorld* World, ELevelTick TickType, float DeltaSeconds) { OnPreSendAllEndOfFrameUpdates(World); });
+		}
+		MeshesToUpdate.Add(RealtimeMesh);
+		NumMeshesToUpdate = MeshesToUpdate.Num();
+	}
+
+	static FRealtimeMeshEndOfFrameUpdateManager& Get()
+	{
+		return TLazySingleton<FRealtimeMeshEndOfFrameUpdateManager>::Get();
+	}
+};
+
 
 URealtimeMeshSubsystem::URealtimeMeshSubsystem()
 	: bInitialized(false)
@@ -30,7 +107,7 @@ void URealtimeMeshSubsystem::Deinitialize()
 
 bool URealtimeMeshSubsystem::IsTickable() const
 {
-	return ActiveGeneratedActors.Num() > 0;
+	return PendingGeneratedActors.Num() > 0;
 }
 
 bool URealtimeMeshSubsystem::IsTickableInEditor() const
@@ -42,13 +119,25 @@ void URealtimeMeshSubsystem::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
-	// Rebuild all valid generated actors, if necessary
-	for (TWeakObjectPtr<ARealtimeMeshActor>& Actor : ActiveGeneratedActors)
+	// Rebuild the generated actors that asked for it, rebuilds can queue actors again for the next tick.
+	// Frozen actors are dropped with their rebuild still pending, thawing or constructing them again queues it
+	const TSet<TWeakObjectPtr<ARealtimeMeshActor>> PendingActors = MoveTemp(PendingGeneratedActors);
+	PendingGeneratedActors.Reset();
+	for (const TWeakObjectPtr<ARealtimeMeshActor>& Actor : PendingActors)
 	{
-		if (Actor.IsValid() && IsValid(Actor->GetLevel()))
+		if (!Actor.IsValid())
+		{
+			continue;
+		}
+
+		// Not in a level yet, it stays queued since joining one does not queue the rebuild again
+		if (!IsValid(Actor->GetLevel()))
 		{
-			Actor->ExecuteRebuildGeneratedMeshIfPending();
+			PendingGeneratedActors.Add(Actor);
+			continue;
 		}
+
+		Actor->ExecuteRebuildGeneratedMeshIfPending();
 	}
 }
 
@@ -61,7 +150,11 @@ bool URealtimeMeshSubsystem::RegisterGeneratedMeshActor(ARealtimeMeshActor* Acto
 {
 	if (GetWorld() && bInitialized)
 	{
-		ActiveGeneratedActors.Add(Actor);
+		// Actors constructed before they registered are already waiting on their rebuild
+		if (Actor->IsGeneratedMeshRebuildPending())
+		{
+			PendingGeneratedActors.Add(Actor);
+		}
 		return true;
 	}
 	return false;
@@ -71,10 +164,23 @@ void URealtimeMeshSubsystem::UnregisterGeneratedMeshActor(ARealtimeMeshActor* Ac
 {
 	if (GetWorld() && bInitialized)
 	{
-		ActiveGeneratedActors.Remove(Actor);
+		PendingGeneratedActors.Remove(Actor);
 	}
 }
 
+void URealtimeMeshSubsystem::MarkGeneratedMeshActorPending(ARealtimeMeshActor* Actor)
+{
+	if (GetWorld() && bInitialized)
+	{
+		PendingGeneratedActors.Add(Actor);
+	}
+}
+
+void URealtimeMeshSubsystem::MarkMeshForEndOfFrameUpdate(URealtimeMesh* Mesh)
+{
+	FRealtimeMeshEndOfFrameUpdateManager::Get().MarkMeshForUpdate(Mesh);
+}
+
 URealtimeMeshSubsystem* URealtimeMeshSubsystem::GetInstance(UWorld* World)
 {
 	return World ? World->GetSubsystem<URealtimeMeshSubsystem>() : nullptr;
@@ -8,6 +8,8 @@
 #include "RenderProxy/RealtimeMeshSectionGroupProxy.h"
 #include "RenderProxy/RealtimeMeshVertexFactory.h"
 #include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Misc/ScopeLock.h"
 #include "Mesh/RealtimeMeshBlueprintMeshBuilder.h"
 #if RMC_ENGINE_ABOVE_5_2
 #include "Logging/MessageLog.h"
@@ -20,12 +22,138 @@ namespace RealtimeMesh
 {
 	namespace Simple::Private
 	{
-		static thread_local bool bShouldDeferPolyGroupUpdates = false;		
+		static thread_local bool bShouldDeferPolyGroupUpdates = false;
+
+		/* Whether a collision only mesh keeps the stream, collision reads positions, triangles and texcoords and sections come from the polygroups */
+		bool IsCollisionStream(const FRealtimeMeshStreamKey& StreamKey)
+		{
+			return StreamKey == FRealtimeMeshStreams::Position ||
+				StreamKey == FRealtimeMeshStreams::Triangles ||
+				StreamKey == FRealtimeMeshStreams::TexCoords ||
+				StreamKey == FRealtimeMeshStreams::PolyGroups ||
+				StreamKey == FRealtimeMeshStreams::PolyGroupSegments;
+		}
+
+		/* Copies the triangles of a section's index range, rebased to the first vertex of its range. Triangles reaching outside the range are skipped. */
+		template <typename IndexType>
+		void CopyCollisionTriangles(TConstArrayView<IndexType> Indices, int32 MinVertex, int32 NumVertices, TArray<FTriIndices>& OutTriangles)
+		{
+			for (int32 TriIdx = 0; TriIdx + 2 < Indices.Num(); TriIdx += 3)
+			{
+				FTriIndices Tri;
+				Tri.v0 = Indices[TriIdx + 0] - MinVertex;
+				Tri.v1 = Indices[TriIdx + 1] - MinVertex;
+				Tri.v2 = Indices[TriIdx + 2] - MinVertex;
+
+				if ((uint32)Tri.v0 < (uint32)NumVertices && (uint32)Tri.v1 < (uint32)NumVertices && (uint32)Tri.v2 < (uint32)NumVertices)
+				{
+					OutTriangles.Add(Tri);
+				}
+			}
+		}
+
+		/* Concatenates section blocks onto the collision data. Offsets of every block are summed up first,
+		 * so each block then copies into its own slice of the pre-sized arrays in parallel. */
+		void AppendCollisionMeshBlocks(FRealtimeMeshTriMeshData& CollisionData, TConstArrayView<FRealtimeMeshCollisionMeshBlock> Blocks)
+		{
+			auto& CollisionVertices = CollisionData.GetVertices();
+			auto& CollisionUVs = CollisionData.GetUVs();
+			auto& CollisionMaterials = CollisionData.GetMaterials();
+			auto& CollisionTriangles = CollisionData.GetTriangles();
+
+			TArray<int32> VertexOffsets;
+			TArray<int32> TriangleOffsets;
+			VertexOffsets.SetNumUninitialized(Blocks.Num());
+			TriangleOffsets.SetNumUninitialized(Blocks.Num());
+
+			int32 NumVertices = CollisionVertices.Num();
+			int32 NumTriangles = CollisionTriangles.Num();
+			for (int32 BlockIndex = 0; BlockIndex < Blocks.Num(); BlockIndex++)
+			{
+				VertexOffsets[BlockIndex] = NumVertices;
+				TriangleOffsets[BlockIndex] = NumTriangles;
+				NumVertices += Blocks[BlockIndex].Mesh->GetVertices().Num();
+				NumTriangles += Blocks[BlockIndex].Mesh->GetTriangles().Num();
+			}
+
+			if (CollisionUVs.Num() < 1)
+			{
+				CollisionUVs.SetNum(1);
+			}
+			// Keep the UVs lined up with the vertices already there
+			CollisionUVs[0].SetNumZeroed(CollisionVertices.Num());
+
+			CollisionVertices.SetNumUninitialized(NumVertices);
+			CollisionUVs[0].SetNumUninitialized(NumVertices);
+			CollisionTriangles.SetNumUninitialized(NumTriangles);
+			CollisionMaterials.SetNumUninitialized(NumTriangles);
+
+			ParallelFor(Blocks.Num(), [&](int32 BlockIndex)
+			{
+				const FRealtimeMeshCollisionMeshBlock& Block = Blocks[BlockIndex];
+				const int32 StartVertexIndex = VertexOffsets[BlockIndex];
+				const int32 StartTriangleIndex = TriangleOffsets[BlockIndex];
+
+				const TArray<FVector3f>& BlockVertices = Block.Mesh->GetVertices();
+				FMemory::Memcpy(CollisionVertices.GetData() + StartVertexIndex, BlockVertices.GetData(), BlockVertices.Num() * BlockVertices.GetTypeSize());
+				const TArray<FVector2D>& BlockUVs = Block.Mesh->GetUVs()[0];
+				FMemory::Memcpy(CollisionUVs[0].GetData() + StartVertexIndex, BlockUVs.GetData(), BlockUVs.Num() * BlockUVs.GetTypeSize());
+
+				const TArray<FTriIndices>& BlockTriangles = Block.Mesh->GetTriangles();
+				for (int32 TriIdx = 0; TriIdx < BlockTriangles.Num(); TriIdx++)
+				{
+					FTriIndices& Tri = CollisionTriangles[StartTriangleIndex + TriIdx];
+					Tri.v0 = BlockTriangles[TriIdx].v0 + StartVertexIndex;
+					Tri.v1 = BlockTriangles[TriIdx].v1 + StartVertexIndex;
+					Tri.v2 = BlockTriangles[TriIdx].v2 + StartVertexIndex;
+
+					CollisionMaterials[StartTriangleIndex + TriIdx] = Block.MaterialSlot;
+				}
+			});
+		}
+
+		/* Gets the collision blocks of the sections, building the stale ones in parallel. Must be called under the mesh read guard,
+		 * the builds only read the streams resolved here and take no lock so they cannot stall behind a waiting writer. */
+		void GatherCollisionMeshBlocks(TConstArrayView<TSharedRef<const FRealtimeMeshSectionSimple>> Sections, TArray<FRealtimeMeshCollisionMeshBlock>& OutBlocks)
+		{
+			TArray<TSharedPtr<const FRealtimeMeshTriMeshData>> SectionBlocks;
+			SectionBlocks.SetNum(Sections.Num());
+
+			TArray<int32> StaleSections;
+			TArray<FRealtimeMeshCollisionMeshSource> StaleSources;
+			for (int32 SectionIndex = 0; SectionIndex < Sections.Num(); SectionIndex++)
+			{
+				if (!Sections[SectionIndex]->FindCachedCollisionMeshBlock(SectionBlocks[SectionIndex]))
+				{
+					StaleSections.Add(SectionIndex);
+					StaleSources.Add(Sections[SectionIndex]->GetCollisionMeshSource());
+				}
+			}
+
+			ParallelFor(StaleSections.Num(), [&](int32 StaleIndex)
+			{
+				SectionBlocks[StaleSections[StaleIndex]] = FRealtimeMeshSectionSimple::BuildCollisionMeshBlock(StaleSources[StaleIndex]);
+			});
+
+			for (const int32 SectionIndex : StaleSections)
+			{
+				Sections[SectionIndex]->SetCollisionMeshBlock(SectionBlocks[SectionIndex]);
+			}
+
+			for (int32 SectionIndex = 0; SectionIndex < Sections.Num(); SectionIndex++)
+			{
+				if (SectionBlocks[SectionIndex])
+				{
+					OutBlocks.Add(FRealtimeMeshCollisionMeshBlock{MoveTemp(SectionBlocks[SectionIndex]), Sections[SectionIndex]->GetConfig().MaterialSlot});
+				}
+			}
+		}
 	}	
 	
 	FRealtimeMeshSectionSimple::FRealtimeMeshSectionSimple(const FRealtimeMeshSharedResourcesRef& InSharedResources, const FRealtimeMeshSectionKey& InKey)
 		: FRealtimeMeshSection(InSharedResources, InKey)
 		  , bShouldCreateMeshCollision(false)
+		  , bCollisionMeshBlockValid(false)
 	{
 		SharedResources->OnStreamChanged().AddRaw(this, &FRealtimeMeshSectionSimple::HandleStreamsChanged);
 	}
@@ -41,8 +169,11 @@ namespace RealtimeMesh
 		if (bShouldCreateMeshCollision != bNewShouldCreateMeshCollision)
 		{
 			bShouldCreateMeshCollision = bNewShouldCreateMeshCollision;
+			InvalidateCollisionMeshBlock();
 			MarkBoundsDirtyIfNotOverridden();
-			MarkCollisionDirtyIfNecessary();
+
+			// Turning collision off has to drop this section's triangles as well
+			StaticCastSharedRef<FRealtimeMeshSharedResourcesSimple>(SharedResources)->BroadcastCollisionDataChanged(Key.SectionGroup());
 		}
 	}
 
@@ -53,6 +184,7 @@ namespace RealtimeMesh
 			FRealtimeMeshScopeGuardWrite ScopeGuard(SharedResources->GetGuard());
 			FRealtimeMeshSection::UpdateStreamRange(Commands, InRange);
 
+			InvalidateCollisionMeshBlock();
 			MarkBoundsDirtyIfNotOverridden();
 			MarkCollisionDirtyIfNecessary();
 		}
@@ -64,130 +196,148 @@ namespace RealtimeMesh
 		}
 	}
 
+	TSharedPtr<const FRealtimeMeshTriMeshData> FRealtimeMeshSectionSimple::GetCollisionMeshBlock() const
+	{
+		FRealtimeMeshScopeGuardRead ScopeGuard(SharedResources->GetGuard());
+
+		TSharedPtr<const FRealtimeMeshTriMeshData> Block;
+		if (!FindCachedCollisionMeshBlock(Block))
+		{
+			Block = BuildCollisionMeshBlock(GetCollisionMeshSource());
+			SetCollisionMeshBlock(Block);
+		}
+		return Block;
+	}
+
 	bool FRealtimeMeshSectionSimple::GenerateCollisionMesh(FRealtimeMeshTriMeshData& CollisionData)
 	{
 		FRealtimeMeshScopeGuardRead ScopeGuard(SharedResources->GetGuard());
-		if (bShouldCreateMeshCollision)
+		if (const auto Block = GetCollisionMeshBlock())
 		{
-			if (const auto SectionGroup = GetSectionGroupAs<FRealtimeMeshSectionGroupSimple>())
-			{
-				const auto PositionStream = SectionGroup->GetStream(FRealtimeMeshStreams::Position);
-				const auto TriangleStream = SectionGroup->GetStream(FRealtimeMeshStreams::Triangles);
+			Simple::Private::AppendCollisionMeshBlocks(CollisionData, {FRealtimeMeshCollisionMeshBlock{Block, GetConfig().MaterialSlot}});
+			return true;
+		}
+		return false;
+	}
 
-				const auto TexCoordsStream = SectionGroup->GetStream(FRealtimeMeshStreamKey(
-					ERealtimeMeshStreamType::Vertex, FRealtimeMeshStreams::TexCoordsStreamName));
+	bool FRealtimeMeshSectionSimple::FindCachedCollisionMeshBlock(TSharedPtr<const FRealtimeMeshTriMeshData>& OutBlock) const
+	{
+		FScopeLock CacheLock(&CollisionMeshBlockLock);
+		if (!bShouldCreateMeshCollision)
+		{
+			OutBlock.Reset();
+			return true;
+		}
 
-				auto& CollisionVertices = CollisionData.GetVertices();
-				auto& CollisionUVs = CollisionData.GetUVs();
-				auto& CollisionMaterials = CollisionData.GetMaterials();
-				auto& CollisionTriangles = CollisionData.GetTriangles();
+		OutBlock = CollisionMeshBlock;
+		return bCollisionMeshBlockValid;
+	}
 
-				if (PositionStream && TriangleStream)
-				{
-					if (PositionStream->Num() >= 3 && (TriangleStream->Num() * TriangleStream->GetNumElements()) >= 3)
-					{
-						const int32 StartVertexIndex = CollisionVertices.Num();
+	void FRealtimeMeshSectionSimple::SetCollisionMeshBlock(const TSharedPtr<const FRealtimeMeshTriMeshData>& InBlock) const
+	{
+		// Generation can run on several threads under the read guard, any of them may fill the cache as they all build the same block
+		FScopeLock CacheLock(&CollisionMeshBlockLock);
+		CollisionMeshBlock = InBlock;
+		bCollisionMeshBlockValid = true;
+	}
 
-						// Copy in the vertices
-						const auto PositionsView = PositionStream->GetArrayView<FVector3f>();
-						CollisionVertices.Append(PositionsView.GetData(), PositionsView.Num());
+	FRealtimeMeshCollisionMeshSource FRealtimeMeshSectionSimple::GetCollisionMeshSource() const
+	{
+		FRealtimeMeshScopeGuardRead ScopeGuard(SharedResources->GetGuard());
 
-						// TODO: We're only copying one UV set
-						if (CollisionUVs.Num() < 1)
-						{
-							CollisionUVs.SetNum(1);
-						}
+		FRealtimeMeshCollisionMeshSource Source;
+		if (const auto SectionGroup = GetSectionGroupAs<FRealtimeMeshSectionGroupSimple>())
+		{
+			Source.Positions = SectionGroup->GetStream(FRealtimeMeshStreams::Position);
+			Source.Triangles = SectionGroup->GetStream(FRealtimeMeshStreams::Triangles);
+			Source.TexCoords = SectionGroup->GetStream(FRealtimeMeshStreamKey(
+				ERealtimeMeshStreamType::Vertex, FRealtimeMeshStreams::TexCoordsStreamName));
+			Source.Range = GetStreamRange();
+		}
+		return Source;
+	}
 
-						int32 NumRemainingTexCoords = PositionStream->Num();
-						if (TexCoordsStream)
-						{
-							if (TexCoordsStream->GetLayout() == RealtimeMesh::GetRealtimeMeshBufferLayout<FVector2DHalf>())
-							{
-								const auto TexCoordsView = TexCoordsStream->GetArrayView<FVector2DHalf>().Left(PositionStream->Num());
-								CollisionUVs[0].SetNum(TexCoordsView.Num());
-								for (int32 TexCoordIdx = 0; TexCoordIdx < TexCoordsView.Num(); TexCoordIdx++)
-								{
-									CollisionUVs[0][TexCoordIdx] = FVector2D(TexCoordsView[TexCoordIdx]);
-								}
-							}
-							else
-							{
-								const auto TexCoordsView = TexCoordsStream->GetArrayView<FVector2f>().Left(PositionStream->Num());
-								CollisionUVs[0].SetNum(TexCoordsView.Num());
-								for (int32 TexCoordIdx = 0; TexCoordIdx < TexCoordsView.Num(); TexCoordIdx++)
-								{
-									CollisionUVs[0][TexCoordIdx] = FVector2D(TexCoordsView[TexCoordIdx]);
-								}
-							}
-							NumRemainingTexCoords -= TexCoordsStream->Num();
-						}
+	TSharedPtr<const FRealtimeMeshTriMeshData> FRealtimeMeshSectionSimple::BuildCollisionMeshBlock(const FRealtimeMeshCollisionMeshSource& Source)
+	{
+		const auto PositionStream = Source.Positions;
+		const auto TriangleStream = Source.Triangles;
+		const auto TexCoordsStream = Source.TexCoords;
 
-						if (NumRemainingTexCoords > 0)
-						{
-							CollisionUVs[0].AddZeroed(NumRemainingTexCoords);
-						}
+		if (!PositionStream || !TriangleStream)
+		{
+			return nullptr;
+		}
 
-						const int32 MaterialSlot = GetConfig().MaterialSlot;
-						if (TriangleStream->GetLayout().GetElementType() == RealtimeMesh::GetRealtimeMeshDataElementType<int16>())
-						{
-							const auto TrianglesView = TriangleStream->GetElementArrayView<int16>();
-							for (int32 TriIdx = 0; TriIdx < TrianglesView.Num(); TriIdx += 3)
-							{
-								FTriIndices& Tri = CollisionTriangles.AddDefaulted_GetRef();
-								Tri.v0 = TrianglesView[TriIdx + 0] + StartVertexIndex;
-								Tri.v1 = TrianglesView[TriIdx + 1] + StartVertexIndex;
-								Tri.v2 = TrianglesView[TriIdx + 2] + StartVertexIndex;
-
-								CollisionMaterials.Add(MaterialSlot);
-							}
-						}
-						else if (TriangleStream->GetLayout().GetElementType() == RealtimeMesh::GetRealtimeMeshDataElementType<uint16>())
-						{
-							const auto TrianglesView = TriangleStream->GetElementArrayView<uint16>();
-							for (int32 TriIdx = 0; TriIdx < TrianglesView.Num(); TriIdx += 3)
-							{
-								FTriIndices& Tri = CollisionTriangles.AddDefaulted_GetRef();
-								Tri.v0 = TrianglesView[TriIdx + 0] + StartVertexIndex;
-								Tri.v1 = TrianglesView[TriIdx + 1] + StartVertexIndex;
-								Tri.v2 = TrianglesView[TriIdx + 2] + StartVertexIndex;
-
-								CollisionMaterials.Add(MaterialSlot);
-							}
-						}
-						else if (TriangleStream->GetLayout().GetElementType() == RealtimeMesh::GetRealtimeMeshDataElementType<int32>())
-						{
-							const auto TrianglesView = TriangleStream->GetElementArrayView<int32>();
-							for (int32 TriIdx = 0; TriIdx < TrianglesView.Num(); TriIdx += 3)
-							{
-								FTriIndices& Tri = CollisionTriangles.AddDefaulted_GetRef();
-								Tri.v0 = TrianglesView[TriIdx + 0] + StartVertexIndex;
-								Tri.v1 = TrianglesView[TriIdx + 1] + StartVertexIndex;
-								Tri.v2 = TrianglesView[TriIdx + 2] + StartVertexIndex;
-
-								CollisionMaterials.Add(MaterialSlot);
-							}
-						}
-						else
-						{
-							const auto TrianglesView = TriangleStream->GetElementArrayView<uint32>();
+		// Only this section's range is copied, polygroup sections share their group's streams
+		const FRealtimeMeshStreamRange& Range = Source.Range;
+		const int32 MinVertex = Range.GetMinVertex();
+		const int32 NumVertices = FMath::Min(Range.NumVertices(), PositionStream->Num() - MinVertex);
+		const int32 MinIndex = Range.GetMinIndex();
+		const int32 NumIndices = FMath::Min(Range.NumPrimitives(3) * 3, TriangleStream->Num() * TriangleStream->GetNumElements() - MinIndex);
 
-							for (int32 TriIdx = 0; TriIdx < TrianglesView.Num(); TriIdx += 3)
-							{
-								FTriIndices& Tri = CollisionTriangles.AddDefaulted_GetRef();
-								Tri.v0 = TrianglesView[TriIdx + 0] + StartVertexIndex;
-								Tri.v1 = TrianglesView[TriIdx + 1] + StartVertexIndex;
-								Tri.v2 = TrianglesView[TriIdx + 2] + StartVertexIndex;
+		if (NumVertices < 3 || NumIndices < 3 || MinVertex < 0 || MinIndex < 0)
+		{
+			return nullptr;
+		}
 
-								CollisionMaterials.Add(MaterialSlot);
-							}
-						}
+		const auto Block = MakeShared<FRealtimeMeshTriMeshData>();
+		auto& CollisionVertices = Block->GetVertices();
+		auto& CollisionUVs = Block->GetUVs();
+		auto& CollisionTriangles = Block->GetTriangles();
 
-						return true;
-					}
+		// Copy in the vertices
+		CollisionVertices.Append(PositionStream->GetArrayView<FVector3f>().Slice(MinVertex, NumVertices));
+
+		// TODO: We're only copying one UV set
+		CollisionUVs.SetNum(1);
+		CollisionUVs[0].Reserve(NumVertices);
+		if (TexCoordsStream && TexCoordsStream->Num() > MinVertex)
+		{
+			const int32 NumTexCoords = FMath::Min(NumVertices, TexCoordsStream->Num() - MinVertex);
+			if (TexCoordsStream->GetLayout() == RealtimeMesh::GetRealtimeMeshBufferLayout<FVector2DHalf>())
+			{
+				for (const FVector2DHalf& TexCoord : TexCoordsStream->GetArrayView<FVector2DHalf>().Slice(MinVertex, NumTexCoords))
+				{
+					CollisionUVs[0].Add(FVector2D(TexCoord));
+				}
+			}
+			else
+			{
+				for (const FVector2f& TexCoord : TexCoordsStream->GetArrayView<FVector2f>().Slice(MinVertex, NumTexCoords))
+				{
+					CollisionUVs[0].Add(FVector2D(TexCoord));
 				}
 			}
 		}
-		return false;
+		CollisionUVs[0].AddZeroed(NumVertices - CollisionUVs[0].Num());
+
+		CollisionTriangles.Reserve(NumIndices / 3);
+		const auto ElementType = TriangleStream->GetLayout().GetElementType();
+		if (ElementType == RealtimeMesh::GetRealtimeMeshDataElementType<int16>())
+		{
+			Simple::Private::CopyCollisionTriangles(TriangleStream->GetElementArrayView<int16>().Slice(MinIndex, NumIndices), MinVertex, NumVertices, CollisionTriangles);
+		}
+		else if (ElementType == RealtimeMesh::GetRealtimeMeshDataElementType<uint16>())
+		{
+			Simple::Private::CopyCollisionTriangles(TriangleStream->GetElementArrayView<uint16>().Slice(MinIndex, NumIndices), MinVertex, NumVertices, CollisionTriangles);
+		}
+		else if (ElementType == RealtimeMesh::GetRealtimeMeshDataElementType<int32>())
+		{
+			Simple::Private::CopyCollisionTriangles(TriangleStream->GetElementArrayView<int32>().Slice(MinIndex, NumIndices), MinVertex, NumVertices, CollisionTriangles);
+		}
+		else
+		{
+			Simple::Private::CopyCollisionTriangles(TriangleStream->GetElementArrayView<uint32>().Slice(MinIndex, NumIndices), MinVertex, NumVertices, CollisionTriangles);
+		}
+
+		return Block;
+	}
+
+	void FRealtimeMeshSectionSimple::InvalidateCollisionMeshBlock() const
+	{
+		FScopeLock CacheLock(&CollisionMeshBlockLock);
+		CollisionMeshBlock.Reset();
+		bCollisionMeshBlockValid = false;
 	}
 
 	bool FRealtimeMeshSectionSimple::Serialize(FArchive& Ar)
@@ -202,6 +352,7 @@ namespace RealtimeMesh
 	void FRealtimeMeshSectionSimple::Reset(FRealtimeMeshProxyCommandBatch& Commands)
 	{
 		bShouldCreateMeshCollision = false;
+		InvalidateCollisionMeshBlock();
 		FRealtimeMeshSection::Reset(Commands);
 	}
 
@@ -214,6 +365,7 @@ namespace RealtimeMesh
 
 		if (StreamKey == FRealtimeMeshStreams::Position || StreamKey == FRealtimeMeshStreams::TexCoords || StreamKey == FRealtimeMeshStreams::Triangles)
 		{
+			InvalidateCollisionMeshBlock();
 			MarkBoundsDirtyIfNotOverridden();
 			MarkCollisionDirtyIfNecessary();
 		}
@@ -247,7 +399,7 @@ namespace RealtimeMesh
 	{
 		if (bShouldCreateMeshCollision)
 		{
-			StaticCastSharedRef<FRealtimeMeshSharedResourcesSimple>(SharedResources)->BroadcastCollisionDataChanged();
+			StaticCastSharedRef<FRealtimeMeshSharedResourcesSimple>(SharedResources)->BroadcastCollisionDataChanged(Key.SectionGroup());
 		}
 	}
 
@@ -347,6 +499,11 @@ namespace RealtimeMesh
 	{
 		FRealtimeMeshScopeGuardWrite ScopeGuard(SharedResources->GetGuard());
 
+		if (SharedResources->IsCollisionOnly() && !Simple::Private::IsCollisionStream(Stream.GetStreamKey()))
+		{
+			return;
+		}
+
 		// Replace the stored stream (We allow this to copy as we then pass the stream to the RT command queue)
 		Streams.AddStream(Stream);
 		
@@ -443,6 +600,24 @@ namespace RealtimeMesh
 
 	void FRealtimeMeshSectionGroupSimple::SetAllStreams(FRealtimeMeshProxyCommandBatch& Commands, FRealtimeMeshStreamSet&& InStreams)
 	{
+		// Streams only the renderer reads are not kept at all
+		if (SharedResources->IsCollisionOnly())
+		{
+			TArray<FRealtimeMeshStreamKey> RenderStreamKeys;
+			InStreams.ForEach([&RenderStreamKeys](const FRealtimeMeshStream& Stream)
+			{
+				if (!Simple::Private::IsCollisionStream(Stream.GetStreamKey()))
+				{
+					RenderStreamKeys.Add(Stream.GetStreamKey());
+				}
+			});
+
+			for (const FRealtimeMeshStreamKey& StreamKey : RenderStreamKeys)
+			{
+				InStreams.Remove(StreamKey);
+			}
+		}
+
 		bool bWantsPolyGroupUpdate = false;
 		bool bWantsDepthOnlyPolyGroupUpdate = false;
 		if (bAutoCreateSectionsForPolygonGroups)
@@ -541,15 +716,34 @@ namespace RealtimeMesh
 	}
 
 	bool FRealtimeMeshSectionGroupSimple::GenerateCollisionMesh(FRealtimeMeshTriMeshData& CollisionData)
+	{
+		TArray<FRealtimeMeshCollisionMeshBlock> Blocks;
+		GatherCollisionMeshBlocks(Blocks);
+		Simple::Private::AppendCollisionMeshBlocks(CollisionData, Blocks);
+		return Blocks.Num() > 0;
+	}
+
+	void FRealtimeMeshSectionGroupSimple::GatherCollisionMeshBlocks(TArray<FRealtimeMeshCollisionMeshBlock>& OutBlocks) const
+	{
+		FRealtimeMeshScopeGuardRead ScopeGuard(SharedResources->GetGuard());
+
+		TArray<TSharedRef<const FRealtimeMeshSectionSimple>> CollisionSections;
+		GatherCollisionSections(CollisionSections);
+		Simple::Private::GatherCollisionMeshBlocks(CollisionSections, OutBlocks);
+	}
+
+	void FRealtimeMeshSectionGroupSimple::GatherCollisionSections(TArray<TSharedRef<const FRealtimeMeshSectionSimple>>& OutSections) const
 	{
 		FRealtimeMeshScopeGuardRead ScopeGuard(SharedResources->GetGuard());
 
-		bool bHasSectionData = false;
 		for (const auto& Section : Sections)
 		{
-			bHasSectionData |= StaticCastSharedRef<FRealtimeMeshSectionSimple>(Section)->GenerateCollisionMesh(CollisionData);
+			const auto SimpleSection = StaticCastSharedRef<const FRealtimeMeshSectionSimple>(Section);
+			if (SimpleSection->HasCollision())
+			{
+				OutSections.Add(SimpleSection);
+			}
 		}
-		return bHasSectionData;
 	}
 
 	void FRealtimeMeshSectionGroupSimple::UpdatePolyGroupSections(FRealtimeMeshProxyCommandBatch& Commands, bool bUpdateDepthOnly)
@@ -597,9 +791,11 @@ namespace RealtimeMesh
 				{
 					check(Sections.Contains(SectionKey));
 					const auto& Section = *Sections.Find(SectionKey);
-					if (Section->GetKey().IsPolyGroupKey() && (Section->GetStreamRange().Vertices.IsEmpty() || Section->GetStreamRange().Indices.IsEmpty()))
+					const bool bHasPolyGroup = Ranges.Contains(Section->GetConfig().MaterialSlot) &&
+						FRealtimeMeshSectionKey::CreateForPolyGroup(Key, Section->GetConfig().MaterialSlot) == SectionKey;
+					if (Section->GetKey().IsPolyGroupKey() && (!bHasPolyGroup || Section->GetStreamRange().Vertices.IsEmpty() || Section->GetStreamRange().Indices.IsEmpty()))
 					{
-						// Drop this section as it's empty.
+						// Drop this section as it's empty, or its polygroup no longer has any triangles
 						RemoveSection(Commands, SectionKey);
 					}
 				}
@@ -615,15 +811,24 @@ namespace RealtimeMesh
 
 	
 	bool FRealtimeMeshLODSimple::GenerateCollisionMesh(FRealtimeMeshTriMeshData& CollisionData)
+	{
+		TArray<FRealtimeMeshCollisionMeshBlock> Blocks;
+		GatherCollisionMeshBlocks(Blocks);
+		Simple::Private::AppendCollisionMeshBlocks(CollisionData, Blocks);
+		return Blocks.Num() > 0;
+	}
+
+	void FRealtimeMeshLODSimple::GatherCollisionMeshBlocks(TArray<FRealtimeMeshCollisionMeshBlock>& OutBlocks) const
 	{
 		FRealtimeMeshScopeGuardRead ScopeGuard(SharedResources->GetGuard());
 
-		bool bHasSectionData = false;
+		// Sections of every group build and copy together, rather than one group after the other
+		TArray<TSharedRef<const FRealtimeMeshSectionSimple>> CollisionSections;
 		for (const auto& SectionGroup : SectionGroups)
 		{
-			bHasSectionData |= StaticCastSharedRef<FRealtimeMeshSectionGroupSimple>(SectionGroup)->GenerateCollisionMesh(CollisionData);
+			StaticCastSharedRef<FRealtimeMeshSectionGroupSimple>(SectionGroup)->GatherCollisionSections(CollisionSections);
 		}
-		return bHasSectionData;
+		Simple::Private::GatherCollisionMeshBlocks(CollisionSections, OutBlocks);
 	}
 
 
@@ -635,6 +840,28 @@ namespace RealtimeMesh
 
 
 	
+	bool FRealtimeMeshSimple::GenerateSectionGroupCollisionMesh(const FRealtimeMeshSectionGroupKey& SectionGroupKey, FRealtimeMeshTriMeshData& CollisionData)
+	{
+		FRealtimeMeshScopeGuardRead ScopeGuard(SharedResources->GetGuard());
+
+		// Only the section groups feeding collision cook bodies
+		if (IsCollisionSource(SectionGroupKey))
+		{
+			if (const auto SectionGroup = GetSectionGroupAs<FRealtimeMeshSectionGroupSimple>(SectionGroupKey))
+			{
+				return SectionGroup->GenerateCollisionMesh(CollisionData);
+			}
+		}
+		return false;
+	}
+
+	bool FRealtimeMeshSimple::IsCollisionSource(const FRealtimeMeshSectionGroupKey& SectionGroupKey) const
+	{
+		FRealtimeMeshScopeGuardRead ScopeGuard(SharedResources->GetGuard());
+		return SectionGroupKey.IsPartOf(FRealtimeMeshLODKey(CollisionConfig.CollisionLOD)) &&
+			(CollisionConfig.CollisionSectionGroup == NAME_None || SectionGroupKey.Name() == CollisionConfig.CollisionSectionGroup);
+	}
+
 	FRealtimeMeshCollisionConfiguration FRealtimeMeshSimple::GetCollisionConfig() const
 	{
 		FRealtimeMeshScopeGuardRead ScopeGuard(SharedResources->GetGuard());
@@ -644,7 +871,25 @@ namespace RealtimeMesh
 	TFuture<ERealtimeMeshCollisionUpdateResult> FRealtimeMeshSimple::SetCollisionConfig(const FRealtimeMeshCollisionConfiguration& InCollisionConfig)
 	{
 		FRealtimeMeshScopeGuardWrite ScopeGuard(SharedResources->GetGuard());
+
+		const bool bWasCookingPerSectionGroup = CollisionConfig.bCookPerSectionGroup;
+		const bool bSourceChanged = InCollisionConfig.CollisionLOD != CollisionConfig.CollisionLOD ||
+			InCollisionConfig.CollisionSectionGroup != CollisionConfig.CollisionSectionGroup;
+
+		// Groups that stop feeding collision drop their bodies
+		if (bWasCookingPerSectionGroup && bSourceChanged)
+		{
+			MarkCollisionSourceSectionGroupsDirty();
+		}
+
 		CollisionConfig = InCollisionConfig;
+
+		// Switching to bodies per section group, or to another source, cooks every group of the source. The whole mesh body keeps only the simple geometry
+		if (CollisionConfig.bCookPerSectionGroup && (!bWasCookingPerSectionGroup || bSourceChanged))
+		{
+			MarkCollisionSourceSectionGroupsDirty();
+		}
+
 		return MarkCollisionDirty();
 	}
 
@@ -663,10 +908,20 @@ namespace RealtimeMesh
 
 	bool FRealtimeMeshSimple::GenerateCollisionMesh(FRealtimeMeshTriMeshData& CollisionData)
 	{
-		// TODO: Allow other LOD to be used for collision?
-		if (LODs.IsValidIndex(0))
+		FRealtimeMeshScopeGuardRead ScopeGuard(SharedResources->GetGuard());
+
+		const FRealtimeMeshLODKey CollisionLODKey(CollisionConfig.CollisionLOD);
+		if (CollisionConfig.CollisionSectionGroup != NAME_None)
 		{
-			return StaticCastSharedRef<FRealtimeMeshLODSimple>(LODs[0])->GenerateCollisionMesh(CollisionData);
+			const auto SectionGroupKey = FRealtimeMeshSectionGroupKey::Create(CollisionLODKey, CollisionConfig.CollisionSectionGroup);
+			if (const auto SectionGroup = GetSectionGroupAs<FRealtimeMeshSectionGroupSimple>(SectionGroupKey))
+			{
+				return SectionGroup->GenerateCollisionMesh(CollisionData);
+			}
+		}
+		else if (const auto LOD = GetLODAs<FRealtimeMeshLODSimple>(CollisionLODKey))
+		{
+			return LOD->GenerateCollisionMesh(CollisionData);
 		}
 		return false;
 	}
@@ -689,9 +944,14 @@ namespace RealtimeMesh
 			Ar << SimpleGeometry;
 		}
 
-		if (Ar.IsLoading() && RenderProxy)
+		if (Ar.IsLoading() && (RenderProxy || SharedResources->IsCollisionOnly()))
 		{
 			MarkCollisionDirtyNoCallback();
+
+			if (CollisionConfig.bCookPerSectionGroup)
+			{
+				MarkCollisionSourceSectionGroupsDirty();
+			}
 		}
 
 		return bResult;
@@ -708,40 +968,75 @@ namespace RealtimeMesh
 		FRealtimeMeshScopeGuardWrite ScopeGuard(SharedResources);
 		MarkForEndOfFrameUpdate();
 
-		if (!PendingCollisionPromise.IsValid())
+		// Every caller this frame waits on the same update, rather than on a chain of one promise per call
+		bCollisionDirty = true;
+		return PendingCollisionPromises.Add_GetRef(MakeShared<TPromise<ERealtimeMeshCollisionUpdateResult>>())->GetFuture();
+	}
+
+	void FRealtimeMeshSimple::MarkCollisionDirtyNoCallback() const
+	{
+		FRealtimeMeshScopeGuardWrite ScopeGuard(SharedResources);
+		MarkForEndOfFrameUpdate();
+		bCollisionDirty = true;
+	}
+
+	void FRealtimeMeshSimple::MarkCollisionSourceSectionGroupsDirty() const
+	{
+		FRealtimeMeshScopeGuardWrite ScopeGuard(SharedResources);
+		if (const auto LOD = GetLOD(FRealtimeMeshLODKey(CollisionConfig.CollisionLOD)))
 		{
-            PendingCollisionPromise = MakeShared<TPromise<ERealtimeMeshCollisionUpdateResult>>();
-			return PendingCollisionPromise->GetFuture();			
+			DirtyCollisionSectionGroups.Append(LOD->GetSectionGroupKeys());
 		}
+	}
 
-		const auto NewPendingPromise = MakeShared<TPromise<ERealtimeMeshCollisionUpdateResult>>();
-		auto NewReturnPromise = MakeShared<TPromise<ERealtimeMeshCollisionUpdateResult>>();
+	void FRealtimeMeshSimple::MarkSectionGroupCollisionDirty(const FRealtimeMeshSectionGroupKey& SectionGroupKey) const
+	{
+		FRealtimeMeshScopeGuardWrite ScopeGuard(SharedResources);
 
-		NewPendingPromise->GetFuture().Next([PendingPromise = PendingCollisionPromise, ReturnPromise = NewReturnPromise](ERealtimeMeshCollisionUpdateResult Result)
+		// Groups that do not feed collision can change freely without a cook
+		if (!IsCollisionSource(SectionGroupKey))
 		{
-			PendingPromise->SetValue(Result);
-			ReturnPromise->SetValue(Result);
-		});
+			return;
+		}
 
-		PendingCollisionPromise = NewPendingPromise;
-		return NewReturnPromise->GetFuture();
+		if (CollisionConfig.bCookPerSectionGroup)
+		{
+			MarkForEndOfFrameUpdate();
+			DirtyCollisionSectionGroups.Add(SectionGroupKey);
+		}
+		else
+		{
+			MarkCollisionDirtyNoCallback();
+		}
 	}
 
-	void FRealtimeMeshSimple::MarkCollisionDirtyNoCallback() const
+	void FRealtimeMeshSimple::HandleCollisionDataChanged(const FRealtimeMeshSectionGroupKey& SectionGroupKey) const
 	{
-		FRealtimeMeshScopeGuardWrite ScopeGuard(SharedResources);
-		MarkForEndOfFrameUpdate();
+		MarkSectionGroupCollisionDirty(SectionGroupKey);
+	}
 
-		if (!PendingCollisionPromise.IsValid())
+	void FRealtimeMeshSimple::HandleSectionChanged(const FRealtimeMeshSectionKey& SectionKey, ERealtimeMeshChangeType ChangeType) const
+	{
+		// Removed sections take their triangles out of their group's body
+		if (ChangeType == ERealtimeMeshChangeType::Removed && CollisionConfig.bCookPerSectionGroup)
+		{
+			MarkSectionGroupCollisionDirty(SectionKey.SectionGroup());
+		}
+	}
+
+	void FRealtimeMeshSimple::HandleSectionGroupChanged(const FRealtimeMeshSectionGroupKey& SectionGroupKey, ERealtimeMeshChangeType ChangeType) const
+	{
+		// Removed groups drop their body
+		if (ChangeType == ERealtimeMeshChangeType::Removed && CollisionConfig.bCookPerSectionGroup)
 		{
-			PendingCollisionPromise = MakeShared<TPromise<ERealtimeMeshCollisionUpdateResult>>();
+			MarkSectionGroupCollisionDirty(SectionGroupKey);
 		}
 	}
 
 	void FRealtimeMeshSimple::ProcessEndOfFrameUpdates()
 	{
 		FRealtimeMeshScopeGuardWrite ScopeGuard(SharedResources);
-		if (PendingCollisionPromise.IsValid())
+		if (bCollisionDirty)
 		{
 			const bool bAsyncCook = CollisionConfig.bUseAsyncCook;
 
@@ -760,7 +1055,8 @@ namespace RealtimeMesh
 				FRealtimeMeshTriMeshData CollisionMesh;
 				if (const auto ThisShared = ThisWeak.Pin())
 				{
-					if (ThisShared->GenerateCollisionMesh(CollisionMesh))
+					// When cooking per section group the whole mesh body only carries the simple geometry
+					if (!CollisionData->Config.bCookPerSectionGroup && ThisShared->GenerateCollisionMesh(CollisionMesh))
 					{
 						CollisionData->ComplexGeometry = MoveTemp(CollisionMesh);
 					}
@@ -778,18 +1074,28 @@ namespace RealtimeMesh
 				GenerateMeshDataLambda();
 			}
 
-			GenerationPromise->GetFuture().Next([ThisWeak, ResultPromise = PendingCollisionPromise](const TSharedPtr<FRealtimeMeshCollisionData>& CollisionData) mutable
+			GenerationPromise->GetFuture().Next([ThisWeak, ResultPromises = MoveTemp(PendingCollisionPromises)](const TSharedPtr<FRealtimeMeshCollisionData>& CollisionData) mutable
 			{
-				auto SendCollisionUpdate = [ThisWeak, ResultPromise, CollisionData]() mutable
+				auto SendCollisionUpdate = [ThisWeak, ResultPromises = MoveTemp(ResultPromises), CollisionData]() mutable
 				{
 					if (const auto ThisShared = ThisWeak.Pin())
 					{
 						ThisShared->UpdateCollision(MoveTemp(*CollisionData))
-						          .Next([ResultPromise](ERealtimeMeshCollisionUpdateResult Result)
+						          .Next([ResultPromises = MoveTemp(ResultPromises)](ERealtimeMeshCollisionUpdateResult Result)
 						          {
-							          ResultPromise->SetValue(Result);
+							          for (const auto& ResultPromise : ResultPromises)
+							          {
+								          ResultPromise->SetValue(Result);
+							          }
 						          });
 					}
+					else
+					{
+						for (const auto& ResultPromise : ResultPromises)
+						{
+							ResultPromise->SetValue(ERealtimeMeshCollisionUpdateResult::Ignored);
+						}
+					}
 				};
 
 				if (!IsInGameThread())
@@ -802,10 +1108,78 @@ namespace RealtimeMesh
 				}
 			});
 
-			PendingCollisionPromise.Reset();
+			PendingCollisionPromises.Reset();
+			bCollisionDirty = false;
+		}
+
+		if (DirtyCollisionSectionGroups.Num() > 0)
+		{
+			ProcessSectionGroupCollisionUpdates();
 		}
 		FRealtimeMesh::ProcessEndOfFrameUpdates();
 	}
+
+	void FRealtimeMeshSimple::ProcessSectionGroupCollisionUpdates()
+	{
+		const bool bAsyncCook = CollisionConfig.bUseAsyncCook;
+
+		// Every dirty group is generated in one task, and each cooks on its own
+		TArray<FRealtimeMeshSectionGroupKey> SectionGroupKeys = DirtyCollisionSectionGroups.Array();
+		DirtyCollisionSectionGroups.Reset();
+
+		auto ThisWeak = TWeakPtr<FRealtimeMeshSimple>(StaticCastSharedRef<FRealtimeMeshSimple>(this->AsShared()));
+
+		const bool bGenerateOnOtherThread = bAsyncCook && IsInGameThread();
+
+		auto GenerateMeshDataLambda = [ThisWeak, SectionGroupKeys = MoveTemp(SectionGroupKeys), Config = CollisionConfig]() mutable
+		{
+			const auto ThisShared = ThisWeak.Pin();
+			if (!ThisShared)
+			{
+				return;
+			}
+
+			TArray<TPair<FRealtimeMeshSectionGroupKey, FRealtimeMeshCollisionData>> Updates;
+			Updates.Reserve(SectionGroupKeys.Num());
+			for (const FRealtimeMeshSectionGroupKey& SectionGroupKey : SectionGroupKeys)
+			{
+				// Groups without collision send empty data, which drops any body they had
+				FRealtimeMeshCollisionData CollisionData;
+				CollisionData.Config = Config;
+				ThisShared->GenerateSectionGroupCollisionMesh(SectionGroupKey, CollisionData.ComplexGeometry);
+				Updates.Emplace(SectionGroupKey, MoveTemp(CollisionData));
+			}
+
+			auto SendCollisionUpdates = [ThisWeak, Updates = MoveTemp(Updates)]() mutable
+			{
+				if (const auto ThisShared = ThisWeak.Pin())
+				{
+					for (auto& Update : Updates)
+					{
+						ThisShared->UpdateSectionGroupCollision(Update.Key, MoveTemp(Update.Value));
+					}
+				}
+			};
+
+			if (!IsInGameThread())
+			{
+				AsyncTask(ENamedThreads::GameThread, MoveTemp(SendCollisionUpdates));
+			}
+			else
+			{
+				SendCollisionUpdates();
+			}
+		};
+
+		if (bGenerateOnOtherThread)
+		{
+			AsyncTask(ENamedThreads::AnyThread, MoveTemp(GenerateMeshDataLambda));
+		}
+		else
+		{
+			GenerateMeshDataLambda();
+		}
+	}
 }
 
 
@@ -10,13 +10,15 @@
 
 namespace RealtimeMesh
 {
+	// A collision only mesh has no proxy to update, its batches stay empty so no stream is copied for the render thread
 	FRealtimeMeshProxyCommandBatch::FRealtimeMeshProxyCommandBatch(const FRealtimeMeshSharedResourcesPtr& InSharedResources, bool bInRequiresProxyRecreate):
-		Mesh(InSharedResources.IsValid() ? InSharedResources->GetOwner() : nullptr)
+		Mesh(InSharedResources.IsValid() && !InSharedResources->IsCollisionOnly() ? InSharedResources->GetOwner() : nullptr)
 		, bRequiresProxyRecreate(bInRequiresProxyRecreate)
 	{
 	}
 
-	FRealtimeMeshProxyCommandBatch::FRealtimeMeshProxyCommandBatch(const FRealtimeMeshPtr& InMesh, bool bInRequiresProxyRecreate): Mesh(InMesh)
+	FRealtimeMeshProxyCommandBatch::FRealtimeMeshProxyCommandBatch(const FRealtimeMeshPtr& InMesh, bool bInRequiresProxyRecreate):
+		Mesh(InMesh.IsValid() && !InMesh->GetSharedResources()->IsCollisionOnly() ? InMesh : nullptr)
 		, bRequiresProxyRecreate(bInRequiresProxyRecreate)
 	{
 	}
@@ -119,6 +119,7 @@ namespace RealtimeMesh
 		virtual FBoxSphereBounds3f CalculateBounds() const;
 
 		TFuture<ERealtimeMeshCollisionUpdateResult> UpdateCollision(FRealtimeMeshCollisionData&& InCollisionData);
+		TFuture<ERealtimeMeshCollisionUpdateResult> UpdateSectionGroupCollision(const FRealtimeMeshSectionGroupKey& SectionGroupKey, FRealtimeMeshCollisionData&& InCollisionData);
 
 		friend class URealtimeMesh;
 	};
@@ -115,6 +115,8 @@ namespace RealtimeMesh
 	DECLARE_DELEGATE(FRealtimeMeshRequestEndOfFrameUpdateDelegate);
 	DECLARE_DELEGATE_ThreeParams(FRealtimeMeshCollisionUpdateDelegate, const TSharedRef<TPromise<ERealtimeMeshCollisionUpdateResult>>&,
 	                             const TSharedRef<FRealtimeMeshCollisionData>&, bool);
+	DECLARE_DELEGATE_FourParams(FRealtimeMeshSectionGroupCollisionUpdateDelegate, const TSharedRef<TPromise<ERealtimeMeshCollisionUpdateResult>>&,
+	                            const FRealtimeMeshSectionGroupKey&, const TSharedRef<FRealtimeMeshCollisionData>&, bool);
 
 	class REALTIMEMESHCOMPONENT_API FRealtimeMeshSharedResources : public TSharedFromThis<FRealtimeMeshSharedResources>
 	{
@@ -122,6 +124,7 @@ namespace RealtimeMesh
 		FName MeshName;
 		FRealtimeMeshWeakPtr Owner;
 		FRealtimeMeshProxyWeakPtr Proxy;
+		bool bCollisionOnly;
 
 		FRealtimeMeshSectionChangedEvent SectionChangedEvent;
 		FRealtimeMeshSectionPropertyChangedEvent SectionConfigChangedEvent;
@@ -146,11 +149,13 @@ namespace RealtimeMesh
 
 		FRealtimeMeshRequestEndOfFrameUpdateDelegate EndOfFrameRequestHandler;
 		FRealtimeMeshCollisionUpdateDelegate CollisionUpdateHandler;
+		FRealtimeMeshSectionGroupCollisionUpdateDelegate SectionGroupCollisionUpdateHandler;
 
 	public:
 		virtual ~FRealtimeMeshSharedResources() = default;
 
 		FRealtimeMeshSharedResources()
+			: bCollisionOnly(false)
 		{
 		}
 
@@ -176,6 +181,13 @@ namespace RealtimeMesh
 		FRealtimeMeshPtr GetOwner() const { return Owner.Pin(); }
 		FRealtimeMeshProxyPtr GetProxy() const { return Proxy.Pin(); }
 
+		/*
+		 * A collision only mesh never creates a render proxy or sends anything to the render thread, and keeps only the
+		 * streams collision is generated from. Meant for dedicated servers.
+		 */
+		bool IsCollisionOnly() const { return bCollisionOnly; }
+		void SetCollisionOnly(bool bInCollisionOnly) { bCollisionOnly = bInCollisionOnly; }
+
 		ERHIFeatureLevel::Type GetFeatureLevel() const;
 
 		virtual bool WantsStreamOnGPU(const FRealtimeMeshStreamKey& StreamKey) const
@@ -310,6 +322,7 @@ namespace RealtimeMesh
 
 		FRealtimeMeshRequestEndOfFrameUpdateDelegate& GetEndOfFrameRequestHandler() { return EndOfFrameRequestHandler; }
 		FRealtimeMeshCollisionUpdateDelegate& GetCollisionUpdateHandler() { return CollisionUpdateHandler; }
+		FRealtimeMeshSectionGroupCollisionUpdateDelegate& GetSectionGroupCollisionUpdateHandler() { return SectionGroupCollisionUpdateHandler; }
 
 	public:
 		virtual FRealtimeMeshVertexFactoryRef CreateVertexFactory() const;
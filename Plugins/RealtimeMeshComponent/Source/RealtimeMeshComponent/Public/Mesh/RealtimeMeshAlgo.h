@@ -177,12 +177,12 @@ namespace RealtimeMeshAlgo
 				continue;
 			}
 
-			int32 MinVertexIndex = Indices[PolyGroup.StartIndex];
+			int32 MinVertexIndex = Indices[PolyGroup.StartIndex * 3];
 			int32 MaxVertexIndex = MinVertexIndex;
 			const int32 MinTriangleIndex = PolyGroup.StartIndex;
 			const int32 MaxTriangleIndex = PolyGroup.StartIndex + PolyGroup.Count;
 
-			for (int32 Index = MinTriangleIndex; Index <= MaxTriangleIndex; Index++)
+			for (int32 Index = MinTriangleIndex; Index < MaxTriangleIndex; Index++)
 			{
 				MinVertexIndex = FMath::Min<IndexType>(MinVertexIndex, Indices[Index * 3 + 0]);
 				MinVertexIndex = FMath::Min<IndexType>(MinVertexIndex, Indices[Index * 3 + 1]);
@@ -193,11 +193,10 @@ namespace RealtimeMeshAlgo
 				MaxVertexIndex = FMath::Max<IndexType>(MaxVertexIndex, Indices[Index * 3 + 2]);
 			}
 
+			// Same vertex and index bounds GatherStreamRangesFromPolyGroupIndices produces
 			if (MaxVertexIndex != MinVertexIndex && MaxTriangleIndex != MinTriangleIndex)
 			{
-				const int32 VertexCount = MaxVertexIndex - MinVertexIndex;
-				const int32 TriangleCount = MaxTriangleIndex - MinTriangleIndex;
-				OutStreamRanges.Add(PolyGroup.PolygonGroupIndex, FRealtimeMeshStreamRange(MinVertexIndex, VertexCount, MinTriangleIndex, TriangleCount));
+				OutStreamRanges.Add(PolyGroup.PolygonGroupIndex, FRealtimeMeshStreamRange(MinVertexIndex, MaxVertexIndex + 1, MinTriangleIndex * 3, MaxTriangleIndex * 3));
 			}
 		}
 	}
@@ -785,6 +785,20 @@ namespace RealtimeMesh
 		FORCEINLINE bool HasPolyGroups() const { return TrianglePolyGroups.IsSet(); }
 		FORCEINLINE bool HasSegments() const { return TriangleSegments.IsSet(); }
 
+		FORCEINLINE SizeType NumVertices() const { return Vertices.Num(); }
+		FORCEINLINE SizeType NumTriangles() const { return Triangles.Num(); }
+
+		// Reserving vertices/triangles also reserves every enabled stream tied to them (tangents, texcoords, colors, polygroups)
+		void ReserveNumVertices(SizeType Number)
+		{
+			Vertices.Reserve(Number);
+		}
+
+		void ReserveNumTriangles(SizeType Number)
+		{
+			Triangles.Reserve(Number);
+		}
+
 
 		void EnableTangents()
 		{
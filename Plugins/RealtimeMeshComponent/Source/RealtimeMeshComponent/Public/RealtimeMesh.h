@@ -5,13 +5,58 @@
 #include "RealtimeMeshCore.h"
 #include "Data/RealtimeMeshData.h"
 #include "RealtimeMeshCollision.h"
+#include "RealtimeMeshCollisionRefit.h"
 #include "Interfaces/Interface_CollisionDataProvider.h"
+#include "Misc/SecureHash.h"
 #if RMC_ENGINE_ABOVE_5_2
 #include "Tickable.h"
 #endif
 #include "RealtimeMesh.generated.h"
 
 
+/*
+ * Collision body of one section group, cooked on its own when the mesh collision config cooks per section group.
+ * Outer of the body setups it cooks, so the cook reads this group's triangles rather than the whole mesh's.
+ */
+UCLASS(Transient)
+class REALTIMEMESHCOMPONENT_API URealtimeMeshCollisionBody : public UObject, public IInterface_CollisionDataProvider
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+	FRealtimeMeshSectionGroupKey SectionGroupKey;
+
+	/* Cooked body in use */
+	UPROPERTY()
+	TObjectPtr<UBodySetup> BodySetup;
+
+	/* Body pending async cook */
+	UPROPERTY()
+	TObjectPtr<UBodySetup> PendingBodySetup;
+
+	/* Triangles of the pending cook */
+	TOptional<FRealtimeMeshTriMeshData> PendingTriMeshData;
+	bool bPendingFastCook;
+	bool bPendingDeformableMesh;
+
+	/* Lets a deformable group move the vertices of its cooked body instead of cooking it again */
+	RealtimeMesh::FRealtimeMeshCollisionRefit Refit;
+
+	/* Counter for generating version identifier for collision updates */
+	int32 UpdateVersionCounter;
+
+	/* Currently applied collision version, used for ignoring old cooks in async */
+	int32 CurrentVersion;
+
+	//	Begin IInterface_CollisionDataProvider interface
+	virtual bool GetPhysicsTriMeshData(struct FTriMeshCollisionData* CollisionData, bool InUseAllTriData) override;
+	virtual bool ContainsPhysicsTriMeshData(bool InUseAllTriData) const override;
+	virtual bool WantsNegXTriMesh() override { return false; }
+	virtual void GetMeshId(FString& OutMeshId) override { OutMeshId = GetName(); }
+	//	End IInterface_CollisionDataProvider interface
+};
+
+
 UCLASS(Blueprintable, Abstract, ClassGroup = Rendering, HideCategories = (Object, Activation, Cooking))
 class REALTIMEMESHCOMPONENT_API URealtimeMesh : public UObject, public IInterface_CollisionDataProvider
 {
@@ -22,6 +67,7 @@ private:
 		FRealtimeMeshTriMeshData TriMeshData;
 		int32 UpdateKey;
 		bool bFastCook;
+		bool bDeformableMesh;
 	};
 
 public:
@@ -31,20 +77,25 @@ public:
 
 	DECLARE_EVENT_TwoParams(URealtimeMesh, FCollisionBodyUpdated, URealtimeMesh*, UBodySetup*);
 
+	DECLARE_EVENT_ThreeParams(URealtimeMesh, FSectionGroupCollisionBodyUpdated, URealtimeMesh*, const FRealtimeMeshSectionGroupKey&, UBodySetup*);
+
 private:
 	FBoundsChangedEvent BoundsChangedEvent;
 	FRenderDataChangedEvent RenderDataChangedEvent;
 	FCollisionBodyUpdated CollisionBodyUpdatedEvent;
+	FSectionGroupCollisionBodyUpdated SectionGroupCollisionBodyUpdatedEvent;
 
 public:
 	FBoundsChangedEvent& OnBoundsChanged() { return BoundsChangedEvent; }
 	FRenderDataChangedEvent& OnRenderDataChanged() { return RenderDataChangedEvent; }
 	FCollisionBodyUpdated& OnCollisionBodyUpdated() { return CollisionBodyUpdatedEvent; }
+	FSectionGroupCollisionBodyUpdated& OnSectionGroupCollisionBodyUpdated() { return SectionGroupCollisionBodyUpdatedEvent; }
 
 protected:
 	void BroadcastBoundsChangedEvent() { BoundsChangedEvent.Broadcast(this); }
 	void BroadcastRenderDataChangedEvent(bool bShouldRecreateProxies) { RenderDataChangedEvent.Broadcast(this, bShouldRecreateProxies); }
 	void BroadcastCollisionBodyUpdatedEvent(UBodySetup* NewBodySetup);
+	void BroadcastSectionGroupCollisionBodyUpdatedEvent(const FRealtimeMeshSectionGroupKey& SectionGroupKey, UBodySetup* NewBodySetup);
 
 	void Initialize(const TSharedRef<RealtimeMesh::FRealtimeMeshSharedResources>& InSharedResources);
 
@@ -75,6 +126,19 @@ protected:
 	/* Currently applied collision version, used for ignoring old cooks in async */
 	int32 CurrentCollisionVersion;
 
+	/* Lets a deformable mesh move the vertices of its cooked body instead of cooking it again */
+	RealtimeMesh::FRealtimeMeshCollisionRefit CollisionRefit;
+
+	/* Kept here so the shared resources a reset creates stay collision only */
+	bool bCollisionOnly;
+
+	/* Set while the mesh waits in the subsystem's end of frame queue, so marking it again does not queue it twice */
+	TAtomic<bool> bQueuedForEndOfFrameUpdate;
+
+	/* Bodies cooked per section group, when the collision config asks for it */
+	UPROPERTY(Transient)
+	TMap<FRealtimeMeshSectionGroupKey, TObjectPtr<URealtimeMeshCollisionBody>> SectionGroupCollisionBodies;
+
 public:
 	RealtimeMesh::FRealtimeMeshRef GetMesh() const { return MeshRef.ToSharedRef(); }
 
@@ -83,6 +147,10 @@ public:
 
 	UBodySetup* GetBodySetup() const { return BodySetup; }
 
+	UBodySetup* GetSectionGroupBodySetup(const FRealtimeMeshSectionGroupKey& SectionGroupKey) const;
+
+	const TMap<FRealtimeMeshSectionGroupKey, TObjectPtr<URealtimeMeshCollisionBody>>& GetSectionGroupCollisionBodies() const { return SectionGroupCollisionBodies; }
+
 	/**
 	 * Reset the mesh to its initial state
 	 */
@@ -95,6 +163,17 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Components|RealtimeMesh")
 	virtual FBoxSphereBounds GetLocalBounds() const;
 
+	/**
+	 * Stops the mesh from rendering, it creates no render proxy and keeps only the streams its collision is generated from.
+	 * Meant for meshes that only exist for collision, like those of a dedicated server. Set it before adding any data,
+	 * render streams already added are not dropped until they are next updated.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Components|RealtimeMesh")
+	void SetCollisionOnly(bool bInCollisionOnly);
+
+	UFUNCTION(BlueprintCallable, Category = "Components|RealtimeMesh")
+	bool IsCollisionOnly() const { return bCollisionOnly; }
+
 
 	/**
 	 * This event will be fired to notify the BP that the generated Mesh should
@@ -165,7 +244,33 @@ protected:
 protected: // Collision
 	void InitiateCollisionUpdate(const TSharedRef<TPromise<ERealtimeMeshCollisionUpdateResult>>& Promise, const TSharedRef<FRealtimeMeshCollisionData>& CollisionUpdate,
 	                             bool bForceSyncUpdate);
-	void FinishPhysicsAsyncCook(bool bSuccess, TSharedRef<TPromise<ERealtimeMeshCollisionUpdateResult>> Promise, UBodySetup* FinishedBodySetup, int32 UpdateKey);
+	void FinishPhysicsAsyncCook(bool bSuccess, TSharedRef<TPromise<ERealtimeMeshCollisionUpdateResult>> Promise, UBodySetup* FinishedBodySetup, int32 UpdateKey,
+	                            TOptional<FSHAHash> CookHash);
+
+	/**
+	 * @brief Applies the cooked meshes the cache read back for an async update, or cooks them on a miss if the update is still pending
+	 */
+	void FinishCookCacheLoad(bool bLoaded, TSharedRef<TPromise<ERealtimeMeshCollisionUpdateResult>> Promise, UBodySetup* LoadedBodySetup, int32 UpdateKey,
+	                         TOptional<FSHAHash> CookHash);
+
+	void InitiateSectionGroupCollisionUpdate(const TSharedRef<TPromise<ERealtimeMeshCollisionUpdateResult>>& Promise, const FRealtimeMeshSectionGroupKey& SectionGroupKey,
+	                                         const TSharedRef<FRealtimeMeshCollisionData>& CollisionUpdate, bool bForceSyncUpdate);
+	void FinishSectionGroupPhysicsAsyncCook(bool bSuccess, TSharedRef<TPromise<ERealtimeMeshCollisionUpdateResult>> Promise, TWeakObjectPtr<URealtimeMeshCollisionBody> WeakBody,
+	                                        UBodySetup* FinishedBodySetup, int32 UpdateKey, TOptional<FSHAHash> CookHash);
+	void FinishSectionGroupCookCacheLoad(bool bLoaded, TSharedRef<TPromise<ERealtimeMeshCollisionUpdateResult>> Promise, TWeakObjectPtr<URealtimeMeshCollisionBody> WeakBody,
+	                                     UBodySetup* LoadedBodySetup, int32 UpdateKey, TOptional<FSHAHash> CookHash);
+
+	/**
+	 * @brief Captures what a deformable mesh needs to refit CookedBodySetup on its next update, or forgets it for any other mesh
+	 */
+	static void UpdateCollisionRefit(RealtimeMesh::FRealtimeMeshCollisionRefit& Refit, bool bDeformableMesh, const FRealtimeMeshTriMeshData& TriMeshData, const UBodySetup* CookedBodySetup);
+
+	/**
+	 * @brief Hash of the triangles to cook if the config uses the cook cache and the body has nothing else to cook
+	 */
+	static TOptional<FSHAHash> GetCookCacheHash(const FRealtimeMeshCollisionConfiguration& Config, const FRealtimeMeshTriMeshData& TriMeshData, const UBodySetup* NewBodySetup);
+	void RemoveSectionGroupCollisionBody(const FRealtimeMeshSectionGroupKey& SectionGroupKey);
+	void RemoveSectionGroupCollisionBodies();
 
 	
 	friend struct FRealtimeMeshEndOfFrameUpdateManager;
@@ -17,14 +17,17 @@ protected:
 		meta = (ExposeFunctionCategories = "Mesh,Rendering,Physics,Components|StaticMesh", AllowPrivateAccess = "true"))
 	TObjectPtr<class URealtimeMeshComponent> RealtimeMeshComponent;
 
-public:
+private:
 	/**
 	 * If true, the RealtimeMeshComponent will be "Frozen" in its current state, and automatic rebuilding
 	 * will be disabled. However the DynamicMesh can still be modified by explicitly-called functions/etc.
+	 * Only set through SetFrozen, which queues a rebuild that was pending while frozen again on thawing.
 	 */
-	UPROPERTY(Category = "RealtimeMeshActor", EditAnywhere, BlueprintReadWrite)
+	UPROPERTY(Category = "RealtimeMeshActor", EditAnywhere, BlueprintReadWrite, BlueprintSetter = SetFrozen, BlueprintGetter = IsFrozen,
+		meta = (AllowPrivateAccess = "true"))
 	bool bFrozen = false;
 
+public:
 	/** If true, the RealtimeMeshComponent will be cleared before the OnRebuildGeneratedMesh event is executed. */
 	UPROPERTY(Category = "RealtimeMeshActor|Advanced", EditAnywhere, BlueprintReadWrite)
 	bool bResetOnRebuild = true;
@@ -55,6 +58,17 @@ public:
 	 */
 	virtual void ExecuteRebuildGeneratedMeshIfPending();
 
+	bool IsGeneratedMeshRebuildPending() const { return bGeneratedMeshRebuildPending; }
+
+	/**
+	 * Freezes or thaws the RealtimeMeshComponent, a rebuild that was pending while frozen is queued again on thawing
+	 */
+	UFUNCTION(Category = "RealtimeMeshActor", BlueprintSetter)
+	void SetFrozen(bool bInFrozen);
+
+	UFUNCTION(Category = "RealtimeMeshActor", BlueprintGetter)
+	bool IsFrozen() const { return bFrozen; }
+
 public:
 	//~ Begin UObject/AActor Interface
 	virtual void PostLoad() override;
@@ -81,4 +95,7 @@ protected:
 
 	void RegisterWithGenerationManager();
 	void UnregisterWithGenerationManager();
+
+	// sets bGeneratedMeshRebuildPending and queues the rebuild with the subsystem, if registered
+	void MarkGeneratedMeshRebuildPending();
 };
@@ -22,6 +22,10 @@ public:
 		  , bShouldFastCookMeshes(false)
 		  , bFlipNormals(false)
 		  , bDeformableMesh(false)
+		  , bCookPerSectionGroup(false)
+		  , CollisionLOD(0)
+		  , CollisionSectionGroup(NAME_None)
+		  , bUseCookCache(false)
 	{
 	}
 
@@ -37,9 +41,29 @@ public:
 	UPROPERTY(Category="RealtimeMesh|Collision", EditAnywhere, BlueprintReadWrite)
 	bool bFlipNormals;
 
+	// Updates that keep every triangle and only move vertices refit the cooked collision instead of cooking it again,
+	// see RealtimeMesh::FRealtimeMeshCollisionRefit.
 	UPROPERTY(Category="RealtimeMesh|Collision", EditAnywhere, BlueprintReadWrite)
 	bool bDeformableMesh;
 
+	// Cook a separate body for each section group, so changing one group only re-cooks that group instead of the whole mesh.
+	// Meant for static meshes such as terrain, the group bodies are not welded together for simulation.
+	UPROPERTY(Category="RealtimeMesh|Collision", EditAnywhere, BlueprintReadWrite)
+	bool bCookPerSectionGroup;
+
+	// LOD whose section groups feed complex collision. A coarser LOD cooks faster and takes less physics memory.
+	UPROPERTY(Category="RealtimeMesh|Collision", EditAnywhere, BlueprintReadWrite, meta=(ClampMin="0", ClampMax="7"))
+	int32 CollisionLOD;
+
+	// Section group of the collision LOD that alone feeds complex collision, such as a collision only group whose sections are not visible.
+	// None uses every section group of the LOD.
+	UPROPERTY(Category="RealtimeMesh|Collision", EditAnywhere, BlueprintReadWrite)
+	FName CollisionSectionGroup;
+
+	// Load cooked collision from the on disk cache when the same triangles were cooked before, and store new cooks in it.
+	// Meant for deterministic generated meshes, see RealtimeMesh::FRealtimeMeshCollisionCache.
+	UPROPERTY(Category="RealtimeMesh|Collision", EditAnywhere, BlueprintReadWrite)
+	bool bUseCookCache;
 
 	friend FArchive& operator<<(FArchive& Ar, FRealtimeMeshCollisionConfiguration& Config);
 };
@@ -0,0 +1,123 @@
+// Copyright TriAxis Games, L.L.C. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "Misc/SecureHash.h"
+
+class UBodySetup;
+struct FRealtimeMeshTriMeshData;
+
+namespace RealtimeMesh::CollisionCache::Private
+{
+	struct FCookedCollision;
+}
+
+namespace RealtimeMesh
+{
+	/**
+	 * @brief Cooked complex collision kept on disk by a hash of the triangles it was cooked from.
+	 * Generated meshes are deterministic, so a section group met again, in this session or a later one, hashes the same and
+	 * loads its cooked triangle meshes instead of cooking them again. Once the files are over the size limit the least
+	 * recently used are deleted. Safe to use from any thread.
+	 */
+	class REALTIMEMESHCOMPONENT_API FRealtimeMeshCollisionCache
+	{
+	public:
+		static constexpr int64 DefaultMaxSize = 256 * 1024 * 1024;
+
+		/**
+		 * @brief Cache in InDirectory, picking up the files already there
+		 * @param InDirectory Directory the cooked meshes are written to
+		 * @param InMaxSize Bytes the files may take before the least recently used are evicted
+		 */
+		FRealtimeMeshCollisionCache(const FString& InDirectory, int64 InMaxSize = DefaultMaxSize);
+		~FRealtimeMeshCollisionCache();
+
+		/**
+		 * @brief Cache in Saved/RealtimeMeshCollision that meshes configured with bUseCookCache share
+		 */
+		static FRealtimeMeshCollisionCache& Get();
+
+		/**
+		 * @brief Hash of everything a cook of TriMeshData reads, and of the engine version whose Chaos the cook is for
+		 */
+		static FSHAHash HashTriMeshData(const FRealtimeMeshTriMeshData& TriMeshData, bool bFastCook);
+
+		/**
+		 * @brief Gives BodySetup the triangle meshes, face remap and UV info cooked for Hash, as if it had cooked them itself
+		 * @return false on a miss, BodySetup is left alone
+		 */
+		bool Load(const FSHAHash& Hash, UBodySetup* BodySetup);
+
+		/**
+		 * @brief Load without blocking the game thread, the file is read and deserialized on the thread pool and given to BodySetup back on the game thread
+		 * @param OnLoaded Called on the game thread with whether BodySetup got the cooked meshes, false on a miss or if BodySetup is gone
+		 */
+		void LoadAsync(const FSHAHash& Hash, UBodySetup* BodySetup, TUniqueFunction<void(bool bLoaded)> OnLoaded);
+
+		/**
+		 * @brief Writes the triangle meshes, face remap and UV info BodySetup cooked to the cache under Hash, in the background
+		 */
+		void Store(const FSHAHash& Hash, const UBodySetup* BodySetup);
+
+		/**
+		 * @brief Blocks until every Store so far is on disk
+		 */
+		void WaitForWrites();
+
+		/**
+		 * @brief Deletes every cached file
+		 */
+		void Clear();
+
+		void SetMaxSize(int64 InMaxSize);
+		int64 GetMaxSize() const;
+
+		/**
+		 * @brief Bytes the cached files take
+		 */
+		int64 GetSize() const;
+
+		int32 Num() const;
+		int32 GetNumHits() const { return NumHits; }
+		int32 GetNumMisses() const { return NumMisses; }
+
+	private:
+		struct FEntry
+		{
+			int64 Size;
+			int64 LastUsed;
+		};
+
+		FString GetPath(const FSHAHash& Hash) const;
+
+		/**
+		 * @brief Reads and deserializes the file for Hash, touches no UObject so it runs on any thread
+		 */
+		bool Read(const FSHAHash& Hash, CollisionCache::Private::FCookedCollision& OutCooked);
+
+		/**
+		 * @brief Gives BodySetup what Read read, on the game thread
+		 */
+		static void Apply(CollisionCache::Private::FCookedCollision& Cooked, UBodySetup* BodySetup);
+
+		/**
+		 * @brief Deletes the least recently used files until the rest fit, call with Mutex held
+		 */
+		void EvictLocked();
+
+		const FString Directory;
+
+		mutable FCriticalSection Mutex;
+		TMap<FSHAHash, FEntry> Entries;
+		TSet<FSHAHash> PendingWrites;
+		TArray<TFuture<void>> Writes;
+		int64 MaxSize;
+		int64 TotalSize;
+
+		TAtomic<int32> NumHits;
+		TAtomic<int32> NumMisses;
+	};
+}
@@ -0,0 +1,50 @@
+// Copyright TriAxis Games, L.L.C. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UBodySetup;
+struct FRealtimeMeshTriMeshData;
+
+namespace RealtimeMesh
+{
+	/**
+	 * @brief What a deformable mesh needs to refit its cooked complex collision instead of cooking it again.
+	 * Captured from a cook, it remembers the topology the cook was for and which cooked vertex each source vertex became.
+	 * An update with the same triangles then copies the cooked triangle mesh, moves its vertices and rebuilds its bounding
+	 * volume hierarchy, which skips the cleaning and welding a cook does. A refit whose vertices do not land where the
+	 * cooked mesh expects them, such as vertices welded by the cook that moved apart, is refused and the update cooks.
+	 * Cooks to capture from are made with FTriMeshCollisionData::bDeformableMesh set, so Chaos keeps the vertex map the refit moves
+	 * vertices through.
+	 */
+	class REALTIMEMESHCOMPONENT_API FRealtimeMeshCollisionRefit
+	{
+	public:
+		/**
+		 * @brief Remembers the topology of TriMeshData and maps its vertices to the ones CookedBodySetup cooked them to
+		 */
+		void Capture(const FRealtimeMeshTriMeshData& TriMeshData, const UBodySetup* CookedBodySetup);
+
+		/**
+		 * @brief Gives NewBodySetup a copy of CookedBodySetup's triangle mesh moved to the vertices of TriMeshData
+		 * @param CookedBodySetup Body the last capture was cooked for
+		 * @return false if TriMeshData differs in more than its vertex positions, NewBodySetup is left alone and needs a cook
+		 */
+		bool Refit(const FRealtimeMeshTriMeshData& TriMeshData, const UBodySetup* CookedBodySetup, UBodySetup* NewBodySetup) const;
+
+		bool IsCaptured() const { return VertexMap.Num() > 0; }
+		void Reset();
+
+		/**
+		 * @brief Hash of everything but the vertex positions of TriMeshData
+		 */
+		static uint32 HashTopology(const FRealtimeMeshTriMeshData& TriMeshData);
+
+	private:
+		uint32 TopologyHash = 0;
+
+		/* Index of the cooked vertex each source vertex became, INDEX_NONE for vertices the cook dropped */
+		TArray<int32> VertexMap;
+	};
+}
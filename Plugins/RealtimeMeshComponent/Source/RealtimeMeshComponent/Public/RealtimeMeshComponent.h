@@ -83,6 +83,18 @@ public:
 	//~ Begin UPrimitiveComponent Interface.
 	virtual FPrimitiveSceneProxy* CreateSceneProxy() override;
 	virtual class UBodySetup* GetBodySetup() override;
+	virtual bool DoCustomNavigableGeometryExport(FNavigableGeometryExport& GeomExport) const override;
+	//~ End UPrimitiveComponent Interface.
+
+protected:
+	//~ Begin UActorComponent Interface.
+	virtual void OnCreatePhysicsState() override;
+	virtual void OnDestroyPhysicsState() override;
+	//~ End UActorComponent Interface.
+
+	//~ Begin UPrimitiveComponent Interface.
+	virtual void OnUpdateTransform(EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport) override;
+	virtual void OnComponentCollisionSettingsChanged(bool bUpdateOverlaps = true) override;
 	//~ End UPrimitiveComponent Interface.
 public:
 	//~ Begin UMeshComponent Interface
@@ -99,12 +111,21 @@ public:
 
 
 private:
+	/* Bodies of the mesh's section groups when it cooks collision per section group, alongside the component's own body */
+	TMap<FRealtimeMeshSectionGroupKey, FBodyInstance*> SectionGroupBodies;
+
+	void CreateSectionGroupBody(const FRealtimeMeshSectionGroupKey& SectionGroupKey, UBodySetup* BodySetup);
+	void DestroySectionGroupBody(const FRealtimeMeshSectionGroupKey& SectionGroupKey);
+	void CreateSectionGroupBodies();
+	void DestroySectionGroupBodies();
+
 	virtual void BindToEvents(URealtimeMesh* RealtimeMesh);
 	virtual void UnbindFromEvents(URealtimeMesh* RealtimeMesh);
 
 	virtual void HandleBoundsUpdated(URealtimeMesh* IncomingMesh);
 	virtual void HandleMeshRenderingDataChanged(URealtimeMesh* IncomingMesh, bool bShouldProxyRecreate);
 	virtual void HandleCollisionBodyUpdated(URealtimeMesh* RealtimeMesh, UBodySetup* BodySetup);
+	virtual void HandleSectionGroupCollisionBodyUpdated(URealtimeMesh* RealtimeMesh, const FRealtimeMeshSectionGroupKey& SectionGroupKey, UBodySetup* BodySetup);
 
 	virtual void UpdateCollision();
 };
@@ -53,6 +53,9 @@ namespace RealtimeMesh
 			StreamKeySizeChanged = 4,
 			RemovedNamedStreamElements = 5,
 			SimpleMeshStoresCollisionConfig = 6,
+			CollisionConfigCooksPerSectionGroup = 7,
+			CollisionConfigSelectsSource = 8,
+			CollisionConfigUsesCookCache = 9,
 
 			// -----<new versions can be added above this line>-------------------------------------------------
 			VersionPlusOne,
@@ -9,6 +9,7 @@
 
 class UWorld;
 class ARealtimeMeshActor;
+class URealtimeMesh;
 
 /**
  * URealtimeMeshEditorSubsystem manages recomputation of "generated" mesh actors, eg
@@ -20,6 +21,9 @@ class ARealtimeMeshActor;
  * allow the Subsystem to tell them when they should regenerate themselves (if necessary).
  * The current behavior is to run all pending generations on a Tick, however in future
  * this regeneration will be more carefully managed via throttling / timeslicing / etc.
+ *
+ * Only actors and meshes that asked for work are visited. Actors queue themselves when their rebuild
+ * becomes pending and meshes when they have end of frame work, so with nothing pending neither costs anything.
  * 
  */
 UCLASS()
@@ -44,10 +48,22 @@ public:
 	bool RegisterGeneratedMeshActor(ARealtimeMeshActor* Actor);
 	void UnregisterGeneratedMeshActor(ARealtimeMeshActor* Actor);
 
+	/**
+	 * @brief Queues the rebuild of a registered actor for the next tick
+	 */
+	void MarkGeneratedMeshActorPending(ARealtimeMeshActor* Actor);
+
+	/**
+	 * @brief Queues the mesh's end of frame updates, processed after the next world finishes ticking its actors.
+	 * Safe to call from any thread, a mesh queued more than once is processed once.
+	 */
+	static void MarkMeshForEndOfFrameUpdate(URealtimeMesh* Mesh);
+
 	static URealtimeMeshSubsystem* GetInstance(UWorld* World);
 
 private:
-	
-	TSet<TWeakObjectPtr<ARealtimeMeshActor>> ActiveGeneratedActors;
+
+	/* Registered actors with a rebuild pending, the only ones the tick visits */
+	TSet<TWeakObjectPtr<ARealtimeMeshActor>> PendingGeneratedActors;
 	bool bInitialized;
 };
@@ -31,6 +31,28 @@ enum class ERealtimeMeshSimpleSectionGroupMode : uint8
 
 namespace RealtimeMesh
 {
+	/**
+	 * @brief Collision mesh of a single section as it caches it, with vertex indices local to the block,
+	 * and the material slot its triangles collide with.
+	 */
+	struct FRealtimeMeshCollisionMeshBlock
+	{
+		TSharedPtr<const FRealtimeMeshTriMeshData> Mesh;
+		int32 MaterialSlot;
+	};
+
+	/**
+	 * @brief Streams and range a section's collision mesh is built from. Resolved under the mesh guard, so the
+	 * build itself can run on other threads without taking it.
+	 */
+	struct FRealtimeMeshCollisionMeshSource
+	{
+		const FRealtimeMeshStream* Positions = nullptr;
+		const FRealtimeMeshStream* Triangles = nullptr;
+		const FRealtimeMeshStream* TexCoords = nullptr;
+		FRealtimeMeshStreamRange Range;
+	};
+
 	/**
 	 * @brief Concrete implementation of FRealtimeMeshSection implementing necessary
 	 * logic to support complex collision updates by section.
@@ -41,6 +63,11 @@ namespace RealtimeMesh
 		// Is the mesh collision enabled for this section?
 		bool bShouldCreateMeshCollision;
 
+		// Collision mesh of this section, kept until its streams, range or collision setting change
+		mutable TSharedPtr<const FRealtimeMeshTriMeshData> CollisionMeshBlock;
+		mutable bool bCollisionMeshBlockValid;
+		mutable FCriticalSection CollisionMeshBlockLock;
+
 	public:
 		FRealtimeMeshSectionSimple(const FRealtimeMeshSharedResourcesRef& InSharedResources, const FRealtimeMeshSectionKey& InKey);
 		virtual ~FRealtimeMeshSectionSimple() override;
@@ -70,6 +97,38 @@ namespace RealtimeMesh
 		 * @return Whether the generation succeeded. 
 		 */
 		virtual bool GenerateCollisionMesh(FRealtimeMeshTriMeshData& CollisionData);
+
+		/**
+		 * @brief Gets the cached collision mesh of this section, building it if its data changed since the last call.
+		 * @return The collision mesh, or null if this section has no collision or no valid triangles.
+		 */
+		TSharedPtr<const FRealtimeMeshTriMeshData> GetCollisionMeshBlock() const;
+
+		/**
+		 * @brief Gets the cached collision mesh of this section without building it.
+		 * @param OutBlock The cached collision mesh, null if this section has no collision.
+		 * @return Whether the cache is current, if not the block has to be built from GetCollisionMeshSource.
+		 */
+		bool FindCachedCollisionMeshBlock(TSharedPtr<const FRealtimeMeshTriMeshData>& OutBlock) const;
+
+		/**
+		 * @brief Caches a collision mesh built from this section's current data.
+		 * @param InBlock The collision mesh, null if the section has no valid triangles.
+		 */
+		void SetCollisionMeshBlock(const TSharedPtr<const FRealtimeMeshTriMeshData>& InBlock) const;
+
+		/**
+		 * @brief Gets the streams and range the collision mesh of this section is built from.
+		 * @return The source, valid until the mesh guard is released.
+		 */
+		FRealtimeMeshCollisionMeshSource GetCollisionMeshSource() const;
+
+		/**
+		 * @brief Copies a section's range of its group streams into a new collision mesh. Takes no lock.
+		 * @param Source Streams and range to copy from.
+		 * @return The new collision mesh, or null if the range has no valid triangles.
+		 */
+		static TSharedPtr<const FRealtimeMeshTriMeshData> BuildCollisionMeshBlock(const FRealtimeMeshCollisionMeshSource& Source);
 		
 		/**
 		 * @brief Serializes this section to the running archive.
@@ -103,6 +162,11 @@ namespace RealtimeMesh
 		 * @brief Marks the collision dirty, to request an update to collision
 		 */
 		void MarkCollisionDirtyIfNecessary() const;
+
+		/**
+		 * @brief Drops the cached collision mesh so the next collision update rebuilds it
+		 */
+		void InvalidateCollisionMeshBlock() const;
 	};
 
 	DECLARE_DELEGATE_RetVal_OneParam(FRealtimeMeshSectionConfig, FRealtimeMeshPolyGroupConfigHandler, int32);
@@ -152,6 +216,8 @@ namespace RealtimeMesh
 		virtual bool Serialize(FArchive& Ar) override;
 		
 		virtual bool GenerateCollisionMesh(FRealtimeMeshTriMeshData& CollisionData);
+		void GatherCollisionMeshBlocks(TArray<FRealtimeMeshCollisionMeshBlock>& OutBlocks) const;
+		void GatherCollisionSections(TArray<TSharedRef<const FRealtimeMeshSectionSimple>>& OutSections) const;
 	protected:
 
 		virtual void UpdatePolyGroupSections(FRealtimeMeshProxyCommandBatch& Commands, bool bUpdateDepthOnly);
@@ -167,9 +233,10 @@ namespace RealtimeMesh
 		}
 
 		virtual bool GenerateCollisionMesh(FRealtimeMeshTriMeshData& CollisionData);
+		void GatherCollisionMeshBlocks(TArray<FRealtimeMeshCollisionMeshBlock>& OutBlocks) const;
 	};
 
-	DECLARE_MULTICAST_DELEGATE(FRealtimeMeshSimpleCollisionDataChangedEvent);
+	DECLARE_MULTICAST_DELEGATE_OneParam(FRealtimeMeshSimpleCollisionDataChangedEvent, const FRealtimeMeshSectionGroupKey&);
 
 	class REALTIMEMESHCOMPONENT_API FRealtimeMeshSharedResourcesSimple : public FRealtimeMeshSharedResources
 	{
@@ -177,7 +244,7 @@ namespace RealtimeMesh
 
 	public:
 		FRealtimeMeshSimpleCollisionDataChangedEvent& OnCollisionDataChanged() { return CollisionDataChangedEvent; }
-		void BroadcastCollisionDataChanged() const { CollisionDataChangedEvent.Broadcast(); }
+		void BroadcastCollisionDataChanged(const FRealtimeMeshSectionGroupKey& SectionGroupKey) const { CollisionDataChangedEvent.Broadcast(SectionGroupKey); }
 
 
 		virtual FRealtimeMeshSectionRef CreateSection(const FRealtimeMeshSectionKey& InKey) const override
@@ -204,23 +271,32 @@ namespace RealtimeMesh
 	protected:
 		FRealtimeMeshCollisionConfiguration CollisionConfig;
 		FRealtimeMeshSimpleGeometry SimpleGeometry;
-		mutable TSharedPtr<TPromise<ERealtimeMeshCollisionUpdateResult>> PendingCollisionPromise;
+		// Callers waiting on the whole mesh collision update pending for the end of the frame
+		mutable TArray<TSharedRef<TPromise<ERealtimeMeshCollisionUpdateResult>>> PendingCollisionPromises;
+		mutable bool bCollisionDirty;
+		// Section groups to re-cook at the end of the frame when cooking per section group
+		mutable TSet<FRealtimeMeshSectionGroupKey> DirtyCollisionSectionGroups;
 
 	public:
 		FRealtimeMeshSimple(const FRealtimeMeshSharedResourcesRef& InSharedResources)
 			: FRealtimeMesh(InSharedResources)
+			, bCollisionDirty(false)
 		{
-			SharedResources->As<FRealtimeMeshSharedResourcesSimple>().OnCollisionDataChanged().AddRaw(this, &FRealtimeMeshSimple::MarkCollisionDirtyNoCallback);
+			SharedResources->As<FRealtimeMeshSharedResourcesSimple>().OnCollisionDataChanged().AddRaw(this, &FRealtimeMeshSimple::HandleCollisionDataChanged);
+			SharedResources->OnSectionChanged().AddRaw(this, &FRealtimeMeshSimple::HandleSectionChanged);
+			SharedResources->OnSectionGroupChanged().AddRaw(this, &FRealtimeMeshSimple::HandleSectionGroupChanged);
 		}
 
 		virtual ~FRealtimeMeshSimple() override
 		{
-			if (PendingCollisionPromise)
+			for (const auto& PendingCollisionPromise : PendingCollisionPromises)
 			{
 				PendingCollisionPromise->SetValue(ERealtimeMeshCollisionUpdateResult::Ignored);
 			}
 			
 			SharedResources->As<FRealtimeMeshSharedResourcesSimple>().OnCollisionDataChanged().RemoveAll(this);
+			SharedResources->OnSectionChanged().RemoveAll(this);
+			SharedResources->OnSectionGroupChanged().RemoveAll(this);
 		}
 
 		FRealtimeMeshCollisionConfiguration GetCollisionConfig() const;
@@ -229,17 +305,28 @@ namespace RealtimeMesh
 		TFuture<ERealtimeMeshCollisionUpdateResult> SetSimpleGeometry(const FRealtimeMeshSimpleGeometry& InSimpleGeometry);
 
 		virtual bool GenerateCollisionMesh(FRealtimeMeshTriMeshData& CollisionData);
+		virtual bool GenerateSectionGroupCollisionMesh(const FRealtimeMeshSectionGroupKey& SectionGroupKey, FRealtimeMeshTriMeshData& CollisionData);
+
+		// Does this section group feed complex collision, as selected by the collision LOD and section group of the config?
+		bool IsCollisionSource(const FRealtimeMeshSectionGroupKey& SectionGroupKey) const;
 
 		virtual void Reset(FRealtimeMeshProxyCommandBatch& Commands, bool bRemoveRenderProxy) override;
 
 		virtual bool Serialize(FArchive& Ar) override;
 
 		void MarkCollisionDirtyNoCallback() const;
+		void MarkSectionGroupCollisionDirty(const FRealtimeMeshSectionGroupKey& SectionGroupKey) const;
 	protected:
 		void MarkForEndOfFrameUpdate() const;
+		void MarkCollisionSourceSectionGroupsDirty() const;
 		TFuture<ERealtimeMeshCollisionUpdateResult> MarkCollisionDirty() const;
 
+		void HandleCollisionDataChanged(const FRealtimeMeshSectionGroupKey& SectionGroupKey) const;
+		void HandleSectionChanged(const FRealtimeMeshSectionKey& SectionKey, ERealtimeMeshChangeType ChangeType) const;
+		void HandleSectionGroupChanged(const FRealtimeMeshSectionGroupKey& SectionGroupKey, ERealtimeMeshChangeType ChangeType) const;
+
 		virtual void ProcessEndOfFrameUpdates() override;
+		void ProcessSectionGroupCollisionUpdates();
 
 		friend class URealtimeMeshSimple;
 	};
@@ -31,6 +31,7 @@ public class RealtimeMeshComponent : ModuleRules
                 "RHI",
                 "NavigationSystem",
                 "PhysicsCore",
+                "Chaos",
 				"DeveloperSettings",
                 "Projects",
             }
@@ -28,6 +28,11 @@ void ARealtimeMeshStressTestActor::OnGenerateMesh_Implementation()
 	RealtimeMesh->SetupMaterialSlot(0, "PrimaryMaterial");
 	RealtimeMesh->SetupMaterialSlot(1, "SecondaryMaterial");
 
+	// The boxes only scale each tick, their collision is refit rather than cooked again
+	FRealtimeMeshCollisionConfiguration CollisionConfig = RealtimeMesh->GetCollisionConfig();
+	CollisionConfig.bDeformableMesh = true;
+	RealtimeMesh->SetCollisionConfig(CollisionConfig);
+
 	// Create a basic single section
 	FRealtimeMeshSimpleMeshData MeshData;
 
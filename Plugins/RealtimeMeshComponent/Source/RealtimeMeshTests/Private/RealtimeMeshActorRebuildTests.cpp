@@ -0,0 +1,70 @@
+﻿// Copyright TriAxis Games, L.L.C. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "Engine/Engine.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "RealtimeMeshEngineSubsystem.h"
+#include "RealtimeMeshRebuildCountingActor.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(RealtimeMeshActorRebuildTests, "RealtimeMeshComponent.RealtimeMeshActorRebuild",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool RealtimeMeshActorRebuildTests::RunTest(const FString& Parameters)
+{
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	URealtimeMeshSubsystem* Subsystem = URealtimeMeshSubsystem::GetInstance(World);
+	if (!TestNotNull(TEXT("SubsystemCreated"), Subsystem))
+	{
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+		return false;
+	}
+
+	// Spawning constructs the actor, which queues its first rebuild
+	ARealtimeMeshRebuildCountingActor* Actor = World->SpawnActor<ARealtimeMeshRebuildCountingActor>();
+	TestTrue(TEXT("SpawnQueuesRebuild"), Actor->IsGeneratedMeshRebuildPending() && Subsystem->IsTickable());
+
+	// A frozen actor is dropped from the queue with its rebuild still pending
+	Actor->SetFrozen(true);
+	TestTrue(TEXT("IsFrozen"), Actor->IsFrozen());
+	Subsystem->Tick(0.0f);
+	TestEqual(TEXT("FrozenDoesNotRebuild"), Actor->NumRebuilds, 0);
+	TestTrue(TEXT("FrozenKeepsRebuildPending"), Actor->IsGeneratedMeshRebuildPending());
+	TestFalse(TEXT("FrozenLeavesQueue"), Subsystem->IsTickable());
+
+	// Thawing queues the pending rebuild again
+	Actor->SetFrozen(false);
+	TestFalse(TEXT("IsThawed"), Actor->IsFrozen());
+	TestTrue(TEXT("ThawRequeuesRebuild"), Subsystem->IsTickable());
+	Subsystem->Tick(0.0f);
+	TestEqual(TEXT("ThawedRebuildsOnce"), Actor->NumRebuilds, 1);
+	TestFalse(TEXT("ThawedRebuildNoLongerPending"), Actor->IsGeneratedMeshRebuildPending());
+	TestFalse(TEXT("ThawedLeavesQueue"), Subsystem->IsTickable());
+
+	// Thawing without a pending rebuild queues nothing
+	Actor->SetFrozen(true);
+	Actor->SetFrozen(false);
+	TestFalse(TEXT("ThawWithoutPendingQueuesNothing"), Subsystem->IsTickable());
+
+	// An actor outside any level stays queued until it is in one
+	ARealtimeMeshRebuildCountingActor* LevelLessActor = NewObject<ARealtimeMeshRebuildCountingActor>(World);
+	LevelLessActor->OnConstruction(FTransform::Identity);
+	Subsystem->RegisterGeneratedMeshActor(LevelLessActor);
+	Subsystem->Tick(0.0f);
+	TestEqual(TEXT("LevelLessDoesNotRebuild"), LevelLessActor->NumRebuilds, 0);
+	TestTrue(TEXT("LevelLessStaysQueued"), Subsystem->IsTickable());
+
+	LevelLessActor->Rename(nullptr, World->PersistentLevel);
+	Subsystem->Tick(0.0f);
+	TestEqual(TEXT("JoiningLevelRebuilds"), LevelLessActor->NumRebuilds, 1);
+	TestFalse(TEXT("JoiningLevelLeavesQueue"), Subsystem->IsTickable());
+
+	Subsystem->UnregisterGeneratedMeshActor(LevelLessActor);
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	return true;
+}
@@ -0,0 +1,24 @@
+﻿// Copyright TriAxis Games, L.L.C. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RealtimeMeshActor.h"
+#include "RealtimeMeshRebuildCountingActor.generated.h"
+
+/**
+ * Generated mesh actor that only counts its rebuilds, for tests of when the subsystem runs them
+ */
+UCLASS(NotBlueprintable, Transient)
+class REALTIMEMESHTESTS_API ARealtimeMeshRebuildCountingActor : public ARealtimeMeshActor
+{
+	GENERATED_BODY()
+
+public:
+	int32 NumRebuilds = 0;
+
+	virtual void OnGenerateMesh_Implementation() override
+	{
+		NumRebuilds++;
+	}
+};
@@ -22,6 +22,12 @@ struct FVoxelChunkNode
 
 	short SectionID = 0;
 
+	// Faces the chunk was last meshed with transition cells on, see FVoxelMeshParams::TransitionFaces
+	uint8 TransitionFaces = 0;
+
+	// Materials the chunk has a section for, as of its last meshing
+	TArray<uint16> Materials;
+
 	FVoxelChunkNode() :
 		Depth(0),
 		Location(FVector::ZeroVector) {};
@@ -106,4 +112,44 @@ struct FVoxelChunkNode
 			}
 		}
 	}
+
+	void GetLeaves(TArray<FVoxelChunkNode*>& InOutLeaves)
+	{
+		if (IsLeaf())
+		{
+			InOutLeaves.Add(this);
+			return;
+		}
+
+		for (uint8 i = 0; i < 8; i++)
+		{
+			if (Children[i] != nullptr)
+			{
+				Children[i]->GetLeaves(InOutLeaves);
+			}
+		}
+	}
+
+	/* Leaves whose box overlaps or touches InBox */
+	void GetLeaves(const FBox& InBox, double InVolumeExtent, TSet<FVoxelChunkNode*>& InOutLeaves)
+	{
+		if (!GetBox(InVolumeExtent).Intersect(InBox))
+		{
+			return;
+		}
+
+		if (IsLeaf())
+		{
+			InOutLeaves.Add(this);
+			return;
+		}
+
+		for (uint8 i = 0; i < 8; i++)
+		{
+			if (Children[i] != nullptr)
+			{
+				Children[i]->GetLeaves(InBox, InVolumeExtent, InOutLeaves);
+			}
+		}
+	}
 };
\ No newline at end of file
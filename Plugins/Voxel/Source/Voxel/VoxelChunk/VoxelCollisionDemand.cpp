@@ -0,0 +1,104 @@
+#include "VoxelCollisionDemand.h"
+
+#include "VoxelChunkNode.h"
+
+
+void FVoxelCollisionDemand::Update(FVoxelChunkNode* InRootNode, double InVolumeExtent, TConstArrayView<FBox> InBounds, bool bInMeshOnDemand, TArray<FVoxelChunkNode*>& OutDropped)
+{
+	Wanted.Reset();
+	if (InRootNode && !InBounds.IsEmpty())
+	{
+		GatherChunks(InRootNode, InVolumeExtent, InBounds, bInMeshOnDemand);
+	}
+
+	// Chunks that stopped being meshed leaves lost their section group and its body with it, only the others need dropping
+	for (auto it = Colliding.CreateIterator(); it; ++it)
+	{
+		FVoxelChunkNode* chunk = *it;
+		if (!Wanted.Contains(chunk))
+		{
+			if (chunk->IsLeaf() && chunk->SectionID != 0)
+			{
+				OutDropped.Add(chunk);
+			}
+			it.RemoveCurrent();
+		}
+	}
+
+	for (FVoxelChunkNode* chunk : Wanted)
+	{
+		if (!Colliding.Contains(chunk) && !Queued.Contains(chunk))
+		{
+			Queue.Add(chunk);
+			Queued.Add(chunk);
+		}
+	}
+}
+
+void FVoxelCollisionDemand::Dequeue(int32 InMaxChunks, TArray<FVoxelChunkNode*>& OutChunks)
+{
+	int32 numTaken = 0;
+	int32 idxQueue = 0;
+	for (; idxQueue < Queue.Num() && numTaken < InMaxChunks; idxQueue++)
+	{
+		FVoxelChunkNode* chunk = Queue[idxQueue];
+		Queued.Remove(chunk);
+
+		// Consumers may have moved on before the chunk's turn came
+		if (Wanted.Contains(chunk))
+		{
+			Colliding.Add(chunk);
+			OutChunks.Add(chunk);
+			numTaken++;
+		}
+	}
+
+	Queue.RemoveAt(0, idxQueue, false);
+}
+
+void FVoxelCollisionDemand::Reset()
+{
+	Wanted.Reset();
+	Colliding.Reset();
+	Queue.Reset();
+	Queued.Reset();
+}
+
+void FVoxelCollisionDemand::GatherChunks(FVoxelChunkNode* InNode, double InVolumeExtent, TConstArrayView<FBox> InBounds, bool bInMeshOnDemand)
+{
+	// A chunk's box holds every child's, so whole branches no consumer is near are skipped at once
+	const FBox box = InNode->GetBox(InVolumeExtent);
+
+	bool bIntersects = false;
+	for (const FBox& bounds : InBounds)
+	{
+		if (bounds.Intersect(box))
+		{
+			bIntersects = true;
+			break;
+		}
+	}
+
+	if (!bIntersects)
+	{
+		return;
+	}
+
+	if (InNode->IsLeaf())
+	{
+		// Leaves without a mesh have nothing to collide with, unless they are only meshed once they are handed out
+		if (bInMeshOnDemand || InNode->SectionID != 0)
+		{
+			Wanted.Add(InNode);
+		}
+		return;
+	}
+
+	for (FVoxelChunkNode* child : InNode->Children)
+	{
+		if (child)
+		{
+			GatherChunks(child, InVolumeExtent, InBounds, bInMeshOnDemand);
+		}
+	}
+}
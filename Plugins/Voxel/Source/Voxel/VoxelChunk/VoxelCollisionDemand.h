@@ -0,0 +1,45 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FVoxelChunkNode;
+
+/*
+ * Which leaf chunks collide, those overlapping the bounds of the actors that can touch the terrain. Chunks a consumer reaches
+ * queue up and are handed out a bounded number at a time, so a consumer teleporting into new terrain spreads its cooks over a
+ * few updates. Chunks no consumer overlaps anymore are dropped at once, collision follows the consumers instead of the terrain.
+ */
+struct VOXEL_API FVoxelCollisionDemand
+{
+	/*
+	 * Collects the meshed leaves under InRootNode that any of InBounds overlaps and queues those without collision.
+	 * With bInMeshOnDemand every leaf in the bounds is collected, for collision only volumes that mesh a leaf once it collides.
+	 * Chunks with collision that no bounds overlap anymore are forgotten, the ones still meshed leaves are added to OutDropped.
+	 */
+	void Update(FVoxelChunkNode* InRootNode, double InVolumeExtent, TConstArrayView<FBox> InBounds, bool bInMeshOnDemand, TArray<FVoxelChunkNode*>& OutDropped);
+
+	/* Takes up to InMaxChunks chunks from the front of the queue that are still wanted, they have collision from now on */
+	void Dequeue(int32 InMaxChunks, TArray<FVoxelChunkNode*>& OutChunks);
+
+	/* Whether InChunk was handed out by Dequeue and has not been dropped since */
+	bool HasCollision(const FVoxelChunkNode* InChunk) const { return Colliding.Contains(InChunk); }
+
+	int32 NumColliding() const { return Colliding.Num(); }
+	int32 NumQueued() const { return Queue.Num(); }
+
+	/* Forgets every chunk, for when the chunk octree is rebuilt */
+	void Reset();
+
+private:
+	void GatherChunks(FVoxelChunkNode* InNode, double InVolumeExtent, TConstArrayView<FBox> InBounds, bool bInMeshOnDemand);
+
+	// Leaves the last Update found inside the bounds
+	TSet<FVoxelChunkNode*> Wanted;
+
+	// Chunks whose sections are set to collide
+	TSet<FVoxelChunkNode*> Colliding;
+
+	// Wanted chunks waiting for collision, in the order they were reached
+	TArray<FVoxelChunkNode*> Queue;
+	TSet<FVoxelChunkNode*> Queued;
+};
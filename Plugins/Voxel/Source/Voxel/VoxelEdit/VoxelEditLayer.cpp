@@ -0,0 +1,101 @@
+#include "VoxelEditLayer.h"
+
+#include "VoxelChunk/VoxelChunkNode.h"
+
+
+namespace VoxelEditLayer
+{
+	/* Polynomial smooth minimum, blends a and b over InSmoothness and equals FMath::Min outside of it */
+	double SmoothMin(double InA, double InB, double InSmoothness)
+	{
+		if (InSmoothness <= 0)
+		{
+			return FMath::Min(InA, InB);
+		}
+
+		const double h = FMath::Clamp(0.5 + 0.5 * (InB - InA) / InSmoothness, 0.0, 1.0);
+		return FMath::Lerp(InB, InA, h) - InSmoothness * h * (1.0 - h);
+	}
+}
+
+double FVoxelEdit::GetDistance(const FVector& InLocation) const
+{
+	const FVector local = InLocation - Center;
+	if (Shape == EVoxelEditShape::Sphere)
+	{
+		return local.Length() - Extent.X;
+	}
+
+	const FVector q = local.GetAbs() - Extent;
+	return q.ComponentMax(FVector::ZeroVector).Length() + FMath::Min(q.GetMax(), 0.0);
+}
+
+double FVoxelEdit::Apply(const FVector& InLocation, double InDistance, uint8* InOutMaterialId) const
+{
+	using namespace VoxelEditLayer;
+
+	const double editDistance = GetDistance(InLocation);
+	if (Operation == EVoxelEditOperation::Remove)
+	{
+		return -SmoothMin(-InDistance, editDistance, Smoothness);
+	}
+
+	if (InOutMaterialId && editDistance < InDistance)
+	{
+		*InOutMaterialId = MaterialId;
+	}
+
+	return SmoothMin(InDistance, editDistance, Smoothness);
+}
+
+void FVoxelEditLayer::Init(double InVolumeExtent)
+{
+	VolumeExtent = InVolumeExtent;
+	DirtyBounds.Reset();
+}
+
+void FVoxelEditLayer::ConsumeDirtyChunks(FVoxelChunkNode* InRootNode, int32 InChunkResolution, int32 InSampleReach, TArray<FVoxelChunkNode*>& OutDirtyChunks)
+{
+	if (InRootNode && !DirtyBounds.IsEmpty())
+	{
+		GatherDirtyChunks(InRootNode, InChunkResolution, InSampleReach, OutDirtyChunks);
+	}
+
+	DirtyBounds.Reset();
+}
+
+void FVoxelEditLayer::GatherDirtyChunks(FVoxelChunkNode* InNode, int32 InChunkResolution, int32 InSampleReach, TArray<FVoxelChunkNode*>& OutDirtyChunks) const
+{
+	// A chunk's box grown by its sample reach holds every child's, so whole branches are skipped at once
+	const double voxelSize = InNode->GetExtent(VolumeExtent) * 2 / InChunkResolution;
+	const FBox box = InNode->GetBox(VolumeExtent).ExpandBy(voxelSize * InSampleReach);
+
+	bool bIntersects = false;
+	for (const FBox& bounds : DirtyBounds)
+	{
+		if (bounds.Intersect(box))
+		{
+			bIntersects = true;
+			break;
+		}
+	}
+
+	if (!bIntersects)
+	{
+		return;
+	}
+
+	if (InNode->IsLeaf())
+	{
+		OutDirtyChunks.Add(InNode);
+		return;
+	}
+
+	for (FVoxelChunkNode* child : InNode->Children)
+	{
+		if (child)
+		{
+			GatherDirtyChunks(child, InChunkResolution, InSampleReach, OutDirtyChunks);
+		}
+	}
+}
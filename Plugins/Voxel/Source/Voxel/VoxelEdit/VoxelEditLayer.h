@@ -0,0 +1,91 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "VoxelEditLayer.generated.h"
+
+struct FVoxelChunkNode;
+
+/* Shape of a brush stroke */
+UENUM(BlueprintType)
+enum class EVoxelEditShape : uint8
+{
+	Sphere,
+	Box
+};
+
+/* How a brush stroke combines with the density beneath it */
+UENUM(BlueprintType)
+enum class EVoxelEditOperation : uint8
+{
+	// Union, fills the shape
+	Add,
+	// Subtraction, digs the shape out
+	Remove
+};
+
+/* One brush stroke, in the volume's actor space */
+struct FVoxelEdit
+{
+	EVoxelEditShape Shape = EVoxelEditShape::Sphere;
+	EVoxelEditOperation Operation = EVoxelEditOperation::Add;
+
+	FVector Center = FVector::ZeroVector;
+
+	// Half size of the box, or the radius of the sphere in X
+	FVector Extent = FVector::ZeroVector;
+
+	// Distance over which the stroke blends into the density beneath it, 0 for a hard edge
+	double Smoothness = 0;
+
+	// Material the stroke fills with, Remove keeps the material beneath
+	uint8 MaterialId = 0;
+
+	/* Signed distance from InLocation to the shape's surface, negative inside */
+	double GetDistance(const FVector& InLocation) const;
+
+	/*
+	 * Combines the stroke at InLocation with InDistance, the signed distance to the surface beneath it, and returns the result.
+	 * InOutMaterialId, if set, takes the stroke's material where it fills.
+	 */
+	double Apply(const FVector& InLocation, double InDistance, uint8* InOutMaterialId = nullptr) const;
+
+	/* Region the stroke changes the density in, blend included */
+	FBox GetBounds() const
+	{
+		const FVector extent = Shape == EVoxelEditShape::Sphere ? FVector(Extent.X) : Extent;
+		return FBox::BuildAABB(Center, extent + Smoothness);
+	}
+};
+
+/*
+ * Bounds of the brush strokes made since the last ConsumeDirtyChunks. Strokes are baked into the volume's FVoxelEditOctree as they
+ * are made and not kept, only their bounds are until the next update, so however many land in a frame every leaf chunk they touch
+ * is remeshed once.
+ */
+struct VOXEL_API FVoxelEditLayer
+{
+	/* Tracks strokes for a volume of InVolumeExtent and forgets the bounds marked so far, the volume meshes every chunk after this anyway */
+	void Init(double InVolumeExtent);
+
+	/* Marks the bounds of a stroke made on top of the others dirty */
+	void Add(const FVoxelEdit& InEdit) { DirtyBounds.Add(InEdit.GetBounds()); }
+
+	/* Marks InBounds dirty as a stroke there would, for densities that changed some other way, like edits loaded from disk */
+	void MarkDirty(const FBox& InBounds) { DirtyBounds.Add(InBounds); }
+
+	/* Whether strokes were made since the last ConsumeDirtyChunks */
+	bool HasDirtyBounds() const { return !DirtyBounds.IsEmpty(); }
+
+	/*
+	 * Adds the leaf chunks under InRootNode whose samples the strokes made since the last call changed to OutDirtyChunks, once
+	 * each, and forgets the strokes' bounds. Chunks read InSampleReach voxels of InChunkResolution past their box.
+	 */
+	void ConsumeDirtyChunks(FVoxelChunkNode* InRootNode, int32 InChunkResolution, int32 InSampleReach, TArray<FVoxelChunkNode*>& OutDirtyChunks);
+
+private:
+	void GatherDirtyChunks(FVoxelChunkNode* InNode, int32 InChunkResolution, int32 InSampleReach, TArray<FVoxelChunkNode*>& OutDirtyChunks) const;
+
+	TArray<FBox> DirtyBounds;
+	double VolumeExtent = 0;
+};
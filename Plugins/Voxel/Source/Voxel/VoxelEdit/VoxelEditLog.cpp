@@ -0,0 +1,379 @@
+#include "VoxelEditLog.h"
+
+#include "Misc/Compression.h"
+#include "Serialization/Archive.h"
+
+
+namespace VoxelEditLog
+{
+	/* Which fields of a record follow its flags byte */
+	enum ERecordFlags : uint8
+	{
+		Box = 1 << 0,
+		Remove = 1 << 1,
+		// Box extents differ per axis, three follow instead of one
+		NonUniformExtent = 1 << 2,
+		HasSmoothness = 1 << 3,
+		HasMaterial = 1 << 4,
+		AllFlags = (1 << 5) - 1
+	};
+
+	/* How a batch payload is stored, raw if compressing did not make it smaller */
+	enum class EPayloadFormat : uint8
+	{
+		Raw,
+		LZ4,
+		Zlib
+	};
+
+	FName GetFormatName(EPayloadFormat InFormat)
+	{
+		return InFormat == EPayloadFormat::LZ4 ? NAME_LZ4 : NAME_Zlib;
+	}
+
+	int32 QuantizeSteps(double InValue, double InStep)
+	{
+		return (int32)FMath::Clamp<int64>(FMath::RoundToInt64(InValue / InStep), MIN_int32, MAX_int32);
+	}
+
+	void WriteVarint(TArray<uint8>& OutData, uint64 InValue)
+	{
+		while (InValue >= 0x80)
+		{
+			OutData.Add((uint8)(InValue | 0x80));
+			InValue >>= 7;
+		}
+		OutData.Add((uint8)InValue);
+	}
+
+	// Zigzag encoded, so deltas either way take as few bytes
+	void WriteSignedVarint(TArray<uint8>& OutData, int64 InValue)
+	{
+		WriteVarint(OutData, ((uint64)InValue << 1) ^ (uint64)(InValue >> 63));
+	}
+
+	bool ReadVarint(TConstArrayView<uint8> InData, int32& InOutOffset, uint64& OutValue)
+	{
+		OutValue = 0;
+		for (int32 shift = 0; shift < 64; shift += 7)
+		{
+			if (InOutOffset >= InData.Num())
+			{
+				return false;
+			}
+
+			const uint8 byte = InData[InOutOffset++];
+			OutValue |= (uint64)(byte & 0x7f) << shift;
+			if (!(byte & 0x80))
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	bool ReadSignedVarint(TConstArrayView<uint8> InData, int32& InOutOffset, int64& OutValue)
+	{
+		uint64 value = 0;
+		if (!ReadVarint(InData, InOutOffset, value))
+		{
+			return false;
+		}
+
+		OutValue = (int64)(value >> 1) ^ -(int64)(value & 1);
+		return true;
+	}
+
+	bool ReadVarint(FArchive& Ar, uint64& OutValue)
+	{
+		OutValue = 0;
+		for (int32 shift = 0; shift < 64; shift += 7)
+		{
+			if (Ar.Tell() >= Ar.TotalSize())
+			{
+				return false;
+			}
+
+			uint8 byte = 0;
+			Ar << byte;
+			OutValue |= (uint64)(byte & 0x7f) << shift;
+			if (!(byte & 0x80))
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	/* The stroke a record decodes to, shared by the writer so both sides round the same way */
+	FVoxelEdit MakeEdit(uint8 InFlags, const FIntVector& InCenter, const FIntVector& InExtent, int32 InSmoothness, uint8 InMaterialId, double InStep)
+	{
+		FVoxelEdit edit;
+		edit.Shape = InFlags & Box ? EVoxelEditShape::Box : EVoxelEditShape::Sphere;
+		edit.Operation = InFlags & Remove ? EVoxelEditOperation::Remove : EVoxelEditOperation::Add;
+		edit.Center = FVector(InCenter) * InStep;
+		edit.Extent = InFlags & NonUniformExtent ? FVector(InExtent) * InStep : FVector(InExtent.X * InStep);
+		edit.Smoothness = InSmoothness * InStep;
+		edit.MaterialId = InMaterialId;
+		return edit;
+	}
+
+	/* Decodes InNumRecords records, returns false if they do not fill InRecords exactly */
+	bool ReadRecords(TConstArrayView<uint8> InRecords, int32 InNumRecords, double InStep, TArray<FVoxelEdit>& OutEdits)
+	{
+		FIntVector center = FIntVector::ZeroValue;
+		uint8 materialId = 0;
+
+		int32 offset = 0;
+		for (int32 i = 0; i < InNumRecords; i++)
+		{
+			if (offset >= InRecords.Num())
+			{
+				return false;
+			}
+
+			const uint8 flags = InRecords[offset++];
+			if (flags & ~AllFlags)
+			{
+				return false;
+			}
+
+			for (int32 axis = 0; axis < 3; axis++)
+			{
+				int64 delta = 0;
+				if (!ReadSignedVarint(InRecords, offset, delta))
+				{
+					return false;
+				}
+
+				const int64 value = center[axis] + delta;
+				if (value < MIN_int32 || value > MAX_int32)
+				{
+					return false;
+				}
+				center[axis] = (int32)value;
+			}
+
+			FIntVector extent;
+			for (int32 axis = 0; axis < (flags & NonUniformExtent ? 3 : 1); axis++)
+			{
+				uint64 value = 0;
+				if (!ReadVarint(InRecords, offset, value) || value > MAX_int32)
+				{
+					return false;
+				}
+				extent[axis] = (int32)value;
+			}
+
+			uint64 smoothness = 0;
+			if (flags & HasSmoothness && (!ReadVarint(InRecords, offset, smoothness) || smoothness > MAX_int32))
+			{
+				return false;
+			}
+
+			if (flags & HasMaterial)
+			{
+				if (offset >= InRecords.Num())
+				{
+					return false;
+				}
+				materialId = InRecords[offset++];
+			}
+
+			// Steps are bounded, but a stroke spanning thousands of kilometers would still bake every node of the volume
+			const FVoxelEdit& edit = OutEdits.Add_GetRef(MakeEdit(flags, center, extent, (int32)smoothness, materialId, InStep));
+			if (edit.Center.ContainsNaN() || edit.Center.GetAbsMax() > FVoxelEditLogReader::MaxEditDistance
+				|| edit.Extent.GetMax() > FVoxelEditLogReader::MaxEditExtent || edit.Smoothness > FVoxelEditLogReader::MaxEditExtent)
+			{
+				return false;
+			}
+		}
+
+		return offset == InRecords.Num();
+	}
+}
+
+FVoxelEditLogWriter::FVoxelEditLogWriter(double InPositionStep, EVoxelEditCompression InCompression) :
+	PositionStep(InPositionStep),
+	Compression(InCompression)
+{
+	check(PositionStep >= FVoxelEditLogReader::MinPositionStep && PositionStep <= FVoxelEditLogReader::MaxPositionStep);
+}
+
+FVoxelEdit FVoxelEditLogWriter::Add(const FVoxelEdit& InEdit)
+{
+	using namespace VoxelEditLog;
+
+	const bool bBox = InEdit.Shape == EVoxelEditShape::Box;
+	const FIntVector center(QuantizeSteps(InEdit.Center.X, PositionStep), QuantizeSteps(InEdit.Center.Y, PositionStep), QuantizeSteps(InEdit.Center.Z, PositionStep));
+	const FIntVector extent(
+		FMath::Max(QuantizeSteps(InEdit.Extent.X, PositionStep), 0),
+		bBox ? FMath::Max(QuantizeSteps(InEdit.Extent.Y, PositionStep), 0) : 0,
+		bBox ? FMath::Max(QuantizeSteps(InEdit.Extent.Z, PositionStep), 0) : 0
+	);
+	const int32 smoothness = FMath::Max(QuantizeSteps(InEdit.Smoothness, PositionStep), 0);
+
+	uint8 flags = 0;
+	flags |= bBox ? Box : 0;
+	flags |= InEdit.Operation == EVoxelEditOperation::Remove ? Remove : 0;
+	flags |= bBox && (extent.Y != extent.X || extent.Z != extent.X) ? NonUniformExtent : 0;
+	flags |= smoothness > 0 ? HasSmoothness : 0;
+	flags |= InEdit.MaterialId != PreviousMaterialId ? HasMaterial : 0;
+
+	Records.Add(flags);
+	for (int32 axis = 0; axis < 3; axis++)
+	{
+		WriteSignedVarint(Records, (int64)center[axis] - PreviousCenter[axis]);
+	}
+
+	for (int32 axis = 0; axis < (flags & NonUniformExtent ? 3 : 1); axis++)
+	{
+		WriteVarint(Records, extent[axis]);
+	}
+
+	if (flags & HasSmoothness)
+	{
+		WriteVarint(Records, smoothness);
+	}
+
+	if (flags & HasMaterial)
+	{
+		Records.Add(InEdit.MaterialId);
+	}
+
+	NumRecords++;
+	PreviousCenter = center;
+	PreviousMaterialId = InEdit.MaterialId;
+
+	return MakeEdit(flags, center, extent, smoothness, InEdit.MaterialId, PositionStep);
+}
+
+void FVoxelEditLogWriter::Flush(FArchive& Ar)
+{
+	using namespace VoxelEditLog;
+
+	if (NumRecords == 0)
+	{
+		return;
+	}
+
+	const EPayloadFormat compressedFormat = Compression == EVoxelEditCompression::LZ4 ? EPayloadFormat::LZ4 : EPayloadFormat::Zlib;
+	const FName formatName = GetFormatName(compressedFormat);
+
+	TArray<uint8> compressed;
+	int32 compressedSize = FCompression::CompressMemoryBound(formatName, Records.Num());
+	compressed.SetNumUninitialized(compressedSize);
+
+	EPayloadFormat format = EPayloadFormat::Raw;
+	if (FCompression::CompressMemory(formatName, compressed.GetData(), compressedSize, Records.GetData(), Records.Num()) && compressedSize < Records.Num())
+	{
+		compressed.SetNum(compressedSize);
+		format = compressedFormat;
+	}
+
+	TArray<uint8>& payload = format == EPayloadFormat::Raw ? Records : compressed;
+
+	TArray<uint8> header;
+	WriteVarint(header, NumRecords);
+	WriteVarint(header, Records.Num());
+	WriteVarint(header, payload.Num());
+	Ar.Serialize(header.GetData(), header.Num());
+
+	uint8 formatByte = (uint8)format;
+	Ar << formatByte;
+	Ar << PositionStep;
+	Ar.Serialize(payload.GetData(), payload.Num());
+
+	// Batches stand alone, the next one's deltas start over
+	Records.Reset();
+	NumRecords = 0;
+	PreviousCenter = FIntVector::ZeroValue;
+	PreviousMaterialId = 0;
+}
+
+bool FVoxelEditLogReader::ReadBatch(FArchive& Ar, TArray<FVoxelEdit>& OutEdits)
+{
+	using namespace VoxelEditLog;
+
+	const int64 start = Ar.Tell();
+	auto fail = [&Ar, start]()
+	{
+		Ar.Seek(start);
+		return false;
+	};
+
+	uint64 numRecords = 0;
+	uint64 recordsSize = 0;
+	uint64 payloadSize = 0;
+	if (!ReadVarint(Ar, numRecords) || !ReadVarint(Ar, recordsSize) || !ReadVarint(Ar, payloadSize))
+	{
+		return fail();
+	}
+
+	// Every record takes five bytes at least, a flags byte, the center and an extent
+	if (recordsSize > MaxBatchBytes || payloadSize > MaxBatchBytes || numRecords > recordsSize / 5)
+	{
+		return fail();
+	}
+
+	if (Ar.TotalSize() - Ar.Tell() < (int64)(sizeof(uint8) + sizeof(double) + payloadSize))
+	{
+		return fail();
+	}
+
+	uint8 formatByte = 0;
+	double positionStep = 0;
+	Ar << formatByte;
+	Ar << positionStep;
+
+	TArray<uint8> payload;
+	payload.SetNumUninitialized((int32)payloadSize);
+	Ar.Serialize(payload.GetData(), payload.Num());
+
+	const EPayloadFormat format = (EPayloadFormat)formatByte;
+	// A NaN or infinite step would decode every stroke to NaN or infinity, a huge one to strokes spanning the world
+	if (Ar.IsError() || !FMath::IsFinite(positionStep) || !(positionStep >= MinPositionStep && positionStep <= MaxPositionStep) || format > EPayloadFormat::Zlib)
+	{
+		return fail();
+	}
+
+	TArray<uint8> records;
+	if (format == EPayloadFormat::Raw)
+	{
+		if (payloadSize != recordsSize)
+		{
+			return fail();
+		}
+		records = MoveTemp(payload);
+	}
+	else
+	{
+		records.SetNumUninitialized((int32)recordsSize);
+		if (!FCompression::UncompressMemory(GetFormatName(format), records.GetData(), records.Num(), payload.GetData(), payload.Num()))
+		{
+			return fail();
+		}
+	}
+
+	TArray<FVoxelEdit> edits;
+	edits.Reserve((int32)numRecords);
+	if (!ReadRecords(records, (int32)numRecords, positionStep, edits))
+	{
+		return fail();
+	}
+
+	OutEdits.Append(edits);
+	return true;
+}
+
+int32 FVoxelEditLogReader::ReadAll(FArchive& Ar, TArray<FVoxelEdit>& OutEdits)
+{
+	const int32 numEdits = OutEdits.Num();
+	while (Ar.Tell() < Ar.TotalSize() && ReadBatch(Ar, OutEdits))
+	{
+	}
+
+	return OutEdits.Num() - numEdits;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "VoxelEditLayer.h"
+#include "VoxelEditRegionStore.h"
+
+class FArchive;
+
+/*
+ * Strokes encoded compactly for sending between peers and replaying at startup. A log is a run of batches, each readable on its own,
+ * so a log can be appended to as strokes are made and read from any batch boundary:
+ *  - batch header: record count, payload size before and after compression, the payload format and the position step
+ *  - records: a flags byte with the shape, operation and which fields follow, the center as a delta from the previous record's,
+ *    then the extent, smoothness and material if it changed, all in varints
+ * Positions, extents and smoothness are quantized to the position step, so a batch of strokes walking through the ground takes a few
+ * bytes per record before compression.
+ */
+struct VOXEL_API FVoxelEditLogWriter
+{
+	/* Quantizes strokes to InPositionStep units, within the reader's step range, and compresses batches with InCompression */
+	explicit FVoxelEditLogWriter(double InPositionStep = 1.0, EVoxelEditCompression InCompression = EVoxelEditCompression::LZ4);
+
+	/*
+	 * Queues a stroke for the next batch and returns it as readers decode it, the writing peer applies that one so every peer bakes
+	 * the same stroke.
+	 */
+	FVoxelEdit Add(const FVoxelEdit& InEdit);
+
+	/* Strokes queued for the next batch */
+	int32 NumPending() const { return NumRecords; }
+
+	/*
+	 * Writes the queued strokes to Ar as one batch, at its current position, nothing if none are queued. An FMemoryWriter made with
+	 * bSetOffset appends to a log it is given.
+	 */
+	void Flush(FArchive& Ar);
+
+private:
+	double PositionStep = 1.0;
+	EVoxelEditCompression Compression = EVoxelEditCompression::LZ4;
+
+	// Records of the batch being built, and the state they are deltas from
+	TArray<uint8> Records;
+	int32 NumRecords = 0;
+	FIntVector PreviousCenter = FIntVector::ZeroValue;
+	uint8 PreviousMaterialId = 0;
+};
+
+/* Decodes logs from FVoxelEditLogWriter */
+struct VOXEL_API FVoxelEditLogReader
+{
+	// Largest payload a batch may claim, so a corrupt or hostile log can not ask for huge allocations
+	static constexpr int32 MaxBatchBytes = 1 << 24;
+
+	// Position steps a batch may be quantized to, anything else is corrupt rather than a choice of precision
+	static constexpr double MinPositionStep = 1e-3;
+	static constexpr double MaxPositionStep = 1e3;
+
+	// Largest center coordinate, and extent or smoothness, a stroke may decode to, 10000 km and 100 km, far past any volume
+	static constexpr double MaxEditDistance = 1e9;
+	static constexpr double MaxEditExtent = 1e7;
+
+	/*
+	 * Reads the batch at Ar's position, appending its strokes to OutEdits. Returns false, with Ar and OutEdits as they were, if Ar
+	 * ends before the batch does, as a log being appended to may, or the batch is malformed. A batch is malformed if any stroke in it
+	 * decodes past MaxEditDistance or MaxEditExtent, the whole batch is refused rather than applying the rest.
+	 */
+	static bool ReadBatch(FArchive& Ar, TArray<FVoxelEdit>& OutEdits);
+
+	/* Reads batches until Ar ends or holds only part of one, returns the number of strokes read */
+	static int32 ReadAll(FArchive& Ar, TArray<FVoxelEdit>& OutEdits);
+};
@@ -0,0 +1,810 @@
+#include "VoxelEditOctree.h"
+
+#include "VoxelEditLayer.h"
+
+
+namespace VoxelEditOctree
+{
+	/* a / b rounded towards negative infinity, for b > 0 */
+	int32 FloorDivide(int32 InA, int32 InB)
+	{
+		return InA >= 0 ? InA / InB : -((-InA + InB - 1) / InB);
+	}
+
+	/* Offset of child InIndex from its parent's minimum corner in half sizes, in the child order of FVoxelChunkNode::NodeOffsets */
+	FIntVector GetChildOffset(int32 InIndex)
+	{
+		return FIntVector((InIndex >> 2) & 1, (InIndex >> 1) & 1, InIndex & 1);
+	}
+
+	int32 GetBrickIndex(int32 InX, int32 InY, int32 InZ)
+	{
+		return (InX * FVoxelEditOctree::BrickSize + InY) * FVoxelEditOctree::BrickSize + InZ;
+	}
+
+	/* What a saved node holds, written before its data */
+	enum class ENodeTag : uint8
+	{
+		Empty,
+		Uniform,
+		Brick,
+		Children
+	};
+
+	void AppendBytes(TArray<uint8>& OutData, const void* InBytes, int32 InNum)
+	{
+		const int32 offset = OutData.AddUninitialized(InNum);
+		FMemory::Memcpy(&OutData[offset], InBytes, InNum);
+	}
+
+	bool ReadBytes(TConstArrayView<uint8> InData, int32& InOutOffset, void* OutBytes, int32 InNum)
+	{
+		if (InOutOffset + InNum > InData.Num())
+		{
+			return false;
+		}
+
+		if (OutBytes)
+		{
+			FMemory::Memcpy(OutBytes, &InData[InOutOffset], InNum);
+		}
+		InOutOffset += InNum;
+		return true;
+	}
+}
+
+void FVoxelEditOctree::Init(double InVoxelSize, int32 InHalfExtent, double InIsovalue, double InDensityPerUnit)
+{
+	VoxelSize = InVoxelSize;
+	Isovalue = InIsovalue;
+	DensityPerUnit = InDensityPerUnit;
+	Quantization = FVoxelQuantizedDensity16(0.0, InVoxelSize * RangeVoxels / FVoxelQuantizedDensity16::RangeVoxels);
+	RootSize = FMath::Max((int32)FMath::RoundUpToPowerOfTwo(InHalfExtent) * 2, BrickSize);
+
+	Reset();
+}
+
+void FVoxelEditOctree::Reset()
+{
+	Nodes.Reset();
+	Bricks.Reset();
+	FreeChildren.Reset();
+	FreeBricks.Reset();
+
+	Nodes.AddDefaulted();
+}
+
+void FVoxelEditOctree::ApplyEdit(const FVoxelEdit& InEdit, FSampleBase InSampleBase)
+{
+	ApplyEdits(MakeArrayView(&InEdit, 1), InSampleBase);
+}
+
+void FVoxelEditOctree::ApplyEdits(TConstArrayView<FVoxelEdit> InEdits, FSampleBase InSampleBase)
+{
+	if (RootSize <= 0 || InEdits.IsEmpty())
+	{
+		return;
+	}
+
+	TArray<int32> edits;
+	edits.SetNumUninitialized(InEdits.Num());
+	for (int32 i = 0; i < InEdits.Num(); i++)
+	{
+		edits[i] = i;
+	}
+
+	ApplyEdits(0, FIntVector(-RootSize / 2), RootSize, InEdits, edits, InSampleBase);
+}
+
+void FVoxelEditOctree::ApplyEdits(int32 InNode, const FIntVector& InMin, int32 InSize, TConstArrayView<FVoxelEdit> InEdits, TConstArrayView<int32> InReaching, FSampleBase InSampleBase)
+{
+	using namespace VoxelEditOctree;
+
+	const int16 maxValue = FVoxelQuantizedDensity16::MaxValue;
+	const double halfSize = (InSize - 1) * 0.5;
+	const double radius = halfSize * VoxelSize * UE_SQRT_3;
+	const FVector center = (FVector(InMin) + halfSize) * VoxelSize;
+
+	// Strokes that reach into the node without settling it, the ones that do settle it are applied as they come
+	TArray<int32, TInlineAllocator<16>> reaching;
+	for (const int32 index : InReaching)
+	{
+		const FVoxelEdit& edit = InEdits[index];
+		const bool bAdd = edit.Operation == EVoxelEditOperation::Add;
+
+		// Stored distances clamp at the quantization range, the stroke changes nothing further than that plus its blend away
+		const double range = RangeVoxels * VoxelSize + edit.Smoothness;
+		const double editDistance = edit.GetDistance(center);
+
+		if (editDistance - radius >= range)
+		{
+			continue;
+		}
+
+		// Just as far inside, the whole node ends up past the range whatever it or the strokes before held
+		if (editDistance + radius <= -range)
+		{
+			SetUniform(InNode, bAdd ? -maxValue : maxValue, bAdd ? edit.MaterialId : 0);
+			reaching.Reset();
+			continue;
+		}
+
+		// Digging out air or filling solid of the same material leaves it as it is
+		const FNode& node = Nodes[InNode];
+		if (reaching.IsEmpty() && node.bUniform && (bAdd ? node.Distance == -maxValue && node.MaterialId == edit.MaterialId : node.Distance == maxValue))
+		{
+			continue;
+		}
+
+		reaching.Add(index);
+	}
+
+	if (reaching.IsEmpty())
+	{
+		return;
+	}
+
+	if (InSize == BrickSize)
+	{
+		if (Nodes[InNode].Brick == INDEX_NONE)
+		{
+			MakeBrick(InNode, InMin, InSampleBase);
+		}
+
+		FBrick& brick = Bricks[Nodes[InNode].Brick];
+		for (int32 x = 0; x < BrickSize; x++)
+		{
+			for (int32 y = 0; y < BrickSize; y++)
+			{
+				for (int32 z = 0; z < BrickSize; z++)
+				{
+					const int32 index = GetBrickIndex(x, y, z);
+					const FVector location = FVector(InMin.X + x, InMin.Y + y, InMin.Z + z) * VoxelSize;
+
+					// Stored between strokes as one stroke at a time would, quantized and clamped
+					int16 distance = brick.Distances[index];
+					uint8 materialId = brick.MaterialIds[index];
+					for (const int32 edit : reaching)
+					{
+						distance = Quantization.Encode(InEdits[edit].Apply(location, Quantization.Decode(distance), &materialId));
+						materialId = GetStoredMaterial(distance, materialId);
+					}
+
+					brick.Distances[index] = distance;
+					brick.MaterialIds[index] = materialId;
+				}
+			}
+		}
+
+		TryCollapse(InNode);
+		return;
+	}
+
+	if (Nodes[InNode].Children == INDEX_NONE)
+	{
+		MakeChildren(InNode);
+	}
+
+	const int32 childSize = InSize / 2;
+	for (int32 i = 0; i < 8; i++)
+	{
+		ApplyEdits(Nodes[InNode].Children + i, InMin + GetChildOffset(i) * childSize, childSize, InEdits, reaching, InSampleBase);
+	}
+
+	TryCollapse(InNode);
+}
+
+void FVoxelEditOctree::MakeBrick(int32 InNode, const FIntVector& InMin, FSampleBase InSampleBase)
+{
+	using namespace VoxelEditOctree;
+
+	const int32 brickIndex = FreeBricks.IsEmpty() ? Bricks.AddUninitialized() : FreeBricks.Pop();
+	FBrick& brick = Bricks[brickIndex];
+	FNode& node = Nodes[InNode];
+
+	if (node.bUniform)
+	{
+		for (int32 i = 0; i < BrickVolume; i++)
+		{
+			brick.Distances[i] = node.Distance;
+			brick.MaterialIds[i] = node.MaterialId;
+		}
+	}
+	else
+	{
+		for (int32 x = 0; x < BrickSize; x++)
+		{
+			for (int32 y = 0; y < BrickSize; y++)
+			{
+				for (int32 z = 0; z < BrickSize; z++)
+				{
+					const int32 index = GetBrickIndex(x, y, z);
+					const FVector location = FVector(InMin.X + x, InMin.Y + y, InMin.Z + z) * VoxelSize;
+
+					uint8 materialId = 0;
+					const int16 distance = Quantization.Encode((InSampleBase(location, materialId) - Isovalue) / DensityPerUnit);
+					brick.Distances[index] = distance;
+					brick.MaterialIds[index] = GetStoredMaterial(distance, materialId);
+				}
+			}
+		}
+	}
+
+	node.Brick = brickIndex;
+	node.bUniform = false;
+}
+
+void FVoxelEditOctree::MakeChildren(int32 InNode)
+{
+	int32 children = INDEX_NONE;
+	if (FreeChildren.IsEmpty())
+	{
+		children = Nodes.AddDefaulted(8);
+	}
+	else
+	{
+		children = FreeChildren.Pop();
+		for (int32 i = 0; i < 8; i++)
+		{
+			Nodes[children + i] = FNode();
+		}
+	}
+
+	// Nodes may have moved, only take the reference now
+	FNode& node = Nodes[InNode];
+	if (node.bUniform)
+	{
+		for (int32 i = 0; i < 8; i++)
+		{
+			FNode& child = Nodes[children + i];
+			child.bUniform = true;
+			child.Distance = node.Distance;
+			child.MaterialId = node.MaterialId;
+		}
+	}
+
+	node.Children = children;
+	node.bUniform = false;
+}
+
+void FVoxelEditOctree::TryCollapse(int32 InNode)
+{
+	const FNode& node = Nodes[InNode];
+
+	if (node.Brick != INDEX_NONE)
+	{
+		const FBrick& brick = Bricks[node.Brick];
+		const int16 distance = brick.Distances[0];
+		const uint8 materialId = brick.MaterialIds[0];
+
+		// Only values clamped past the range are alike over a whole brick, anything nearer the surface varies
+		if (FMath::Abs<int32>(distance) != FVoxelQuantizedDensity16::MaxValue)
+		{
+			return;
+		}
+
+		for (int32 i = 1; i < BrickVolume; i++)
+		{
+			if (brick.Distances[i] != distance || brick.MaterialIds[i] != materialId)
+			{
+				return;
+			}
+		}
+
+		SetUniform(InNode, distance, materialId);
+		return;
+	}
+
+	if (node.Children != INDEX_NONE)
+	{
+		const FNode& first = Nodes[node.Children];
+
+		// Children cleared by LoadChunk leave nothing to keep
+		bool bAnyEdited = false;
+		for (int32 i = 0; i < 8; i++)
+		{
+			bAnyEdited |= Nodes[node.Children + i].IsEdited();
+		}
+
+		if (!bAnyEdited)
+		{
+			FreeBelow(InNode);
+			return;
+		}
+
+		if (!first.bUniform)
+		{
+			return;
+		}
+
+		for (int32 i = 1; i < 8; i++)
+		{
+			const FNode& child = Nodes[node.Children + i];
+			if (!child.bUniform || child.Distance != first.Distance || child.MaterialId != first.MaterialId)
+			{
+				return;
+			}
+		}
+
+		SetUniform(InNode, first.Distance, first.MaterialId);
+	}
+}
+
+void FVoxelEditOctree::SetUniform(int32 InNode, int16 InDistance, uint8 InMaterialId)
+{
+	FreeBelow(InNode);
+
+	FNode& node = Nodes[InNode];
+	node.bUniform = true;
+	node.Distance = InDistance;
+	node.MaterialId = InMaterialId;
+}
+
+void FVoxelEditOctree::FreeBelow(int32 InNode)
+{
+	FNode& node = Nodes[InNode];
+
+	if (node.Brick != INDEX_NONE)
+	{
+		FreeBricks.Add(node.Brick);
+		node.Brick = INDEX_NONE;
+	}
+
+	if (node.Children != INDEX_NONE)
+	{
+		const int32 children = node.Children;
+		node.Children = INDEX_NONE;
+
+		for (int32 i = 0; i < 8; i++)
+		{
+			FreeBelow(children + i);
+		}
+
+		FreeChildren.Add(children);
+	}
+}
+
+FIntVector FVoxelEditOctree::GetLatticePoint(const FVector& InLocation) const
+{
+	return FIntVector(
+		FMath::RoundToInt(InLocation.X / VoxelSize),
+		FMath::RoundToInt(InLocation.Y / VoxelSize),
+		FMath::RoundToInt(InLocation.Z / VoxelSize)
+	);
+}
+
+bool FVoxelEditOctree::Sample(const FIntVector& InPoint, double& OutDensity, uint8* OutMaterialId) const
+{
+	using namespace VoxelEditOctree;
+
+	const int32 halfRoot = RootSize / 2;
+	if (RootSize == 0
+		|| InPoint.X < -halfRoot || InPoint.X >= halfRoot
+		|| InPoint.Y < -halfRoot || InPoint.Y >= halfRoot
+		|| InPoint.Z < -halfRoot || InPoint.Z >= halfRoot)
+	{
+		return false;
+	}
+
+	int32 index = 0;
+	FIntVector min(-halfRoot);
+	int32 size = RootSize;
+	while (Nodes[index].Children != INDEX_NONE)
+	{
+		size /= 2;
+		const int32 child =
+			(InPoint.X >= min.X + size ? 4 : 0)
+			| (InPoint.Y >= min.Y + size ? 2 : 0)
+			| (InPoint.Z >= min.Z + size ? 1 : 0);
+
+		index = Nodes[index].Children + child;
+		min = min + GetChildOffset(child) * size;
+	}
+
+	const FNode& node = Nodes[index];
+	if (node.bUniform)
+	{
+		OutDensity = DecodeDensity(node.Distance);
+		if (OutMaterialId)
+		{
+			*OutMaterialId = node.MaterialId;
+		}
+		return true;
+	}
+
+	if (node.Brick != INDEX_NONE)
+	{
+		const FBrick& brick = Bricks[node.Brick];
+		const int32 brickIndex = GetBrickIndex(InPoint.X - min.X, InPoint.Y - min.Y, InPoint.Z - min.Z);
+		OutDensity = DecodeDensity(brick.Distances[brickIndex]);
+		if (OutMaterialId)
+		{
+			*OutMaterialId = brick.MaterialIds[brickIndex];
+		}
+		return true;
+	}
+
+	return false;
+}
+
+void FVoxelEditOctree::Extract(const FIntVector& InOrigin, int32 InStride, const FIntVector& InSize, TArrayView<double> OutDensities, TArrayView<uint8> OutMaterialIds) const
+{
+	check(InStride > 0);
+	check(OutDensities.Num() == InSize.X * InSize.Y * InSize.Z);
+	check(OutMaterialIds.IsEmpty() || OutMaterialIds.Num() == OutDensities.Num());
+
+	if (RootSize > 0)
+	{
+		Extract(0, FIntVector(-RootSize / 2), RootSize, InOrigin, InStride, InSize, OutDensities, OutMaterialIds);
+	}
+}
+
+void FVoxelEditOctree::Extract(int32 InNode, const FIntVector& InMin, int32 InSize, const FIntVector& InOrigin, int32 InStride, const FIntVector& InGridSize, TArrayView<double> OutDensities, TArrayView<uint8> OutMaterialIds) const
+{
+	using namespace VoxelEditOctree;
+
+	const FNode& node = Nodes[InNode];
+	if (!node.IsEdited())
+	{
+		return;
+	}
+
+	// Range of grid samples whose lattice points fall inside the node, along each axis
+	FIntVector first;
+	FIntVector last;
+	for (int32 axis = 0; axis < 3; axis++)
+	{
+		first[axis] = FMath::Max(FloorDivide(InMin[axis] - InOrigin[axis] + InStride - 1, InStride), 0);
+		last[axis] = FMath::Min(FloorDivide(InMin[axis] + InSize - 1 - InOrigin[axis], InStride), InGridSize[axis] - 1);
+
+		if (first[axis] > last[axis])
+		{
+			return;
+		}
+	}
+
+	if (node.Children != INDEX_NONE)
+	{
+		const int32 childSize = InSize / 2;
+		for (int32 i = 0; i < 8; i++)
+		{
+			Extract(node.Children + i, InMin + GetChildOffset(i) * childSize, childSize, InOrigin, InStride, InGridSize, OutDensities, OutMaterialIds);
+		}
+		return;
+	}
+
+	const FBrick* brick = node.Brick != INDEX_NONE ? &Bricks[node.Brick] : nullptr;
+	const double uniformDensity = DecodeDensity(node.Distance);
+
+	for (int32 x = first.X; x <= last.X; x++)
+	{
+		for (int32 y = first.Y; y <= last.Y; y++)
+		{
+			int32 index = (x * InGridSize.Y + y) * InGridSize.Z + first.Z;
+			for (int32 z = first.Z; z <= last.Z; z++, index++)
+			{
+				if (brick)
+				{
+					const int32 brickIndex = GetBrickIndex(
+						InOrigin.X + x * InStride - InMin.X,
+						InOrigin.Y + y * InStride - InMin.Y,
+						InOrigin.Z + z * InStride - InMin.Z
+					);
+					OutDensities[index] = DecodeDensity(brick->Distances[brickIndex]);
+					if (!OutMaterialIds.IsEmpty())
+					{
+						OutMaterialIds[index] = brick->MaterialIds[brickIndex];
+					}
+				}
+				else
+				{
+					OutDensities[index] = uniformDensity;
+					if (!OutMaterialIds.IsEmpty())
+					{
+						OutMaterialIds[index] = node.MaterialId;
+					}
+				}
+			}
+		}
+	}
+}
+
+void FVoxelEditOctree::GatherChunks(int32 InChunkSize, TArray<FIntVector>& OutChunks) const
+{
+	check(FMath::IsPowerOfTwo(InChunkSize) && InChunkSize >= BrickSize && InChunkSize <= RootSize);
+
+	OutChunks.Reset();
+	GatherChunks(0, FIntVector(-RootSize / 2), RootSize, InChunkSize, OutChunks);
+}
+
+void FVoxelEditOctree::GatherChunks(int32 InNode, const FIntVector& InMin, int32 InSize, int32 InChunkSize, TArray<FIntVector>& OutChunks) const
+{
+	using namespace VoxelEditOctree;
+
+	const FNode& node = Nodes[InNode];
+	if (!node.IsEdited())
+	{
+		return;
+	}
+
+	// A uniform node above the chunk size holds every chunk it covers
+	if (InSize == InChunkSize || node.bUniform)
+	{
+		const FIntVector first(FloorDivide(InMin.X, InChunkSize), FloorDivide(InMin.Y, InChunkSize), FloorDivide(InMin.Z, InChunkSize));
+		const int32 numChunks = InSize / InChunkSize;
+		for (int32 x = 0; x < numChunks; x++)
+		{
+			for (int32 y = 0; y < numChunks; y++)
+			{
+				for (int32 z = 0; z < numChunks; z++)
+				{
+					OutChunks.Add(first + FIntVector(x, y, z));
+				}
+			}
+		}
+		return;
+	}
+
+	const int32 childSize = InSize / 2;
+	for (int32 i = 0; i < 8; i++)
+	{
+		GatherChunks(node.Children + i, InMin + GetChildOffset(i) * childSize, childSize, InChunkSize, OutChunks);
+	}
+}
+
+void FVoxelEditOctree::GatherChunks(const FBox& InBounds, int32 InChunkSize, TArray<FIntVector>& OutChunks) const
+{
+	using namespace VoxelEditOctree;
+
+	OutChunks.Reset();
+	if (RootSize == 0)
+	{
+		return;
+	}
+
+	// Strokes change stored distances as far as the range past their bounds
+	const FBox bounds = InBounds.ExpandBy(RangeVoxels * VoxelSize);
+	const FIntVector min = GetLatticePoint(bounds.Min);
+	const FIntVector max = GetLatticePoint(bounds.Max);
+
+	for (int32 x = FloorDivide(min.X, InChunkSize); x <= FloorDivide(max.X, InChunkSize); x++)
+	{
+		for (int32 y = FloorDivide(min.Y, InChunkSize); y <= FloorDivide(max.Y, InChunkSize); y++)
+		{
+			for (int32 z = FloorDivide(min.Z, InChunkSize); z <= FloorDivide(max.Z, InChunkSize); z++)
+			{
+				OutChunks.Add(FIntVector(x, y, z));
+			}
+		}
+	}
+}
+
+int32 FVoxelEditOctree::FindChunkNode(const FIntVector& InChunk, int32 InChunkSize, int32& OutSize) const
+{
+	using namespace VoxelEditOctree;
+
+	const FIntVector point = InChunk * InChunkSize;
+	const int32 halfRoot = RootSize / 2;
+	if (RootSize == 0
+		|| point.X < -halfRoot || point.X >= halfRoot
+		|| point.Y < -halfRoot || point.Y >= halfRoot
+		|| point.Z < -halfRoot || point.Z >= halfRoot)
+	{
+		return INDEX_NONE;
+	}
+
+	int32 index = 0;
+	FIntVector min(-halfRoot);
+	int32 size = RootSize;
+	while (size > InChunkSize && Nodes[index].Children != INDEX_NONE)
+	{
+		size /= 2;
+		const int32 child =
+			(point.X >= min.X + size ? 4 : 0)
+			| (point.Y >= min.Y + size ? 2 : 0)
+			| (point.Z >= min.Z + size ? 1 : 0);
+
+		index = Nodes[index].Children + child;
+		min = min + GetChildOffset(child) * size;
+	}
+
+	OutSize = size;
+	return index;
+}
+
+void FVoxelEditOctree::SaveChunk(const FIntVector& InChunk, int32 InChunkSize, TArray<uint8>& OutData) const
+{
+	OutData.Reset();
+
+	// The descent stops above the chunk only at a uniform or empty node, which the chunk takes the value of
+	int32 size = 0;
+	const int32 node = FindChunkNode(InChunk, InChunkSize, size);
+	if (node != INDEX_NONE && Nodes[node].IsEdited())
+	{
+		SaveNode(node, OutData);
+	}
+}
+
+void FVoxelEditOctree::SaveNode(int32 InNode, TArray<uint8>& OutData) const
+{
+	using namespace VoxelEditOctree;
+
+	const FNode& node = Nodes[InNode];
+	ENodeTag tag = ENodeTag::Empty;
+	if (node.bUniform)
+	{
+		tag = ENodeTag::Uniform;
+	}
+	else if (node.Brick != INDEX_NONE)
+	{
+		tag = ENodeTag::Brick;
+	}
+	else if (node.Children != INDEX_NONE)
+	{
+		tag = ENodeTag::Children;
+	}
+
+	OutData.Add((uint8)tag);
+
+	if (tag == ENodeTag::Uniform)
+	{
+		AppendBytes(OutData, &node.Distance, sizeof(node.Distance));
+		OutData.Add(node.MaterialId);
+	}
+	else if (tag == ENodeTag::Brick)
+	{
+		const FBrick& brick = Bricks[node.Brick];
+		AppendBytes(OutData, brick.Distances, sizeof(brick.Distances));
+		AppendBytes(OutData, brick.MaterialIds, sizeof(brick.MaterialIds));
+	}
+	else if (tag == ENodeTag::Children)
+	{
+		for (int32 i = 0; i < 8; i++)
+		{
+			SaveNode(node.Children + i, OutData);
+		}
+	}
+}
+
+bool FVoxelEditOctree::LoadChunk(const FIntVector& InChunk, int32 InChunkSize, TConstArrayView<uint8> InData)
+{
+	using namespace VoxelEditOctree;
+
+	check(FMath::IsPowerOfTwo(InChunkSize) && InChunkSize >= BrickSize && InChunkSize <= RootSize);
+
+	// Read through once without building anything, so malformed data leaves the chunk alone
+	int32 offset = 0;
+	if (!InData.IsEmpty() && (!LoadNode(INDEX_NONE, InChunkSize, InData, offset) || offset != InData.Num()))
+	{
+		return false;
+	}
+
+	const FIntVector point = InChunk * InChunkSize;
+	const int32 halfRoot = RootSize / 2;
+	if (point.X < -halfRoot || point.X >= halfRoot
+		|| point.Y < -halfRoot || point.Y >= halfRoot
+		|| point.Z < -halfRoot || point.Z >= halfRoot)
+	{
+		return false;
+	}
+
+	// Subdivide down to the chunk, uniform nodes above it pass their value on to its neighbours
+	TArray<int32> path;
+	int32 index = 0;
+	FIntVector min(-halfRoot);
+	for (int32 size = RootSize; size > InChunkSize; )
+	{
+		path.Add(index);
+		if (Nodes[index].Children == INDEX_NONE)
+		{
+			MakeChildren(index);
+		}
+
+		size /= 2;
+		const int32 child =
+			(point.X >= min.X + size ? 4 : 0)
+			| (point.Y >= min.Y + size ? 2 : 0)
+			| (point.Z >= min.Z + size ? 1 : 0);
+
+		index = Nodes[index].Children + child;
+		min = min + GetChildOffset(child) * size;
+	}
+
+	FreeBelow(index);
+	Nodes[index].bUniform = false;
+
+	offset = 0;
+	if (!InData.IsEmpty())
+	{
+		LoadNode(index, InChunkSize, InData, offset);
+	}
+
+	TryCollapse(index);
+	for (int32 i = path.Num() - 1; i >= 0; i--)
+	{
+		TryCollapse(path[i]);
+	}
+
+	return true;
+}
+
+bool FVoxelEditOctree::LoadNode(int32 InNode, int32 InSize, TConstArrayView<uint8> InData, int32& InOutOffset)
+{
+	using namespace VoxelEditOctree;
+
+	uint8 tag = 0;
+	if (!ReadBytes(InData, InOutOffset, &tag, sizeof(tag)))
+	{
+		return false;
+	}
+
+	switch ((ENodeTag)tag)
+	{
+	case ENodeTag::Empty:
+		return true;
+
+	case ENodeTag::Uniform:
+	{
+		int16 distance = 0;
+		uint8 materialId = 0;
+		if (!ReadBytes(InData, InOutOffset, &distance, sizeof(distance)) || !ReadBytes(InData, InOutOffset, &materialId, sizeof(materialId)))
+		{
+			return false;
+		}
+
+		if (InNode != INDEX_NONE)
+		{
+			SetUniform(InNode, distance, materialId);
+		}
+		return true;
+	}
+
+	case ENodeTag::Brick:
+	{
+		if (InSize != BrickSize)
+		{
+			return false;
+		}
+
+		if (InNode == INDEX_NONE)
+		{
+			return ReadBytes(InData, InOutOffset, nullptr, sizeof(FBrick::Distances) + sizeof(FBrick::MaterialIds));
+		}
+
+		const int32 brickIndex = FreeBricks.IsEmpty() ? Bricks.AddUninitialized() : FreeBricks.Pop();
+		FBrick& brick = Bricks[brickIndex];
+		Nodes[InNode].Brick = brickIndex;
+		return ReadBytes(InData, InOutOffset, brick.Distances, sizeof(brick.Distances)) && ReadBytes(InData, InOutOffset, brick.MaterialIds, sizeof(brick.MaterialIds));
+	}
+
+	case ENodeTag::Children:
+	{
+		if (InSize <= BrickSize)
+		{
+			return false;
+		}
+
+		if (InNode != INDEX_NONE)
+		{
+			MakeChildren(InNode);
+		}
+
+		for (int32 i = 0; i < 8; i++)
+		{
+			if (!LoadNode(InNode != INDEX_NONE ? Nodes[InNode].Children + i : INDEX_NONE, InSize / 2, InData, InOutOffset))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	default:
+		return false;
+	}
+}
+
+SIZE_T FVoxelEditOctree::GetAllocatedSize() const
+{
+	return Nodes.GetAllocatedSize() + Bricks.GetAllocatedSize() + FreeChildren.GetAllocatedSize() + FreeBricks.GetAllocatedSize();
+}
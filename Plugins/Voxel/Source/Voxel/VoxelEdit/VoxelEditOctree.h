@@ -0,0 +1,162 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "VoxelUtilities/VoxelQuantizedDensity.h"
+
+struct FVoxelEdit;
+
+/*
+ * Density and material of the edited parts of a volume, with the strokes baked in, stored on the lattice of its finest voxels.
+ * Lattice point (x, y, z) sits at (x, y, z) * VoxelSize in the volume's actor space, so a chunk of any depth samples every
+ * 2^(MaxDepth - Depth)th point. The octree only subdivides where strokes reached:
+ *  - nodes no stroke reached hold nothing and the procedural density shows through
+ *  - nodes all air or all solid past the quantization range, as most of a dig ends up, collapse to a single value
+ *  - the rest end in bricks of BrickSize^3 quantized distances and materials
+ * Distances are quantized to 16 bits over RangeVoxels finest voxels, a tighter range than chunk grids use so bricks only line the
+ * surface. Chunks with coarser voxels than that read them clamped, which moves their surface crossings by a fraction of their own
+ * voxel at most.
+ */
+struct VOXEL_API FVoxelEditOctree
+{
+	// Lattice points along a brick's edge
+	static constexpr int32 BrickSize = 8;
+	static constexpr int32 BrickVolume = BrickSize * BrickSize * BrickSize;
+
+	// Distance from the surface stored before clamping, in finest voxels
+	static constexpr double RangeVoxels = 4.0;
+
+	/* Procedural density at InLocation, writing its material to OutMaterialId */
+	using FSampleBase = TFunctionRef<double(const FVector& InLocation, uint8& OutMaterialId)>;
+
+	/*
+	 * Empties the octree for a lattice of InVoxelSize spanning at least InHalfExtent points either side of the origin. Densities are
+	 * below InIsovalue inside and change by InDensityPerUnit per unit of distance near the surface.
+	 */
+	void Init(double InVoxelSize, int32 InHalfExtent, double InIsovalue, double InDensityPerUnit);
+
+	/* Removes every edit, back to the procedural density everywhere */
+	void Reset();
+
+	/* Bakes a stroke on top of what is stored, new bricks start from InSampleBase */
+	void ApplyEdit(const FVoxelEdit& InEdit, FSampleBase InSampleBase);
+
+	/*
+	 * Bakes strokes in order in a single descent, as applying them one by one would. Each node only considers the strokes that
+	 * reached its parent, a stroke covering it drops the ones before, and bricks apply all theirs per sample, so a replayed log of
+	 * thousands of strokes visits every node once.
+	 */
+	void ApplyEdits(TConstArrayView<FVoxelEdit> InEdits, FSampleBase InSampleBase);
+
+	/* Lattice point nearest InLocation */
+	FIntVector GetLatticePoint(const FVector& InLocation) const;
+
+	/* Density and material at lattice point InPoint if an edit reached it, returns false and leaves them alone otherwise */
+	bool Sample(const FIntVector& InPoint, double& OutDensity, uint8* OutMaterialId = nullptr) const;
+
+	/*
+	 * Overwrites the samples of a grid of InSize lattice points, InStride apart from InOrigin, that edits reached. Grids are laid
+	 * out like FArray3D, z fastest, OutMaterialIds is skipped if empty. Whole nodes are filled at once, so a chunk of any depth
+	 * extracts in time proportional to the edited samples it holds.
+	 */
+	void Extract(const FIntVector& InOrigin, int32 InStride, const FIntVector& InSize, TArrayView<double> OutDensities, TArrayView<uint8> OutMaterialIds) const;
+
+	/* Chunks of InChunkSize lattice points, a power of two from BrickSize to the root's size, by minimum point / InChunkSize */
+	void GatherChunks(int32 InChunkSize, TArray<FIntVector>& OutChunks) const;
+
+	/* Chunks whose points a stroke within InBounds can change */
+	void GatherChunks(const FBox& InBounds, int32 InChunkSize, TArray<FIntVector>& OutChunks) const;
+
+	/* Writes what chunk InChunk holds to OutData, left empty if no edit reached it */
+	void SaveChunk(const FIntVector& InChunk, int32 InChunkSize, TArray<uint8>& OutData) const;
+
+	/* Replaces what chunk InChunk holds with InData from SaveChunk. Returns false, leaving the chunk as it was, if InData is malformed */
+	bool LoadChunk(const FIntVector& InChunk, int32 InChunkSize, TConstArrayView<uint8> InData);
+
+	double GetVoxelSize() const { return VoxelSize; }
+	int32 GetRootSize() const { return RootSize; }
+
+	int32 NumNodes() const { return Nodes.Num() - FreeChildren.Num() * 8; }
+	int32 NumBricks() const { return Bricks.Num() - FreeBricks.Num(); }
+
+	/* Bytes held, free slots included */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	struct FNode
+	{
+		// First of the 8 consecutive children in Nodes, INDEX_NONE if not subdivided
+		int32 Children = INDEX_NONE;
+
+		// Index in Bricks, INDEX_NONE if the node is not a brick
+		int32 Brick = INDEX_NONE;
+
+		// Value of the whole node if bUniform
+		int16 Distance = 0;
+		uint8 MaterialId = 0;
+		bool bUniform = false;
+
+		bool IsEdited() const { return bUniform || Children != INDEX_NONE || Brick != INDEX_NONE; }
+	};
+
+	struct FBrick
+	{
+		int16 Distances[BrickVolume];
+		uint8 MaterialIds[BrickVolume];
+	};
+
+	/* Applies strokes InReaching, indices in InEdits in order, to the node */
+	void ApplyEdits(int32 InNode, const FIntVector& InMin, int32 InSize, TConstArrayView<FVoxelEdit> InEdits, TConstArrayView<int32> InReaching, FSampleBase InSampleBase);
+
+	/* Turns the node into a brick holding its uniform value, or InSampleBase if nothing reached it yet */
+	void MakeBrick(int32 InNode, const FIntVector& InMin, FSampleBase InSampleBase);
+
+	/* Subdivides a leaf node, the children inherit its value */
+	void MakeChildren(int32 InNode);
+
+	/* Collapses the node to a single value if its brick or its children all hold the same one */
+	void TryCollapse(int32 InNode);
+
+	/* Makes the node uniform, freeing what was below it */
+	void SetUniform(int32 InNode, int16 InDistance, uint8 InMaterialId);
+	void FreeBelow(int32 InNode);
+
+	void GatherChunks(int32 InNode, const FIntVector& InMin, int32 InSize, int32 InChunkSize, TArray<FIntVector>& OutChunks) const;
+
+	/* Node covering chunk InChunk, or the uniform or empty node above it, and its size */
+	int32 FindChunkNode(const FIntVector& InChunk, int32 InChunkSize, int32& OutSize) const;
+
+	void SaveNode(int32 InNode, TArray<uint8>& OutData) const;
+
+	/* Reads a node saved at InSize, building it below InNode unless it is INDEX_NONE, returns false if InData runs out or is malformed */
+	bool LoadNode(int32 InNode, int32 InSize, TConstArrayView<uint8> InData, int32& InOutOffset);
+
+	void Extract(int32 InNode, const FIntVector& InMin, int32 InSize, const FIntVector& InOrigin, int32 InStride, const FIntVector& InGridSize, TArrayView<double> OutDensities, TArrayView<uint8> OutMaterialIds) const;
+
+	/* Air carries no material, so all-air bricks collapse whatever was dug */
+	uint8 GetStoredMaterial(int16 InDistance, uint8 InMaterialId) const
+	{
+		return InDistance == FVoxelQuantizedDensity16::MaxValue ? 0 : InMaterialId;
+	}
+
+	double DecodeDensity(int16 InDistance) const
+	{
+		return Isovalue + Quantization.Decode(InDistance) * DensityPerUnit;
+	}
+
+	// Nodes[0] is the root, children are allocated in blocks of 8
+	TArray<FNode> Nodes;
+	TArray<FBrick> Bricks;
+	TArray<int32> FreeChildren;
+	TArray<int32> FreeBricks;
+
+	// Quantizes distances in units, not densities, so strokes apply to them directly
+	FVoxelQuantizedDensity16 Quantization;
+
+	double VoxelSize = 0;
+	double Isovalue = 0;
+	double DensityPerUnit = 1;
+
+	// Root spans lattice points [-RootSize / 2, RootSize / 2)
+	int32 RootSize = 0;
+};
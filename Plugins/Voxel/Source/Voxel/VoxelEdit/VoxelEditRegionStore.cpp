@@ -0,0 +1,408 @@
+#include "VoxelEditRegionStore.h"
+
+#include "Async/Async.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+
+
+namespace VoxelEditRegionStore
+{
+	// "VXER"
+	static constexpr uint32 Magic = 0x52455856;
+	static constexpr uint32 Version = 1;
+
+	static constexpr int32 NumEntries = FVoxelEditRegionStore::RegionChunks * FVoxelEditRegionStore::RegionChunks * FVoxelEditRegionStore::RegionChunks;
+
+	// Largest payload a chunk may claim once decompressed, so a corrupt region file can not ask for huge allocations
+	static constexpr int64 MaxChunkBytes = 1 << 24;
+
+	struct FHeader
+	{
+		uint32 Magic = 0;
+		uint32 Version = 0;
+		int32 ChunkSize = 0;
+		int32 RegionChunks = 0;
+		double VoxelSize = 0;
+	};
+
+	/* Where a chunk's payload sits in the file, one per chunk of the region after the header */
+	struct FEntry
+	{
+		// From the start of the file, 0 if the chunk has no payload
+		uint32 Offset = 0;
+		uint32 Size = 0;
+		uint32 UncompressedSize = 0;
+		uint32 Format = 0;
+	};
+
+	/* How a payload is stored, raw if compressing did not make it smaller */
+	enum class EPayloadFormat : uint8
+	{
+		Raw,
+		LZ4,
+		Zlib
+	};
+
+	FName GetFormatName(EPayloadFormat InFormat)
+	{
+		return InFormat == EPayloadFormat::LZ4 ? NAME_LZ4 : NAME_Zlib;
+	}
+
+	int32 FloorDivide(int32 InA, int32 InB)
+	{
+		return InA >= 0 ? InA / InB : -((-InA + InB - 1) / InB);
+	}
+}
+
+FVoxelEditRegionStore::FVoxelEditRegionStore(const FString& InDirectory, int32 InChunkSize, double InVoxelSize, EVoxelEditCompression InCompression) :
+	Directory(InDirectory),
+	ChunkSize(InChunkSize),
+	VoxelSize(InVoxelSize),
+	Compression(InCompression)
+{
+}
+
+FIntVector FVoxelEditRegionStore::GetRegion(const FIntVector& InChunk)
+{
+	using namespace VoxelEditRegionStore;
+
+	return FIntVector(FloorDivide(InChunk.X, RegionChunks), FloorDivide(InChunk.Y, RegionChunks), FloorDivide(InChunk.Z, RegionChunks));
+}
+
+int32 FVoxelEditRegionStore::GetChunkIndex(const FIntVector& InChunk)
+{
+	const FIntVector local = InChunk - GetRegion(InChunk) * RegionChunks;
+	return (local.X * RegionChunks + local.Y) * RegionChunks + local.Z;
+}
+
+FIntVector FVoxelEditRegionStore::GetChunk(const FIntVector& InRegion, int32 InIndex)
+{
+	return InRegion * RegionChunks + FIntVector(InIndex / (RegionChunks * RegionChunks), (InIndex / RegionChunks) % RegionChunks, InIndex % RegionChunks);
+}
+
+FString FVoxelEditRegionStore::GetRegionPath(const FIntVector& InRegion) const
+{
+	return Directory / FString::Printf(TEXT("r.%d.%d.%d.vxr"), InRegion.X, InRegion.Y, InRegion.Z);
+}
+
+void FVoxelEditRegionStore::FindRegions(TArray<FIntVector>& OutRegions) const
+{
+	OutRegions.Reset();
+
+	TArray<FString> files;
+	IFileManager::Get().FindFiles(files, *(Directory / TEXT("*.vxr")), true, false);
+
+	for (const FString& file : files)
+	{
+		TArray<FString> parts;
+		file.ParseIntoArray(parts, TEXT("."));
+		if (parts.Num() == 5 && parts[0] == TEXT("r"))
+		{
+			OutRegions.Add(FIntVector(FCString::Atoi(*parts[1]), FCString::Atoi(*parts[2]), FCString::Atoi(*parts[3])));
+		}
+	}
+}
+
+void FVoxelEditRegionStore::Write(FVoxelEditRegionChunk&& InChunk)
+{
+	FScopeLock lock(&Lock);
+	Queued.FindOrAdd(GetRegion(InChunk.Chunk)).Add(GetChunkIndex(InChunk.Chunk), MoveTemp(InChunk.Data));
+}
+
+bool FVoxelEditRegionStore::HasQueuedWrites() const
+{
+	FScopeLock lock(&Lock);
+	return !Queued.IsEmpty();
+}
+
+bool FVoxelEditRegionStore::Flush()
+{
+	FScopeLock lock(&Lock);
+	if (bWriting || Queued.IsEmpty())
+	{
+		return false;
+	}
+
+	Writing = MoveTemp(Queued);
+	Queued.Reset();
+	bWriting = true;
+
+	Async(EAsyncExecution::ThreadPool, [store = AsShared()]()
+	{
+		store->WriteRegions();
+	});
+
+	return true;
+}
+
+bool FVoxelEditRegionStore::IsWriting() const
+{
+	FScopeLock lock(&Lock);
+	return bWriting;
+}
+
+void FVoxelEditRegionStore::WaitForWrites()
+{
+	while (IsWriting() || Flush())
+	{
+		FPlatformProcess::Sleep(0.001f);
+	}
+}
+
+void FVoxelEditRegionStore::Clear()
+{
+	TArray<FIntVector> regions;
+	FindRegions(regions);
+
+	FScopeLock lock(&Lock);
+
+	// A flush running now may create or rewrite files FindRegions did not see, they are removed by the next one
+	for (const TMap<FIntVector, FRegionChunks>* chunks : { &Writing, &Queued })
+	{
+		for (const TPair<FIntVector, FRegionChunks>& region : *chunks)
+		{
+			regions.AddUnique(region.Key);
+		}
+	}
+
+	Queued.Reset();
+	for (const FIntVector& region : regions)
+	{
+		FRegionChunks& chunks = Queued.Add(region);
+		for (int32 i = 0; i < RegionChunks * RegionChunks * RegionChunks; i++)
+		{
+			chunks.Add(i, TArray<uint8>());
+		}
+	}
+}
+
+void FVoxelEditRegionStore::WriteRegions()
+{
+	// Writing only changes on the game thread while no flush runs, so it is read here without the lock
+	for (const TPair<FIntVector, FRegionChunks>& region : Writing)
+	{
+		// Payloads of the chunks that did not change are copied over still compressed
+		TMap<int32, FCompressedChunk> chunks;
+		ReadRegionFile(region.Key, chunks);
+
+		for (const TPair<int32, TArray<uint8>>& chunk : region.Value)
+		{
+			if (chunk.Value.IsEmpty())
+			{
+				chunks.Remove(chunk.Key);
+			}
+			else
+			{
+				chunks.Add(chunk.Key, Compress(chunk.Value));
+			}
+		}
+
+		WriteRegionFile(region.Key, chunks);
+	}
+
+	FScopeLock lock(&Lock);
+	Writing.Reset();
+	bWriting = false;
+}
+
+TFuture<TArray<FVoxelEditRegionChunk>> FVoxelEditRegionStore::LoadRegion(const FIntVector& InRegion) const
+{
+	return Async(EAsyncExecution::ThreadPool, [store = AsShared(), InRegion]()
+	{
+		// Chunks written since the file was saved, taken before reading it so a flush finishing meanwhile is in one or the other
+		FRegionChunks written;
+		{
+			FScopeLock lock(&store->Lock);
+			for (const TMap<FIntVector, FRegionChunks>* chunks : { &store->Writing, &store->Queued })
+			{
+				if (const FRegionChunks* regionChunks = chunks->Find(InRegion))
+				{
+					written.Append(*regionChunks);
+				}
+			}
+		}
+
+		TMap<int32, FCompressedChunk> saved;
+		store->ReadRegionFile(InRegion, saved);
+
+		TArray<FVoxelEditRegionChunk> chunks;
+		for (const TPair<int32, FCompressedChunk>& chunk : saved)
+		{
+			if (written.Contains(chunk.Key))
+			{
+				continue;
+			}
+
+			FVoxelEditRegionChunk& loaded = chunks.AddDefaulted_GetRef();
+			loaded.Chunk = GetChunk(InRegion, chunk.Key);
+			if (!Decompress(chunk.Value, loaded.Data))
+			{
+				chunks.Pop();
+			}
+		}
+
+		for (TPair<int32, TArray<uint8>>& chunk : written)
+		{
+			FVoxelEditRegionChunk& loaded = chunks.AddDefaulted_GetRef();
+			loaded.Chunk = GetChunk(InRegion, chunk.Key);
+			loaded.Data = MoveTemp(chunk.Value);
+		}
+
+		return chunks;
+	});
+}
+
+bool FVoxelEditRegionStore::ReadRegionFile(const FIntVector& InRegion, TMap<int32, FCompressedChunk>& OutChunks) const
+{
+	using namespace VoxelEditRegionStore;
+
+	OutChunks.Reset();
+
+	FScopeLock fileLock(&FileLock);
+
+	IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+	const FString path = GetRegionPath(InRegion);
+	if (!platformFile.FileExists(*path))
+	{
+		return false;
+	}
+
+	// The mapped region is declared last so it is unmapped before the handle closes
+	TUniquePtr<IMappedFileHandle> handle(platformFile.OpenMapped(*path));
+	if (!handle || handle->GetFileSize() < (int64)(sizeof(FHeader) + sizeof(FEntry) * NumEntries))
+	{
+		return false;
+	}
+
+	TUniquePtr<IMappedFileRegion> mapped(handle->MapRegion(0, handle->GetFileSize()));
+	if (!mapped)
+	{
+		return false;
+	}
+
+	const uint8* data = mapped->GetMappedPtr();
+	const int64 size = mapped->GetMappedSize();
+
+	FHeader header;
+	FMemory::Memcpy(&header, data, sizeof(header));
+	if (header.Magic != Magic || header.Version != Version || header.ChunkSize != ChunkSize || header.RegionChunks != RegionChunks || header.VoxelSize != VoxelSize)
+	{
+		return false;
+	}
+
+	for (int32 i = 0; i < NumEntries; i++)
+	{
+		FEntry entry;
+		FMemory::Memcpy(&entry, data + sizeof(FHeader) + sizeof(FEntry) * i, sizeof(entry));
+		if (entry.Offset == 0 || entry.Offset + (int64)entry.Size > size)
+		{
+			continue;
+		}
+
+		FCompressedChunk& chunk = OutChunks.Add(i);
+		chunk.Data.Append(data + entry.Offset, entry.Size);
+		chunk.UncompressedSize = entry.UncompressedSize;
+		chunk.Format = (uint8)entry.Format;
+	}
+
+	return true;
+}
+
+bool FVoxelEditRegionStore::WriteRegionFile(const FIntVector& InRegion, const TMap<int32, FCompressedChunk>& InChunks) const
+{
+	using namespace VoxelEditRegionStore;
+
+	const FString path = GetRegionPath(InRegion);
+	if (InChunks.IsEmpty())
+	{
+		FScopeLock fileLock(&FileLock);
+		return IFileManager::Get().Delete(*path, false, true, true);
+	}
+
+	FHeader header;
+	header.Magic = Magic;
+	header.Version = Version;
+	header.ChunkSize = ChunkSize;
+	header.RegionChunks = RegionChunks;
+	header.VoxelSize = VoxelSize;
+
+	TArray<FEntry> entries;
+	entries.SetNum(NumEntries);
+
+	TArray<uint8> file;
+	file.AddZeroed(sizeof(FHeader) + sizeof(FEntry) * NumEntries);
+	for (const TPair<int32, FCompressedChunk>& chunk : InChunks)
+	{
+		FEntry& entry = entries[chunk.Key];
+		entry.Offset = file.Num();
+		entry.Size = chunk.Value.Data.Num();
+		entry.UncompressedSize = chunk.Value.UncompressedSize;
+		entry.Format = chunk.Value.Format;
+		file.Append(chunk.Value.Data);
+	}
+
+	FMemory::Memcpy(file.GetData(), &header, sizeof(header));
+	FMemory::Memcpy(file.GetData() + sizeof(header), entries.GetData(), sizeof(FEntry) * NumEntries);
+
+	// Written beside the region and moved over it, so a reader never maps half a file
+	const FString tempPath = path + TEXT(".tmp");
+	if (!FFileHelper::SaveArrayToFile(file, *tempPath))
+	{
+		return false;
+	}
+
+	FScopeLock fileLock(&FileLock);
+	return IFileManager::Get().Move(*path, *tempPath, true, true);
+}
+
+FVoxelEditRegionStore::FCompressedChunk FVoxelEditRegionStore::Compress(const TArray<uint8>& InData) const
+{
+	using namespace VoxelEditRegionStore;
+
+	const EPayloadFormat format = Compression == EVoxelEditCompression::LZ4 ? EPayloadFormat::LZ4 : EPayloadFormat::Zlib;
+	const FName formatName = GetFormatName(format);
+
+	FCompressedChunk chunk;
+	chunk.UncompressedSize = InData.Num();
+
+	int32 compressedSize = FCompression::CompressMemoryBound(formatName, InData.Num());
+	chunk.Data.SetNumUninitialized(compressedSize);
+	if (FCompression::CompressMemory(formatName, chunk.Data.GetData(), compressedSize, InData.GetData(), InData.Num()) && compressedSize < InData.Num())
+	{
+		chunk.Data.SetNum(compressedSize);
+		chunk.Format = (uint8)format;
+	}
+	else
+	{
+		chunk.Data = InData;
+		chunk.Format = (uint8)EPayloadFormat::Raw;
+	}
+
+	return chunk;
+}
+
+bool FVoxelEditRegionStore::Decompress(const FCompressedChunk& InChunk, TArray<uint8>& OutData)
+{
+	using namespace VoxelEditRegionStore;
+
+	const EPayloadFormat format = (EPayloadFormat)InChunk.Format;
+	if (format == EPayloadFormat::Raw)
+	{
+		OutData = InChunk.Data;
+		return true;
+	}
+
+	// The size comes from the file as a uint32, anything past the limit, negative included, is corrupt
+	if ((format != EPayloadFormat::LZ4 && format != EPayloadFormat::Zlib) || InChunk.UncompressedSize < 0 || InChunk.UncompressedSize > MaxChunkBytes)
+	{
+		return false;
+	}
+
+	OutData.SetNumUninitialized(InChunk.UncompressedSize);
+	return FCompression::UncompressMemory(GetFormatName(format), OutData.GetData(), InChunk.UncompressedSize, InChunk.Data.GetData(), InChunk.Data.Num());
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+
+#include "VoxelEditRegionStore.generated.h"
+
+/* Compression of the chunk payloads in region files */
+UENUM(BlueprintType)
+enum class EVoxelEditCompression : uint8
+{
+	// Fast to read and write, the default
+	LZ4,
+	// Smaller files, slower to write
+	Zlib
+};
+
+/* One chunk of a region file, as FVoxelEditOctree::SaveChunk writes it */
+struct FVoxelEditRegionChunk
+{
+	// Minimum lattice point of the chunk divided by the chunk size
+	FIntVector Chunk = FIntVector::ZeroValue;
+
+	// Empty for a chunk without edits
+	TArray<uint8> Data;
+};
+
+/*
+ * Edits saved to region files, each holding a block of RegionChunks^3 chunks with every chunk's payload compressed on its own.
+ * A region file is a header, a table of where each chunk's payload sits, then the payloads. Chunks written between two flushes
+ * are queued and each region they touch is rewritten once, on a background thread, keeping the payloads of the chunks that did not
+ * change as they are. Files are replaced whole, so a crash mid-write leaves the previous file.
+ * Regions are read through memory-mapped files on a background thread, with the chunks queued or being written taking precedence,
+ * so a region loads correctly whenever its chunks were last written.
+ */
+class VOXEL_API FVoxelEditRegionStore : public TSharedFromThis<FVoxelEditRegionStore, ESPMode::ThreadSafe>
+{
+public:
+	// Chunks along a region's edge
+	static constexpr int32 RegionChunks = 8;
+
+	/*
+	 * Region files in InDirectory for chunks of InChunkSize lattice points of InVoxelSize, files saved for another chunk or voxel
+	 * size are skipped when loading and replaced when written to.
+	 */
+	FVoxelEditRegionStore(const FString& InDirectory, int32 InChunkSize, double InVoxelSize, EVoxelEditCompression InCompression);
+
+	/* Region holding chunk InChunk */
+	static FIntVector GetRegion(const FIntVector& InChunk);
+
+	/* Regions with a file in the directory */
+	void FindRegions(TArray<FIntVector>& OutRegions) const;
+
+	/* Queues a chunk for the next flush, replacing what is queued or saved for it */
+	void Write(FVoxelEditRegionChunk&& InChunk);
+
+	/* Whether chunks are queued for the next flush */
+	bool HasQueuedWrites() const;
+
+	/*
+	 * Starts writing the queued chunks in the background, one file write per region however many of its chunks changed. Returns false
+	 * if the previous flush is still running or nothing is queued, the chunks then stay queued for the next one.
+	 */
+	bool Flush();
+
+	/* Whether a flush is running */
+	bool IsWriting() const;
+
+	/* Writes whatever is queued and blocks until it is on disk, for shutdown */
+	void WaitForWrites();
+
+	/* Drops the queued chunks and queues every chunk of every saved or written region empty, so the next flush removes the files */
+	void Clear();
+
+	/* Reads the chunks of region InRegion on a background thread, the ones queued empty since included */
+	TFuture<TArray<FVoxelEditRegionChunk>> LoadRegion(const FIntVector& InRegion) const;
+
+	const FString& GetDirectory() const { return Directory; }
+	int32 GetChunkSize() const { return ChunkSize; }
+	double GetVoxelSize() const { return VoxelSize; }
+
+private:
+	// Chunk payloads by index in their region, x major
+	using FRegionChunks = TMap<int32, TArray<uint8>>;
+
+	struct FCompressedChunk
+	{
+		TArray<uint8> Data;
+		int32 UncompressedSize = 0;
+		uint8 Format = 0;
+	};
+
+	FString GetRegionPath(const FIntVector& InRegion) const;
+
+	static int32 GetChunkIndex(const FIntVector& InChunk);
+	static FIntVector GetChunk(const FIntVector& InRegion, int32 InIndex);
+
+	/* Compressed payloads of the chunks saved in a region file, false if it does not exist or was saved for another lattice */
+	bool ReadRegionFile(const FIntVector& InRegion, TMap<int32, FCompressedChunk>& OutChunks) const;
+
+	bool WriteRegionFile(const FIntVector& InRegion, const TMap<int32, FCompressedChunk>& InChunks) const;
+
+	FCompressedChunk Compress(const TArray<uint8>& InData) const;
+	static bool Decompress(const FCompressedChunk& InChunk, TArray<uint8>& OutData);
+
+	/* Writes the regions in Writing, runs on a background thread */
+	void WriteRegions();
+
+	FString Directory;
+	int32 ChunkSize = 0;
+	double VoxelSize = 0;
+	EVoxelEditCompression Compression = EVoxelEditCompression::LZ4;
+
+	// Guards Queued, Writing and bWriting
+	mutable FCriticalSection Lock;
+
+	// Keeps a region file from being replaced while it is mapped
+	mutable FCriticalSection FileLock;
+
+	TMap<FIntVector, FRegionChunks> Queued;
+	TMap<FIntVector, FRegionChunks> Writing;
+	bool bWriting = false;
+};
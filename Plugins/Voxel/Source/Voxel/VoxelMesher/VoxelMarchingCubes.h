@@ -0,0 +1,421 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMesher/VoxelMesherTypes.h"
+#include "VoxelUtilities/Array3D.h"
+#include "VoxelUtilities/VoxelQuantizedDensity.h"
+#include "VoxelUtilities/VoxelSignMask.h"
+#include "VoxelUtilities/VoxelStatics.h"
+
+
+namespace VoxelMarchingCubes
+{
+	// Samples beyond the chunk on every side of the density grid, the central differences of the normals read them
+	static constexpr int32 Apron = 1;
+
+	/* Samples per grid edge for a chunk of InResolution cells */
+	constexpr int32 GetGridEdgeCount(int32 InResolution) { return InResolution + 1 + Apron * 2; }
+}
+
+/*
+ * Vertex of every crossed grid edge around the cells being marched, so the up to four cells sharing an edge emit one vertex.
+ * Cells come in x major order, only the edges on the low and high x plane of the current cells and those between them are kept.
+ */
+struct FVoxelEdgeVertexCache
+{
+	/* Sizes the cache for grids of InEdgeCount corners per edge and clears it */
+	void Init(int32 InEdgeCount)
+	{
+		EdgeCount = InEdgeCount;
+		const int32 planeSize = InEdgeCount * InEdgeCount;
+
+		Indices.SetNumUninitialized(planeSize * 5);
+		FMemory::Memset(Indices.GetData(), 0xff, Indices.Num() * sizeof(int32));
+		LowPlane = Indices.GetData();
+		HighPlane = LowPlane + planeSize * 2;
+		EdgesX = HighPlane + planeSize * 2;
+		CurrentX = 0;
+	}
+
+	/* Moves on to the cells at InX, the last cells' high plane becomes the low plane when they were neighbours */
+	FORCEINLINE void SetX(int32 InX)
+	{
+		if (InX == CurrentX)
+		{
+			return;
+		}
+
+		const int32 planeSize = EdgeCount * EdgeCount;
+		if (InX == CurrentX + 1)
+		{
+			Swap(LowPlane, HighPlane);
+		}
+		else
+		{
+			FMemory::Memset(LowPlane, 0xff, planeSize * 2 * sizeof(int32));
+		}
+
+		FMemory::Memset(HighPlane, 0xff, planeSize * 2 * sizeof(int32));
+		FMemory::Memset(EdgesX, 0xff, planeSize * sizeof(int32));
+		CurrentX = InX;
+	}
+
+	/* Vertex of cube edge InEdge of the cell at (current x, InY, InZ), INDEX_NONE until one is emitted for it */
+	FORCEINLINE int32& GetEdgeVertex(int32 InEdge, int32 InY, int32 InZ)
+	{
+		const float* cornerA = VoxelStatics::a2fVertexOffset[VoxelStatics::a2iEdgeConnection[InEdge][0]];
+		const float* cornerB = VoxelStatics::a2fVertexOffset[VoxelStatics::a2iEdgeConnection[InEdge][1]];
+
+		// Edges are keyed by their lower corner and axis
+		const int32 idxCorner = (InY + (int32)FMath::Min(cornerA[1], cornerB[1])) * EdgeCount + InZ + (int32)FMath::Min(cornerA[2], cornerB[2]);
+		if (cornerA[0] != cornerB[0])
+		{
+			return EdgesX[idxCorner];
+		}
+
+		int32* plane = cornerA[0] != 0 ? HighPlane : LowPlane;
+		return plane[idxCorner * 2 + (cornerA[1] != cornerB[1] ? 0 : 1)];
+	}
+
+private:
+	TArray<int32> Indices;
+
+	// Edges along y and z of every corner of the low and high x plane, interleaved
+	int32* LowPlane = nullptr;
+	int32* HighPlane = nullptr;
+
+	// Edges along x from every corner of the low plane
+	int32* EdgesX = nullptr;
+
+	int32 EdgeCount = 0;
+	int32 CurrentX = 0;
+};
+
+/*
+ * Marching cubes over a sampled chunk.
+ * InResolution > 0 bakes the chunk resolution into the kernel so the row stride is a constant,
+ * InResolution == 0 is the generic kernel reading FVoxelMeshParams::Resolution at runtime.
+ * bInUnrolled fully unrolls the per-cell corner and edge loops.
+ * Vertices are shared by the cells around their edge, their normals come from the central difference gradient of the
+ * density field, which needs the VoxelMarchingCubes::Apron samples the grid carries past every face of the chunk.
+ */
+template<int32 InResolution, bool bInUnrolled = false>
+struct TVoxelMarchingCubes
+{
+	static constexpr bool IsSpecialized() { return InResolution > 0; }
+
+	/*
+	 * Generates mesh to the streamset, returns true if any triangles were generated.
+	 * InDensityValues holds densities (double, float) or quantized samples (int8, int16), which are meshed directly,
+	 * and starts VoxelMarchingCubes::Apron samples before the chunk's corner (0, 0, 0).
+	 */
+	template<typename InSampleType>
+	static bool GenerateMesh(const FArray3D<InSampleType>& InDensityValues, const FVoxelMeshParams& InParams, FRealtimeMeshStreamSet& OutStreamSet)
+	{
+		const int32 resolution = IsSpecialized() ? InResolution : InParams.Resolution;
+		const int32 gridEdgeCount = VoxelMarchingCubes::GetGridEdgeCount(resolution);
+		check(InDensityValues.GetSize3D() == FIntVector(gridEdgeCount));
+
+		const InSampleType isovalue = VoxelDensity::GetSampleIsovalue<InSampleType>(InParams.SurfaceIsovalue);
+
+		FVoxelSignMask signMask;
+		signMask.Build(InDensityValues, isovalue, VoxelMarchingCubes::Apron);
+
+		// First pass, find the cells that have both inside and outside corners and count their triangles and shared vertices
+		TArray<FVoxelActiveCell> activeCells;
+		const int32 numTris = signMask.GatherActiveCells(activeCells);
+		if (numTris == 0)
+		{
+			return false;
+		}
+
+		const int32 numVertices = signMask.CountCrossedEdges();
+
+		FVoxelMeshBuilder builder(OutStreamSet);
+		EnableVoxelMeshStreams(InParams, builder);
+
+		// One vertex per crossed edge, so the final size of every stream is known here, plus whatever is added after
+		builder.ReserveNumVertices(numVertices + InParams.NumExtraVertices);
+		builder.ReserveNumTriangles(numTris + InParams.NumExtraTriangles);
+
+		FVoxelEdgeVertexCache edgeVertices;
+		edgeVertices.Init(resolution + 1);
+
+		// Second pass, march the active cells and fill the reserved streams
+		const int32 idxCorner0 = InDensityValues.GetIndex1D(VoxelMarchingCubes::Apron, VoxelMarchingCubes::Apron, VoxelMarchingCubes::Apron);
+		const InSampleType* corner0 = InDensityValues.InternalArray.GetData() + idxCorner0;
+		const uint8* materialCorner0 = nullptr;
+		if (InParams.MaterialIds)
+		{
+			check(InParams.MaterialIds->GetSize3D() == InDensityValues.GetSize3D());
+			materialCorner0 = InParams.MaterialIds->InternalArray.GetData() + idxCorner0;
+		}
+
+		EmitActiveCells(activeCells, corner0, materialCorner0, gridEdgeCount * gridEdgeCount, 0, isovalue, InParams, edgeVertices, builder);
+
+		// The count pass must agree with what was emitted, otherwise the streams grew or were left with slack
+		check(builder.NumTriangles() == numTris);
+		check(builder.NumVertices() == numVertices);
+
+		return true;
+	}
+
+	/*
+	 * Streams the chunk through a slab of x planes instead of sampling a full density grid, so the working set stays
+	 * at four planes of densities plus the sign mask of two whatever the resolution. InSamplePlane fills OutPlane with
+	 * the (y, z) densities of plane InX of the grid with VoxelMarchingCubes::Apron samples past every face, z fastest,
+	 * and OutMaterialPlane with their material ids, which it may leave at 0. InParams.MaterialIds is not read.
+	 * Triangles are emitted slab by slab, streams grow as they go.
+	 */
+	static bool GenerateMeshSlabs(
+		const FVoxelMeshParams& InParams,
+		TFunctionRef<void(int32 InX, TArrayView<double> OutPlane, TArrayView<uint8> OutMaterialPlane)> InSamplePlane,
+		FRealtimeMeshStreamSet& OutStreamSet
+	)
+	{
+		const int32 resolution = IsSpecialized() ? InResolution : InParams.Resolution;
+		const int32 edgeCount = resolution + 1;
+		const int32 gridEdgeCount = VoxelMarchingCubes::GetGridEdgeCount(resolution);
+		const int32 planeSize = gridEdgeCount * gridEdgeCount;
+		const int32 apron = VoxelMarchingCubes::Apron;
+		static_assert(VoxelMarchingCubes::Apron == 1, "The slab holds one plane either side of its two corner planes");
+
+		// The slab's two corner planes plus the plane before and after them for the gradients, contiguous so every
+		// plane is one stride from the next. Planes move down one slot per slab, which is cheap next to sampling one
+		TArray<double> planes;
+		planes.SetNumUninitialized(planeSize * 4);
+		double* planeData = planes.GetData();
+
+		// Material ids move along with the densities, zeroed so samplers without materials can skip them
+		TArray<uint8> materialPlanes;
+		materialPlanes.SetNumZeroed(planeSize * 4);
+		uint8* materialPlaneData = materialPlanes.GetData();
+
+		for (int32 i = 0; i < 3; i++)
+		{
+			InSamplePlane(i, MakeArrayView(planeData + i * planeSize, planeSize), MakeArrayView(materialPlaneData + i * planeSize, planeSize));
+		}
+
+		FVoxelMeshBuilder builder(OutStreamSet);
+		EnableVoxelMeshStreams(InParams, builder);
+
+		FVoxelSignMask signMask;
+		TArray<FVoxelActiveCell> activeCells;
+
+		FVoxelEdgeVertexCache edgeVertices;
+		edgeVertices.Init(edgeCount);
+
+		for (int32 x = 0; x < resolution; x++)
+		{
+			if (x > 0)
+			{
+				FMemory::Memmove(planeData, planeData + planeSize, planeSize * 3 * sizeof(double));
+				FMemory::Memmove(materialPlaneData, materialPlaneData + planeSize, planeSize * 3);
+			}
+
+			InSamplePlane(x + apron + 2, MakeArrayView(planeData + planeSize * 3, planeSize), MakeArrayView(materialPlaneData + planeSize * 3, planeSize));
+
+			const double* plane0 = planeData + planeSize;
+			signMask.BuildSlab(plane0, plane0 + planeSize, edgeCount, edgeCount, InParams.SurfaceIsovalue, apron);
+
+			activeCells.Reset();
+			if (signMask.GatherActiveCells(activeCells) > 0)
+			{
+				// Active cells are slab local, x == 0 addresses the slab's first corner plane
+				const int32 idxCorner0 = planeSize + apron * gridEdgeCount + apron;
+				EmitActiveCells(activeCells, planeData + idxCorner0, materialPlaneData + idxCorner0, planeSize, x, InParams.SurfaceIsovalue, InParams, edgeVertices, builder);
+			}
+		}
+
+		return builder.NumTriangles() != 0;
+	}
+
+private:
+	/*
+	 * Marches InActiveCells and adds their triangles to InBuilder.
+	 * InCorner0 is the density of chunk corner (0, 0, 0) in a grid with VoxelMarchingCubes::Apron samples past every face,
+	 * InMaterialCorner0 its material id in a grid of the same layout, nullptr for material 0 everywhere.
+	 * InPlaneStride the distance from one x plane to the next, InOffsetX is added to the x of every cell to place it in the chunk.
+	 * Edges are interpolated in sample units against InIsovalue, which is where quantized samples put the surface too.
+	 */
+	template<typename InSampleType>
+	static void EmitActiveCells(
+		const TArray<FVoxelActiveCell>& InActiveCells,
+		const InSampleType* InCorner0,
+		const uint8* InMaterialCorner0,
+		int32 InPlaneStride,
+		int32 InOffsetX,
+		double InIsovalue,
+		const FVoxelMeshParams& InParams,
+		FVoxelEdgeVertexCache& InEdgeVertices,
+		FVoxelMeshBuilder& InBuilder
+	)
+	{
+		const int32 rowStride = IsSpecialized() ? VoxelMarchingCubes::GetGridEdgeCount(InResolution) : VoxelMarchingCubes::GetGridEdgeCount(InParams.Resolution);
+
+		// Corner offsets relative to corner 0 of a cube, computed once per call from the plane stride passed in at runtime
+		int32 cornerOffsets[8];
+		VoxelStatics::ForEachIndex<8, bInUnrolled>([&](auto i)
+		{
+			cornerOffsets[i] = GetIndex1D(
+				(int32)VoxelStatics::a2fVertexOffset[i][0],
+				(int32)VoxelStatics::a2fVertexOffset[i][1],
+				(int32)VoxelStatics::a2fVertexOffset[i][2],
+				InPlaneStride,
+				rowStride
+			);
+		});
+
+		const double isovalue = InIsovalue;
+		const float voxelSize = InParams.VoxelSize;
+		const bool bTransitions = InParams.TransitionFaces != 0;
+
+		double densityBuffer[8];
+		int32 edgeVertexBuffer[12];
+
+		for (const FVoxelActiveCell& cell : InActiveCells)
+		{
+			const FVector3f cellLocation(cell.X + InOffsetX, cell.Y, cell.Z);
+			InEdgeVertices.SetX(cell.X + InOffsetX);
+
+			// Find values at the cube's corners
+			const int32 idxCell = GetIndex1D(cell.X, cell.Y, cell.Z, InPlaneStride, rowStride);
+			const InSampleType* corner0 = InCorner0 + idxCell;
+			VoxelStatics::ForEachIndex<8, bInUnrolled>([&](auto i)
+			{
+				densityBuffer[i] = corner0[cornerOffsets[i]];
+			});
+
+			// The cell takes the material of its most inside corner
+			uint16 material = 0;
+			if (InMaterialCorner0)
+			{
+				int32 idxInnerCorner = 0;
+				for (int32 i = 1; i < 8; i++)
+				{
+					idxInnerCorner = densityBuffer[i] < densityBuffer[idxInnerCorner] ? i : idxInnerCorner;
+				}
+				material = InMaterialCorner0[idxCell + cornerOffsets[idxInnerCorner]];
+			}
+
+			// Find the point of intersection of the surface with each edge, unless a neighbouring cell already did
+			const uint16 edgeFlags = VoxelStatics::aiCubeEdgeFlags[cell.Case];
+			VoxelStatics::ForEachIndex<12, bInUnrolled>([&](auto i)
+			{
+				if (edgeFlags & (1 << i))
+				{
+					int32& edgeVertex = InEdgeVertices.GetEdgeVertex(i, cell.Y, cell.Z);
+					if (edgeVertex == INDEX_NONE)
+					{
+						const uint8 idxCornerA = VoxelStatics::a2iEdgeConnection[i][0];
+						const uint8 idxCornerB = VoxelStatics::a2iEdgeConnection[i][1];
+						const double c1 = densityBuffer[idxCornerA];
+						const double c2 = densityBuffer[idxCornerB];
+						const float edgeOffset = c1 == c2 ? 0.5f : (float)FMath::Clamp((isovalue - c1) / (c2 - c1), 0.0, 1.0);
+
+						const FVector3f gridLocation = cellLocation + FVector3f(
+							VoxelStatics::a2fVertexOffset[idxCornerA][0] + VoxelStatics::a2fEdgeDirection[i][0] * edgeOffset,
+							VoxelStatics::a2fVertexOffset[idxCornerA][1] + VoxelStatics::a2fEdgeDirection[i][1] * edgeOffset,
+							VoxelStatics::a2fVertexOffset[idxCornerA][2] + VoxelStatics::a2fEdgeDirection[i][2] * edgeOffset
+						);
+
+						// Cells along faces with transition cells are narrowed to make room for them
+						const FVector3f position = InParams.ChunkOrigin + (bTransitions ? InParams.GetTransitionLocation(gridLocation) : gridLocation) * voxelSize;
+						edgeVertex = AddVoxelMeshVertex(InParams, InBuilder, position, [&]()
+						{
+							// Density rises away from the inside, so its gradient at the crossing is the outward normal
+							const FVector3f gradientA = GetGradient(corner0 + cornerOffsets[idxCornerA], InPlaneStride, rowStride);
+							const FVector3f gradientB = GetGradient(corner0 + cornerOffsets[idxCornerB], InPlaneStride, rowStride);
+							return (gradientA + (gradientB - gradientA) * edgeOffset).GetSafeNormal();
+						});
+					}
+
+					edgeVertexBuffer[i] = edgeVertex;
+				}
+			});
+
+			// Draw the triangles that were found, there can be up to five per cube
+			const uint8* triangleEdges = VoxelStatics::a2iCubeTriangleEdges[cell.Case];
+			const int32 numCaseTris = VoxelStatics::aiCubeTriangleCount[cell.Case];
+			for (int32 i = 0; i < numCaseTris; i++)
+			{
+				InBuilder.AddTriangle(edgeVertexBuffer[triangleEdges[i * 3]], edgeVertexBuffer[triangleEdges[i * 3 + 1]], edgeVertexBuffer[triangleEdges[i * 3 + 2]], material);
+			}
+		}
+	}
+
+	/* Central difference gradient at the grid corner InCorner points to, in sample units per voxel times two */
+	template<typename InSampleType>
+	static FORCEINLINE FVector3f GetGradient(const InSampleType* InCorner, int32 InPlaneStride, int32 InRowStride)
+	{
+		const int32 rowStride = IsSpecialized() ? VoxelMarchingCubes::GetGridEdgeCount(InResolution) : InRowStride;
+		return FVector3f(
+			(float)((double)InCorner[InPlaneStride] - (double)InCorner[-InPlaneStride]),
+			(float)((double)InCorner[rowStride] - (double)InCorner[-rowStride]),
+			(float)((double)InCorner[1] - (double)InCorner[-1])
+		);
+	}
+
+	/* Same x major layout as FArray3DLinearLayout with a separate plane stride, the row stride folds to a constant for specialized kernels */
+	static FORCEINLINE int32 GetIndex1D(int32 InX, int32 InY, int32 InZ, int32 InPlaneStride, int32 InRowStride)
+	{
+		const int32 rowStride = IsSpecialized() ? VoxelMarchingCubes::GetGridEdgeCount(InResolution) : InRowStride;
+		return InX * InPlaneStride + InY * rowStride + InZ;
+	}
+};
+
+namespace VoxelMarchingCubes
+{
+	/* Picks the kernel specialized for InParams.Resolution, or the generic one for uncommon resolutions */
+	template<bool bInUnrolled, typename InSampleType>
+	bool GenerateMesh(const FArray3D<InSampleType>& InDensityValues, const FVoxelMeshParams& InParams, FRealtimeMeshStreamSet& OutStreamSet)
+	{
+		switch (InParams.Resolution)
+		{
+		case 8:
+			return TVoxelMarchingCubes<8, bInUnrolled>::GenerateMesh(InDensityValues, InParams, OutStreamSet);
+		case 16:
+			return TVoxelMarchingCubes<16, bInUnrolled>::GenerateMesh(InDensityValues, InParams, OutStreamSet);
+		case 32:
+			return TVoxelMarchingCubes<32, bInUnrolled>::GenerateMesh(InDensityValues, InParams, OutStreamSet);
+		case 64:
+			return TVoxelMarchingCubes<64, bInUnrolled>::GenerateMesh(InDensityValues, InParams, OutStreamSet);
+		default:
+			return TVoxelMarchingCubes<0, bInUnrolled>::GenerateMesh(InDensityValues, InParams, OutStreamSet);
+		}
+	}
+
+	/* Slab streaming counterpart of GenerateMesh, see TVoxelMarchingCubes::GenerateMeshSlabs */
+	template<bool bInUnrolled>
+	bool GenerateMeshSlabs(const FVoxelMeshParams& InParams, TFunctionRef<void(int32, TArrayView<double>, TArrayView<uint8>)> InSamplePlane, FRealtimeMeshStreamSet& OutStreamSet)
+	{
+		switch (InParams.Resolution)
+		{
+		case 8:
+			return TVoxelMarchingCubes<8, bInUnrolled>::GenerateMeshSlabs(InParams, InSamplePlane, OutStreamSet);
+		case 16:
+			return TVoxelMarchingCubes<16, bInUnrolled>::GenerateMeshSlabs(InParams, InSamplePlane, OutStreamSet);
+		case 32:
+			return TVoxelMarchingCubes<32, bInUnrolled>::GenerateMeshSlabs(InParams, InSamplePlane, OutStreamSet);
+		case 64:
+			return TVoxelMarchingCubes<64, bInUnrolled>::GenerateMeshSlabs(InParams, InSamplePlane, OutStreamSet);
+		default:
+			return TVoxelMarchingCubes<0, bInUnrolled>::GenerateMeshSlabs(InParams, InSamplePlane, OutStreamSet);
+		}
+	}
+
+	template<typename InSampleType>
+	FORCEINLINE bool GenerateMesh(const FArray3D<InSampleType>& InDensityValues, const FVoxelMeshParams& InParams, bool bUnrolled, FRealtimeMeshStreamSet& OutStreamSet)
+	{
+		return bUnrolled
+			? GenerateMesh<true>(InDensityValues, InParams, OutStreamSet)
+			: GenerateMesh<false>(InDensityValues, InParams, OutStreamSet);
+	}
+
+	FORCEINLINE bool GenerateMeshSlabs(const FVoxelMeshParams& InParams, TFunctionRef<void(int32, TArrayView<double>, TArrayView<uint8>)> InSamplePlane, bool bUnrolled, FRealtimeMeshStreamSet& OutStreamSet)
+	{
+		return bUnrolled
+			? GenerateMeshSlabs<true>(InParams, InSamplePlane, OutStreamSet)
+			: GenerateMeshSlabs<false>(InParams, InSamplePlane, OutStreamSet);
+	}
+}
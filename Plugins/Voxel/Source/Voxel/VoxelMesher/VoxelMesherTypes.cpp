@@ -0,0 +1,111 @@
+#include "VoxelMesherTypes.h"
+
+#include "Algo/IsSorted.h"
+
+
+void FinalizeVoxelMeshStreams(const FVoxelMeshParams& InParams, FRealtimeMeshStreamSet& InOutStreamSet)
+{
+	using namespace RealtimeMesh;
+
+	const FRealtimeMeshStream* positions = InOutStreamSet.Find(FRealtimeMeshStreams::Position);
+	FRealtimeMeshStream* triangles = InOutStreamSet.Find(FRealtimeMeshStreams::Triangles);
+	FRealtimeMeshStream* polyGroups = InOutStreamSet.Find(FRealtimeMeshStreams::PolyGroups);
+	if (!positions || !triangles || !polyGroups)
+	{
+		return;
+	}
+
+	const TArrayView<TIndex3<uint32>> triangleData = triangles->GetArrayView<TIndex3<uint32>>();
+	const TArrayView<uint16> materials = polyGroups->GetArrayView<uint16>();
+	check(materials.Num() == triangleData.Num());
+
+	// Counting sort, stable so triangles of a material keep the cell order their vertices were emitted in
+	if (!Algo::IsSorted(materials))
+	{
+		uint16 maxMaterial = 0;
+		for (const uint16 material : materials)
+		{
+			maxMaterial = FMath::Max(maxMaterial, material);
+		}
+
+		TArray<int32, TInlineAllocator<16>> materialStarts;
+		materialStarts.SetNumZeroed(maxMaterial + 2);
+		for (const uint16 material : materials)
+		{
+			materialStarts[material + 1]++;
+		}
+
+		for (int32 i = 1; i < materialStarts.Num(); i++)
+		{
+			materialStarts[i] += materialStarts[i - 1];
+		}
+
+		TArray<TIndex3<uint32>> sortedTriangles;
+		sortedTriangles.SetNumUninitialized(triangleData.Num());
+		for (int32 i = 0; i < triangleData.Num(); i++)
+		{
+			sortedTriangles[materialStarts[materials[i]]++] = triangleData[i];
+		}
+		FMemory::Memcpy(triangleData.GetData(), sortedTriangles.GetData(), triangleData.Num() * sizeof(TIndex3<uint32>));
+
+		// materialStarts now holds the end of every material's range
+		int32 idxTriangle = 0;
+		for (int32 material = 0; material <= maxMaterial; material++)
+		{
+			for (; idxTriangle < materialStarts[material]; idxTriangle++)
+			{
+				materials[idxTriangle] = material;
+			}
+		}
+	}
+
+	if (!InParams.bLeanLayout)
+	{
+		return;
+	}
+
+	// One segment per material replaces a polygroup per triangle
+	TArray<FRealtimeMeshPolygonGroupRange, TInlineAllocator<16>> segments;
+	for (int32 i = 0; i < materials.Num(); i++)
+	{
+		if (segments.IsEmpty() || segments.Last().PolygonGroupIndex != materials[i])
+		{
+			segments.Emplace(i, 0, materials[i]);
+		}
+		segments.Last().Count++;
+	}
+
+	InOutStreamSet.Remove(FRealtimeMeshStreams::PolyGroups);
+	FRealtimeMeshStream* segmentStream = InOutStreamSet.AddStream(FRealtimeMeshStreams::PolyGroupSegments, GetRealtimeMeshBufferLayout<FRealtimeMeshPolygonGroupRange>());
+	segmentStream->SetNumUninitialized(segments.Num());
+	FMemory::Memcpy(segmentStream->GetData(), segments.GetData(), segments.Num() * sizeof(FRealtimeMeshPolygonGroupRange));
+
+	if (positions->Num() <= TNumericLimits<uint16>::Max() + 1)
+	{
+		triangles->ConvertTo<TIndex3<uint16>>();
+	}
+}
+
+void GetVoxelMeshMaterials(const FRealtimeMeshStreamSet& InStreamSet, TArray<uint16>& OutMaterials)
+{
+	using namespace RealtimeMesh;
+
+	OutMaterials.Reset();
+	if (const FRealtimeMeshStream* segments = InStreamSet.Find(FRealtimeMeshStreams::PolyGroupSegments))
+	{
+		for (const FRealtimeMeshPolygonGroupRange& segment : segments->GetArrayView<FRealtimeMeshPolygonGroupRange>())
+		{
+			OutMaterials.Add(segment.PolygonGroupIndex);
+		}
+	}
+	else if (const FRealtimeMeshStream* polyGroups = InStreamSet.Find(FRealtimeMeshStreams::PolyGroups))
+	{
+		for (const uint16 material : polyGroups->GetArrayView<uint16>())
+		{
+			if (OutMaterials.IsEmpty() || OutMaterials.Last() != material)
+			{
+				OutMaterials.Add(material);
+			}
+		}
+	}
+}
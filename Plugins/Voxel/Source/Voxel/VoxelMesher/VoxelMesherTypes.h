@@ -0,0 +1,153 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Mesh/RealtimeMeshBuilder.h"
+#include "VoxelUtilities/Array3D.h"
+
+
+// Builder layout every voxel mesher writes chunk streams with
+using FVoxelMeshBuilder = RealtimeMesh::TRealtimeMeshBuilderLocal<uint32, FPackedNormal, FVector2DHalf, 1>;
+
+
+/*
+ * Unit tangent for a vertex with unit normal InNormal, the x axis made perpendicular to the normal (y where the normal runs
+ * close to x). It only depends on the normal, so vertices shared between cells or chunks get the same one.
+ */
+FORCEINLINE FVector3f GetVoxelMeshTangent(const FVector3f& InNormal)
+{
+	const FVector3f axis = FMath::Abs(InNormal.X) < 0.9f ? FVector3f(1, 0, 0) : FVector3f(0, 1, 0);
+	return (axis - InNormal * FVector3f::DotProduct(axis, InNormal)).GetSafeNormal();
+}
+
+/* Chunk-wide inputs shared by the meshers */
+struct FVoxelMeshParams
+{
+	// Location of corner (0, 0, 0) of the chunk's density grid, in actor space
+	FVector3f ChunkOrigin;
+
+	// Distance between two neighbouring density samples
+	double VoxelSize;
+
+	// Density below which a corner is considered inside the surface
+	double SurfaceIsovalue;
+
+	// Cells per chunk edge, the density grid has Resolution + 1 samples per edge
+	int32 Resolution;
+
+	// Faces bordering a coarser chunk, bit 2 * axis + 1 for the positive side and 2 * axis for the negative one
+	uint8 TransitionFaces = 0;
+
+	// Fraction of a voxel the cell layer along a transition face gives up to make room for the transition cells
+	float TransitionWidth = 0.5f;
+
+	// Material id of every sample of the density grid the mesher reads, same size and apron. nullptr puts every triangle in material 0
+	const FArray3D<uint8>* MaterialIds = nullptr;
+
+	// Leave out the vertex colors, keep materials as segments rather than per triangle and narrow small chunks to 16 bit
+	// indices, see FinalizeVoxelMeshStreams
+	bool bLeanLayout = false;
+
+	// Only write what collision reads, positions, triangles and materials. Normals are not even computed
+	bool bCollisionOnly = false;
+
+	// Vertices and triangles added after the mesher is done, the transition cells, reserved along with the mesher's own
+	int32 NumExtraVertices = 0;
+	int32 NumExtraTriangles = 0;
+
+	/*
+	 * Where grid location InLocation (in voxels) ends up once the cell layers along the transition faces are narrowed.
+	 * Locations on the chunk's other faces are shared with neighbours that may not narrow, so they stay put.
+	 */
+	FORCEINLINE FVector3f GetTransitionLocation(const FVector3f& InLocation) const
+	{
+		FVector3f location = InLocation;
+		for (int32 axis = 0; axis < 3; axis++)
+		{
+			const float b = InLocation[(axis + 1) % 3];
+			const float c = InLocation[(axis + 2) % 3];
+			if (b == 0 || c == 0 || b == Resolution || c == Resolution)
+			{
+				continue;
+			}
+
+			if ((TransitionFaces & (1 << (axis * 2))) && InLocation[axis] < 1)
+			{
+				location[axis] = 1 - (1 - InLocation[axis]) * (1 - TransitionWidth);
+			}
+
+			if ((TransitionFaces & (1 << (axis * 2 + 1))) && InLocation[axis] > Resolution - 1)
+			{
+				location[axis] = Resolution - 1 + (InLocation[axis] - (Resolution - 1)) * (1 - TransitionWidth);
+			}
+		}
+
+		return location;
+	}
+};
+
+/*
+ * Enables the streams every voxel mesher fills besides positions and triangles. The local vertex factory needs tangents and
+ * texcoords bound, the lean layout leaves out the vertex colors nothing writes. Triangles always carry their material as a
+ * polygroup while meshing, FinalizeVoxelMeshStreams groups them. A collision only chunk is never drawn and gets no
+ * vertex streams besides its positions.
+ */
+FORCEINLINE void EnableVoxelMeshStreams(const FVoxelMeshParams& InParams, FVoxelMeshBuilder& InBuilder)
+{
+	if (InParams.bCollisionOnly)
+	{
+		InBuilder.EnablePolyGroups();
+		return;
+	}
+
+	InBuilder.EnableTangents();
+	InBuilder.EnableTexCoords();
+	InBuilder.EnablePolyGroups();
+
+	if (!InParams.bLeanLayout)
+	{
+		InBuilder.EnableColors();
+	}
+}
+
+/*
+ * Adds a vertex at InPosition with the streams EnableVoxelMeshStreams enabled and returns its index. InGetNormal gives the
+ * vertex's unit normal and is only called when the chunk is drawn, so collision only chunks skip the gradient.
+ */
+template <typename NormalFuncType>
+FORCEINLINE int32 AddVoxelMeshVertex(const FVoxelMeshParams& InParams, FVoxelMeshBuilder& InBuilder, const FVector3f& InPosition, NormalFuncType&& InGetNormal)
+{
+	if (InParams.bCollisionOnly)
+	{
+		return InBuilder.AddVertex(InPosition).GetIndex();
+	}
+
+	const FVector3f normal = InGetNormal();
+	return InBuilder.AddVertex(InPosition)
+		.SetNormalAndTangent(normal, GetVoxelMeshTangent(normal))
+		.SetTexCoords(FVector2D())
+		.GetIndex();
+}
+
+/*
+ * Runs once every mesher has written the chunk's streams. Sorts the triangles by material so every polygroup is one
+ * contiguous range, which is the only form the section group turns into one section per material without reorganizing
+ * them. The lean layout then replaces the per-triangle polygroups with one segment per material and narrows the triangles
+ * to 16 bit indices when the chunk has few enough vertices. Meshers emit in cell order with 32 bit indices until then,
+ * since transition cells append to the same streams.
+ */
+VOXEL_API void FinalizeVoxelMeshStreams(const FVoxelMeshParams& InParams, FRealtimeMeshStreamSet& InOutStreamSet);
+
+/* Materials a finalized chunk has triangles in, in ascending order */
+VOXEL_API void GetVoxelMeshMaterials(const FRealtimeMeshStreamSet& InStreamSet, TArray<uint16>& OutMaterials);
+
+/* Bytes the chunk's streams take, which is also what they upload to the GPU apart from the CPU only polygroups */
+FORCEINLINE int64 GetVoxelMeshStreamBytes(const FRealtimeMeshStreamSet& InStreamSet)
+{
+	int64 numBytes = 0;
+	InStreamSet.ForEach([&numBytes](const RealtimeMesh::FRealtimeMeshStream& InStream)
+	{
+		numBytes += int64(InStream.Num()) * InStream.GetStride();
+	});
+
+	return numBytes;
+}
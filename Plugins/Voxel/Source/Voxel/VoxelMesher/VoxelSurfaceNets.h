@@ -0,0 +1,241 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMesher/VoxelMesherTypes.h"
+#include "VoxelUtilities/Array3D.h"
+#include "VoxelUtilities/VoxelQuantizedDensity.h"
+#include "VoxelUtilities/VoxelSignMask.h"
+#include "VoxelUtilities/VoxelStatics.h"
+
+
+/*
+ * Naive surface nets over a sampled chunk, the dual of marching cubes.
+ * Every active cell gets one vertex at the mean of its edge crossings and every edge the surface crosses becomes a quad
+ * joining the four cells around it, so vertices are shared and a chunk has roughly half the triangles marching cubes makes.
+ * Quads on the low faces of the chunk need the cells just outside it, so the grid carries an apron of Apron samples on
+ * every side. A chunk owns the edges starting inside [0, Resolution) on every axis, which keeps neighbours of the same
+ * resolution watertight without emitting anything twice.
+ */
+struct FVoxelSurfaceNets
+{
+	// Samples beyond the chunk on every side of the density grid
+	static constexpr int32 Apron = 1;
+
+	/* Samples per grid edge for a chunk of InResolution cells */
+	static constexpr int32 GetGridEdgeCount(int32 InResolution) { return InResolution + 1 + Apron * 2; }
+
+	/*
+	 * Generates mesh to the streamset, returns true if any triangles were generated.
+	 * InDensityValues starts Apron samples before the chunk's corner (0, 0, 0) and holds densities or quantized samples.
+	 * Every quad takes the material of the inside end of the edge it crosses.
+	 */
+	template<typename InSampleType>
+	static bool GenerateMesh(const FArray3D<InSampleType>& InDensityValues, const FVoxelMeshParams& InParams, FRealtimeMeshStreamSet& OutStreamSet)
+	{
+		const int32 resolution = InParams.Resolution;
+		const int32 cellCount = GetGridEdgeCount(resolution) - 1;
+		check(InDensityValues.GetSize3D() == FIntVector(GetGridEdgeCount(resolution)));
+		check(!InParams.MaterialIds || InParams.MaterialIds->GetSize3D() == InDensityValues.GetSize3D());
+
+		const InSampleType isovalue = VoxelDensity::GetSampleIsovalue<InSampleType>(InParams.SurfaceIsovalue);
+
+		FVoxelSignMask signMask;
+		signMask.Build(InDensityValues, isovalue);
+
+		TArray<FVoxelActiveCell> activeCells;
+		signMask.GatherActiveCells(activeCells);
+
+		// First pass, count the vertices and quads so the streams are sized once
+		int32 numVertices = 0;
+		int32 numQuads = 0;
+		for (const FVoxelActiveCell& cell : activeCells)
+		{
+			if (IsVertexCell(cell, resolution))
+			{
+				numVertices++;
+				numQuads += GetNumOwnedQuads(cell, resolution);
+			}
+		}
+
+		if (numQuads == 0)
+		{
+			return false;
+		}
+
+		FVoxelMeshBuilder builder(OutStreamSet);
+		EnableVoxelMeshStreams(InParams, builder);
+
+		builder.ReserveNumVertices(numVertices + InParams.NumExtraVertices);
+		builder.ReserveNumTriangles(numQuads * 2 + InParams.NumExtraTriangles);
+
+		// Vertex of every cell in the current and previous x plane, quads only reach back one cell along each axis
+		TArray<int32> vertexPlanes;
+		vertexPlanes.SetNumUninitialized(cellCount * cellCount * 2);
+		FMemory::Memset(vertexPlanes.GetData(), 0xff, vertexPlanes.Num() * sizeof(int32));
+		int32* prevPlane = vertexPlanes.GetData();
+		int32* currPlane = prevPlane + cellCount * cellCount;
+		int32 currX = 0;
+
+		const auto view = InDensityValues.GetView();
+		const float voxelSize = InParams.VoxelSize;
+
+		// Second pass, place the vertices and join them with the quads of owned edges, active cells come in x major order
+		for (const FVoxelActiveCell& cell : activeCells)
+		{
+			if (!IsVertexCell(cell, resolution))
+			{
+				continue;
+			}
+
+			while (currX < cell.X)
+			{
+				Swap(prevPlane, currPlane);
+				FMemory::Memset(currPlane, 0xff, cellCount * cellCount * sizeof(int32));
+				currX++;
+			}
+
+			double densityBuffer[8];
+			for (int32 i = 0; i < 8; i++)
+			{
+				densityBuffer[i] = view(
+					cell.X + (int32)VoxelStatics::a2fVertexOffset[i][0],
+					cell.Y + (int32)VoxelStatics::a2fVertexOffset[i][1],
+					cell.Z + (int32)VoxelStatics::a2fVertexOffset[i][2]
+				);
+			}
+
+			// Mean of the points where the surface crosses the cell's edges
+			FVector3f massPoint(0);
+			int32 numCrossings = 0;
+			const uint16 edgeFlags = VoxelStatics::aiCubeEdgeFlags[cell.Case];
+			for (int32 i = 0; i < 12; i++)
+			{
+				if (edgeFlags & (1 << i))
+				{
+					const uint8 idxCornerA = VoxelStatics::a2iEdgeConnection[i][0];
+					const double c1 = densityBuffer[idxCornerA];
+					const double c2 = densityBuffer[VoxelStatics::a2iEdgeConnection[i][1]];
+					const float edgeOffset = c1 == c2 ? 0.5f : (float)FMath::Clamp((isovalue - c1) / (c2 - c1), 0.0, 1.0);
+
+					massPoint += FVector3f(
+						VoxelStatics::a2fVertexOffset[idxCornerA][0] + VoxelStatics::a2fEdgeDirection[i][0] * edgeOffset,
+						VoxelStatics::a2fVertexOffset[idxCornerA][1] + VoxelStatics::a2fEdgeDirection[i][1] * edgeOffset,
+						VoxelStatics::a2fVertexOffset[idxCornerA][2] + VoxelStatics::a2fEdgeDirection[i][2] * edgeOffset
+					);
+					numCrossings++;
+				}
+			}
+			massPoint /= (float)numCrossings;
+
+			const FVector3f cellLocation(cell.X - Apron, cell.Y - Apron, cell.Z - Apron);
+			currPlane[cell.Y * cellCount + cell.Z] = AddVoxelMeshVertex(InParams, builder, InParams.ChunkOrigin + (cellLocation + massPoint) * voxelSize, [&]()
+			{
+				// Density rises away from the inside, so its gradient across the cell is the outward normal
+				return FVector3f(
+					(densityBuffer[1] + densityBuffer[2] + densityBuffer[5] + densityBuffer[6]) - (densityBuffer[0] + densityBuffer[3] + densityBuffer[4] + densityBuffer[7]),
+					(densityBuffer[2] + densityBuffer[3] + densityBuffer[6] + densityBuffer[7]) - (densityBuffer[0] + densityBuffer[1] + densityBuffer[4] + densityBuffer[5]),
+					(densityBuffer[4] + densityBuffer[5] + densityBuffer[6] + densityBuffer[7]) - (densityBuffer[0] + densityBuffer[1] + densityBuffer[2] + densityBuffer[3])
+				).GetSafeNormal();
+			});
+
+			if (!IsOwnedCorner(cell, resolution))
+			{
+				continue;
+			}
+
+			const bool bInside = cell.Case & 1;
+			const int32 y = cell.Y;
+			const int32 z = cell.Z;
+
+			const auto getMaterial = [&](int32 InCorner)
+			{
+				if (!InParams.MaterialIds)
+				{
+					return uint16(0);
+				}
+
+				const int32 corner = bInside ? 0 : InCorner;
+				return uint16(InParams.MaterialIds->GetUnchecked(
+					cell.X + (int32)VoxelStatics::a2fVertexOffset[corner][0],
+					cell.Y + (int32)VoxelStatics::a2fVertexOffset[corner][1],
+					cell.Z + (int32)VoxelStatics::a2fVertexOffset[corner][2]
+				));
+			};
+
+			// Each quad winds around its edge (axis a, then b = a + 1 and c = a + 2), flipped when the surface faces along +a
+			if (bInside != bool(cell.Case & (1 << CornerX)))
+			{
+				AddQuad(builder, bInside, getMaterial(CornerX),
+					currPlane[y * cellCount + z], currPlane[(y - 1) * cellCount + z],
+					currPlane[(y - 1) * cellCount + z - 1], currPlane[y * cellCount + z - 1]);
+			}
+
+			if (bInside != bool(cell.Case & (1 << CornerY)))
+			{
+				AddQuad(builder, bInside, getMaterial(CornerY),
+					currPlane[y * cellCount + z], currPlane[y * cellCount + z - 1],
+					prevPlane[y * cellCount + z - 1], prevPlane[y * cellCount + z]);
+			}
+
+			if (bInside != bool(cell.Case & (1 << CornerZ)))
+			{
+				AddQuad(builder, bInside, getMaterial(CornerZ),
+					currPlane[y * cellCount + z], prevPlane[y * cellCount + z],
+					prevPlane[(y - 1) * cellCount + z], currPlane[(y - 1) * cellCount + z]);
+			}
+		}
+
+		check(builder.NumVertices() == numVertices);
+		check(builder.NumTriangles() == numQuads * 2);
+
+		return true;
+	}
+
+private:
+	// Corners of a cell one step from corner 0 along x, y and z, see VoxelStatics::a2fVertexOffset
+	static constexpr int32 CornerX = 1;
+	static constexpr int32 CornerY = 3;
+	static constexpr int32 CornerZ = 4;
+
+	/* Cells that can be part of an owned quad, the cells past the chunk's high faces belong to the neighbours' quads */
+	static FORCEINLINE bool IsVertexCell(const FVoxelActiveCell& InCell, int32 InResolution)
+	{
+		return InCell.X < Apron + InResolution && InCell.Y < Apron + InResolution && InCell.Z < Apron + InResolution;
+	}
+
+	/* Whether corner 0 of the cell is inside the chunk, only the edges leaving such corners are meshed by this chunk */
+	static FORCEINLINE bool IsOwnedCorner(const FVoxelActiveCell& InCell, int32 InResolution)
+	{
+		return InCell.X >= Apron && InCell.Y >= Apron && InCell.Z >= Apron && IsVertexCell(InCell, InResolution);
+	}
+
+	static FORCEINLINE int32 GetNumOwnedQuads(const FVoxelActiveCell& InCell, int32 InResolution)
+	{
+		if (!IsOwnedCorner(InCell, InResolution))
+		{
+			return 0;
+		}
+
+		const bool bInside = InCell.Case & 1;
+		return (bInside != bool(InCell.Case & (1 << CornerX)))
+			+ (bInside != bool(InCell.Case & (1 << CornerY)))
+			+ (bInside != bool(InCell.Case & (1 << CornerZ)));
+	}
+
+	/* Splits quad v0 v1 v2 v3, wound counter clockwise around its edge axis, into two triangles of material InMaterial */
+	static FORCEINLINE void AddQuad(FVoxelMeshBuilder& InBuilder, bool bInFlip, uint16 InMaterial, int32 InV0, int32 InV1, int32 InV2, int32 InV3)
+	{
+		checkSlow(InV0 >= 0 && InV1 >= 0 && InV2 >= 0 && InV3 >= 0);
+
+		if (bInFlip)
+		{
+			InBuilder.AddTriangle(InV0, InV2, InV1, InMaterial);
+			InBuilder.AddTriangle(InV0, InV3, InV2, InMaterial);
+		}
+		else
+		{
+			InBuilder.AddTriangle(InV0, InV1, InV2, InMaterial);
+			InBuilder.AddTriangle(InV0, InV2, InV3, InMaterial);
+		}
+	}
+};
@@ -0,0 +1,542 @@
+#include "VoxelTransitionCells.h"
+
+#include "VoxelUtilities/VoxelStatics.h"
+
+
+namespace VoxelTransitionCells
+{
+	// Points a transition cell can have: 12 fine edges of its 3x3 front face (6 along the face's first axis, then 6 along
+	// the second) followed by the 4 coarse edges of its back face
+	static constexpr int32 NumCellPoints = 16;
+
+	// Segments a transition cell can have: two per fine cube and two on the back face, one per side face
+	static constexpr int32 MaxCellSegments = 4 * 2 + 2 + 4;
+
+	/* Whether both corners of cube edge InEdge lie on cube face InFace */
+	bool IsEdgeOnFace(int32 InEdge, int32 InFace)
+	{
+		const int32 axis = InFace / 2;
+		const float side = InFace & 1;
+		return VoxelStatics::a2fVertexOffset[VoxelStatics::a2iEdgeConnection[InEdge][0]][axis] == side
+			&& VoxelStatics::a2fVertexOffset[VoxelStatics::a2iEdgeConnection[InEdge][1]][axis] == side;
+	}
+
+	/* Boundary edges of every marching cubes case sorted by the cube face they lie on, built once from the triangle table */
+	struct FFaceSegmentTable
+	{
+		uint8 NumSegments[256][6];
+		uint8 Segments[256][6][2][2];
+
+		FFaceSegmentTable()
+		{
+			FMemory::Memzero(NumSegments, sizeof(NumSegments));
+
+			for (int32 idxCase = 0; idxCase < 256; idxCase++)
+			{
+				const uint8* triangleEdges = VoxelStatics::a2iCubeTriangleEdges[idxCase];
+				const int32 numEdges = VoxelStatics::aiCubeTriangleCount[idxCase] * 3;
+
+				for (int32 i = 0; i < numEdges; i++)
+				{
+					const uint8 from = triangleEdges[i];
+					const uint8 to = triangleEdges[i % 3 == 2 ? i - 2 : i + 1];
+
+					// Edges shared by two triangles of the patch are walked once each way, the rest bound the patch
+					bool bShared = false;
+					for (int32 j = 0; j < numEdges && !bShared; j++)
+					{
+						bShared = triangleEdges[j] == to && triangleEdges[j % 3 == 2 ? j - 2 : j + 1] == from;
+					}
+
+					for (int32 face = 0; face < 6 && !bShared; face++)
+					{
+						if (IsEdgeOnFace(from, face) && IsEdgeOnFace(to, face))
+						{
+							uint8& num = NumSegments[idxCase][face];
+							check(num < 2);
+							Segments[idxCase][face][num][0] = from;
+							Segments[idxCase][face][num][1] = to;
+							num++;
+						}
+					}
+				}
+			}
+		}
+	};
+
+	/* One transition cell: crossing points by cell point id and the oriented contour segments joining them */
+	struct FCell
+	{
+		FVector3f Locations[NumCellPoints];
+		FVector3f Normals[NumCellPoints];
+		int8 Next[NumCellPoints];
+
+		// Every segment added, also the ones that did not fit in Next
+		int8 Segments[MaxCellSegments][2];
+		int32 NumSegments = 0;
+
+		FCell()
+		{
+			FMemory::Memset(Next, 0xff, sizeof(Next));
+		}
+
+		/* Adds segment InFrom -> InTo, returns false if a point would get two outgoing segments */
+		bool AddSegment(int32 InFrom, int32 InTo)
+		{
+			check(NumSegments < MaxCellSegments);
+			Segments[NumSegments][0] = InFrom;
+			Segments[NumSegments][1] = InTo;
+			NumSegments++;
+
+			if (Next[InFrom] >= 0)
+			{
+				return false;
+			}
+
+			Next[InFrom] = InTo;
+			return true;
+		}
+
+		/* Whether every point starts as many segments as it ends, at most one, so the segments form closed loops */
+		bool HasClosedLoops() const
+		{
+			int32 numIncoming[NumCellPoints] = { 0 };
+			for (int32 i = 0; i < NumSegments; i++)
+			{
+				numIncoming[Segments[i][1]]++;
+			}
+
+			for (int32 i = 0; i < NumCellPoints; i++)
+			{
+				if (numIncoming[i] != (Next[i] >= 0 ? 1 : 0))
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		bool HasIncoming(int32 InPoint) const
+		{
+			for (int32 i = 0; i < NumCellPoints; i++)
+			{
+				if (Next[i] == InPoint)
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+	};
+
+	/* Central difference gradient of InSample at a grid corner, InStep corners to either side */
+	FVector3f GetGradient(TFunctionRef<double(int32, int32, int32)> InSample, const FIntVector& InCorner, int32 InStep)
+	{
+		return FVector3f(
+			(float)(InSample(InCorner.X + InStep, InCorner.Y, InCorner.Z) - InSample(InCorner.X - InStep, InCorner.Y, InCorner.Z)),
+			(float)(InSample(InCorner.X, InCorner.Y + InStep, InCorner.Z) - InSample(InCorner.X, InCorner.Y - InStep, InCorner.Z)),
+			(float)(InSample(InCorner.X, InCorner.Y, InCorner.Z + InStep) - InSample(InCorner.X, InCorner.Y, InCorner.Z - InStep))
+		);
+	}
+
+	/* Corner InCorner of the cube starting at InCubeMin, cube edges InScale corners long */
+	FIntVector GetCubeCorner(const FIntVector& InCubeMin, uint8 InCorner, int32 InScale)
+	{
+		return InCubeMin + FIntVector(
+			(int32)VoxelStatics::a2fVertexOffset[InCorner][0],
+			(int32)VoxelStatics::a2fVertexOffset[InCorner][1],
+			(int32)VoxelStatics::a2fVertexOffset[InCorner][2]
+		) * InScale;
+	}
+}
+
+bool FVoxelTransitionCells::GenerateMesh(
+	const FVoxelMeshParams& InParams,
+	double InSampleIsovalue,
+	TFunctionRef<double(int32 InX, int32 InY, int32 InZ)> InSample,
+	TFunctionRef<double(int32 InX, int32 InY, int32 InZ)> InSampleCoarse,
+	TFunctionRef<uint8(int32 InX, int32 InY, int32 InZ)> InSampleMaterial,
+	FRealtimeMeshStreamSet& OutStreamSet
+)
+{
+	FVoxelTransitionMesh mesh;
+	BuildMesh(InParams, InSampleIsovalue, InSample, InSampleCoarse, InSampleMaterial, mesh);
+	return EmitMesh(InParams, mesh, OutStreamSet);
+}
+
+void FVoxelTransitionCells::BuildMesh(
+	const FVoxelMeshParams& InParams,
+	double InSampleIsovalue,
+	TFunctionRef<double(int32 InX, int32 InY, int32 InZ)> InSample,
+	TFunctionRef<double(int32 InX, int32 InY, int32 InZ)> InSampleCoarse,
+	TFunctionRef<uint8(int32 InX, int32 InY, int32 InZ)> InSampleMaterial,
+	FVoxelTransitionMesh& OutMesh
+)
+{
+	using namespace VoxelTransitionCells;
+
+	const int32 resolution = InParams.Resolution;
+	check(resolution % 2 == 0);
+
+	// Grid locations and normals of the cells' vertices and their triangles
+	TArray<FVector3f>& vertexLocations = OutMesh.Locations;
+	TArray<FVector3f>& vertexNormals = OutMesh.Normals;
+	TArray<int32>& triangles = OutMesh.Triangles;
+	TArray<uint16>& triangleMaterials = OutMesh.Materials;
+
+	for (int32 face = 0; face < 6; face++)
+	{
+		if (!(InParams.TransitionFaces & (1 << face)))
+		{
+			continue;
+		}
+
+		const int32 axis = face / 2;
+		const bool bPositive = face & 1;
+		const int32 axisB = (axis + 1) % 3;
+		const int32 axisC = (axis + 2) % 3;
+		const int32 facePlane = bPositive ? resolution : 0;
+
+		for (int32 i0 = 0; i0 < resolution; i0 += 2)
+		{
+			for (int32 j0 = 0; j0 < resolution; j0 += 2)
+			{
+				FCell cell;
+				bool bValid = true;
+
+				// Most inside fine sample on the chunk face, whose material the cell takes
+				FIntVector innerCorner = FIntVector::ZeroValue;
+				double innerDensity = TNumericLimits<double>::Max();
+
+				// Front face, the contours of the 2x2 fine cubes behind it, reversed since the transition cell sits on their other side
+				for (int32 idxCube = 0; idxCube < 4; idxCube++)
+				{
+					FIntVector cubeMin;
+					cubeMin[axis] = bPositive ? resolution - 1 : 0;
+					cubeMin[axisB] = i0 + (idxCube & 1);
+					cubeMin[axisC] = j0 + (idxCube >> 1);
+
+					double densityBuffer[8];
+					uint8 idxCase = 0;
+					for (int32 i = 0; i < 8; i++)
+					{
+						densityBuffer[i] = InSample(
+							cubeMin.X + (int32)VoxelStatics::a2fVertexOffset[i][0],
+							cubeMin.Y + (int32)VoxelStatics::a2fVertexOffset[i][1],
+							cubeMin.Z + (int32)VoxelStatics::a2fVertexOffset[i][2]
+						);
+						idxCase |= uint8(densityBuffer[i] < InSampleIsovalue) << i;
+
+						const FIntVector corner = GetCubeCorner(cubeMin, i, 1);
+						if (corner[axis] == facePlane && densityBuffer[i] < innerDensity)
+						{
+							innerCorner = corner;
+							innerDensity = densityBuffer[i];
+						}
+					}
+
+					uint8 segments[2][2];
+					const int32 numSegments = GetFaceSegments(idxCase, face, segments);
+					for (int32 idxSegment = 0; idxSegment < numSegments; idxSegment++)
+					{
+						int32 points[2];
+						for (int32 k = 0; k < 2; k++)
+						{
+							const uint8 edge = segments[idxSegment][k];
+							const uint8 idxCornerA = VoxelStatics::a2iEdgeConnection[edge][0];
+							const uint8 idxCornerB = VoxelStatics::a2iEdgeConnection[edge][1];
+
+							// Fine edges are keyed by where they start on the 3x3 face and which way they run
+							const int32 uA = cubeMin[axisB] + (int32)VoxelStatics::a2fVertexOffset[idxCornerA][axisB] - i0;
+							const int32 vA = cubeMin[axisC] + (int32)VoxelStatics::a2fVertexOffset[idxCornerA][axisC] - j0;
+							const int32 uB = cubeMin[axisB] + (int32)VoxelStatics::a2fVertexOffset[idxCornerB][axisB] - i0;
+							const int32 vB = cubeMin[axisC] + (int32)VoxelStatics::a2fVertexOffset[idxCornerB][axisC] - j0;
+							points[k] = uA != uB ? vA * 2 + FMath::Min(uA, uB) : 6 + uA * 2 + FMath::Min(vA, vB);
+
+							// Same interpolation as the marching cubes kernel, so the points land on the chunk's own vertices
+							const double c1 = densityBuffer[idxCornerA];
+							const double c2 = densityBuffer[idxCornerB];
+							const float edgeOffset = c1 == c2 ? 0.5f : (float)FMath::Clamp((InSampleIsovalue - c1) / (c2 - c1), 0.0, 1.0);
+
+							const FVector3f gridLocation = FVector3f(cubeMin) + FVector3f(
+								VoxelStatics::a2fVertexOffset[idxCornerA][0] + VoxelStatics::a2fEdgeDirection[edge][0] * edgeOffset,
+								VoxelStatics::a2fVertexOffset[idxCornerA][1] + VoxelStatics::a2fEdgeDirection[edge][1] * edgeOffset,
+								VoxelStatics::a2fVertexOffset[idxCornerA][2] + VoxelStatics::a2fEdgeDirection[edge][2] * edgeOffset
+							);
+							cell.Locations[points[k]] = InParams.GetTransitionLocation(gridLocation);
+
+							// Same gradient the chunk's own vertex on this edge gets
+							const FVector3f gradientA = GetGradient(InSample, GetCubeCorner(cubeMin, idxCornerA, 1), 1);
+							const FVector3f gradientB = GetGradient(InSample, GetCubeCorner(cubeMin, idxCornerB, 1), 1);
+							cell.Normals[points[k]] = (gradientA + (gradientB - gradientA) * edgeOffset).GetSafeNormal();
+						}
+
+						bValid &= cell.AddSegment(points[1], points[0]);
+					}
+				}
+
+				// Back face, the contour of the coarse neighbour's cube on the other side of the chunk face, also reversed
+				{
+					FIntVector cubeMin;
+					cubeMin[axis] = bPositive ? resolution : -2;
+					cubeMin[axisB] = i0;
+					cubeMin[axisC] = j0;
+
+					double densityBuffer[8];
+					uint8 idxCase = 0;
+					for (int32 i = 0; i < 8; i++)
+					{
+						densityBuffer[i] = InSampleCoarse(
+							cubeMin.X + (int32)VoxelStatics::a2fVertexOffset[i][0] * 2,
+							cubeMin.Y + (int32)VoxelStatics::a2fVertexOffset[i][1] * 2,
+							cubeMin.Z + (int32)VoxelStatics::a2fVertexOffset[i][2] * 2
+						);
+						idxCase |= uint8(densityBuffer[i] < InSampleIsovalue) << i;
+					}
+
+					uint8 segments[2][2];
+					const int32 numSegments = GetFaceSegments(idxCase, face ^ 1, segments);
+					for (int32 idxSegment = 0; idxSegment < numSegments; idxSegment++)
+					{
+						int32 points[2];
+						for (int32 k = 0; k < 2; k++)
+						{
+							const uint8 edge = segments[idxSegment][k];
+							const uint8 idxCornerA = VoxelStatics::a2iEdgeConnection[edge][0];
+							const uint8 idxCornerB = VoxelStatics::a2iEdgeConnection[edge][1];
+
+							// Coarse edges are keyed by the side of the back face they run along
+							const bool bAlongB = VoxelStatics::a2fVertexOffset[idxCornerA][axisB] != VoxelStatics::a2fVertexOffset[idxCornerB][axisB];
+							points[k] = bAlongB
+								? 12 + (int32)VoxelStatics::a2fVertexOffset[idxCornerA][axisC]
+								: 14 + (int32)VoxelStatics::a2fVertexOffset[idxCornerA][axisB];
+
+							const double c1 = densityBuffer[idxCornerA];
+							const double c2 = densityBuffer[idxCornerB];
+							const float edgeOffset = c1 == c2 ? 0.5f : (float)FMath::Clamp((InSampleIsovalue - c1) / (c2 - c1), 0.0, 1.0);
+
+							// Back points are the coarse chunk's, they stay on the chunk face
+							cell.Locations[points[k]] = FVector3f(cubeMin) + FVector3f(
+								VoxelStatics::a2fVertexOffset[idxCornerA][0] + VoxelStatics::a2fEdgeDirection[edge][0] * edgeOffset,
+								VoxelStatics::a2fVertexOffset[idxCornerA][1] + VoxelStatics::a2fEdgeDirection[edge][1] * edgeOffset,
+								VoxelStatics::a2fVertexOffset[idxCornerA][2] + VoxelStatics::a2fEdgeDirection[edge][2] * edgeOffset
+							) * 2;
+
+							// The coarse neighbour takes its central differences over its own voxels
+							const FVector3f gradientA = GetGradient(InSampleCoarse, GetCubeCorner(cubeMin, idxCornerA, 2), 2);
+							const FVector3f gradientB = GetGradient(InSampleCoarse, GetCubeCorner(cubeMin, idxCornerB, 2), 2);
+							cell.Normals[points[k]] = (gradientA + (gradientB - gradientA) * edgeOffset).GetSafeNormal();
+						}
+
+						bValid &= cell.AddSegment(points[1], points[0]);
+					}
+				}
+
+				// Side faces, three fine samples along the front edge and the two coarse corners behind them, never ambiguous
+				static constexpr int32 sideSamples[4][3][2] =
+				{
+					{ { 0, 0 }, { 1, 0 }, { 2, 0 } },
+					{ { 0, 2 }, { 1, 2 }, { 2, 2 } },
+					{ { 0, 0 }, { 0, 1 }, { 0, 2 } },
+					{ { 2, 0 }, { 2, 1 }, { 2, 2 } }
+				};
+				static constexpr int32 sidePoints[4][3] = { { 0, 1, 12 }, { 4, 5, 13 }, { 6, 7, 14 }, { 10, 11, 15 } };
+
+				for (int32 side = 0; side < 4; side++)
+				{
+					bool bInside[3];
+					for (int32 k = 0; k < 3; k++)
+					{
+						FIntVector corner;
+						corner[axis] = facePlane;
+						corner[axisB] = i0 + sideSamples[side][k][0];
+						corner[axisC] = j0 + sideSamples[side][k][1];
+						bInside[k] = InSample(corner.X, corner.Y, corner.Z) < InSampleIsovalue;
+					}
+
+					int32 from;
+					int32 to;
+					if (bInside[0] != bInside[2])
+					{
+						// One fine half edge crosses, joined to the crossing on the coarse edge
+						from = sidePoints[side][bInside[0] != bInside[1] ? 0 : 1];
+						to = sidePoints[side][2];
+					}
+					else if (bInside[0] != bInside[1])
+					{
+						// Both fine half edges cross, the coarse edge does not
+						from = sidePoints[side][0];
+						to = sidePoints[side][1];
+					}
+					else
+					{
+						continue;
+					}
+
+					// Each point already has one segment from a front or back face, the side segment runs the other way
+					if (cell.Next[from] >= 0)
+					{
+						Swap(from, to);
+					}
+
+					const bool bFree = !cell.HasIncoming(to);
+					bValid &= cell.AddSegment(from, to) && bFree;
+				}
+
+				// The cell's points are shared by the triangles around them. They are not shared with the chunk's own vertices
+				// on the same edges, those are emitted again here, so the seam is only closed once positions are compared
+				int32 cellVertices[NumCellPoints];
+				FMemory::Memset(cellVertices, 0xff, sizeof(cellVertices));
+
+				const auto getCellVertex = [&](int32 InPoint)
+				{
+					if (cellVertices[InPoint] == INDEX_NONE)
+					{
+						cellVertices[InPoint] = vertexLocations.Add(cell.Locations[InPoint]);
+						vertexNormals.Add(cell.Normals[InPoint]);
+					}
+
+					return cellVertices[InPoint];
+				};
+
+				bValid &= cell.HasClosedLoops();
+				if (!bValid)
+				{
+					// The contours do not join into loops, which ambiguous fine and coarse cases can cause. Fanning every
+					// segment to the middle of the cell's points still meets the cubes around it along each segment, only
+					// the inside of the cell is approximate, where skipping it would leave a hole in the seam
+					FVector3f centroid(0);
+					FVector3f centroidNormal(0);
+					bool bUsed[NumCellPoints] = { false };
+					int32 numUsed = 0;
+					for (int32 i = 0; i < cell.NumSegments; i++)
+					{
+						for (const int32 point : { cell.Segments[i][0], cell.Segments[i][1] })
+						{
+							if (!bUsed[point])
+							{
+								bUsed[point] = true;
+								centroid += cell.Locations[point];
+								centroidNormal += cell.Normals[point];
+								numUsed++;
+							}
+						}
+					}
+
+					if (numUsed > 0)
+					{
+						const int32 centroidVertex = vertexLocations.Add(centroid / (float)numUsed);
+						vertexNormals.Add(centroidNormal.GetSafeNormal());
+
+						for (int32 i = 0; i < cell.NumSegments; i++)
+						{
+							triangles.Add(centroidVertex);
+							triangles.Add(getCellVertex(cell.Segments[i][0]));
+							triangles.Add(getCellVertex(cell.Segments[i][1]));
+						}
+					}
+				}
+				else
+				{
+					// Walk the closed loops and fan each one into triangles
+					bool bVisited[NumCellPoints] = { false };
+					for (int32 start = 0; start < NumCellPoints; start++)
+					{
+						if (bVisited[start] || cell.Next[start] < 0)
+						{
+							continue;
+						}
+
+						int32 loop[NumCellPoints];
+						int32 numLoop = 0;
+						int32 point = start;
+						while (point >= 0 && !bVisited[point])
+						{
+							bVisited[point] = true;
+							loop[numLoop++] = point;
+							point = cell.Next[point];
+						}
+
+						if (point != start || numLoop < 3)
+						{
+							continue;
+						}
+
+						if (numLoop == 3)
+						{
+							triangles.Add(getCellVertex(loop[0]));
+							triangles.Add(getCellVertex(loop[1]));
+							triangles.Add(getCellVertex(loop[2]));
+							continue;
+						}
+
+						FVector3f centroid(0);
+						FVector3f centroidNormal(0);
+						for (int32 i = 0; i < numLoop; i++)
+						{
+							centroid += cell.Locations[loop[i]];
+							centroidNormal += cell.Normals[loop[i]];
+						}
+
+						const int32 centroidVertex = vertexLocations.Add(centroid / (float)numLoop);
+						vertexNormals.Add(centroidNormal.GetSafeNormal());
+
+						for (int32 i = 0; i < numLoop; i++)
+						{
+							triangles.Add(centroidVertex);
+							triangles.Add(getCellVertex(loop[i]));
+							triangles.Add(getCellVertex(loop[(i + 1) % numLoop]));
+						}
+					}
+				}
+
+				const uint16 material = InSampleMaterial(innerCorner.X, innerCorner.Y, innerCorner.Z);
+				while (triangleMaterials.Num() < triangles.Num() / 3)
+				{
+					triangleMaterials.Add(material);
+				}
+			}
+		}
+	}
+}
+
+bool FVoxelTransitionCells::EmitMesh(const FVoxelMeshParams& InParams, const FVoxelTransitionMesh& InMesh, FRealtimeMeshStreamSet& OutStreamSet)
+{
+	if (InMesh.NumTriangles() == 0)
+	{
+		return false;
+	}
+
+	FVoxelMeshBuilder builder(OutStreamSet);
+	EnableVoxelMeshStreams(InParams, builder);
+
+	// A no-op when the mesher already reserved room for the transition cells
+	const int32 firstVertex = builder.NumVertices();
+	builder.ReserveNumVertices(firstVertex + InMesh.NumVertices());
+	builder.ReserveNumTriangles(builder.NumTriangles() + InMesh.NumTriangles());
+
+	const float voxelSize = InParams.VoxelSize;
+	for (int32 i = 0; i < InMesh.NumVertices(); i++)
+	{
+		AddVoxelMeshVertex(InParams, builder, InParams.ChunkOrigin + InMesh.Locations[i] * voxelSize, [&]() { return InMesh.Normals[i]; });
+	}
+
+	const TArray<int32>& triangles = InMesh.Triangles;
+	for (int32 i = 0; i < triangles.Num(); i += 3)
+	{
+		builder.AddTriangle(firstVertex + triangles[i], firstVertex + triangles[i + 1], firstVertex + triangles[i + 2], InMesh.Materials[i / 3]);
+	}
+
+	return true;
+}
+
+int32 FVoxelTransitionCells::GetFaceSegments(uint8 InCase, int32 InFace, uint8 OutSegments[2][2])
+{
+	static const VoxelTransitionCells::FFaceSegmentTable table;
+
+	const int32 numSegments = table.NumSegments[InCase][InFace];
+	FMemory::Memcpy(OutSegments, table.Segments[InCase][InFace], numSegments * 2);
+	return numSegments;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMesher/VoxelMesherTypes.h"
+
+/* Transition cell geometry of a chunk in grid space, built before it is added to the streams so their size is known up front */
+struct FVoxelTransitionMesh
+{
+	TArray<FVector3f> Locations;
+	TArray<FVector3f> Normals;
+
+	// Three vertex indices per triangle
+	TArray<int32> Triangles;
+	TArray<uint16> Materials;
+
+	int32 NumVertices() const { return Locations.Num(); }
+	int32 NumTriangles() const { return Triangles.Num() / 3; }
+};
+
+/*
+ * Transvoxel style transition cells closing the seam between a marching cubes chunk and a neighbour of half its resolution.
+ * Along a transition face every 2x2 block of fine cells gets a transition cell: its front face is the 3x3 fine samples the
+ * chunk meshes the face with, its back face the 2x2 corners the coarse neighbour sees. The cell is flat in sample space,
+ * narrowing the chunk's last cell layer (FVoxelMeshParams::GetTransitionLocation) gives it its thickness.
+ * Rather than Lengyel's 512 case tables, the cell's surface is built from its boundary: the face contours of the fine and
+ * coarse marching cubes cases on either side, plus the unambiguous contours of its four side faces, always form closed
+ * loops, which are fanned into triangles. Sharing the contours of the cubes around it keeps the seam watertight.
+ * A cell whose contours do not close into loops fans every segment to its middle instead, so it is never left out.
+ * Limits: only 2:1 seams are closed, a neighbour more than one depth coarser still leaves a crack, and the points on the
+ * chunk face are new vertices rather than the chunk's own, so the seam is closed in position but not in topology.
+ */
+struct VOXEL_API FVoxelTransitionCells
+{
+	/* Bit of FVoxelMeshParams::TransitionFaces for axis InAxis (0 x, 1 y, 2 z) on its positive or negative side */
+	static constexpr uint8 GetFaceBit(int32 InAxis, bool bInPositive) { return 1 << (InAxis * 2 + (bInPositive ? 1 : 0)); }
+
+	/*
+	 * Builds the transition cells of every face in InParams.TransitionFaces into OutMesh.
+	 * InSample returns the chunk's own sample at a corner of its grid, InSampleCoarse the sample the coarse neighbour stores at
+	 * a corner of the same grid (always even). Normals take central differences like the meshers do, so InSample is also read
+	 * one corner past the chunk and InSampleCoarse up to four past the face. Both are in the units the meshers compared
+	 * against InSampleIsovalue, so quantized neighbours agree with what they meshed. InSampleMaterial returns the material
+	 * id at a corner on the chunk face, a cell takes the one of its most inside fine sample.
+	 */
+	static void BuildMesh(
+		const FVoxelMeshParams& InParams,
+		double InSampleIsovalue,
+		TFunctionRef<double(int32 InX, int32 InY, int32 InZ)> InSample,
+		TFunctionRef<double(int32 InX, int32 InY, int32 InZ)> InSampleCoarse,
+		TFunctionRef<uint8(int32 InX, int32 InY, int32 InZ)> InSampleMaterial,
+		FVoxelTransitionMesh& OutMesh
+	);
+
+	/*
+	 * Adds InMesh to the streamset after whatever the mesher put there, returns true if it has any triangles.
+	 * Set FVoxelMeshParams::NumExtraVertices and NumExtraTriangles from InMesh before meshing and the streams only grow once.
+	 */
+	static bool EmitMesh(const FVoxelMeshParams& InParams, const FVoxelTransitionMesh& InMesh, FRealtimeMeshStreamSet& OutStreamSet);
+
+	/* BuildMesh and EmitMesh in one go, returns true if any triangles were generated */
+	static bool GenerateMesh(
+		const FVoxelMeshParams& InParams,
+		double InSampleIsovalue,
+		TFunctionRef<double(int32 InX, int32 InY, int32 InZ)> InSample,
+		TFunctionRef<double(int32 InX, int32 InY, int32 InZ)> InSampleCoarse,
+		TFunctionRef<uint8(int32 InX, int32 InY, int32 InZ)> InSampleMaterial,
+		FRealtimeMeshStreamSet& OutStreamSet
+	);
+
+private:
+	/* Contour segments marching cubes case InCase leaves on cube face InFace (2 * axis + positive side), as edge pairs in triangle winding order */
+	static int32 GetFaceSegments(uint8 InCase, int32 InFace, uint8 OutSegments[2][2]);
+};
@@ -0,0 +1,101 @@
+#include "VoxelDensityQuery.h"
+
+
+FVector FVoxelDensityQuery::GetNormal(const FVector& InLocation) const
+{
+	const FVector gradient(
+		SampleDensity(InLocation + FVector(MinStep, 0, 0)) - SampleDensity(InLocation - FVector(MinStep, 0, 0)),
+		SampleDensity(InLocation + FVector(0, MinStep, 0)) - SampleDensity(InLocation - FVector(0, MinStep, 0)),
+		SampleDensity(InLocation + FVector(0, 0, MinStep)) - SampleDensity(InLocation - FVector(0, 0, MinStep))
+	);
+
+	return gradient.GetSafeNormal();
+}
+
+bool FVoxelDensityQuery::Raycast(const FVector& InStart, const FVector& InEnd, FVoxelRaycastHit& OutHit) const
+{
+	const FVector ray = InEnd - InStart;
+	const double length = ray.Length();
+	const FVector direction = length > 0 ? ray / length : FVector::ZeroVector;
+
+	OutHit.bIncomplete = false;
+
+	double distance = GetDistance(InStart);
+	if (distance < 0)
+	{
+		OutHit.Location = InStart;
+		OutHit.Normal = GetNormal(InStart);
+		OutHit.Distance = 0;
+		return true;
+	}
+
+	// Every step covers MinStep at least, so grazing the surface the whole way still reaches the end
+	const int32 maxSteps = (int32)FMath::Min(FMath::CeilToDouble(length / MinStep) + 1.0, (double)MaxRaySteps);
+
+	double t = 0;
+	for (int32 i = 0; i < maxSteps && t < length; i++)
+	{
+		const double next = FMath::Min(t + FMath::Max(distance * StepScale, MinStep), length);
+		const double nextDistance = GetDistance(InStart + direction * next);
+		if (nextDistance < 0)
+		{
+			// The surface is somewhere in the last step, outside at t and inside at next
+			double outside = t;
+			double inside = next;
+			for (int32 j = 0; j < BisectionSteps; j++)
+			{
+				const double middle = (outside + inside) * 0.5;
+				if (GetDistance(InStart + direction * middle) < 0)
+				{
+					inside = middle;
+				}
+				else
+				{
+					outside = middle;
+				}
+			}
+
+			OutHit.Location = InStart + direction * inside;
+			OutHit.Normal = GetNormal(OutHit.Location);
+			OutHit.Distance = inside;
+			return true;
+		}
+
+		t = next;
+		distance = nextDistance;
+	}
+
+	OutHit.Distance = t;
+	OutHit.bIncomplete = t < length;
+	return false;
+}
+
+bool FVoxelDensityQuery::SphereOverlap(const FVector& InCenter, double InRadius) const
+{
+	// Nothing is closer to the center than the surface is
+	double distance = GetDistance(InCenter);
+	if (distance > InRadius)
+	{
+		return false;
+	}
+
+	// The estimate may be short, walk down to the surface to make sure it is inside the sphere
+	FVector location = InCenter;
+	for (int32 i = 0; i < MaxSteps; i++)
+	{
+		if (distance < 0)
+		{
+			return true;
+		}
+
+		location -= GetNormal(location) * FMath::Max(distance * StepScale, MinStep);
+		if (FVector::DistSquared(location, InCenter) > InRadius * InRadius)
+		{
+			return false;
+		}
+
+		distance = GetDistance(location);
+	}
+
+	return false;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "VoxelDensityQuery.generated.h"
+
+/* Where a ray first crosses the isosurface */
+USTRUCT(BlueprintType)
+struct FVoxelRaycastHit
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Voxel|Query")
+	FVector Location = FVector::ZeroVector;
+
+	// Pointing out of the solid
+	UPROPERTY(BlueprintReadOnly, Category = "Voxel|Query")
+	FVector Normal = FVector::ZeroVector;
+
+	// Along the ray from its start, 0 if it started inside. On an incomplete miss, how far the ray was traced
+	UPROPERTY(BlueprintReadOnly, Category = "Voxel|Query")
+	double Distance = 0;
+
+	// Set on a miss if the ray ran out of steps before its end, the rest of it was not traced and may cross the surface
+	UPROPERTY(BlueprintReadOnly, Category = "Voxel|Query")
+	bool bIncomplete = false;
+};
+
+/*
+ * Ray and overlap queries run straight on a density field, which is below the isovalue inside and changes by about
+ * DensityPerUnit per unit of distance near the surface, so no mesh or cooked collision is needed.
+ * Rays are sphere traced: each step advances by the distance to the surface the density gives, and at least MinStep, and the
+ * step that crosses the surface is narrowed down by bisection. Features thinner than MinStep can be stepped over, the finest
+ * voxel size loses nothing the finest chunks would mesh.
+ * Queries only read the field, they are as thread safe as InSampleDensity is.
+ */
+struct VOXEL_API FVoxelDensityQuery
+{
+	/* Density at InLocation */
+	using FSampleDensity = TFunctionRef<double(const FVector& InLocation)>;
+
+	// Steps an overlap takes before giving up
+	static constexpr int32 MaxSteps = 1024;
+
+	// Steps a ray takes at most. Rays get enough to cross their whole length at MinStep per step up to this, longer ones give up
+	static constexpr int32 MaxRaySteps = 1 << 20;
+
+	// Halvings of the step that crossed the surface, a hit is within MinStep / 2^BisectionSteps of it
+	static constexpr int32 BisectionSteps = 12;
+
+	// Fraction of the estimated distance a step covers, blended strokes and interpolated samples can overestimate it slightly
+	static constexpr double StepScale = 0.8;
+
+	FVoxelDensityQuery(FSampleDensity InSampleDensity, double InIsovalue, double InDensityPerUnit, double InMinStep) :
+		SampleDensity(InSampleDensity),
+		Isovalue(InIsovalue),
+		DensityPerUnit(InDensityPerUnit),
+		MinStep(InMinStep) {};
+
+	/* Signed distance from InLocation to the surface the density gives, negative inside */
+	double GetDistance(const FVector& InLocation) const
+	{
+		return (SampleDensity(InLocation) - Isovalue) / DensityPerUnit;
+	}
+
+	bool IsSolid(const FVector& InLocation) const
+	{
+		return SampleDensity(InLocation) < Isovalue;
+	}
+
+	/* Direction the density rises fastest at InLocation, central differences MinStep apart */
+	FVector GetNormal(const FVector& InLocation) const;
+
+	/*
+	 * First crossing into the solid from InStart to InEnd, returns false if the segment stays outside or, with OutHit.bIncomplete
+	 * set, is too long to trace in MaxRaySteps.
+	 */
+	bool Raycast(const FVector& InStart, const FVector& InEnd, FVoxelRaycastHit& OutHit) const;
+
+	/* Whether any solid lies within InRadius of InCenter, found by following the normal down from the center to the surface */
+	bool SphereOverlap(const FVector& InCenter, double InRadius) const;
+
+private:
+	FSampleDensity SampleDensity;
+	double Isovalue;
+	double DensityPerUnit;
+	double MinStep;
+};
@@ -1,3 +0,0 @@
-
-
-#include "Array3D.h"
\ No newline at end of file
@@ -1,16 +1,259 @@
-
-
 #pragma once
 
 #include "CoreMinimal.h"
+#include <type_traits>
+
 
+/*
+ * Layout policies map a 3D index to a storage index for FArray3D.
+ * Each keeps the logical size, may pad storage (GetStorageNum() >= X * Y * Z) and
+ * visits every logical element in storage order through ForEachIndex(Func(X, Y, Z, Index)).
+ */
+
+/* X major linear layout, z fastest, every x plane is one contiguous span */
+struct FArray3DLinearLayout
+{
+	static constexpr bool bContiguousXSlices = true;
+
+	FIntVector Size3D = FIntVector(0);
+
+	void Init(const FIntVector& InSize3D)
+	{
+		Size3D = InSize3D;
+	}
+
+	FORCEINLINE int32 GetStorageNum() const { return Size3D.X * Size3D.Y * Size3D.Z; }
+
+	FORCEINLINE int32 GetIndex1D(int32 InX, int32 InY, int32 InZ) const
+	{
+		return (InX * Size3D.Y + InY) * Size3D.Z + InZ;
+	}
+
+	FIntVector GetIndex3D(int32 InIndex) const
+	{
+		const int32 yz = Size3D.Y * Size3D.Z;
+		const int32 w = InIndex % yz;
+		return FIntVector(InIndex / yz, w / Size3D.Z, w % Size3D.Z);
+	}
+
+	template<typename FuncType>
+	FORCEINLINE void ForEachIndex(FuncType&& InFunc) const
+	{
+		int32 index = 0;
+		for (int32 x = 0; x < Size3D.X; x++)
+		{
+			for (int32 y = 0; y < Size3D.Y; y++)
+			{
+				for (int32 z = 0; z < Size3D.Z; z++)
+				{
+					InFunc(x, y, z, index++);
+				}
+			}
+		}
+	}
+};
+
+/*
+ * Bricks of InBrickSize^3 elements stored one after another in x major brick order, x major inside each brick.
+ * Neighbours along every axis share a brick most of the time, storage is padded to whole bricks.
+ */
+template<int32 InBrickSize>
+struct TArray3DBrickedLayout
+{
+	static_assert(InBrickSize > 1 && (InBrickSize & (InBrickSize - 1)) == 0, "Brick size must be a power of two");
+
+	static constexpr bool bContiguousXSlices = false;
+	static constexpr int32 BrickSize = InBrickSize;
+	static constexpr int32 BrickShift = InBrickSize == 2 ? 1 : InBrickSize == 4 ? 2 : InBrickSize == 8 ? 3 : InBrickSize == 16 ? 4 : 5;
+	static constexpr int32 BrickMask = InBrickSize - 1;
+	static constexpr int32 BrickNum = InBrickSize * InBrickSize * InBrickSize;
+
+	static_assert((1 << BrickShift) == InBrickSize, "Unsupported brick size");
+
+	FIntVector Size3D = FIntVector(0);
+	FIntVector NumBricks = FIntVector(0);
+
+	void Init(const FIntVector& InSize3D)
+	{
+		Size3D = InSize3D;
+		NumBricks = FIntVector(
+			(InSize3D.X + BrickMask) >> BrickShift,
+			(InSize3D.Y + BrickMask) >> BrickShift,
+			(InSize3D.Z + BrickMask) >> BrickShift
+		);
+	}
+
+	FORCEINLINE int32 GetStorageNum() const { return NumBricks.X * NumBricks.Y * NumBricks.Z * BrickNum; }
+
+	FORCEINLINE int32 GetBrickIndex(int32 InBrickX, int32 InBrickY, int32 InBrickZ) const
+	{
+		return (InBrickX * NumBricks.Y + InBrickY) * NumBricks.Z + InBrickZ;
+	}
 
-template<typename InElementType>
+	FORCEINLINE int32 GetIndex1D(int32 InX, int32 InY, int32 InZ) const
+	{
+		const int32 brick = GetBrickIndex(InX >> BrickShift, InY >> BrickShift, InZ >> BrickShift);
+		const int32 local = (((InX & BrickMask) << BrickShift | (InY & BrickMask)) << BrickShift) | (InZ & BrickMask);
+		return (brick << (BrickShift * 3)) | local;
+	}
+
+	FIntVector GetIndex3D(int32 InIndex) const
+	{
+		const int32 brick = InIndex >> (BrickShift * 3);
+		const int32 brickYZ = NumBricks.Y * NumBricks.Z;
+		const int32 w = brick % brickYZ;
+		return FIntVector(
+			(brick / brickYZ) << BrickShift | (InIndex >> (BrickShift * 2) & BrickMask),
+			(w / NumBricks.Z) << BrickShift | (InIndex >> BrickShift & BrickMask),
+			(w % NumBricks.Z) << BrickShift | (InIndex & BrickMask)
+		);
+	}
+
+	template<typename FuncType>
+	FORCEINLINE void ForEachIndex(FuncType&& InFunc) const
+	{
+		int32 index = 0;
+		for (int32 bx = 0; bx < Size3D.X; bx += BrickSize)
+		{
+			for (int32 by = 0; by < Size3D.Y; by += BrickSize)
+			{
+				for (int32 bz = 0; bz < Size3D.Z; bz += BrickSize)
+				{
+					for (int32 x = bx; x < bx + BrickSize; x++)
+					{
+						for (int32 y = by; y < by + BrickSize; y++)
+						{
+							for (int32 z = bz; z < bz + BrickSize; z++, index++)
+							{
+								// Padding of partial bricks along the far faces is skipped
+								if (x < Size3D.X && y < Size3D.Y && z < Size3D.Z)
+								{
+									InFunc(x, y, z, index);
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+};
+
+using FArray3DBrick4Layout = TArray3DBrickedLayout<4>;
+using FArray3DBrick8Layout = TArray3DBrickedLayout<8>;
+
+/*
+ * Z order curve, the bits of x, y and z interleaved (x highest). Any aligned power of two cube is contiguous.
+ * Storage is padded to a power of two cube, so it suits grids that already are one (not Resolution + 1 corner grids).
+ */
+struct FArray3DMortonLayout
+{
+	static constexpr bool bContiguousXSlices = false;
+
+	FIntVector Size3D = FIntVector(0);
+	int32 PaddedSize = 0;
+
+	void Init(const FIntVector& InSize3D)
+	{
+		Size3D = InSize3D;
+		PaddedSize = FMath::RoundUpToPowerOfTwo(FMath::Max3(InSize3D.X, InSize3D.Y, FMath::Max(InSize3D.Z, 1)));
+		check(PaddedSize <= 1024);
+	}
+
+	FORCEINLINE int32 GetStorageNum() const { return PaddedSize * PaddedSize * PaddedSize; }
+
+	FORCEINLINE int32 GetIndex1D(int32 InX, int32 InY, int32 InZ) const
+	{
+		return (SpreadBits(InX) << 2) | (SpreadBits(InY) << 1) | SpreadBits(InZ);
+	}
+
+	FIntVector GetIndex3D(int32 InIndex) const
+	{
+		return FIntVector(CompactBits(InIndex >> 2), CompactBits(InIndex >> 1), CompactBits(InIndex));
+	}
+
+	template<typename FuncType>
+	FORCEINLINE void ForEachIndex(FuncType&& InFunc) const
+	{
+		const int32 storageNum = GetStorageNum();
+		for (int32 index = 0; index < storageNum; index++)
+		{
+			const FIntVector index3D = GetIndex3D(index);
+			if (index3D.X < Size3D.X && index3D.Y < Size3D.Y && index3D.Z < Size3D.Z)
+			{
+				InFunc(index3D.X, index3D.Y, index3D.Z, index);
+			}
+		}
+	}
+
+	/* Inserts two zero bits between each of the low 10 bits of InValue */
+	static FORCEINLINE uint32 SpreadBits(uint32 InValue)
+	{
+		InValue &= 0x000003ff;
+		InValue = (InValue ^ (InValue << 16)) & 0xff0000ff;
+		InValue = (InValue ^ (InValue << 8)) & 0x0300f00f;
+		InValue = (InValue ^ (InValue << 4)) & 0x030c30c3;
+		InValue = (InValue ^ (InValue << 2)) & 0x09249249;
+		return InValue;
+	}
+
+	/* Inverse of SpreadBits, gathers every third bit of InValue */
+	static FORCEINLINE uint32 CompactBits(uint32 InValue)
+	{
+		InValue &= 0x09249249;
+		InValue = (InValue ^ (InValue >> 2)) & 0x030c30c3;
+		InValue = (InValue ^ (InValue >> 4)) & 0x0300f00f;
+		InValue = (InValue ^ (InValue >> 8)) & 0xff0000ff;
+		InValue = (InValue ^ (InValue >> 16)) & 0x000003ff;
+		return InValue;
+	}
+};
+
+/* Raw, unchecked (checkSlow only) access to the storage of an FArray3D, for hot loops */
+template<typename InElementType, typename InLayoutType>
+struct TArray3DView
+{
+	InElementType* Data = nullptr;
+	InLayoutType Layout;
+
+	TArray3DView() {};
+
+	TArray3DView(InElementType* InData, const InLayoutType& InLayout) :
+		Data(InData),
+		Layout(InLayout) {};
+
+	FORCEINLINE InElementType& operator[](int32 Index) const
+	{
+		checkSlow(Index >= 0 && Index < Layout.GetStorageNum());
+		return Data[Index];
+	}
+
+	FORCEINLINE InElementType& operator()(int32 InX, int32 InY, int32 InZ) const
+	{
+		checkSlow(InX >= 0 && InY >= 0 && InZ >= 0 && InX < Layout.Size3D.X && InY < Layout.Size3D.Y && InZ < Layout.Size3D.Z);
+		return Data[Layout.GetIndex1D(InX, InY, InZ)];
+	}
+
+	FORCEINLINE InElementType& operator[](const FIntVector& Index3D) const
+	{
+		return (*this)(Index3D.X, Index3D.Y, Index3D.Z);
+	}
+};
+
+
+template<typename InElementType, typename InLayoutType = FArray3DLinearLayout>
 struct FArray3D
 {
+	using ElementType = InElementType;
+	using LayoutType = InLayoutType;
+	using ViewType = TArray3DView<InElementType, InLayoutType>;
+	using ConstViewType = TArray3DView<const InElementType, InLayoutType>;
+
+	// Storage in layout order, may be larger than SizeTotal for padded layouts
 	TArray<InElementType> InternalArray;
 	FIntVector Size3D;
 	int32 SizeTotal;
+	InLayoutType Layout;
 
 	FArray3D() {};
 
@@ -21,21 +264,79 @@ struct FArray3D
 
 	void Init(int32 InSizeX, int32 InSizeY, int32 InSizeZ, const InElementType& InitValue = InElementType())
 	{
-		Size3D = FIntVector(InSizeX, InSizeY, InSizeZ);
-		SizeTotal = Size3D.X * Size3D.Y * Size3D.Z;
-		InternalArray.Init(InitValue, SizeTotal);
+		Init(FIntVector(InSizeX, InSizeY, InSizeZ), InitValue);
 	}
 
 	void Init(const FIntVector& InSize3D, const InElementType& InitValue = InElementType())
 	{
+		if constexpr (std::is_trivially_copyable_v<InElementType>)
+		{
+			Init(InSize3D, NoInit);
+			Fill(InitValue);
+		}
+		else
+		{
+			// Other elements have to be constructed, not assigned over uninitialized memory
+			Size3D = InSize3D;
+			SizeTotal = Size3D.X * Size3D.Y * Size3D.Z;
+			Layout.Init(InSize3D);
+			InternalArray.Init(InitValue, Layout.GetStorageNum());
+		}
+	}
+
+	/* Sizes the array without writing the elements, for callers that overwrite all of them anyway */
+	void Init(const FIntVector& InSize3D, ENoInit)
+	{
+		static_assert(std::is_trivially_copyable_v<InElementType>, "Uninitialized FArray3D storage needs a trivially copyable element type");
+
 		Size3D = InSize3D;
 		SizeTotal = Size3D.X * Size3D.Y * Size3D.Z;
-		InternalArray.Init(InitValue, SizeTotal);
+		Layout.Init(InSize3D);
+		InternalArray.SetNumUninitialized(Layout.GetStorageNum());
 	}
 
 	void Reset(const InElementType& InitValue = InElementType())
 	{
-		InternalArray.Init(InitValue, SizeTotal);
+		Fill(InitValue);
+	}
+
+	/*
+	 * Writes InValue to every element, padding included. The elements must already be initialized, which Init does.
+	 * Trivially copyable elements are filled in bulk: a memset when the value is all zero bytes, otherwise one
+	 * element is written and the filled prefix is doubled with memcpy, both run as wide vector stores. Other elements
+	 * are assigned one by one.
+	 */
+	void Fill(const InElementType& InValue)
+	{
+		InElementType* data = InternalArray.GetData();
+		const int32 num = InternalArray.Num();
+		if (num == 0)
+		{
+			return;
+		}
+
+		if constexpr (std::is_trivially_copyable_v<InElementType>)
+		{
+			uint8 zeroBytes[sizeof(InElementType)] = { 0 };
+			if (FMemory::Memcmp(&InValue, zeroBytes, sizeof(InElementType)) == 0)
+			{
+				FMemory::Memzero(data, num * sizeof(InElementType));
+				return;
+			}
+
+			data[0] = InValue;
+			for (int32 filled = 1; filled < num; filled *= 2)
+			{
+				FMemory::Memcpy(data + filled, data, FMath::Min(filled, num - filled) * sizeof(InElementType));
+			}
+		}
+		else
+		{
+			for (int32 i = 0; i < num; i++)
+			{
+				data[i] = InValue;
+			}
+		}
 	}
 
 	FArray3D(int32 InSizeX, int32 InSizeY, int32 InSizeZ, const InElementType& InitValue = InElementType())
@@ -48,6 +349,11 @@ struct FArray3D
 		Init(InSize3D, InitValue);
 	}
 
+	FArray3D(const FIntVector& InSize3D, ENoInit)
+	{
+		Init(InSize3D, NoInit);
+	}
+
 	FORCEINLINE InElementType& operator[](int32 Index)
 	{
 		return InternalArray[Index];
@@ -68,28 +374,106 @@ struct FArray3D
 		return InternalArray[GetIndex1D(Index3D)];
 	}
 
+	/* Unchecked element access, bounds are only verified by checkSlow */
+	FORCEINLINE InElementType& GetUnchecked(int32 InX, int32 InY, int32 InZ)
+	{
+		return GetView()(InX, InY, InZ);
+	}
+
+	FORCEINLINE const InElementType& GetUnchecked(int32 InX, int32 InY, int32 InZ) const
+	{
+		return GetView()(InX, InY, InZ);
+	}
+
+	FORCEINLINE ViewType GetView() { return ViewType(InternalArray.GetData(), Layout); }
+	FORCEINLINE ConstViewType GetView() const { return ConstViewType(InternalArray.GetData(), Layout); }
+
+	/* Contiguous span of storage, in layout order */
+	TArrayView<InElementType> GetSpan(int32 InStartIndex, int32 InNum)
+	{
+		check(InStartIndex >= 0 && InNum >= 0 && InStartIndex + InNum <= InternalArray.Num());
+		return MakeArrayView(InternalArray.GetData() + InStartIndex, InNum);
+	}
+
+	TArrayView<const InElementType> GetSpan(int32 InStartIndex, int32 InNum) const
+	{
+		check(InStartIndex >= 0 && InNum >= 0 && InStartIndex + InNum <= InternalArray.Num());
+		return MakeArrayView(InternalArray.GetData() + InStartIndex, InNum);
+	}
+
+	/* The (y, z) plane at InX as one span, z fastest, only for layouts that store x planes contiguously */
+	template<typename L = InLayoutType>
+	TArrayView<InElementType> GetSliceX(int32 InX)
+	{
+		static_assert(L::bContiguousXSlices, "Layout does not store x slices contiguously");
+		return GetSpan(InX * Size3D.Y * Size3D.Z, Size3D.Y * Size3D.Z);
+	}
+
+	template<typename L = InLayoutType>
+	TArrayView<const InElementType> GetSliceX(int32 InX) const
+	{
+		static_assert(L::bContiguousXSlices, "Layout does not store x slices contiguously");
+		return GetSpan(InX * Size3D.Y * Size3D.Z, Size3D.Y * Size3D.Z);
+	}
+
+	/* One whole brick as a span, x major inside the brick, only for bricked layouts */
+	template<typename L = InLayoutType>
+	TArrayView<InElementType> GetBrick(int32 InBrickX, int32 InBrickY, int32 InBrickZ)
+	{
+		return GetSpan(Layout.GetBrickIndex(InBrickX, InBrickY, InBrickZ) * L::BrickNum, L::BrickNum);
+	}
+
+	template<typename L = InLayoutType>
+	TArrayView<const InElementType> GetBrick(int32 InBrickX, int32 InBrickY, int32 InBrickZ) const
+	{
+		return GetSpan(Layout.GetBrickIndex(InBrickX, InBrickY, InBrickZ) * L::BrickNum, L::BrickNum);
+	}
+
+	/* Calls InFunc(X, Y, Z, Index) for every element in storage order */
+	template<typename FuncType>
+	FORCEINLINE void ForEachIndex(FuncType&& InFunc) const
+	{
+		Layout.ForEachIndex(Forward<FuncType>(InFunc));
+	}
+
+	/* Calls InFunc(X, Y, Z, Element) for every element in storage order */
+	template<typename FuncType>
+	FORCEINLINE void ForEachElement(FuncType&& InFunc)
+	{
+		InElementType* data = InternalArray.GetData();
+		Layout.ForEachIndex([&](int32 InX, int32 InY, int32 InZ, int32 InIndex)
+		{
+			InFunc(InX, InY, InZ, data[InIndex]);
+		});
+	}
+
+	template<typename FuncType>
+	FORCEINLINE void ForEachElement(FuncType&& InFunc) const
+	{
+		const InElementType* data = InternalArray.GetData();
+		Layout.ForEachIndex([&](int32 InX, int32 InY, int32 InZ, int32 InIndex)
+		{
+			InFunc(InX, InY, InZ, data[InIndex]);
+		});
+	}
+
 	const int32 GetIndex1D(int32 InX, int32 InY, int32 InZ) const
 	{
-		return InX * Size3D.Z * Size3D.Y + (InY * Size3D.Z + InZ);
+		return Layout.GetIndex1D(InX, InY, InZ);
 	}
 
 	const int32 GetIndex1D(const FIntVector& InIndex3D) const
 	{
-		return InIndex3D.X * Size3D.Z * Size3D.Y + (InIndex3D.Y * Size3D.Z + InIndex3D.Z);
+		return Layout.GetIndex1D(InIndex3D.X, InIndex3D.Y, InIndex3D.Z);
 	}
 
-	FIntVector GetIndex3D(int32 InIndex)
+	FIntVector GetIndex3D(int32 InIndex) const
 	{
-		int32 yz = (Size3D.Y * Size3D.Z);
-		int32 x = InIndex / yz;
-		int32 w = InIndex % yz;
-		int32 y = w / Size3D.Z;
-		int32 z = w % Size3D.Z;
-
-		return FIntVector(x, y, z);
+		return Layout.GetIndex3D(InIndex);
 	}
 
 	const int32 GetSizeTotal() const { return SizeTotal; };
+	const int32 GetStorageNum() const { return InternalArray.Num(); };
 	const int32 GetSizeX() const { return Size3D.X; };
 	const int32 GetSizeY() const { return Size3D.Y; };
 	const int32 GetSizeZ() const { return Size3D.Z; };
@@ -99,4 +483,4 @@ struct FArray3D
 	{
 		InternalArray.Empty();
 	}
-};
\ No newline at end of file
+};
@@ -0,0 +1,6 @@
+#include "VoxelQuantizedDensity.h"
+
+
+// Compile both storage types once here, so a mistake in the template shows up in this module and not only where it is used
+template struct TVoxelQuantizedDensity<int8>;
+template struct TVoxelQuantizedDensity<int16>;
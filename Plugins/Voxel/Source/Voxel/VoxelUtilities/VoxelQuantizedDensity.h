@@ -0,0 +1,95 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include <type_traits>
+
+
+/*
+ * Density stored as a signed integer relative to the surface, for grids that are cached or edited rather than meshed once.
+ * A sample holds (density - isovalue) in voxels, scaled so RangeVoxels maps to the integer limit, samples further than that
+ * from the surface clamp but keep their sign. Interpolating between quantized samples gives the same surface crossing as
+ * interpolating the densities, so the meshers read quantized grids directly against an isovalue of zero.
+ */
+template<typename InStorageType>
+struct TVoxelQuantizedDensity
+{
+	static_assert(std::is_integral_v<InStorageType> && std::is_signed_v<InStorageType>, "Quantized density needs a signed integer type");
+
+	using StorageType = InStorageType;
+
+	static constexpr int32 MaxValue = TNumericLimits<InStorageType>::Max();
+
+	// Distance from the surface covered before clamping, in voxels. 8 bit keeps 1/63 voxel steps, 16 bit 1/2047
+	static constexpr double RangeVoxels = sizeof(InStorageType) == 1 ? 2.0 : 16.0;
+
+	// Quantized units per density unit
+	double Scale = 1.0;
+
+	// Density of the surface, encodes to zero
+	double Isovalue = 0.0;
+
+	TVoxelQuantizedDensity() {};
+
+	/* InDensityPerVoxel is how much the density changes across one voxel near the surface */
+	TVoxelQuantizedDensity(double InIsovalue, double InDensityPerVoxel) :
+		Scale(MaxValue / (RangeVoxels * InDensityPerVoxel)),
+		Isovalue(InIsovalue) {};
+
+	FORCEINLINE InStorageType Encode(double InDensity) const
+	{
+		const double scaled = FMath::Clamp((InDensity - Isovalue) * Scale, (double)-MaxValue, (double)MaxValue);
+
+		// Inside samples never round up to zero, so every corner keeps its inside/outside state and cases match the densities
+		return (InStorageType)(scaled < 0 ? FMath::Min<int32>(FMath::RoundToInt32(scaled), -1) : FMath::RoundToInt32(scaled));
+	}
+
+	FORCEINLINE double Decode(InStorageType InSample) const
+	{
+		return InSample / Scale + Isovalue;
+	}
+
+	/* Encodes a span of densities, a plain loop over contiguous memory so the compiler vectorizes it */
+	void Encode(TArrayView<const double> InDensities, TArrayView<InStorageType> OutSamples) const
+	{
+		check(InDensities.Num() == OutSamples.Num());
+
+		const double* src = InDensities.GetData();
+		InStorageType* dst = OutSamples.GetData();
+		for (int32 i = 0; i < InDensities.Num(); i++)
+		{
+			dst[i] = Encode(src[i]);
+		}
+	}
+
+	void Decode(TArrayView<const InStorageType> InSamples, TArrayView<double> OutDensities) const
+	{
+		check(InSamples.Num() == OutDensities.Num());
+
+		const InStorageType* src = InSamples.GetData();
+		double* dst = OutDensities.GetData();
+		for (int32 i = 0; i < InSamples.Num(); i++)
+		{
+			dst[i] = Decode(src[i]);
+		}
+	}
+};
+
+using FVoxelQuantizedDensity8 = TVoxelQuantizedDensity<int8>;
+using FVoxelQuantizedDensity16 = TVoxelQuantizedDensity<int16>;
+
+namespace VoxelDensity
+{
+	/* Isovalue to compare samples of InSampleType against, quantized samples are already relative to the surface */
+	template<typename InSampleType>
+	constexpr InSampleType GetSampleIsovalue(double InIsovalue)
+	{
+		if constexpr (std::is_integral_v<InSampleType>)
+		{
+			return 0;
+		}
+		else
+		{
+			return (InSampleType)InIsovalue;
+		}
+	}
+}
@@ -0,0 +1,128 @@
+#include "VoxelSignMask.h"
+
+#include "VoxelStatics.h"
+
+
+void FVoxelSignMask::BuildSlab(const double* InPlane0, const double* InPlane1, int32 InSizeY, int32 InSizeZ, double InIsovalue, int32 InApron)
+{
+	Allocate(FIntVector(2, InSizeY, InSizeZ));
+
+	const int32 rowStride = InSizeZ + InApron * 2;
+	const int32 firstCorner = InApron * rowStride + InApron;
+	BuildPlane(0, InPlane0 + firstCorner, rowStride, InIsovalue);
+	BuildPlane(1, InPlane1 + firstCorner, rowStride, InIsovalue);
+}
+
+void FVoxelSignMask::Allocate(const FIntVector& InSize3D)
+{
+	Size3D = InSize3D;
+	NumRowWords = (Size3D.Z + 63) / 64;
+
+	// Init zeroes the words and keeps the allocation when a mask is rebuilt at the same size
+	Rows.Init(0, Size3D.X * Size3D.Y * NumRowWords);
+}
+
+uint64 FVoxelSignMask::GetActiveCells(int32 InX, int32 InY, int32 InWord) const
+{
+	uint64 allInside = ~uint64(0);
+	uint64 anyInside = 0;
+
+	// A cell spans corners z and z + 1 of the four rows around it
+	for (int32 i = 0; i < 4; i++)
+	{
+		const uint64* row = GetRow(InX + (i & 1), InY + (i >> 1));
+		const uint64 lower = row[InWord];
+		const uint64 upper = (lower >> 1) | (InWord + 1 < NumRowWords ? row[InWord + 1] << 63 : 0);
+
+		allInside &= lower & upper;
+		anyInside |= lower | upper;
+	}
+
+	// Mask off the bits past the last cell of the row
+	const int32 numCells = FMath::Min(Size3D.Z - 1 - InWord * 64, 64);
+	const uint64 validCells = numCells == 64 ? ~uint64(0) : (uint64(1) << numCells) - 1;
+
+	return anyInside & ~allInside & validCells;
+}
+
+int32 FVoxelSignMask::GatherActiveCells(TArray<FVoxelActiveCell>& OutActiveCells) const
+{
+	const int32 numCellWords = GetNumCellWords();
+	int32 numTris = 0;
+
+	for (int32 x = 0; x < Size3D.X - 1; x++)
+	{
+		for (int32 y = 0; y < Size3D.Y - 1; y++)
+		{
+			for (int32 idxWord = 0; idxWord < numCellWords; idxWord++)
+			{
+				uint64 activeCells = GetActiveCells(x, y, idxWord);
+				while (activeCells)
+				{
+					const int32 z = idxWord * 64 + FMath::CountTrailingZeros64(activeCells);
+					activeCells &= activeCells - 1;
+
+					const uint8 idxFlag = GetCellCase(x, y, z);
+					numTris += VoxelStatics::GetNumCaseTriangles(idxFlag);
+
+					OutActiveCells.Add({ (uint16)x, (uint16)y, (uint16)z, idxFlag });
+				}
+			}
+		}
+	}
+
+	return numTris;
+}
+
+int32 FVoxelSignMask::CountCrossedEdges() const
+{
+	// Bits past the last corner of a row are zero in every row, so they only need masking where a row is compared to itself
+	const int32 numLastEdges = (Size3D.Z - 1) - (NumRowWords - 1) * 64;
+	const uint64 lastWordEdges = numLastEdges == 64 ? ~uint64(0) : (uint64(1) << numLastEdges) - 1;
+
+	int32 numEdges = 0;
+	for (int32 x = 0; x < Size3D.X; x++)
+	{
+		for (int32 y = 0; y < Size3D.Y; y++)
+		{
+			const uint64* row = GetRow(x, y);
+			const uint64* rowY = y + 1 < Size3D.Y ? GetRow(x, y + 1) : nullptr;
+			const uint64* rowX = x + 1 < Size3D.X ? GetRow(x + 1, y) : nullptr;
+
+			for (int32 idxWord = 0; idxWord < NumRowWords; idxWord++)
+			{
+				// Edges along z compare corner z with z + 1 of the same row
+				const uint64 upper = (row[idxWord] >> 1) | (idxWord + 1 < NumRowWords ? row[idxWord + 1] << 63 : 0);
+				const uint64 validEdges = idxWord + 1 < NumRowWords ? ~uint64(0) : lastWordEdges;
+				numEdges += FMath::CountBits((row[idxWord] ^ upper) & validEdges);
+
+				if (rowY)
+				{
+					numEdges += FMath::CountBits(row[idxWord] ^ rowY[idxWord]);
+				}
+
+				if (rowX)
+				{
+					numEdges += FMath::CountBits(row[idxWord] ^ rowX[idxWord]);
+				}
+			}
+		}
+	}
+
+	return numEdges;
+}
+
+uint8 FVoxelSignMask::GetCellCase(int32 InX, int32 InY, int32 InZ) const
+{
+	uint8 idxFlag = 0;
+	for (int32 i = 0; i < 8; i++)
+	{
+		idxFlag |= IsInside(
+			InX + (int32)VoxelStatics::a2fVertexOffset[i][0],
+			InY + (int32)VoxelStatics::a2fVertexOffset[i][1],
+			InZ + (int32)VoxelStatics::a2fVertexOffset[i][2]
+		) << i;
+	}
+
+	return idxFlag;
+}
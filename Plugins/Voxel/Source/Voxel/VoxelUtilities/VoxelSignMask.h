@@ -0,0 +1,96 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelUtilities/Array3D.h"
+
+
+/* A cell the surface passes through, gathered by the classification pass of the mesher */
+struct FVoxelActiveCell
+{
+	uint16 X;
+	uint16 Y;
+	uint16 Z;
+
+	// Marching cubes case, bit n is set when corner n is inside
+	uint8 Case;
+};
+
+/*
+ * Inside/outside state of a density grid, packed 64 corners to a word along each z row.
+ * Lets the mesher find the cells the surface passes through with a few bitwise ops per row
+ * instead of building a case index for every single cell.
+ */
+struct VOXEL_API FVoxelSignMask
+{
+	// Packed z rows in the same x major order as FArray3D, NumRowWords words per row
+	TArray<uint64> Rows;
+	FIntVector Size3D;
+	int32 NumRowWords = 0;
+
+	/*
+	 * Packs the corners of InDensityValues, a corner is inside when its sample is below InIsovalue (in sample units).
+	 * InApron samples on every side of the grid are left out, corner (0, 0, 0) of the mask is sample (InApron, InApron, InApron).
+	 */
+	template<typename InSampleType>
+	void Build(const FArray3D<InSampleType>& InDensityValues, InSampleType InIsovalue, int32 InApron = 0)
+	{
+		const FIntVector gridSize = InDensityValues.GetSize3D();
+		Allocate(gridSize - FIntVector(InApron * 2));
+
+		for (int32 x = 0; x < Size3D.X; x++)
+		{
+			BuildPlane(x, InDensityValues.GetSliceX(x + InApron).GetData() + InApron * gridSize.Z + InApron, gridSize.Z, InIsovalue);
+		}
+	}
+
+	/*
+	 * Packs a two plane slab of InSizeY * InSizeZ corners. InPlane0 and InPlane1 are x planes laid out like FArray3D,
+	 * with InApron extra samples before and after every row and column that are left out.
+	 */
+	void BuildSlab(const double* InPlane0, const double* InPlane1, int32 InSizeY, int32 InSizeZ, double InIsovalue, int32 InApron = 0);
+
+	/* Returns the cells of word InWord in cell row (InX, InY) that have both inside and outside corners, bit n is cell InWord * 64 + n */
+	uint64 GetActiveCells(int32 InX, int32 InY, int32 InWord) const;
+
+	/* Appends every active cell to OutActiveCells, in x major order, returns the number of triangles marching cubes will emit for them */
+	int32 GatherActiveCells(TArray<FVoxelActiveCell>& OutActiveCells) const;
+
+	/* Number of grid edges between an inside and an outside corner, which is the number of vertices a mesher sharing them emits */
+	int32 CountCrossedEdges() const;
+
+	/* Marching cubes case of a cell, bit n is set when corner n is inside */
+	uint8 GetCellCase(int32 InX, int32 InY, int32 InZ) const;
+
+	FORCEINLINE bool IsInside(int32 InX, int32 InY, int32 InZ) const
+	{
+		return (GetRow(InX, InY)[InZ >> 6] >> (InZ & 63)) & 1;
+	}
+
+	FORCEINLINE const uint64* GetRow(int32 InX, int32 InY) const
+	{
+		return Rows.GetData() + (InX * Size3D.Y + InY) * NumRowWords;
+	}
+
+	/* Number of words needed to cover a row of cells */
+	const int32 GetNumCellWords() const { return (Size3D.Z - 1 + 63) / 64; };
+
+private:
+	void Allocate(const FIntVector& InSize3D);
+
+	/* Packs mask plane InX from InPlane, whose rows of samples start InRowStride apart */
+	template<typename InSampleType>
+	void BuildPlane(int32 InX, const InSampleType* InPlane, int32 InRowStride, InSampleType InIsovalue)
+	{
+		uint64* row = Rows.GetData() + InX * Size3D.Y * NumRowWords;
+		for (int32 y = 0; y < Size3D.Y; y++)
+		{
+			for (int32 z = 0; z < Size3D.Z; z++)
+			{
+				row[z >> 6] |= uint64(InPlane[z] < InIsovalue) << (z & 63);
+			}
+
+			row += NumRowWords;
+			InPlane += InRowStride;
+		}
+	}
+};
@@ -1,10 +1,12 @@
-
 #include "VoxelVolume.h"
 
 #include "Kismet/KismetMathLibrary.h"
 #include "Kismet/GameplayStatics.h"
 #include "Components/BillboardComponent.h"
 #include "Components/BoxComponent.h"
+#include "Misc/App.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeRWLock.h"
 
 #include "RealtimeMeshLibrary.h"
 #include "RealtimeMeshSimple.h"
@@ -13,7 +15,11 @@
 #include "Mesh/RealtimeMeshSimpleData.h"
 
 #include "VoxelChunk/VoxelChunkNode.h"
-#include "VoxelUtilities/VoxelStatics.h"
+#include "VoxelChunk/VoxelCollisionDemand.h"
+#include "VoxelEdit/VoxelEditLog.h"
+#include "VoxelMesher/VoxelMarchingCubes.h"
+#include "VoxelMesher/VoxelSurfaceNets.h"
+#include "VoxelMesher/VoxelTransitionCells.h"
 #include "VoxelUtilities/Array3D.h"
 
 
@@ -45,14 +51,49 @@ void AVoxelVolume::TickActor(float DeltaTime, ELevelTick TickType, FActorTickFun
 {
 	UpdateVolume();
 
+	if (EditStore)
+	{
+		EditSaveTimer += DeltaTime;
+		if (EditSaveTimer >= EditSaveInterval)
+		{
+			SaveEdits();
+		}
+	}
+
 	Super::TickActor(DeltaTime, TickType, ThisTickFunction);
 }
 
+void AVoxelVolume::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Strokes waiting on regions still loading are baked so they are saved too
+	for (const TFuture<TArray<FVoxelEditRegionChunk>>& load : PendingRegionLoads)
+	{
+		load.Wait();
+	}
+	ApplyLoadedEdits();
+
+	SaveEdits();
+	if (EditStore)
+	{
+		EditStore->WaitForWrites();
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void AVoxelVolume::OnGenerateMesh_Implementation()
 {
 	Super::OnGenerateMesh_Implementation();
 
 	URealtimeMeshSimple* RealtimeMesh = GetRealtimeMeshComponent()->InitializeRealtimeMesh<URealtimeMeshSimple>();
+	RealtimeMesh->SetCollisionOnly(IsCollisionOnly());
+
+	// Each chunk cooks its own body, an edit or a LOD change re-cooks only the chunks it touches
+	FRealtimeMeshCollisionConfiguration collisionConfig = RealtimeMesh->GetCollisionConfig();
+	collisionConfig.bCookPerSectionGroup = true;
+	collisionConfig.bUseCookCache = bCacheCookedCollision;
+	collisionConfig.bDeformableMesh = bRefitCollision;
+	RealtimeMesh->SetCollisionConfig(collisionConfig);
 
 	for (uint8 i = 0; i < NumMaterials; i++)
 	{
@@ -65,16 +106,27 @@ void AVoxelVolume::OnGenerateMesh_Implementation()
 	}
 
 	RootNode = new FVoxelChunkNode();
+	CollisionDemand.Reset();
 
 	NodeSectionIDTracker = 1;
 
+	// Every chunk is meshed anew, with the edits carried over to the current extent and depth
+	EditLayer.Init(VolumeExtent);
+	InitEditOctree();
+
 	UpdateVolume();
 }
 
 void AVoxelVolume::UpdateVolume()
 {
+	// Regions read since the last update are meshed along with this update's strokes
+	ApplyLoadedEdits();
+
 	if (URealtimeMeshSimple* RealtimeMesh = GetRealtimeMeshComponent()->GetRealtimeMeshAs<URealtimeMeshSimple>())
 	{
+		// Chunks meshed this update, which already sampled every stroke
+		TSet<FVoxelChunkNode*> meshedChunks;
+
 		// Check for dirty chunks
 		TArray<FVoxelChunkNode*> DirtyChunks;
 		if (RechunkToCenter(DirtyChunks))
@@ -99,24 +151,8 @@ void AVoxelVolume::UpdateVolume()
 					}
 
 					// Create new leaf node mesh
-					FRealtimeMeshStreamSet StreamSet;
-					if (GenerateChunkMesh(dirtyChunk, StreamSet))
-					{
-						dirtyChunk->SectionID = NodeSectionIDTracker++;
-
-						FName name = dirtyChunk->GetSectionName();
-						const auto SectionGroupKey = FRealtimeMeshSectionGroupKey::Create(0, name);
-
-						RealtimeMesh->CreateSectionGroup(SectionGroupKey, StreamSet);
-
-						const bool bShouldCreateCollision = MaxDepth - dirtyChunk->Depth + 1 <= CollisionInverseDepth;
-						RealtimeMesh->UpdateSectionConfig
-						(
-							FRealtimeMeshSectionKey::CreateForPolyGroup(SectionGroupKey, 0),
-							FRealtimeMeshSectionConfig(ERealtimeMeshSectionDrawType::Static, 0),
-							bShouldCreateCollision
-						);
-					}
+					UpdateChunkSection(RealtimeMesh, dirtyChunk);
+					meshedChunks.Add(dirtyChunk);
 				}
 				else
 				{
@@ -127,152 +163,794 @@ void AVoxelVolume::UpdateVolume()
 					dirtyChunk->SectionID = 0;
 				}
 			}
+
+			// Only leaves touching a chunk that changed can have gained or lost a coarser neighbour, remesh their transition faces
+			// Boxes are grown by half a voxel so neighbours are found however the shared face rounds
+			const double faceMargin = GetFinestVoxelSize() * 0.5;
+			TSet<FVoxelChunkNode*> neighbourChunks;
+			for (const FVoxelChunkNode* dirtyChunk : DirtyChunks)
+			{
+				RootNode->GetLeaves(dirtyChunk->GetBox(VolumeExtent).ExpandBy(faceMargin), VolumeExtent, neighbourChunks);
+			}
+
+			for (FVoxelChunkNode* leafChunk : neighbourChunks)
+			{
+				// Leaves meshed above already have their current transition faces
+				if (!meshedChunks.Contains(leafChunk) && GetTransitionFaces(leafChunk) != leafChunk->TransitionFaces)
+				{
+					UpdateChunkSection(RealtimeMesh, leafChunk);
+					meshedChunks.Add(leafChunk);
+				}
+			}
+		}
+
+		// Strokes made since the last update, every leaf they reach is remeshed once however many there were
+		if (EditLayer.HasDirtyBounds())
+		{
+			TArray<FVoxelChunkNode*> editedChunks;
+			EditLayer.ConsumeDirtyChunks(RootNode, ChunkResolution, ChunkSampleReach, editedChunks);
+			for (FVoxelChunkNode* editedChunk : editedChunks)
+			{
+				if (!meshedChunks.Contains(editedChunk))
+				{
+					UpdateChunkSection(RealtimeMesh, editedChunk);
+				}
+			}
+		}
+
+		if (bCollisionAroundConsumers)
+		{
+			UpdateCollisionDemand(RealtimeMesh);
 		}
 	}
 }
 
+void AVoxelVolume::UpdateCollisionDemand(URealtimeMeshSimple* InRealtimeMesh)
+{
+	// Colliding components of each consumer in actor space, grown by the margin and swept along where it is heading
+	TArray<FBox> consumerBounds;
+	for (int32 i = CollisionConsumers.Num() - 1; i >= 0; i--)
+	{
+		const AActor* consumer = CollisionConsumers[i].Get();
+		if (!consumer)
+		{
+			CollisionConsumers.RemoveAtSwap(i);
+			continue;
+		}
+
+		const FBox worldBounds = consumer->GetComponentsBoundingBox(false, true);
+		if (!worldBounds.IsValid)
+		{
+			continue;
+		}
+
+		const FBox bounds = worldBounds.InverseTransformBy(GetActorTransform()).ExpandBy(CollisionConsumerMargin);
+		const FVector lead = GetActorTransform().InverseTransformVector(consumer->GetVelocity()) * CollisionLeadTime;
+		consumerBounds.Add(bounds + bounds.ShiftBy(lead));
+	}
+
+	// Collision only chunks are meshed when they start colliding and lose their mesh when they stop
+	const bool bCollisionOnlyChunks = IsCollisionOnly();
+
+	TArray<FVoxelChunkNode*> droppedChunks;
+	CollisionDemand.Update(RootNode, VolumeExtent, consumerBounds, bCollisionOnlyChunks, droppedChunks);
+	for (FVoxelChunkNode* droppedChunk : droppedChunks)
+	{
+		if (bCollisionOnlyChunks)
+		{
+			UpdateChunkSection(InRealtimeMesh, droppedChunk);
+		}
+		else
+		{
+			UpdateChunkSectionConfigs(InRealtimeMesh, droppedChunk);
+		}
+	}
+
+	// Each chunk handed out starts an async cook of its own body, the budget keeps how many start per tick bounded
+	TArray<FVoxelChunkNode*> cookChunks;
+	CollisionDemand.Dequeue(MaxCollisionCooksPerTick, cookChunks);
+	for (FVoxelChunkNode* cookChunk : cookChunks)
+	{
+		if (bCollisionOnlyChunks)
+		{
+			UpdateChunkSection(InRealtimeMesh, cookChunk);
+		}
+		else
+		{
+			UpdateChunkSectionConfigs(InRealtimeMesh, cookChunk);
+		}
+	}
+}
+
+void AVoxelVolume::RegisterCollisionConsumer(AActor* InActor)
+{
+	if (InActor)
+	{
+		CollisionConsumers.AddUnique(InActor);
+	}
+}
+
+void AVoxelVolume::UnregisterCollisionConsumer(AActor* InActor)
+{
+	// The chunks only it overlapped drop their collision on the next tick
+	CollisionConsumers.RemoveSwap(InActor);
+}
+
+bool AVoxelVolume::ShouldChunkCollide(const FVoxelChunkNode* InChunk) const
+{
+	if (bCollisionAroundConsumers)
+	{
+		return CollisionDemand.HasCollision(InChunk);
+	}
+
+	return MaxDepth - InChunk->Depth + 1 <= CollisionInverseDepth;
+}
+
+bool AVoxelVolume::IsCollisionOnly() const
+{
+	return bCollisionOnly || !FApp::CanEverRender();
+}
+
+void AVoxelVolume::UpdateChunkSectionConfigs(URealtimeMeshSimple* InRealtimeMesh, FVoxelChunkNode* InChunk)
+{
+	const FRealtimeMeshSectionGroupKey SectionGroupKey = FRealtimeMeshSectionGroupKey::Create(0, InChunk->GetSectionName());
+	const bool bShouldCreateCollision = ShouldChunkCollide(InChunk);
+	for (const uint16 material : InChunk->Materials)
+	{
+		InRealtimeMesh->UpdateSectionConfig
+		(
+			FRealtimeMeshSectionKey::CreateForPolyGroup(SectionGroupKey, material),
+			FRealtimeMeshSectionConfig(ERealtimeMeshSectionDrawType::Static, material),
+			bShouldCreateCollision
+		);
+	}
+}
+
+void AVoxelVolume::UpdateChunkSection(URealtimeMeshSimple* InRealtimeMesh, FVoxelChunkNode* InChunk)
+{
+	InChunk->TransitionFaces = GetTransitionFaces(InChunk);
+
+	// Nothing draws a collision only chunk, one that does not collide needs no mesh at all
+	if (IsCollisionOnly() && !ShouldChunkCollide(InChunk))
+	{
+		if (InChunk->SectionID != 0)
+		{
+			InRealtimeMesh->RemoveSectionGroup(FRealtimeMeshSectionGroupKey::Create(0, InChunk->GetSectionName())).Wait();
+			InChunk->SectionID = 0;
+		}
+
+		InChunk->Materials.Reset();
+		return;
+	}
+
+	FRealtimeMeshStreamSet StreamSet;
+	const bool bHasMesh = GenerateChunkMesh(InChunk, StreamSet);
+
+	// The section group makes one section per material present from the grouped polygroups, read them before the streams move
+	InChunk->Materials.Reset();
+	GetVoxelMeshMaterials(StreamSet, InChunk->Materials);
+
+	FRealtimeMeshSectionGroupKey SectionGroupKey;
+	if (InChunk->SectionID != 0)
+	{
+		SectionGroupKey = FRealtimeMeshSectionGroupKey::Create(0, InChunk->GetSectionName());
+		if (!bHasMesh)
+		{
+			InRealtimeMesh->RemoveSectionGroup(SectionGroupKey).Wait();
+			InChunk->SectionID = 0;
+			return;
+		}
+
+		InRealtimeMesh->UpdateSectionGroup(SectionGroupKey, MoveTemp(StreamSet));
+	}
+	else if (bHasMesh)
+	{
+		InChunk->SectionID = NodeSectionIDTracker++;
+
+		FName name = InChunk->GetSectionName();
+		SectionGroupKey = FRealtimeMeshSectionGroupKey::Create(0, name);
+		InRealtimeMesh->CreateSectionGroup(SectionGroupKey, MoveTemp(StreamSet));
+	}
+	else
+	{
+		return;
+	}
+
+	// Updates can bring materials the chunk did not have before, so every section is configured each time
+	UpdateChunkSectionConfigs(InRealtimeMesh, InChunk);
+}
+
+const FVoxelChunkNode* AVoxelVolume::FindLeafChunk(const FVector& InLocation) const
+{
+	if (!RootNode || !RootNode->GetBox(VolumeExtent).IsInside(InLocation))
+	{
+		return nullptr;
+	}
+
+	// Child index bits are x, y, z from high to low, see FVoxelChunkNode::NodeOffsets
+	const FVoxelChunkNode* node = RootNode;
+	while (!node->IsLeaf())
+	{
+		const int idxChild =
+			(InLocation.X >= node->Location.X ? 4 : 0)
+			| (InLocation.Y >= node->Location.Y ? 2 : 0)
+			| (InLocation.Z >= node->Location.Z ? 1 : 0);
+
+		if (!node->Children[idxChild])
+		{
+			return nullptr;
+		}
+
+		node = node->Children[idxChild];
+	}
+
+	return node;
+}
+
+uint8 AVoxelVolume::GetTransitionFaces(const FVoxelChunkNode* InChunk) const
+{
+	// Transition cells stitch marching cubes cells to cells twice their size, which needs an even number of them per face
+	if (!bTransitionCells || Mesher != EVoxelMesher::MarchingCubes || ChunkResolution % 2 != 0)
+	{
+		return 0;
+	}
+
+	const double chunkExtent = InChunk->GetExtent(VolumeExtent);
+	const double voxelSize = chunkExtent * 2 / ChunkResolution;
+
+	uint8 transitionFaces = 0;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		for (const bool bPositive : { false, true })
+		{
+			// Half a voxel past the face center, inside whichever leaf borders the face there
+			FVector location = InChunk->Location;
+			location[axis] += (bPositive ? 1 : -1) * (chunkExtent + voxelSize * 0.5);
+
+			// Neighbours more than one depth coarser are left with a crack, finer ones close the seam themselves
+			const FVoxelChunkNode* neighbour = FindLeafChunk(location);
+			if (neighbour && neighbour->Depth + 1 == InChunk->Depth)
+			{
+				transitionFaces |= FVoxelTransitionCells::GetFaceBit(axis, bPositive);
+			}
+		}
+	}
+
+	return transitionFaces;
+}
+
 bool AVoxelVolume::GenerateChunkMesh(FVoxelChunkNode* InChunk, FRealtimeMeshStreamSet& OutStreamSet)
 {
-	const FVector volumeLocation(GetActorLocation());
-	const FVector3f chunkLocation(InChunk->Location);
-	const int edgeCount = ChunkResolution + 1;
 	const double chunkExtent = InChunk->GetExtent(VolumeExtent);
-	const double chunkSize = chunkExtent * 2;
 	const double voxelExtent = chunkExtent / ChunkResolution;
-	const double voxelSize = voxelExtent * 2;
-
-	FArray3D<double> densityValues = FArray3D<double>(FIntVector(ChunkResolution + 1), -1.0);
-	TRealtimeMeshBuilderLocal<uint32, FPackedNormal, FVector2DHalf, 1> builder(OutStreamSet);
-	builder.EnableTangents();
-	builder.EnableTexCoords();
-	builder.EnablePolyGroups();
-	builder.EnableColors();
-
-	// Try to make allocations outside the loop
-	uint32 numTris = 0;
-	double densityBuffer[8];
-	FVector3f edgeVertexBuffer[12];
-	FVector3f edgeNormal;
-	int idxFlag = 0;
-	int x = 0;
-	int y = 0;
-	int z = 0;
-	int i = 0;
-
-	// Start marching cubes
-	for (x = 0; x < ChunkResolution; x++)
-	{
-		for (y = 0; y < ChunkResolution; y++)
+
+	FVoxelMeshParams meshParams;
+	meshParams.ChunkOrigin = FVector3f(InChunk->Location - chunkExtent);
+	meshParams.VoxelSize = voxelExtent * 2;
+	meshParams.SurfaceIsovalue = SurfaceIsovalue;
+	meshParams.Resolution = ChunkResolution;
+	meshParams.TransitionFaces = InChunk->TransitionFaces;
+	meshParams.TransitionWidth = TransitionCellWidth;
+	meshParams.bCollisionOnly = IsCollisionOnly();
+	meshParams.bLeanLayout = VertexLayout == EVoxelVertexLayout::Lean || meshParams.bCollisionOnly;
+
+	// Large chunks stream through two planes of densities instead of holding the whole grid, marching cubes only.
+	// The planes are few enough to keep as doubles, DensityFormat is not read on this path
+	bool bHasMesh;
+	if (Mesher == EVoxelMesher::MarchingCubes && ChunkResolution >= SlabMeshingMinResolution)
+	{
+		FVoxelTransitionMesh transitionMesh;
+		BuildChunkTransitionMesh<double>(InChunk, meshParams, transitionMesh);
+
+		bHasMesh = VoxelMarchingCubes::GenerateMeshSlabs(
+			meshParams,
+			[this, InChunk](int32 InX, TArrayView<double> OutPlane, TArrayView<uint8> OutMaterialPlane)
+			{
+				SampleChunkDensityPlane(InChunk, InX, VoxelMarchingCubes::Apron, OutPlane, NumMaterials > 1 ? OutMaterialPlane : TArrayView<uint8>());
+			},
+			bUnrollMeshingLoops,
+			OutStreamSet
+		);
+
+		bHasMesh = FVoxelTransitionCells::EmitMesh(meshParams, transitionMesh, OutStreamSet) || bHasMesh;
+	}
+	else
+	{
+		switch (DensityFormat)
+		{
+		case EVoxelDensityFormat::Int16:
+			bHasMesh = GenerateChunkMeshFromGrid<int16>(InChunk, meshParams, OutStreamSet);
+			break;
+		case EVoxelDensityFormat::Int8:
+			bHasMesh = GenerateChunkMeshFromGrid<int8>(InChunk, meshParams, OutStreamSet);
+			break;
+		default:
+			bHasMesh = GenerateChunkMeshFromGrid<double>(InChunk, meshParams, OutStreamSet);
+			break;
+		}
+	}
+
+	FinalizeVoxelMeshStreams(meshParams, OutStreamSet);
+	return bHasMesh;
+}
+
+template<typename InSampleType>
+bool AVoxelVolume::GenerateChunkMeshFromGrid(FVoxelChunkNode* InChunk, const FVoxelMeshParams& InParams, FRealtimeMeshStreamSet& OutStreamSet)
+{
+	const int apron = Mesher == EVoxelMesher::SurfaceNets ? FVoxelSurfaceNets::Apron : VoxelMarchingCubes::Apron;
+	const int edgeCount = ChunkResolution + 1 + apron * 2;
+
+	// Every sample is overwritten below, skip the fill
+	FArray3D<InSampleType> samples = FArray3D<InSampleType>(FIntVector(edgeCount), NoInit);
+
+	// A single material leaves the ids out, every triangle is in material 0
+	FVoxelMeshParams params = InParams;
+	FArray3D<uint8> materialIds;
+	if (NumMaterials > 1)
+	{
+		materialIds.Init(FIntVector(edgeCount), NoInit);
+		params.MaterialIds = &materialIds;
+	}
+
+	if constexpr (std::is_same_v<InSampleType, double>)
+	{
+		SampleChunkDensity(InChunk, apron, samples, params.MaterialIds ? &materialIds : nullptr);
+	}
+	else
+	{
+		const TVoxelQuantizedDensity<InSampleType> quantization(SurfaceIsovalue, GetDensityPerVoxel(InParams.VoxelSize));
+
+		// Only one plane of full precision densities is alive at a time
+		TArray<double> plane;
+		plane.SetNumUninitialized(edgeCount * edgeCount);
+
+		for (int x = 0; x < edgeCount; x++)
 		{
-			for (z = 0; z < ChunkResolution; z++)
+			SampleChunkDensityPlane(InChunk, x, apron, plane, params.MaterialIds ? materialIds.GetSliceX(x) : TArrayView<uint8>());
+			quantization.Encode(plane, samples.GetSliceX(x));
+		}
+	}
+
+	switch (Mesher)
+	{
+	case EVoxelMesher::SurfaceNets:
+		return FVoxelSurfaceNets::GenerateMesh(samples, params, OutStreamSet);
+	default:
+	{
+		// Built first so the chunk's streams are reserved for its cells and transition cells together
+		FVoxelTransitionMesh transitionMesh;
+		BuildChunkTransitionMesh<InSampleType>(InChunk, params, transitionMesh);
+		params.NumExtraVertices = transitionMesh.NumVertices();
+		params.NumExtraTriangles = transitionMesh.NumTriangles();
+
+		const bool bHasMesh = VoxelMarchingCubes::GenerateMesh(samples, params, bUnrollMeshingLoops, OutStreamSet);
+		return FVoxelTransitionCells::EmitMesh(params, transitionMesh, OutStreamSet) || bHasMesh;
+	}
+	}
+}
+
+template<typename InSampleType>
+void AVoxelVolume::BuildChunkTransitionMesh(FVoxelChunkNode* InChunk, const FVoxelMeshParams& InParams, FVoxelTransitionMesh& OutMesh)
+{
+	if (InParams.TransitionFaces == 0)
+	{
+		return;
+	}
+
+	// Same corner locations as SampleChunkDensityPlane with the marching cubes apron, so the front of the transition cells
+	// matches the chunk's own cells
+	const FVector3f chunkLocation(InChunk->Location);
+	const double chunkExtent = InChunk->GetExtent(VolumeExtent);
+	const double voxelSize = chunkExtent * 2 / ChunkResolution;
+	const int apron = VoxelMarchingCubes::Apron;
+	const double gridOrigin = chunkExtent + apron * voxelSize;
+
+	const auto getCornerLocation = [&](int32 InX, int32 InY, int32 InZ)
+	{
+		return FVector(
+			chunkLocation.X - gridOrigin + (InX + apron) * voxelSize,
+			chunkLocation.Y - gridOrigin + (InY + apron) * voxelSize,
+			chunkLocation.Z - gridOrigin + (InZ + apron) * voxelSize
+		);
+	};
+
+	const auto sampleDensity = [&](int32 InX, int32 InY, int32 InZ)
+	{
+		return SampleDensity(getCornerLocation(InX, InY, InZ));
+	};
+
+	const auto sampleMaterial = [&](int32 InX, int32 InY, int32 InZ)
+	{
+		uint8 materialId = 0;
+		if (NumMaterials > 1)
+		{
+			SampleDensity(getCornerLocation(InX, InY, InZ), &materialId);
+		}
+		return materialId;
+	};
+
+	if constexpr (std::is_same_v<InSampleType, double>)
+	{
+		FVoxelTransitionCells::BuildMesh(InParams, SurfaceIsovalue, sampleDensity, sampleDensity, sampleMaterial, OutMesh);
+	}
+	else
+	{
+		// The coarse neighbour quantizes its samples for voxels twice the size
+		const TVoxelQuantizedDensity<InSampleType> quantization(SurfaceIsovalue, GetDensityPerVoxel(voxelSize));
+		const TVoxelQuantizedDensity<InSampleType> coarseQuantization(SurfaceIsovalue, GetDensityPerVoxel(voxelSize * 2));
+
+		FVoxelTransitionCells::BuildMesh(
+			InParams,
+			0.0,
+			[&](int32 InX, int32 InY, int32 InZ) { return (double)quantization.Encode(sampleDensity(InX, InY, InZ)); },
+			[&](int32 InX, int32 InY, int32 InZ) { return (double)coarseQuantization.Encode(sampleDensity(InX, InY, InZ)); },
+			sampleMaterial,
+			OutMesh
+		);
+	}
+}
+
+void AVoxelVolume::SampleChunkDensity(FVoxelChunkNode* InChunk, int InApron, FArray3D<double>& OutDensityValues, FArray3D<uint8>* OutMaterialIds)
+{
+	for (int x = 0; x < OutDensityValues.GetSizeX(); x++)
+	{
+		SampleChunkDensityPlane(InChunk, x, InApron, OutDensityValues.GetSliceX(x), OutMaterialIds ? OutMaterialIds->GetSliceX(x) : TArrayView<uint8>());
+	}
+}
+
+void AVoxelVolume::SampleChunkDensityPlane(FVoxelChunkNode* InChunk, int InX, int InApron, TArrayView<double> OutPlane, TArrayView<uint8> OutMaterialPlane)
+{
+	const FVector3f chunkLocation(InChunk->Location);
+	const double chunkExtent = InChunk->GetExtent(VolumeExtent);
+	const double voxelSize = chunkExtent * 2 / ChunkResolution;
+	const int edgeCount = ChunkResolution + 1 + InApron * 2;
+	check(OutPlane.Num() == edgeCount * edgeCount);
+	check(OutMaterialPlane.IsEmpty() || OutMaterialPlane.Num() == OutPlane.Num());
+
+	// Sample (0, 0, 0) sits InApron voxels before the chunk's corner
+	const double gridOrigin = chunkExtent + InApron * voxelSize;
+
+	int idxDensity = 0;
+	for (int y = 0; y < edgeCount; y++)
+	{
+		for (int z = 0; z < edgeCount; z++)
+		{
+			const FVector cornerLocationWorld =
 			{
-				// Find values at the cube's corners
-				for (i = 0; i < 8; i++)
-				{
-					const FIntVector cornerLocationIndex =
-					{
-						x + (int)VoxelStatics::a2fVertexOffset[i][0],
-						y + (int)VoxelStatics::a2fVertexOffset[i][1],
-						z + (int)VoxelStatics::a2fVertexOffset[i][2]
-					};
+				chunkLocation.X - gridOrigin + InX * voxelSize,
+				chunkLocation.Y - gridOrigin + y * voxelSize,
+				chunkLocation.Z - gridOrigin + z * voxelSize
+			};
 
-					if (densityValues[cornerLocationIndex] == -1.0)
-					{
-						const FVector cornerLocationWorld =
-						{
-							chunkLocation.X - chunkExtent + cornerLocationIndex.X * voxelSize,
-							chunkLocation.Y - chunkExtent + cornerLocationIndex.Y * voxelSize,
-							chunkLocation.Z - chunkExtent + cornerLocationIndex.Z * voxelSize
-						};
+			OutPlane[idxDensity] = SampleBaseDensity(cornerLocationWorld, OutMaterialPlane.IsEmpty() ? nullptr : &OutMaterialPlane[idxDensity]);
+			idxDensity++;
+		}
+	}
 
-						densityValues[cornerLocationIndex] = SDFSphere(cornerLocationWorld, VolumeExtent);
-					}
-					
-					densityBuffer[i] = densityValues[cornerLocationIndex];
-				}
+	// Edited corners come from the octree in one pass, the chunk's corners are every stride'th point of its lattice
+	const int32 stride = 1 << (MaxDepth - InChunk->Depth);
+	const FIntVector origin = EditOctree.GetLatticePoint(FVector(chunkLocation.X - gridOrigin + InX * voxelSize, chunkLocation.Y - gridOrigin, chunkLocation.Z - gridOrigin));
+	EditOctree.Extract(origin, stride, FIntVector(1, edgeCount, edgeCount), OutPlane, OutMaterialPlane);
+}
 
-				// Find which vertices are inside of the surface and which are outside
-				idxFlag = 0;
-				for (i = 0; i < 8; i++)
-				{
-					if (densityBuffer[i] < SurfaceIsovalue)
-						idxFlag |= 1 << i;
-				}
+double AVoxelVolume::SampleDensity(const FVector& InLocation, uint8* OutMaterialId) const
+{
+	double density = 0;
+	if (EditOctree.Sample(EditOctree.GetLatticePoint(InLocation), density, OutMaterialId))
+	{
+		return density;
+	}
 
-				// Find which edges are intersected by the surface
-				const int edgeFlags = VoxelStatics::aiCubeEdgeFlags[idxFlag];
+	return SampleBaseDensity(InLocation, OutMaterialId);
+}
 
-				// If the cube is entirely inside or outside of the surface,
-				// then there will be no intersections, continue to next cube
-				if (!edgeFlags) continue;
+double AVoxelVolume::SampleInterpolatedDensity(const FVector& InLocation) const
+{
+	const double voxelSize = GetFinestVoxelSize();
+	const FVector lattice = InLocation / voxelSize;
+	const FVector minCorner(FMath::FloorToDouble(lattice.X), FMath::FloorToDouble(lattice.Y), FMath::FloorToDouble(lattice.Z));
+	const FVector alpha = lattice - minCorner;
 
-				// Find the point of intersection of the surface with each edge
-				for (i = 0; i < 12; i++)
-				{
-					//if there is an intersection on this edge
-					if (edgeFlags & (1 << i))
-					{
-						const double c1 = densityBuffer[VoxelStatics::a2iEdgeConnection[i][0]];
-						const double c2 = densityBuffer[VoxelStatics::a2iEdgeConnection[i][1]];
-						const double edgeOffset = c1 == c2 ? 0.5 : FMath::Clamp((SurfaceIsovalue - c1) / (c2 - c1), 0.0, 1.0);
+	// Corner index bits are x, y, z from high to low
+	double corners[8];
+	for (int i = 0; i < 8; i++)
+	{
+		corners[i] = SampleDensity((minCorner + FVector((i >> 2) & 1, (i >> 1) & 1, i & 1)) * voxelSize);
+	}
 
-						edgeVertexBuffer[i].Set(
-							VoxelStatics::a2fVertexOffset[VoxelStatics::a2iEdgeConnection[i][0]][0] + x
-							+ VoxelStatics::a2fEdgeDirection[i][0] * edgeOffset,
+	const double x00 = FMath::Lerp(corners[0], corners[4], alpha.X);
+	const double x01 = FMath::Lerp(corners[1], corners[5], alpha.X);
+	const double x10 = FMath::Lerp(corners[2], corners[6], alpha.X);
+	const double x11 = FMath::Lerp(corners[3], corners[7], alpha.X);
+	return FMath::Lerp(FMath::Lerp(x00, x10, alpha.Y), FMath::Lerp(x01, x11, alpha.Y), alpha.Z);
+}
 
-							VoxelStatics::a2fVertexOffset[VoxelStatics::a2iEdgeConnection[i][0]][1] + y
-							+ VoxelStatics::a2fEdgeDirection[i][1] * edgeOffset,
+double AVoxelVolume::SampleBaseDensity(const FVector& InLocation, uint8* OutMaterialId) const
+{
+	if (OutMaterialId)
+	{
+		*OutMaterialId = GetMaterialId(InLocation);
+	}
 
-							VoxelStatics::a2fVertexOffset[VoxelStatics::a2iEdgeConnection[i][0]][2] + z
-							+ VoxelStatics::a2fEdgeDirection[i][2] * edgeOffset
-						);
+	return SDFSphere(InLocation, VolumeExtent);
+}
 
-						edgeVertexBuffer[i] *= voxelSize;
-						edgeVertexBuffer[i] += chunkLocation - chunkExtent;
-					}
-				}
+void AVoxelVolume::InitEditOctree()
+{
+	// What the previous lattice has unsaved is written before it goes
+	SaveEdits();
+	if (EditStore)
+	{
+		EditStore->WaitForWrites();
+	}
 
-				//Draw the triangles that were found, there can be up to five per cube
-				for (i = 0; i < 5; i++)
-				{
-					const uint8 idxTableVertex = i * 3;
-					if (VoxelStatics::a2iTriangleConnectionTable[idxFlag][idxTableVertex] < 0) break;
+	// Chunks read up to ChunkSampleReach of their own voxels past the volume's box, the root's are the largest
+	const int32 latticeResolution = ChunkResolution << MaxDepth;
+	const double voxelSize = VolumeExtent * 2 / latticeResolution;
 
-					const uint8 idxVertexA = VoxelStatics::a2iTriangleConnectionTable[idxFlag][idxTableVertex];
-					const uint8 idxVertexB = VoxelStatics::a2iTriangleConnectionTable[idxFlag][idxTableVertex + 1];
-					const uint8 idxVertexC = VoxelStatics::a2iTriangleConnectionTable[idxFlag][idxTableVertex + 2];
+	/*
+	 * Strokes are not kept once baked. What the previous lattice holds carries over chunk by chunk if the voxels keep their size,
+	 * edits on a lattice of another voxel size only survive in the regions they were saved to.
+	 */
+	TArray<FVoxelEditRegionChunk> carriedChunks;
+	const int32 carrySize = GetEditChunkSize();
+	if (EditOctree.GetVoxelSize() == voxelSize)
+	{
+		TArray<FIntVector> chunks;
+		EditOctree.GatherChunks(carrySize, chunks);
+		for (const FIntVector& chunk : chunks)
+		{
+			FVoxelEditRegionChunk& carriedChunk = carriedChunks.AddDefaulted_GetRef();
+			carriedChunk.Chunk = chunk;
+			EditOctree.SaveChunk(chunk, carrySize, carriedChunk.Data);
+		}
+	}
 
-					edgeNormal = FVector3f::CrossProduct(
-						edgeVertexBuffer[idxVertexC] - edgeVertexBuffer[idxVertexA],
-						edgeVertexBuffer[idxVertexB] - edgeVertexBuffer[idxVertexA]
-					);
+	const FString directory = FPaths::ProjectSavedDir() / TEXT("VoxelEdits") / EditSaveName;
+	int32 chunkSize = 0;
+	{
+		FWriteScopeLock lock(EditOctreeLock);
+		EditOctree.Init(voxelSize, latticeResolution / 2 + (ChunkSampleReach << MaxDepth), SurfaceIsovalue, GetDensityPerVoxel(1.0));
+		chunkSize = GetEditChunkSize();
+
+		// What was saved loads back with the regions instead, unless it was saved elsewhere or on another lattice
+		const bool bReloadsSaved = EditStore && !EditSaveName.IsEmpty() && EditStore->GetDirectory() == directory && EditStore->GetChunkSize() == chunkSize && EditStore->GetVoxelSize() == voxelSize;
+		if (!bReloadsSaved && carrySize <= EditOctree.GetRootSize())
+		{
+			for (const FVoxelEditRegionChunk& carriedChunk : carriedChunks)
+			{
+				EditOctree.LoadChunk(carriedChunk.Chunk, carrySize, carriedChunk.Data);
+			}
+		}
+	}
 
-					edgeNormal.Normalize();
+	EditStore.Reset();
+	PendingRegionLoads.Reset();
+	UnsavedEditChunks.Reset();
+	EditSaveTimer = 0;
 
-					const uint32 ia = builder.AddVertex(edgeVertexBuffer[idxVertexA])
-						.SetNormalAndTangent(edgeNormal, FVector3f(0, 1, 0))
-						.SetTexCoords(FVector2D())
-						.GetIndex();
+	if (!EditSaveName.IsEmpty())
+	{
+		EditStore = MakeShared<FVoxelEditRegionStore, ESPMode::ThreadSafe>(directory, chunkSize, voxelSize, EditCompression);
 
-					const uint32 ib = builder.AddVertex(edgeVertexBuffer[idxVertexB])
-						.SetNormalAndTangent(edgeNormal, FVector3f(0, 1, 0))
-						.SetTexCoords(FVector2D())
-						.GetIndex();
+		// What carried over is written to the new regions, saved regions loading later replace the chunks they hold
+		TArray<FIntVector> chunks;
+		EditOctree.GatherChunks(chunkSize, chunks);
+		UnsavedEditChunks.Append(chunks);
 
-					const uint32 ic = builder.AddVertex(edgeVertexBuffer[idxVertexC])
-						.SetNormalAndTangent(edgeNormal, FVector3f(0, 1, 0))
-						.SetTexCoords(FVector2D())
-						.GetIndex();
+		TArray<FIntVector> regions;
+		EditStore->FindRegions(regions);
+		for (const FIntVector& region : regions)
+		{
+			PendingRegionLoads.Add(EditStore->LoadRegion(region));
+		}
+	}
 
-					builder.AddTriangle(ia, ib, ic, 0);
+	ApplyLoadedEdits();
+}
 
-					numTris++;
-				}
+void AVoxelVolume::AddEdits(TConstArrayView<FVoxelEdit> InEdits)
+{
+	for (const FVoxelEdit& edit : InEdits)
+	{
+		EditLayer.Add(edit);
+	}
+
+	// Regions still loading would overwrite the strokes, they wait for them
+	if (!PendingRegionLoads.IsEmpty())
+	{
+		DeferredEdits.Append(InEdits.GetData(), InEdits.Num());
+		return;
+	}
+
+	BakeEdits(InEdits);
+}
+
+void AVoxelVolume::BakeEdits(TConstArrayView<FVoxelEdit> InEdits)
+{
+	{
+		FWriteScopeLock lock(EditOctreeLock);
+		EditOctree.ApplyEdits(InEdits, [this](const FVector& InLocation, uint8& OutMaterialId) { return SampleBaseDensity(InLocation, &OutMaterialId); });
+	}
+
+	if (EditStore)
+	{
+		TArray<FIntVector> chunks;
+		for (const FVoxelEdit& edit : InEdits)
+		{
+			EditOctree.GatherChunks(edit.GetBounds(), EditStore->GetChunkSize(), chunks);
+			UnsavedEditChunks.Append(chunks);
+		}
+	}
+}
+
+int32 AVoxelVolume::ApplyEditLog(FArchive& Ar)
+{
+	TArray<FVoxelEdit> edits;
+	FVoxelEditLogReader::ReadAll(Ar, edits);
+
+	for (FVoxelEdit& edit : edits)
+	{
+		edit.MaterialId = FMath::Min(edit.MaterialId, (uint8)(NumMaterials - 1));
+	}
+
+	AddEdits(edits);
+	return edits.Num();
+}
+
+FBox AVoxelVolume::GetEditChunkBounds(const FIntVector& InChunk) const
+{
+	const double chunkExtent = GetEditChunkSize() * EditOctree.GetVoxelSize();
+	const FVector min = FVector(InChunk) * chunkExtent;
+	return FBox(min, min + FVector(chunkExtent));
+}
+
+void AVoxelVolume::ApplyLoadedEdits()
+{
+	for (int32 i = PendingRegionLoads.Num() - 1; i >= 0; i--)
+	{
+		if (!PendingRegionLoads[i].IsReady())
+		{
+			continue;
+		}
+
+		FWriteScopeLock lock(EditOctreeLock);
+		for (const FVoxelEditRegionChunk& chunk : PendingRegionLoads[i].Get())
+		{
+			if (EditOctree.LoadChunk(chunk.Chunk, EditStore->GetChunkSize(), chunk.Data))
+			{
+				EditLayer.MarkDirty(GetEditChunkBounds(chunk.Chunk));
 			}
 		}
+
+		PendingRegionLoads.RemoveAtSwap(i);
+	}
+
+	if (PendingRegionLoads.IsEmpty() && !DeferredEdits.IsEmpty())
+	{
+		BakeEdits(DeferredEdits);
+		DeferredEdits.Reset();
+	}
+}
+
+void AVoxelVolume::SaveEdits()
+{
+	EditSaveTimer = 0;
+	if (!EditStore)
+	{
+		return;
+	}
+
+	for (const FIntVector& chunk : UnsavedEditChunks)
+	{
+		FVoxelEditRegionChunk regionChunk;
+		regionChunk.Chunk = chunk;
+		EditOctree.SaveChunk(chunk, EditStore->GetChunkSize(), regionChunk.Data);
+		EditStore->Write(MoveTemp(regionChunk));
+	}
+
+	UnsavedEditChunks.Reset();
+
+	// Refused while the previous save is still writing, the chunks stay queued for the next one
+	EditStore->Flush();
+}
+
+void AVoxelVolume::EditSphere(const FVector& InCenter, double InRadius, EVoxelEditOperation InOperation, double InSmoothness, uint8 InMaterialId)
+{
+	FVoxelEdit edit;
+	edit.Shape = EVoxelEditShape::Sphere;
+	edit.Operation = InOperation;
+	edit.Center = InCenter;
+	edit.Extent = FVector(InRadius);
+	edit.Smoothness = InSmoothness;
+	edit.MaterialId = FMath::Min(InMaterialId, (uint8)(NumMaterials - 1));
+	AddEdits(MakeArrayView(&edit, 1));
+}
+
+void AVoxelVolume::EditBox(const FVector& InCenter, const FVector& InExtent, EVoxelEditOperation InOperation, double InSmoothness, uint8 InMaterialId)
+{
+	FVoxelEdit edit;
+	edit.Shape = EVoxelEditShape::Box;
+	edit.Operation = InOperation;
+	edit.Center = InCenter;
+	edit.Extent = InExtent;
+	edit.Smoothness = InSmoothness;
+	edit.MaterialId = FMath::Min(InMaterialId, (uint8)(NumMaterials - 1));
+	AddEdits(MakeArrayView(&edit, 1));
+}
+
+void AVoxelVolume::ClearEdits()
+{
+	// Strokes are not kept once baked, the chunks holding edits are what gets remeshed
+	if (EditOctree.GetRootSize() > 0)
+	{
+		TArray<FIntVector> chunks;
+		EditOctree.GatherChunks(GetEditChunkSize(), chunks);
+		for (const FIntVector& chunk : chunks)
+		{
+			EditLayer.MarkDirty(GetEditChunkBounds(chunk));
+		}
+	}
+
+	// Regions still loading are dropped with the rest
+	if (EditStore)
+	{
+		EditStore->Clear();
+		PendingRegionLoads.Reset();
+		UnsavedEditChunks.Reset();
+	}
+
+	DeferredEdits.Reset();
+
+	FWriteScopeLock lock(EditOctreeLock);
+	EditOctree.Reset();
+}
+
+double AVoxelVolume::GetDensity(const FVector& InLocation) const
+{
+	FReadScopeLock lock(EditOctreeLock);
+	return SampleInterpolatedDensity(InLocation);
+}
+
+bool AVoxelVolume::IsSolid(const FVector& InLocation) const
+{
+	return GetDensity(InLocation) < SurfaceIsovalue;
+}
+
+void AVoxelVolume::GetDensityBatch(TConstArrayView<FVector> InLocations, TArrayView<double> OutDensities) const
+{
+	check(OutDensities.Num() == InLocations.Num());
+
+	FReadScopeLock lock(EditOctreeLock);
+	for (int32 i = 0; i < InLocations.Num(); i++)
+	{
+		OutDensities[i] = SampleInterpolatedDensity(InLocations[i]);
 	}
+}
+
+void AVoxelVolume::IsSolidBatch(TConstArrayView<FVector> InLocations, TArrayView<bool> OutSolid) const
+{
+	check(OutSolid.Num() == InLocations.Num());
 
-	return numTris != 0;
+	FReadScopeLock lock(EditOctreeLock);
+	for (int32 i = 0; i < InLocations.Num(); i++)
+	{
+		OutSolid[i] = SampleInterpolatedDensity(InLocations[i]) < SurfaceIsovalue;
+	}
+}
+
+bool AVoxelVolume::Raycast(const FVector& InStart, const FVector& InEnd, FVoxelRaycastHit& OutHit) const
+{
+	FReadScopeLock lock(EditOctreeLock);
+	const auto sampleDensity = [this](const FVector& InLocation) { return SampleInterpolatedDensity(InLocation); };
+	return FVoxelDensityQuery(sampleDensity, SurfaceIsovalue, GetDensityPerVoxel(1.0), GetFinestVoxelSize()).Raycast(InStart, InEnd, OutHit);
+}
+
+bool AVoxelVolume::SphereOverlap(const FVector& InCenter, double InRadius) const
+{
+	FReadScopeLock lock(EditOctreeLock);
+	const auto sampleDensity = [this](const FVector& InLocation) { return SampleInterpolatedDensity(InLocation); };
+	return FVoxelDensityQuery(sampleDensity, SurfaceIsovalue, GetDensityPerVoxel(1.0), GetFinestVoxelSize()).SphereOverlap(InCenter, InRadius);
 }
 
 bool AVoxelVolume::GetLodOrigin(FVector& OutLocation)
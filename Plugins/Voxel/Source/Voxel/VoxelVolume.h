@@ -1,15 +1,57 @@
-
 #pragma once
 
 #include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
 #include "RealtimeMeshActor.h"
 #include "RealtimeMeshLibrary.h"
 #include "RealtimeMeshSimple.h"
 
+#include "VoxelEdit/VoxelEditLayer.h"
+#include "VoxelEdit/VoxelEditOctree.h"
+#include "VoxelEdit/VoxelEditRegionStore.h"
+#include "VoxelChunk/VoxelCollisionDemand.h"
+#include "VoxelQuery/VoxelDensityQuery.h"
+
 #include "VoxelVolume.generated.h"
 
 class UBoxComponent;
 struct FVoxelChunkNode;
+struct FVoxelMeshParams;
+struct FVoxelTransitionMesh;
+struct FArray3DLinearLayout;
+template<typename InElementType, typename InLayoutType> struct FArray3D;
+
+/* Algorithm chunks are meshed with */
+UENUM(BlueprintType)
+enum class EVoxelMesher : uint8
+{
+	// Up to five triangles per cell, vertices are not shared
+	MarchingCubes,
+	// One shared vertex per active cell and a quad per crossed edge, smoother and lighter
+	SurfaceNets
+};
+
+/* Storage format of sampled density grids */
+UENUM(BlueprintType)
+enum class EVoxelDensityFormat : uint8
+{
+	// 8 bytes per sample, exact
+	Double,
+	// 2 bytes per sample, quantized relative to the surface in 1/2047 voxel steps
+	Int16,
+	// 1 byte per sample, quantized relative to the surface in 1/63 voxel steps
+	Int8
+};
+
+/* Streams chunk meshes are uploaded with */
+UENUM(BlueprintType)
+enum class EVoxelVertexLayout : uint8
+{
+	// Position, tangents, texcoords and colors per vertex, 32 bit indices and a polygroup per triangle
+	Full,
+	// Leaves out the unused colors, keeps materials as one segment each, chunks under 65536 vertices get 16 bit indices
+	Lean
+};
 
 UCLASS()
 class VOXEL_API AVoxelVolume : public ARealtimeMeshActor
@@ -23,19 +65,119 @@ protected:
 	virtual void BeginPlay() override;
 	virtual void OnConstruction(const FTransform& Transform) override;
 	virtual void TickActor(float DeltaTime, ELevelTick TickType, FActorTickFunction& ThisTickFunction) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	virtual void OnGenerateMesh_Implementation() override;
 	void UpdateVolume();
 
+	// Voxels past its box a chunk reads samples at, the transition cells take their coarse normals up to four past a face
+	static constexpr int ChunkSampleReach = 4;
+
+	/* Meshes a leaf chunk into its section group, creating, updating or removing the group depending on what it generates */
+	void UpdateChunkSection(URealtimeMeshSimple* InRealtimeMesh, FVoxelChunkNode* InChunk);
+
+	/* Sets every section of the chunk to the materials it was last meshed with, colliding if ShouldChunkCollide */
+	void UpdateChunkSectionConfigs(URealtimeMeshSimple* InRealtimeMesh, FVoxelChunkNode* InChunk);
+
+	/* Whether the chunk's sections collide, around the consumers or within CollisionInverseDepth of the deepest chunks */
+	bool ShouldChunkCollide(const FVoxelChunkNode* InChunk) const;
+
+	/* Whether chunks are meshed for collision only, when asked to or when nothing can render such as on a dedicated server */
+	bool IsCollisionOnly() const;
+
+	/* Moves collision to the chunks the consumers overlap, dropping it from those they left and cooking at most MaxCollisionCooksPerTick new ones */
+	void UpdateCollisionDemand(URealtimeMeshSimple* InRealtimeMesh);
+
+	/* Leaf chunk containing InLocation, nullptr outside the volume */
+	const FVoxelChunkNode* FindLeafChunk(const FVector& InLocation) const;
+
+	/* Faces of the chunk bordering a leaf one depth coarser, which get transition cells when meshed */
+	uint8 GetTransitionFaces(const FVoxelChunkNode* InChunk) const;
+
 	/* Generates mesh to the streamset, returns true if any triangles were generated */
 	bool GenerateChunkMesh(FVoxelChunkNode* InChunk, FRealtimeMeshStreamSet& OutStreamSet);
 
+	/* Fills OutDensityValues with the density at each corner of the chunk plus InApron corners past every face, and OutMaterialIds with their material if set */
+	void SampleChunkDensity(FVoxelChunkNode* InChunk, int InApron, FArray3D<double, FArray3DLinearLayout>& OutDensityValues, FArray3D<uint8, FArray3DLinearLayout>* OutMaterialIds = nullptr);
+
+	/*
+	 * Fills OutPlane with the (y, z) densities of x plane InX of the chunk grid with InApron extra corners per side, z fastest.
+	 * OutMaterialPlane gets the material ids of the same corners unless it is empty.
+	 */
+	void SampleChunkDensityPlane(FVoxelChunkNode* InChunk, int InX, int InApron, TArrayView<double> OutPlane, TArrayView<uint8> OutMaterialPlane = TArrayView<uint8>());
+
+	/* Samples the chunk into a grid of InSampleType, quantizing if it is an integer type, and meshes it with the selected mesher */
+	template<typename InSampleType>
+	bool GenerateChunkMeshFromGrid(FVoxelChunkNode* InChunk, const FVoxelMeshParams& InParams, FRealtimeMeshStreamSet& OutStreamSet);
+
+	/* Builds the transition cells of InParams.TransitionFaces, sampled the way the chunk and its coarser neighbours sample their grids */
+	template<typename InSampleType>
+	void BuildChunkTransitionMesh(FVoxelChunkNode* InChunk, const FVoxelMeshParams& InParams, FVoxelTransitionMesh& OutMesh);
+
+	/* Density at InLocation, a corner of the finest voxels, with the strokes baked in. OutMaterialId gets its material if set */
+	double SampleDensity(const FVector& InLocation, uint8* OutMaterialId = nullptr) const;
+
+	/* Density at InLocation interpolated between the corners of the finest voxels around it, the field the finest chunks mesh */
+	double SampleInterpolatedDensity(const FVector& InLocation) const;
+
+	/* Size of the finest voxels, those of chunks at MaxDepth and of the edit lattice */
+	double GetFinestVoxelSize() const
+	{
+		return VolumeExtent * 2 / (ChunkResolution << MaxDepth);
+	}
+
+	/* Procedural density at InLocation beneath the strokes, OutMaterialId gets its material if set */
+	double SampleBaseDensity(const FVector& InLocation, uint8* OutMaterialId = nullptr) const;
+
+	/*
+	 * Sizes EditOctree for the finest voxels of the current extent, resolution and depth, carrying its edits over if the voxels keep
+	 * their size. With EditSaveName set the saved regions load in the background instead.
+	 */
+	void InitEditOctree();
+
+	/* Marks the strokes' bounds dirty and bakes them into EditOctree together, they are meshed on the next update */
+	void AddEdits(TConstArrayView<FVoxelEdit> InEdits);
+
+	/* Bakes strokes into EditOctree in one pass, their chunks are saved with the next SaveEdits */
+	void BakeEdits(TConstArrayView<FVoxelEdit> InEdits);
+
+	// Lattice points along the edge of the chunks edits are saved in
+	static constexpr int32 EditChunkSize = 32;
+
+	/* Lattice points along the edge of the chunks edits are saved and carried over in, no larger than EditOctree's root */
+	int32 GetEditChunkSize() const
+	{
+		return FMath::Min(EditChunkSize, EditOctree.GetRootSize());
+	}
+
+	/* Box of actor space edit chunk InChunk holds */
+	FBox GetEditChunkBounds(const FIntVector& InChunk) const;
+
+	/* Loads the edit chunks of the regions read since the last update, bakes the deferred strokes once every region is in */
+	void ApplyLoadedEdits();
+
+	/* Queues the edit chunks changed since the last save and starts writing them, if EditStore is set */
+	void SaveEdits();
+
 	/* Simple signed distance field for a sphere */
 	static double SDFSphere(const FVector& InLocation, double InRadius)
 	{
 		return InLocation.Length() / InRadius;
 	};
 
+	/* Material id at InLocation, NumMaterials bands from the sphere's equator up to its poles */
+	uint8 GetMaterialId(const FVector& InLocation) const
+	{
+		const double latitude = FMath::Abs(InLocation.Z) / FMath::Max(InLocation.Length(), UE_SMALL_NUMBER);
+		return (uint8)FMath::Min((int)(latitude * NumMaterials), NumMaterials - 1);
+	};
+
+	/* Density change across one voxel of InVoxelSize, SDFSphere is normalized to the volume extent */
+	double GetDensityPerVoxel(double InVoxelSize) const
+	{
+		return InVoxelSize / VolumeExtent;
+	};
+
 	/* Get origin for lod calculations, usually player pawn location */
 	bool GetLodOrigin(FVector& OutLocation);
 
@@ -55,8 +197,87 @@ protected:
 	// Base node for the chunk octree
 	FVoxelChunkNode* RootNode = nullptr;
 
+	// Bounds of the brush strokes made since the last update
+	FVoxelEditLayer EditLayer;
+
+	// The strokes baked at the finest voxels, what chunks sample
+	FVoxelEditOctree EditOctree;
+
+	// Taken to write EditOctree, and by queries to read it from other threads, meshing reads it on the game thread that writes it
+	mutable FRWLock EditOctreeLock;
+
+	// Region files EditOctree is saved to, null unless EditSaveName is set
+	TSharedPtr<FVoxelEditRegionStore, ESPMode::ThreadSafe> EditStore;
+
+	// Regions being read into EditOctree
+	TArray<TFuture<TArray<FVoxelEditRegionChunk>>> PendingRegionLoads;
+
+	// Strokes made while regions load, baked on top of them once they are all in
+	TArray<FVoxelEdit> DeferredEdits;
+
+	// Edit chunks changed since the last save
+	TSet<FIntVector> UnsavedEditChunks;
+
+	float EditSaveTimer = 0;
+
+	// Actors chunks collide around with bCollisionAroundConsumers
+	TArray<TWeakObjectPtr<AActor>> CollisionConsumers;
+
+	// Chunks the consumers overlap and which of them collide
+	FVoxelCollisionDemand CollisionDemand;
+
 public:
 
+	/* Chunks around InActor get collision while it is registered, with bCollisionAroundConsumers. Destroyed actors unregister themselves */
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Collision")
+	void RegisterCollisionConsumer(AActor* InActor);
+
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Collision")
+	void UnregisterCollisionConsumer(AActor* InActor);
+
+	/* Digs out or fills a sphere at InCenter (actor space), blended over InSmoothness. Strokes made in one frame are meshed together on the next tick */
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Edit")
+	void EditSphere(const FVector& InCenter, double InRadius, EVoxelEditOperation InOperation, double InSmoothness = 0, uint8 InMaterialId = 0);
+
+	/* Digs out or fills a box of half size InExtent at InCenter (actor space), blended over InSmoothness */
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Edit")
+	void EditBox(const FVector& InCenter, const FVector& InExtent, EVoxelEditOperation InOperation, double InSmoothness = 0, uint8 InMaterialId = 0);
+
+	/*
+	 * Applies the strokes of an edit log (FVoxelEditLogWriter) from Ar's position, as received from a peer or replayed at startup.
+	 * They are baked in one pass and meshed together on the next tick, returns how many were read.
+	 */
+	int32 ApplyEditLog(FArchive& Ar);
+
+	/* Removes every stroke, back to the procedural density, the saved ones included */
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Edit")
+	void ClearEdits();
+
+	/*
+	 * Density at InLocation (actor space) with the strokes baked in, below SurfaceIsovalue inside. It is interpolated as the
+	 * finest chunks mesh it, queries need no chunk meshed or collision cooked.
+	 * Queries can run on any thread at once, strokes are baked while none of them reads.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Query")
+	double GetDensity(const FVector& InLocation) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Query")
+	bool IsSolid(const FVector& InLocation) const;
+
+	/* GetDensity at each of InLocations, taking the lock once */
+	void GetDensityBatch(TConstArrayView<FVector> InLocations, TArrayView<double> OutDensities) const;
+
+	/* IsSolid at each of InLocations, taking the lock once */
+	void IsSolidBatch(TConstArrayView<FVector> InLocations, TArrayView<bool> OutSolid) const;
+
+	/* First point from InStart to InEnd (actor space) in the solid, sphere traced on the density, see FVoxelDensityQuery */
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Query")
+	bool Raycast(const FVector& InStart, const FVector& InEnd, FVoxelRaycastHit& OutHit) const;
+
+	/* Whether any solid lies within InRadius of InCenter (actor space) */
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Query")
+	bool SphereOverlap(const FVector& InCenter, double InRadius) const;
+
 	// Simple bounding box visual for the editor 
 	UPROPERTY(BlueprintReadOnly)
 	TObjectPtr<UBoxComponent> BoundingBox;
@@ -73,6 +294,36 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel")
 	uint8 MaxDepth = 7;
 
+	// Algorithm chunks are meshed with
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Meshing")
+	EVoxelMesher Mesher = EVoxelMesher::MarchingCubes;
+
+	// Fully unroll the per cell corner and edge loops of the marching cubes kernels
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Meshing")
+	bool bUnrollMeshingLoops = false;
+
+	// Chunk resolution from which chunks are meshed slab by slab (marching cubes only), keeping two planes of densities resident instead of the whole grid.
+	// Slabs are always sampled as doubles, DensityFormat only applies below this resolution
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Meshing", Meta = (ClampMin = "1"))
+	int SlabMeshingMinResolution = 64;
+
+	// Format density grids are sampled into before meshing, quantized formats use 4-8x less memory per chunk.
+	// Not read by chunks meshed slab by slab (SlabMeshingMinResolution), which only hold a few planes and keep them as doubles
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Meshing")
+	EVoxelDensityFormat DensityFormat = EVoxelDensityFormat::Double;
+
+	// Streams chunk meshes are built with, the lean layout takes about a third less memory per chunk
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Meshing")
+	EVoxelVertexLayout VertexLayout = EVoxelVertexLayout::Full;
+
+	// Close the seams between chunks and neighbours one depth coarser with transition cells (marching cubes, even chunk resolutions)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Meshing")
+	bool bTransitionCells = true;
+
+	// Fraction of a voxel the cells along a transition face give up to the transition cells
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Meshing", Meta = (ClampMin = "0.05", ClampMax = "0.95", EditCondition = "bTransitionCells"))
+	float TransitionCellWidth = 0.5f;
+
 	// Factor for chunk render distance
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel")
 	float LodFactor = 1.f;
@@ -82,10 +333,50 @@ public:
 	double SurfaceIsovalue = 1.0;
 
 	// Chunk depth, from most detailed, to create collision for
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel")
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel", Meta = (EditCondition = "!bCollisionAroundConsumers"))
 	uint8 CollisionInverseDepth = 3;
+
+	// Only chunks overlapping the registered collision consumers collide, at any depth, instead of every chunk within CollisionInverseDepth
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Collision")
+	bool bCollisionAroundConsumers = false;
+
+	// Distance the bounds of a consumer are grown by before looking for the chunks it overlaps
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Collision", Meta = (ClampMin = "0", EditCondition = "bCollisionAroundConsumers"))
+	double CollisionConsumerMargin = 500;
+
+	// Seconds of a consumer's velocity its bounds are swept along, so fast movers find their chunks cooked
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Collision", Meta = (ClampMin = "0", EditCondition = "bCollisionAroundConsumers"))
+	float CollisionLeadTime = 0.5f;
+
+	// Chunks that start cooking collision per tick, the rest wait their turn in the order consumers reached them
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Collision", Meta = (ClampMin = "1", EditCondition = "bCollisionAroundConsumers"))
+	int32 MaxCollisionCooksPerTick = 8;
+
+	// Chunks keep their cooked collision in Saved/RealtimeMeshCollision, generating the same terrain again loads it instead of cooking
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Collision")
+	bool bCacheCookedCollision = true;
+
+	// Chunks whose triangles an edit kept, such as a light smoothing stroke, move the vertices of their cooked collision instead of cooking it again
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Collision")
+	bool bRefitCollision = false;
+
+	// Chunks are never drawn, only those that collide are meshed and only with positions and triangles. Always on where nothing renders, like a dedicated server
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Collision")
+	bool bCollisionOnly = false;
 	
-	// Number of materials to use
+	// Name edits are saved under in Saved/VoxelEdits and loaded from when the volume is generated, empty to keep them for the session only
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Edit")
+	FString EditSaveName;
+
+	// Seconds between saves of the chunks edits changed, each save writes every region it touches once in the background
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Edit", Meta = (ClampMin = "0"))
+	float EditSaveInterval = 2.f;
+
+	// Compression of the saved edit chunks
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Edit")
+	EVoxelEditCompression EditCompression = EVoxelEditCompression::LZ4;
+
+	// Number of materials to use, chunks get one section per material their surface crosses
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel", Meta = (ClampMin = "1"))
 	uint8 NumMaterials = 1;
 };
\ No newline at end of file
@@ -0,0 +1,157 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+
+#include "VoxelUtilities/Array3D.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelArray3DLayoutBenchmark, "Voxel.Benchmarks.Array3DLayouts",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+namespace Array3DLayoutBenchmark
+{
+	static constexpr int32 GridSize = 64;
+	static constexpr int32 NumPasses = 8;
+	static constexpr int32 NumRandomReads = GridSize * GridSize * GridSize;
+
+	/* Runs InFunc NumPasses times and returns the best time in milliseconds */
+	template<typename FuncType>
+	double TimeBest(FuncType&& InFunc)
+	{
+		double best = TNumericLimits<double>::Max();
+		for (int32 pass = 0; pass < NumPasses; pass++)
+		{
+			const double start = FPlatformTime::Seconds();
+			InFunc();
+			best = FMath::Min(best, FPlatformTime::Seconds() - start);
+		}
+
+		return best * 1000.0;
+	}
+
+	template<typename LayoutType>
+	void Run(FAutomationTestBase& InTest, const TCHAR* InLayoutName, const TArray<FIntVector>& InRandomCoords)
+	{
+		FArray3D<float, LayoutType> grid(FIntVector(GridSize), NoInit);
+		grid.ForEachElement([](int32 InX, int32 InY, int32 InZ, float& OutValue)
+		{
+			OutValue = FMath::Sin(InX * 0.1f) + FMath::Cos(InY * 0.2f) * InZ;
+		});
+
+		const auto view = grid.GetView();
+		double sink = 0;
+
+		const double fillMs = TimeBest([&]() { grid.Fill(1.0f); });
+
+		grid.ForEachElement([](int32 InX, int32 InY, int32 InZ, float& OutValue)
+		{
+			OutValue = FMath::Sin(InX * 0.1f) + FMath::Cos(InY * 0.2f) * InZ;
+		});
+
+		const double sweepMs = TimeBest([&]()
+		{
+			double sum = 0;
+			grid.ForEachElement([&sum](int32, int32, int32, const float& InValue) { sum += InValue; });
+			sink += sum;
+		});
+
+		// Central difference gradient, the access pattern of normal estimation
+		const double stencilMs = TimeBest([&]()
+		{
+			double sum = 0;
+			for (int32 x = 1; x < GridSize - 1; x++)
+			{
+				for (int32 y = 1; y < GridSize - 1; y++)
+				{
+					for (int32 z = 1; z < GridSize - 1; z++)
+					{
+						sum += view(x + 1, y, z) - view(x - 1, y, z)
+							+ view(x, y + 1, z) - view(x, y - 1, z)
+							+ view(x, y, z + 1) - view(x, y, z - 1);
+					}
+				}
+			}
+			sink += sum;
+		});
+
+		// Eight corners per cell, the access pattern of the marching cubes classification
+		const double cubeMs = TimeBest([&]()
+		{
+			double sum = 0;
+			for (int32 x = 0; x < GridSize - 1; x++)
+			{
+				for (int32 y = 0; y < GridSize - 1; y++)
+				{
+					for (int32 z = 0; z < GridSize - 1; z++)
+					{
+						for (int32 i = 0; i < 8; i++)
+						{
+							sum += view(x + (i & 1), y + (i >> 1 & 1), z + (i >> 2));
+						}
+					}
+				}
+			}
+			sink += sum;
+		});
+
+		const double randomMs = TimeBest([&]()
+		{
+			double sum = 0;
+			for (const FIntVector& coord : InRandomCoords)
+			{
+				sum += view[coord];
+			}
+			sink += sum;
+		});
+
+		InTest.AddInfo(FString::Printf(
+			TEXT("%-8s storage %7d  fill %6.3f ms  sweep %6.3f ms  6-neighbour %6.3f ms  8-corner %6.3f ms  random %6.3f ms  (%g)"),
+			InLayoutName, grid.GetStorageNum(), fillMs, sweepMs, stencilMs, cubeMs, randomMs, sink
+		));
+	}
+}
+
+bool FVoxelArray3DLayoutBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace Array3DLayoutBenchmark;
+
+	FRandomStream random(1337);
+	TArray<FIntVector> randomCoords;
+	randomCoords.Reserve(NumRandomReads);
+	for (int32 i = 0; i < NumRandomReads; i++)
+	{
+		randomCoords.Add(FIntVector(random.RandHelper(GridSize), random.RandHelper(GridSize), random.RandHelper(GridSize)));
+	}
+
+	AddInfo(FString::Printf(TEXT("%d^3 float grid, best of %d passes"), GridSize, NumPasses));
+
+	Run<FArray3DLinearLayout>(*this, TEXT("Linear"), randomCoords);
+	Run<FArray3DBrick4Layout>(*this, TEXT("Brick4"), randomCoords);
+	Run<FArray3DBrick8Layout>(*this, TEXT("Brick8"), randomCoords);
+	Run<FArray3DMortonLayout>(*this, TEXT("Morton"), randomCoords);
+
+	// Index mapping must round trip for every layout, also on sizes that need padding
+	for (const FIntVector& size3D : { FIntVector(GridSize), FIntVector(GridSize + 1), FIntVector(5, 9, 17) })
+	{
+		FArray3D<int32, FArray3DBrick4Layout> bricked(size3D, -1);
+		FArray3D<int32, FArray3DMortonLayout> morton(size3D, -1);
+
+		int32 numBricked = 0;
+		bricked.ForEachIndex([&](int32 InX, int32 InY, int32 InZ, int32 InIndex)
+		{
+			numBricked += bricked.GetIndex3D(InIndex) == FIntVector(InX, InY, InZ);
+		});
+
+		int32 numMorton = 0;
+		morton.ForEachIndex([&](int32 InX, int32 InY, int32 InZ, int32 InIndex)
+		{
+			numMorton += morton.GetIndex3D(InIndex) == FIntVector(InX, InY, InZ);
+		});
+
+		TestEqual(TEXT("Bricked layout round trips"), numBricked, bricked.GetSizeTotal());
+		TestEqual(TEXT("Morton layout round trips"), numMorton, morton.GetSizeTotal());
+	}
+
+	return true;
+}
@@ -0,0 +1,122 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "RealtimeMeshSimple.h"
+
+#include "VoxelMesher/VoxelSurfaceNets.h"
+#include "VoxelUtilities/Array3D.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelCollisionBenchmark, "Voxel.Benchmarks.Collision",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+using namespace RealtimeMesh;
+
+namespace VoxelCollisionBenchmark
+{
+	static constexpr int32 Resolution = 16;
+	static constexpr int32 NumChunks = 512;
+	static constexpr int32 NumMaterials = 4;
+
+	/* Sphere filling most of the chunk, banded into materials by height so every chunk has one section per material */
+	void MeshChunk(FRealtimeMeshStreamSet& OutStreamSet)
+	{
+		const int32 apron = FVoxelSurfaceNets::Apron;
+		const FIntVector size(Resolution + 1 + apron * 2);
+		const double radius = Resolution * 0.4;
+
+		FArray3D<double> grid(size, NoInit);
+		FArray3D<uint8> materialIds(size, NoInit);
+		grid.ForEachElement([&](int32 InX, int32 InY, int32 InZ, double& OutDensity)
+		{
+			const FVector location = FVector(InX, InY, InZ) - (apron + Resolution * 0.5);
+			OutDensity = location.Length() / radius;
+			materialIds(InX, InY, InZ) = (uint8)FMath::Clamp((int32)((location.Z / radius * 0.5 + 0.5) * NumMaterials), 0, NumMaterials - 1);
+		});
+
+		FVoxelMeshParams params;
+		params.ChunkOrigin = FVector3f::ZeroVector;
+		params.VoxelSize = 1.0;
+		params.SurfaceIsovalue = 1.0;
+		params.Resolution = Resolution;
+		params.MaterialIds = &materialIds;
+
+		FVoxelSurfaceNets::GenerateMesh(grid, params, OutStreamSet);
+		FinalizeVoxelMeshStreams(params, OutStreamSet);
+	}
+
+	struct FResult
+	{
+		int32 NumVertices = 0;
+		int32 NumTriangles = 0;
+		double TimeMs = 0;
+	};
+
+	FResult Generate(FRealtimeMeshSimple& InMesh)
+	{
+		FRealtimeMeshTriMeshData collisionData;
+
+		const double start = FPlatformTime::Seconds();
+		InMesh.GenerateCollisionMesh(collisionData);
+
+		FResult result;
+		result.TimeMs = (FPlatformTime::Seconds() - start) * 1000.0;
+		result.NumVertices = collisionData.GetVertices().Num();
+		result.NumTriangles = collisionData.GetTriangles().Num();
+		return result;
+	}
+}
+
+bool FVoxelCollisionBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace VoxelCollisionBenchmark;
+
+	FRealtimeMeshStreamSet chunkStreams;
+	MeshChunk(chunkStreams);
+	const int32 chunkTriangles = chunkStreams.FindChecked(FRealtimeMeshStreams::Triangles).Num();
+
+	TArray<uint16> materials;
+	GetVoxelMeshMaterials(chunkStreams, materials);
+
+	// One section group per chunk with a collision section per material, as AVoxelVolume::UpdateChunkMesh sets them up
+	URealtimeMeshSimple* realtimeMesh = NewObject<URealtimeMeshSimple>(GetTransientPackage());
+	TArray<FRealtimeMeshSectionGroupKey> chunkKeys;
+	for (int32 i = 0; i < NumChunks; i++)
+	{
+		const FRealtimeMeshSectionGroupKey& chunkKey = chunkKeys.Add_GetRef(FRealtimeMeshSectionGroupKey::Create(0, FName("Chunk", i)));
+		realtimeMesh->CreateSectionGroup(chunkKey, chunkStreams);
+
+		for (const uint16 material : materials)
+		{
+			realtimeMesh->UpdateSectionConfig(FRealtimeMeshSectionKey::CreateForPolyGroup(chunkKey, material),
+				FRealtimeMeshSectionConfig(ERealtimeMeshSectionDrawType::Static, material), true);
+		}
+	}
+
+	FRealtimeMeshSimple& meshData = *realtimeMesh->GetMeshData();
+
+	// The first update copies every section, as every update did before sections kept their collision mesh.
+	// Sections build and copy across the task graph workers, so this one scales with cores
+	const FResult cold = Generate(meshData);
+
+	// Nothing changed, every section reuses its block
+	const FResult warm = Generate(meshData);
+
+	// An edit remeshes one chunk, only its sections copy their streams again
+	realtimeMesh->UpdateSectionGroup(chunkKeys[NumChunks / 2], chunkStreams);
+	const FResult edited = Generate(meshData);
+
+	AddInfo(FString::Printf(
+		TEXT("%d chunks, %d collision sections, %d workers | %d tris %d verts | every section %7.2f ms | none changed %7.2f ms | one chunk changed %7.2f ms"),
+		NumChunks, NumChunks * materials.Num(), FTaskGraphInterface::Get().GetNumWorkerThreads(), cold.NumTriangles, cold.NumVertices,
+		cold.TimeMs, warm.TimeMs, edited.TimeMs
+	));
+
+	TestTrue(TEXT("Every chunk has a section per material"), materials.Num() == NumMaterials);
+	TestEqual(TEXT("Each section only collides with its own triangles"), cold.NumTriangles, chunkTriangles * NumChunks);
+	TestTrue(TEXT("Cached blocks concatenate to the same mesh"), warm.NumTriangles == cold.NumTriangles && warm.NumVertices == cold.NumVertices);
+	TestTrue(TEXT("A remeshed chunk concatenates to the same mesh"), edited.NumTriangles == cold.NumTriangles && edited.NumVertices == cold.NumVertices);
+
+	return true;
+}
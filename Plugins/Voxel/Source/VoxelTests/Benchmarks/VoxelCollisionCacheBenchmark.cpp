@@ -0,0 +1,154 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/Paths.h"
+#include "RealtimeMeshCollisionCache.h"
+
+#include "VoxelCollisionFixtures.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelCollisionCacheBenchmark, "Voxel.Benchmarks.CollisionCache",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+using namespace RealtimeMesh;
+
+namespace VoxelCollisionCacheBenchmark
+{
+	static constexpr int32 Resolution = 32;
+	static constexpr int32 NumChunks = 32;
+
+	/* Rolling hills offset per chunk, so every chunk meshes different triangles */
+	void SampleGrid(int32 InChunk, FArray3D<double>& OutGrid)
+	{
+		const int32 apron = FVoxelSurfaceNets::Apron;
+		OutGrid.Init(FIntVector(FVoxelSurfaceNets::GetGridEdgeCount(Resolution)), NoInit);
+		OutGrid.ForEachElement([&](int32 InX, int32 InY, int32 InZ, double& OutDensity)
+		{
+			const double x = InX - apron + InChunk * Resolution;
+			const double y = InY - apron;
+			const double height = Resolution * 0.5 + 4.0 * FMath::Sin(x * 0.2) * FMath::Cos(y * 0.15);
+			OutDensity = 1.0 + (InZ - apron - height) / Resolution;
+		});
+	}
+
+	/* Collision triangles of chunk InChunk */
+	void GenerateTriMesh(int32 InChunk, FRealtimeMeshTriMeshData& OutTriMeshData)
+	{
+		FArray3D<double> grid;
+		SampleGrid(InChunk, grid);
+
+		VoxelCollisionFixtures::GenerateTriMesh(grid, Resolution, OutTriMeshData);
+	}
+
+	struct FPass
+	{
+		int32 NumCooks = 0;
+		int32 NumCooked = 0;
+		double Ms = 0;
+	};
+
+	/* Gives every chunk its collision, from InCache when it has it and cooking and storing it otherwise */
+	FPass Run(FRealtimeMeshCollisionCache& InCache, TConstArrayView<FRealtimeMeshTriMeshData> InTriMeshes)
+	{
+		FPass pass;
+		const double start = FPlatformTime::Seconds();
+		for (const FRealtimeMeshTriMeshData& triMeshData : InTriMeshes)
+		{
+			UBodySetup* bodySetup = VoxelCollisionFixtures::CreateBodySetup(triMeshData);
+			const FSHAHash hash = FRealtimeMeshCollisionCache::HashTriMeshData(triMeshData, false);
+			if (!InCache.Load(hash, bodySetup))
+			{
+				bodySetup->CreatePhysicsMeshes();
+				InCache.Store(hash, bodySetup);
+				pass.NumCooks++;
+			}
+			pass.NumCooked += bodySetup->TriMeshGeometries.Num() == 1 ? 1 : 0;
+		}
+		pass.Ms = (FPlatformTime::Seconds() - start) * 1000.0;
+
+		InCache.WaitForWrites();
+		return pass;
+	}
+
+	/* LoadAsync on InHash, running the game thread's tasks until it calls back, false if it never does */
+	bool LoadAsync(FRealtimeMeshCollisionCache& InCache, const FSHAHash& InHash, UBodySetup* InBodySetup, bool& bOutLoaded)
+	{
+		bool bCalled = false;
+		InCache.LoadAsync(InHash, InBodySetup, [&](bool bInLoaded)
+		{
+			bOutLoaded = bInLoaded;
+			bCalled = true;
+		});
+
+		const double timeout = FPlatformTime::Seconds() + 10.0;
+		while (!bCalled && FPlatformTime::Seconds() < timeout)
+		{
+			FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+			FPlatformProcess::Sleep(0.001f);
+		}
+		return bCalled;
+	}
+}
+
+bool FVoxelCollisionCacheBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace VoxelCollisionCacheBenchmark;
+
+	TArray<FRealtimeMeshTriMeshData> triMeshes;
+	triMeshes.SetNum(NumChunks);
+	for (int32 i = 0; i < NumChunks; i++)
+	{
+		GenerateTriMesh(i, triMeshes[i]);
+	}
+
+	const FString directory = FPaths::AutomationTransientDir() / TEXT("VoxelCollisionCache");
+
+	FPass cold;
+	{
+		FRealtimeMeshCollisionCache cache(directory);
+		cache.Clear();
+		cold = Run(cache, triMeshes);
+	}
+
+	// A new cache over the same directory is a later session revisiting the same terrain
+	FRealtimeMeshCollisionCache cache(directory);
+	const int32 numFiles = cache.Num();
+	const int64 size = cache.GetSize();
+	const FPass warm = Run(cache, triMeshes);
+
+	AddInfo(FString::Printf(TEXT("%d chunks, %lld KB cached | cold %d cooks %8.2f ms | warm %d cooks %8.2f ms"),
+		NumChunks, size / 1024, cold.NumCooks, cold.Ms, warm.NumCooks, warm.Ms));
+
+	TestEqual(TEXT("Every chunk cooks when the cache is cold"), cold.NumCooks, NumChunks);
+	TestEqual(TEXT("Every chunk is written to the cache"), numFiles, NumChunks);
+	TestEqual(TEXT("No chunk cooks when the cache is warm"), warm.NumCooks, 0);
+	TestEqual(TEXT("Every chunk loads a cooked trimesh"), warm.NumCooked, NumChunks);
+
+	// Halving the limit evicts the chunks used longest ago, touch the first one so it is the most recent
+	const FSHAHash firstHash = FRealtimeMeshCollisionCache::HashTriMeshData(triMeshes[0], false);
+	cache.Load(firstHash, VoxelCollisionFixtures::CreateBodySetup(triMeshes[0]));
+	cache.SetMaxSize(size / 2);
+
+	TestTrue(TEXT("Eviction brings the cache under its limit"), cache.GetSize() <= size / 2);
+	TestTrue(TEXT("Eviction drops some chunks"), cache.Num() < NumChunks);
+	TestTrue(TEXT("The most recently used chunk survives eviction"), cache.Load(firstHash, VoxelCollisionFixtures::CreateBodySetup(triMeshes[0])));
+
+	// The async load reads on the thread pool and hands the body setup its meshes back on the game thread
+	UBodySetup* asyncBodySetup = VoxelCollisionFixtures::CreateBodySetup(triMeshes[0]);
+	bool bAsyncLoaded = false;
+	TestTrue(TEXT("An async load calls back on the game thread"), LoadAsync(cache, firstHash, asyncBodySetup, bAsyncLoaded));
+	TestTrue(TEXT("An async load of a cached chunk hits"), bAsyncLoaded);
+	TestEqual(TEXT("An async load gives the body setup its cooked trimesh"), asyncBodySetup->TriMeshGeometries.Num(), 1);
+
+	// The fast cook flag is hashed, and no chunk was cooked with it
+	UBodySetup* missBodySetup = VoxelCollisionFixtures::CreateBodySetup(triMeshes[0]);
+	bool bMissLoaded = true;
+	TestTrue(TEXT("An async miss calls back on the game thread"), LoadAsync(cache, FRealtimeMeshCollisionCache::HashTriMeshData(triMeshes[0], true), missBodySetup, bMissLoaded));
+	TestFalse(TEXT("An async load of an uncached chunk misses"), bMissLoaded);
+	TestEqual(TEXT("An async miss leaves the body setup alone"), missBodySetup->TriMeshGeometries.Num(), 0);
+
+	cache.Clear();
+	return true;
+}
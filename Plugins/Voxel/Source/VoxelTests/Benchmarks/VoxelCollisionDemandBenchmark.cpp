@@ -0,0 +1,215 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+
+#include "VoxelBenchmarkFixtures.h"
+#include "VoxelCollisionFixtures.h"
+#include "VoxelChunk/VoxelChunkNode.h"
+#include "VoxelChunk/VoxelCollisionDemand.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelCollisionDemandBenchmark, "Voxel.Benchmarks.CollisionDemand",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+using namespace RealtimeMesh;
+
+namespace VoxelCollisionDemandBenchmark
+{
+	static constexpr double VolumeExtent = 524288;
+	static constexpr int32 MaxDepth = 7;
+	static constexpr int32 CollisionInverseDepth = 3;
+	static constexpr int32 MaxCooksPerUpdate = 8;
+	static constexpr double ConsumerExtent = 500;
+	static constexpr int32 ChunkResolution = 8;
+
+	/* Subdivides around InLodCenter the way AVoxelVolume::RechunkToCenter does, every leaf is meshed */
+	void Subdivide(FVoxelChunkNode* InNode, const FVector& InLodCenter, int16& InOutSectionID)
+	{
+		if (InNode->Depth == MaxDepth || !InNode->IsWithinReach(InLodCenter, VolumeExtent, 1.f))
+		{
+			InNode->SetLeaf(true);
+			InNode->SectionID = InOutSectionID++;
+			return;
+		}
+
+		for (int32 i = 0; i < 8; i++)
+		{
+			InNode->Children[i] = new FVoxelChunkNode(InNode->Depth + 1, InNode->GetChildCenter(i, VolumeExtent));
+			Subdivide(InNode->Children[i], InLodCenter, InOutSectionID);
+		}
+	}
+
+	/* Consumers scattered within InSpread of InCenter, a pawn sized box each */
+	TArray<FBox> MakeConsumers(FRandomStream& InRandom, int32 InNum, const FVector& InCenter, double InSpread)
+	{
+		TArray<FBox> consumers;
+		for (int32 i = 0; i < InNum; i++)
+		{
+			const FVector location = InCenter + FVector(InRandom.FRandRange(-InSpread, InSpread), InRandom.FRandRange(-InSpread, InSpread), InRandom.FRandRange(-InSpread, InSpread));
+			consumers.Add(FBox::BuildAABB(location, FVector(ConsumerExtent)));
+		}
+		return consumers;
+	}
+
+	struct FResult
+	{
+		TArray<FVoxelChunkNode*> Cooked;
+		int32 NumWanted = 0;
+		int32 NumUpdates = 0;
+		int32 MaxCooksInUpdate = 0;
+		double UpdateMs = 0;
+	};
+
+	/* Updates until every wanted chunk collides, the way AVoxelVolume::UpdateCollisionDemand runs each tick */
+	FResult Settle(FVoxelCollisionDemand& InDemand, FVoxelChunkNode* InRoot, TConstArrayView<FBox> InConsumers, bool bInMeshOnDemand, int32& OutNumDropped)
+	{
+		FResult result;
+		OutNumDropped = 0;
+
+		do
+		{
+			TArray<FVoxelChunkNode*> dropped;
+			TArray<FVoxelChunkNode*> cooked;
+
+			const double start = FPlatformTime::Seconds();
+			InDemand.Update(InRoot, VolumeExtent, InConsumers, bInMeshOnDemand, dropped);
+			InDemand.Dequeue(MaxCooksPerUpdate, cooked);
+			result.UpdateMs += (FPlatformTime::Seconds() - start) * 1000.0;
+
+			OutNumDropped += dropped.Num();
+			result.Cooked.Append(cooked);
+			result.MaxCooksInUpdate = FMath::Max(result.MaxCooksInUpdate, cooked.Num());
+			result.NumUpdates++;
+		}
+		while (InDemand.NumQueued() > 0);
+
+		result.NumWanted = InDemand.NumColliding();
+		result.UpdateMs /= result.NumUpdates;
+		return result;
+	}
+
+	/* Leaves any of InConsumers overlaps, checked one by one */
+	int32 CountOverlappedLeaves(TConstArrayView<FVoxelChunkNode*> InLeaves, TConstArrayView<FBox> InConsumers)
+	{
+		int32 numOverlapped = 0;
+		for (const FVoxelChunkNode* leaf : InLeaves)
+		{
+			const FBox box = leaf->GetBox(VolumeExtent);
+			numOverlapped += InConsumers.ContainsByPredicate([&](const FBox& InConsumer) { return InConsumer.Intersect(box); }) ? 1 : 0;
+		}
+		return numOverlapped;
+	}
+
+	/* The chunk every leaf is meshed to, a sphere filling most of it */
+	void MeshChunk(FRealtimeMeshStreamSet& OutStreamSet)
+	{
+		const FArray3D<double> grid = VoxelBenchmarkFixtures::SampleSphereGrid(ChunkResolution, FVoxelSurfaceNets::Apron);
+
+		FVoxelMeshParams params;
+		params.ChunkOrigin = FVector3f::ZeroVector;
+		params.VoxelSize = 1.0;
+		params.SurfaceIsovalue = 1.0;
+		params.Resolution = ChunkResolution;
+		params.bLeanLayout = true;
+		params.bCollisionOnly = true;
+
+		FVoxelSurfaceNets::GenerateMesh(grid, params, OutStreamSet);
+		FinalizeVoxelMeshStreams(params, OutStreamSet);
+	}
+}
+
+bool FVoxelCollisionDemandBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace VoxelCollisionDemandBenchmark;
+
+	FRandomStream random(1337);
+	const FVector lodCenter(0, 0, VolumeExtent * 0.5);
+
+	FVoxelChunkNode root;
+	int16 sectionID = 1;
+	Subdivide(&root, lodCenter, sectionID);
+
+	TArray<FVoxelChunkNode*> leaves;
+	root.GetLeaves(leaves);
+
+	// What CollisionInverseDepth cooks, wherever the chunks are
+	int32 numDepthColliding = 0;
+	for (const FVoxelChunkNode* leaf : leaves)
+	{
+		numDepthColliding += MaxDepth - leaf->Depth + 1 <= CollisionInverseDepth ? 1 : 0;
+	}
+
+	AddInfo(FString::Printf(TEXT("%d leaves, %d collide within collision inverse depth %d"), leaves.Num(), numDepthColliding, CollisionInverseDepth));
+
+	bool bMatchesOverlaps = true;
+	bool bBounded = true;
+	for (const int32 numConsumers : { 1, 8, 64 })
+	{
+		const TArray<FBox> consumers = MakeConsumers(random, numConsumers, lodCenter, VolumeExtent / 16);
+
+		FVoxelCollisionDemand demand;
+		int32 numDropped = 0;
+		const FResult arrived = Settle(demand, &root, consumers, false, numDropped);
+
+		// Every consumer leaves the volume
+		int32 numLeftDropped = 0;
+		Settle(demand, &root, TArray<FBox>(), false, numLeftDropped);
+
+		AddInfo(FString::Printf(TEXT("%3d consumers | %5d chunks collide over %3d updates | %7.3f ms per update | %5d dropped when they leave"),
+			numConsumers, arrived.NumWanted, arrived.NumUpdates, arrived.UpdateMs, numLeftDropped));
+
+		bMatchesOverlaps &= arrived.NumWanted == CountOverlappedLeaves(leaves, consumers) && numLeftDropped == arrived.NumWanted && demand.NumColliding() == 0;
+		bBounded &= arrived.MaxCooksInUpdate <= MaxCooksPerUpdate;
+	}
+
+	TestTrue(TEXT("Exactly the chunks the consumers overlap collide, and are dropped once they leave"), bMatchesOverlaps);
+	TestTrue(TEXT("No update starts more cooks than its budget"), bBounded);
+
+	// A collision only volume meshes a leaf once it collides, so no leaf has a section before the demand hands it out
+	for (FVoxelChunkNode* leaf : leaves)
+	{
+		leaf->SectionID = 0;
+	}
+
+	const TArray<FBox> consumers = MakeConsumers(random, 8, lodCenter, VolumeExtent / 16);
+	const int32 numOverlapped = CountOverlappedLeaves(leaves, consumers);
+	int32 numDropped = 0;
+
+	FVoxelCollisionDemand meshedOnlyDemand;
+	const FResult meshedOnly = Settle(meshedOnlyDemand, &root, consumers, false, numDropped);
+
+	FVoxelCollisionDemand onDemand;
+	const FResult meshedOnDemand = Settle(onDemand, &root, consumers, true, numDropped);
+
+	// Each chunk handed out is meshed into a collision only mesh, one section group per chunk as AVoxelVolume::UpdateChunkSection makes them
+	FRealtimeMeshStreamSet chunkStreamSet;
+	MeshChunk(chunkStreamSet);
+
+	URealtimeMeshSimple* realtimeMesh = NewObject<URealtimeMeshSimple>(GetTransientPackage());
+	realtimeMesh->SetCollisionOnly(true);
+	int16 meshedSectionID = 1;
+	for (FVoxelChunkNode* chunk : meshedOnDemand.Cooked)
+	{
+		chunk->SectionID = meshedSectionID++;
+		const FRealtimeMeshSectionGroupKey groupKey = FRealtimeMeshSectionGroupKey::Create(0, chunk->GetSectionName());
+		realtimeMesh->CreateSectionGroup(groupKey, FRealtimeMeshStreamSet(chunkStreamSet));
+		realtimeMesh->UpdateSectionConfig(FRealtimeMeshSectionKey::CreateForPolyGroup(groupKey, 0), FRealtimeMeshSectionConfig(ERealtimeMeshSectionDrawType::Static, 0), true);
+	}
+
+	FRealtimeMeshTriMeshData triMeshData;
+	realtimeMesh->GetMeshData()->GenerateCollisionMesh(triMeshData);
+	const UBodySetup* bodySetup = VoxelCollisionFixtures::Cook(triMeshData);
+
+	AddInfo(FString::Printf(TEXT("Collision only | %5d chunks overlapped | %5d collide gathering meshed leaves | %5d collide meshing on demand, %7d tris"),
+		numOverlapped, meshedOnly.NumWanted, meshedOnDemand.NumWanted, triMeshData.GetTriangles().Num()));
+
+	TestEqual(TEXT("Gathering only meshed leaves never meshes a collision only chunk"), meshedOnly.NumWanted, 0);
+	TestTrue(TEXT("The consumers overlap some chunks"), numOverlapped > 0);
+	TestEqual(TEXT("Meshing on demand collides exactly the chunks the consumers overlap"), meshedOnDemand.NumWanted, numOverlapped);
+	TestEqual(TEXT("Every chunk handed out feeds its triangles to collision"),
+		triMeshData.GetTriangles().Num(), meshedOnDemand.Cooked.Num() * chunkStreamSet.FindChecked(FRealtimeMeshStreams::Triangles).Num());
+	TestTrue(TEXT("The chunks handed out cook a body"), bodySetup->TriMeshGeometries.Num() > 0);
+
+	return true;
+}
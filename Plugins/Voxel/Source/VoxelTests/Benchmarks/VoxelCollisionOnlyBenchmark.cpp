@@ -0,0 +1,138 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "RealtimeMeshSimple.h"
+
+#include "VoxelMesher/VoxelMarchingCubes.h"
+#include "VoxelMesher/VoxelSurfaceNets.h"
+#include "VoxelUtilities/Array3D.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelCollisionOnlyBenchmark, "Voxel.Benchmarks.CollisionOnly",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+using namespace RealtimeMesh;
+
+namespace VoxelCollisionOnlyBenchmark
+{
+	static constexpr int32 Resolution = 32;
+	static constexpr int32 NumRuns = 32;
+
+	/* Rippled sphere filling most of the chunk, sampled InApron corners past every face */
+	FArray3D<double> SampleGrid(int32 InApron)
+	{
+		const double radius = Resolution * 0.4;
+
+		FArray3D<double> grid(FIntVector(Resolution + 1 + InApron * 2), NoInit);
+		grid.ForEachElement([&](int32 InX, int32 InY, int32 InZ, double& OutDensity)
+		{
+			const FVector location = FVector(InX, InY, InZ) - (InApron + Resolution * 0.5);
+			OutDensity = location.Length() / radius + 0.05 * FMath::Sin(location.X * 0.3) * FMath::Cos(location.Y * 0.2);
+		});
+
+		return grid;
+	}
+
+	struct FResult
+	{
+		FRealtimeMeshStreamSet StreamSet;
+		double Ms = 0;
+	};
+
+	/* Meshes InGrid NumRuns times the way AVoxelVolume::GenerateChunkMesh does, keeping the last chunk */
+	FResult Measure(const FArray3D<double>& InGrid, bool bInSurfaceNets, bool bInCollisionOnly)
+	{
+		FVoxelMeshParams params;
+		params.ChunkOrigin = FVector3f::ZeroVector;
+		params.VoxelSize = 1.0;
+		params.SurfaceIsovalue = 1.0;
+		params.Resolution = Resolution;
+		params.bLeanLayout = true;
+		params.bCollisionOnly = bInCollisionOnly;
+
+		FResult result;
+		const double start = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumRuns; i++)
+		{
+			result.StreamSet = FRealtimeMeshStreamSet();
+			if (bInSurfaceNets)
+			{
+				FVoxelSurfaceNets::GenerateMesh(InGrid, params, result.StreamSet);
+			}
+			else
+			{
+				VoxelMarchingCubes::GenerateMesh(InGrid, params, false, result.StreamSet);
+			}
+			FinalizeVoxelMeshStreams(params, result.StreamSet);
+		}
+		result.Ms = (FPlatformTime::Seconds() - start) * 1000.0 / NumRuns;
+		return result;
+	}
+
+	/* Collision triangles of a chunk in a mesh that is or is not collision only, and the bytes of streams it kept */
+	int64 GenerateTriMesh(const FRealtimeMeshStreamSet& InStreamSet, bool bInCollisionOnly, FRealtimeMeshTriMeshData& OutTriMeshData)
+	{
+		URealtimeMeshSimple* realtimeMesh = NewObject<URealtimeMeshSimple>(GetTransientPackage());
+		realtimeMesh->SetCollisionOnly(bInCollisionOnly);
+
+		const FRealtimeMeshSectionGroupKey groupKey = FRealtimeMeshSectionGroupKey::Create(0, FName("Chunk"));
+		realtimeMesh->CreateSectionGroup(groupKey, FRealtimeMeshStreamSet(InStreamSet));
+		realtimeMesh->UpdateSectionConfig(FRealtimeMeshSectionKey::CreateForPolyGroup(groupKey, 0), FRealtimeMeshSectionConfig(ERealtimeMeshSectionDrawType::Static, 0), true);
+		realtimeMesh->GetMeshData()->GenerateCollisionMesh(OutTriMeshData);
+
+		const TSharedPtr<FRealtimeMeshSectionGroupSimple> sectionGroup = realtimeMesh->GetMeshData()->GetSectionGroupAs<FRealtimeMeshSectionGroupSimple>(groupKey);
+		int64 numBytes = 0;
+		InStreamSet.ForEach([&](const FRealtimeMeshStream& InStream)
+		{
+			if (const FRealtimeMeshStream* kept = sectionGroup->GetStream(InStream.GetStreamKey()))
+			{
+				numBytes += int64(kept->Num()) * kept->GetStride();
+			}
+		});
+		return numBytes;
+	}
+}
+
+bool FVoxelCollisionOnlyBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace VoxelCollisionOnlyBenchmark;
+
+	for (const bool bSurfaceNets : { false, true })
+	{
+		const FArray3D<double> grid = SampleGrid(bSurfaceNets ? FVoxelSurfaceNets::Apron : VoxelMarchingCubes::Apron);
+		const FResult full = Measure(grid, bSurfaceNets, false);
+		const FResult collision = Measure(grid, bSurfaceNets, true);
+
+		const int64 fullBytes = GetVoxelMeshStreamBytes(full.StreamSet);
+		const int64 collisionBytes = GetVoxelMeshStreamBytes(collision.StreamSet);
+
+		AddInfo(FString::Printf(
+			TEXT("%-14s R=%d | Full %7.3f ms %8.1f KB | Collision only %7.3f ms %8.1f KB | %.1fx faster, %.1f%% smaller"),
+			bSurfaceNets ? TEXT("SurfaceNets") : TEXT("MarchingCubes"), Resolution,
+			full.Ms, fullBytes / 1024.0, collision.Ms, collisionBytes / 1024.0,
+			collision.Ms > 0 ? full.Ms / collision.Ms : 0.0, 100.0 * (1.0 - (double)collisionBytes / fullBytes)
+		));
+
+		TestNull(TEXT("Collision only chunks have no tangents"), collision.StreamSet.Find(FRealtimeMeshStreams::Tangents));
+		TestNull(TEXT("Collision only chunks have no texcoords"), collision.StreamSet.Find(FRealtimeMeshStreams::TexCoords));
+		TestEqual(TEXT("Both chunks hold the same vertices"),
+			collision.StreamSet.FindChecked(FRealtimeMeshStreams::Position).Num(), full.StreamSet.FindChecked(FRealtimeMeshStreams::Position).Num());
+		TestEqual(TEXT("Both chunks hold the same triangles"),
+			collision.StreamSet.FindChecked(FRealtimeMeshStreams::Triangles).Num(), full.StreamSet.FindChecked(FRealtimeMeshStreams::Triangles).Num());
+
+		// A collision only mesh handed a drawable chunk drops the render streams and still collides the same
+		FRealtimeMeshTriMeshData fullTriMesh;
+		FRealtimeMeshTriMeshData collisionTriMesh;
+		const int64 keptFullBytes = GenerateTriMesh(full.StreamSet, false, fullTriMesh);
+		const int64 keptCollisionBytes = GenerateTriMesh(full.StreamSet, true, collisionTriMesh);
+
+		AddInfo(FString::Printf(TEXT("%-14s kept on the CPU | drawn %8.1f KB | collision only %8.1f KB"),
+			bSurfaceNets ? TEXT("SurfaceNets") : TEXT("MarchingCubes"), keptFullBytes / 1024.0, keptCollisionBytes / 1024.0));
+
+		TestTrue(TEXT("A collision only mesh keeps fewer bytes"), keptCollisionBytes < keptFullBytes);
+		TestEqual(TEXT("A collision only mesh collides with the same vertices"), collisionTriMesh.GetVertices().Num(), fullTriMesh.GetVertices().Num());
+		TestEqual(TEXT("A collision only mesh collides with the same triangles"), collisionTriMesh.GetTriangles().Num(), fullTriMesh.GetTriangles().Num());
+	}
+
+	return true;
+}
@@ -0,0 +1,124 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Chaos/TriangleMeshImplicitObject.h"
+#include "RealtimeMeshCollisionRefit.h"
+
+#include "VoxelCollisionFixtures.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelCollisionRefitBenchmark, "Voxel.Benchmarks.CollisionRefit",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+using namespace RealtimeMesh;
+
+namespace VoxelCollisionRefitBenchmark
+{
+	using namespace VoxelCollisionFixtures;
+
+	static constexpr int32 Resolution = 64;
+	static constexpr int32 NumUpdates = 16;
+	static constexpr int32 NumRays = 2000;
+
+	/* Collision triangles of a sphere in the middle of the chunk */
+	void GenerateTriMesh(FRealtimeMeshTriMeshData& OutTriMeshData)
+	{
+		const int32 apron = FVoxelSurfaceNets::Apron;
+		FArray3D<double> grid;
+		grid.Init(FIntVector(FVoxelSurfaceNets::GetGridEdgeCount(Resolution)), NoInit);
+		grid.ForEachElement([&](int32 InX, int32 InY, int32 InZ, double& OutDensity)
+		{
+			OutDensity = (FVector(InX, InY, InZ) - (apron + Resolution * 0.5)).Length() / (Resolution * 0.35);
+		});
+
+		VoxelCollisionFixtures::GenerateTriMesh(grid, Resolution, OutTriMeshData);
+	}
+
+	/* Every vertex pushed along its direction from the center by a wave, the way a smoothing stroke moves them and keeps the triangles */
+	void Deform(FRealtimeMeshTriMeshData& InOutTriMeshData, int32 InUpdate)
+	{
+		const FVector3f center(Resolution * 0.5f);
+		for (FVector3f& vertex : InOutTriMeshData.GetVertices())
+		{
+			const FVector3f offset = vertex - center;
+			vertex = center + offset * (1.0f + 0.05f * FMath::Sin(offset.X * 0.3f + InUpdate));
+		}
+	}
+
+	/* Rays from the chunk's edge towards its center that disagree on where they hit the two bodies */
+	int32 CountDisagreements(const UBodySetup* InA, const UBodySetup* InB)
+	{
+		FRandomStream random(7);
+		const FVector center(Resolution * 0.5);
+		int32 numDisagreements = 0;
+		for (int32 i = 0; i < NumRays; i++)
+		{
+			const FVector start = center + random.GetUnitVector() * Resolution * 0.49;
+			const FVector direction = (center - start).GetSafeNormal();
+
+			Chaos::FReal timeA = -1, timeB = -1;
+			Chaos::FVec3 position, normal;
+			int32 faceIndex;
+			InA->TriMeshGeometries[0]->Raycast(start, direction, Resolution, 0, timeA, position, normal, faceIndex);
+			InB->TriMeshGeometries[0]->Raycast(start, direction, Resolution, 0, timeB, position, normal, faceIndex);
+			numDisagreements += FMath::Abs(timeA - timeB) > SameMeshHitTolerance ? 1 : 0;
+		}
+		return numDisagreements;
+	}
+}
+
+bool FVoxelCollisionRefitBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace VoxelCollisionRefitBenchmark;
+
+	FRealtimeMeshTriMeshData triMeshData;
+	GenerateTriMesh(triMeshData);
+
+	FRealtimeMeshCollisionRefit refit;
+	UBodySetup* cooked = Cook(triMeshData, true);
+	refit.Capture(triMeshData, cooked);
+	if (!TestTrue(TEXT("The chunk cooks and is captured"), cooked->TriMeshGeometries.Num() == 1 && refit.IsCaptured()))
+	{
+		return false;
+	}
+
+	double cookMs = 0;
+	double refitMs = 0;
+	int32 numRefits = 0;
+	int32 numDisagreements = 0;
+	const UBodySetup* current = cooked;
+	for (int32 update = 0; update < NumUpdates; update++)
+	{
+		Deform(triMeshData, update);
+
+		double start = FPlatformTime::Seconds();
+		const UBodySetup* fullCook = Cook(triMeshData);
+		cookMs += (FPlatformTime::Seconds() - start) * 1000.0;
+
+		UBodySetup* refitBody = CreateBodySetup(triMeshData, true);
+		start = FPlatformTime::Seconds();
+		const bool bRefit = refit.Refit(triMeshData, current, refitBody);
+		refitMs += (FPlatformTime::Seconds() - start) * 1000.0;
+
+		if (bRefit)
+		{
+			numRefits++;
+			numDisagreements += CountDisagreements(fullCook, refitBody);
+			current = refitBody;
+		}
+	}
+
+	AddInfo(FString::Printf(TEXT("%d vertices, %d triangles | full cook %7.3f ms/update | refit %7.3f ms/update (%.1fx) | %d of %d rays disagree"),
+		triMeshData.GetVertices().Num(), triMeshData.GetTriangles().Num(), cookMs / NumUpdates, refitMs / NumUpdates,
+		refitMs > 0 ? cookMs / refitMs : 0.0, numDisagreements, NumRays * NumUpdates));
+
+	TestEqual(TEXT("Every update that only moves vertices refits"), numRefits, NumUpdates);
+	TestEqual(TEXT("Refit collision is hit where a full cook is"), numDisagreements, 0);
+
+	// Dropping a triangle changes the topology, the update has to cook
+	triMeshData.GetTriangles().Pop();
+	TestFalse(TEXT("An update that changes the triangles does not refit"), refit.Refit(triMeshData, current, CreateBodySetup(triMeshData, true)));
+
+	return true;
+}
@@ -0,0 +1,126 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+
+#include "VoxelCollisionFixtures.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelCollisionSourceBenchmark, "Voxel.Benchmarks.CollisionSource",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+using namespace RealtimeMesh;
+
+namespace VoxelCollisionSourceBenchmark
+{
+	static constexpr int32 NumChunks = 64;
+	static const FName CollisionGroupName("Collision");
+
+	/* The same sphere meshed at InResolution cells per edge, the way a chunk is meshed at every depth */
+	void MeshChunk(int32 InResolution, FRealtimeMeshStreamSet& OutStreamSet)
+	{
+		const int32 apron = FVoxelSurfaceNets::Apron;
+		const FIntVector size(InResolution + 1 + apron * 2);
+		const double radius = InResolution * 0.4;
+
+		FArray3D<double> grid(size, NoInit);
+		grid.ForEachElement([&](int32 InX, int32 InY, int32 InZ, double& OutDensity)
+		{
+			const FVector location = FVector(InX, InY, InZ) - (apron + InResolution * 0.5);
+			OutDensity = location.Length() / radius + 0.05 * FMath::Sin(location.X * 6.0 / InResolution);
+		});
+
+		FVoxelMeshParams params;
+		params.ChunkOrigin = FVector3f::ZeroVector;
+		params.VoxelSize = 1.0;
+		params.SurfaceIsovalue = 1.0;
+		params.Resolution = InResolution;
+
+		FVoxelSurfaceNets::GenerateMesh(grid, params, OutStreamSet);
+		FinalizeVoxelMeshStreams(params, OutStreamSet);
+	}
+
+	void AddChunk(URealtimeMeshSimple* InRealtimeMesh, const FRealtimeMeshSectionGroupKey& InKey, const FRealtimeMeshStreamSet& InStreamSet, bool bInVisible)
+	{
+		InRealtimeMesh->CreateSectionGroup(InKey, InStreamSet);
+
+		FRealtimeMeshSectionConfig config(ERealtimeMeshSectionDrawType::Static, 0);
+		config.bIsVisible = bInVisible;
+		InRealtimeMesh->UpdateSectionConfig(FRealtimeMeshSectionKey::CreateForPolyGroup(InKey, 0), config, true);
+	}
+
+	struct FResult
+	{
+		int32 NumTriangles = 0;
+		double GenerateMs = 0;
+		double CookMs = 0;
+		bool bCooked = false;
+	};
+
+	/* Generates collision from the selected source and cooks it the way URealtimeMesh does, synchronously */
+	FResult Cook(URealtimeMeshSimple* InRealtimeMesh, int32 InCollisionLOD, FName InCollisionSectionGroup)
+	{
+		FRealtimeMeshCollisionConfiguration collisionConfig = InRealtimeMesh->GetCollisionConfig();
+		collisionConfig.CollisionLOD = InCollisionLOD;
+		collisionConfig.CollisionSectionGroup = InCollisionSectionGroup;
+		InRealtimeMesh->SetCollisionConfig(collisionConfig);
+
+		FResult result;
+		FRealtimeMeshTriMeshData triMeshData;
+		double start = FPlatformTime::Seconds();
+		InRealtimeMesh->GetMeshData()->GenerateCollisionMesh(triMeshData);
+		result.GenerateMs = (FPlatformTime::Seconds() - start) * 1000.0;
+		result.NumTriangles = triMeshData.GetTriangles().Num();
+
+		UBodySetup* bodySetup = VoxelCollisionFixtures::CreateBodySetup(triMeshData);
+
+		start = FPlatformTime::Seconds();
+		bodySetup->CreatePhysicsMeshes();
+		result.CookMs = (FPlatformTime::Seconds() - start) * 1000.0;
+		result.bCooked = bodySetup->TriMeshGeometries.Num() > 0;
+		return result;
+	}
+}
+
+bool FVoxelCollisionSourceBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace VoxelCollisionSourceBenchmark;
+
+	FRealtimeMeshStreamSet fine, coarse, collisionOnly;
+	MeshChunk(32, fine);
+	MeshChunk(16, coarse);
+	MeshChunk(8, collisionOnly);
+
+	// The chunks at full detail in LOD 0 and at half in LOD 1, which also holds a hidden group meant for collision only
+	URealtimeMeshSimple* realtimeMesh = NewObject<URealtimeMeshSimple>(GetTransientPackage());
+	realtimeMesh->AddLOD(FRealtimeMeshLODConfig());
+	for (int32 i = 0; i < NumChunks; i++)
+	{
+		AddChunk(realtimeMesh, FRealtimeMeshSectionGroupKey::Create(0, FName("Chunk", i)), fine, true);
+		AddChunk(realtimeMesh, FRealtimeMeshSectionGroupKey::Create(1, FName("Chunk", i)), coarse, true);
+	}
+	AddChunk(realtimeMesh, FRealtimeMeshSectionGroupKey::Create(1, CollisionGroupName), collisionOnly, false);
+
+	const FResult lod0 = Cook(realtimeMesh, 0, NAME_None);
+	const FResult lod1 = Cook(realtimeMesh, 1, NAME_None);
+	const FResult group = Cook(realtimeMesh, 1, CollisionGroupName);
+
+	auto report = [this](const TCHAR* InSource, const FResult& InResult)
+	{
+		AddInfo(FString::Printf(TEXT("%-15s | %7d tris | generate %7.2f ms | cook %8.2f ms"),
+			InSource, InResult.NumTriangles, InResult.GenerateMs, InResult.CookMs));
+	};
+	report(TEXT("LOD 0"), lod0);
+	report(TEXT("LOD 1"), lod1);
+	report(TEXT("Collision group"), group);
+
+	const int32 fineTriangles = fine.FindChecked(FRealtimeMeshStreams::Triangles).Num();
+	const int32 coarseTriangles = coarse.FindChecked(FRealtimeMeshStreams::Triangles).Num();
+	const int32 collisionOnlyTriangles = collisionOnly.FindChecked(FRealtimeMeshStreams::Triangles).Num();
+
+	TestTrue(TEXT("Every source cooks"), lod0.bCooked && lod1.bCooked && group.bCooked);
+	TestEqual(TEXT("LOD 0 collides with its chunks"), lod0.NumTriangles, fineTriangles * NumChunks);
+	TestEqual(TEXT("LOD 1 collides with every group it holds"), lod1.NumTriangles, coarseTriangles * NumChunks + collisionOnlyTriangles);
+	TestEqual(TEXT("The collision group collides alone"), group.NumTriangles, collisionOnlyTriangles);
+
+	return true;
+}
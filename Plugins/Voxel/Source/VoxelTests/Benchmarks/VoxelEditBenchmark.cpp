@@ -0,0 +1,171 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+
+#include "VoxelChunk/VoxelChunkNode.h"
+#include "VoxelEdit/VoxelEditLayer.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelEditBenchmark, "Voxel.Benchmarks.Edits",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+namespace VoxelEditBenchmark
+{
+	static constexpr double VolumeExtent = 65536;
+	static constexpr int32 MaxDepth = 7;
+	static constexpr int32 ChunkResolution = 32;
+	static constexpr int32 SampleReach = 4;
+
+	/* Subdivides around InLodCenter the way AVoxelVolume::RechunkToCenter does, so leaves sit at every depth */
+	void Subdivide(FVoxelChunkNode* InNode, const FVector& InLodCenter)
+	{
+		if (InNode->Depth == MaxDepth || !InNode->IsWithinReach(InLodCenter, VolumeExtent, 1.f))
+		{
+			InNode->SetLeaf(true);
+			return;
+		}
+
+		for (int32 i = 0; i < 8; i++)
+		{
+			InNode->Children[i] = new FVoxelChunkNode(InNode->Depth + 1, InNode->GetChildCenter(i, VolumeExtent));
+			Subdivide(InNode->Children[i], InLodCenter);
+		}
+	}
+
+	/* Leaves whose grown box any of InBounds touches, checked one by one */
+	TSet<FVoxelChunkNode*> GatherDirtyLeaves(FVoxelChunkNode* InRoot, const TArray<FBox>& InBounds)
+	{
+		TArray<FVoxelChunkNode*> leaves;
+		InRoot->GetLeaves(leaves);
+
+		TSet<FVoxelChunkNode*> dirty;
+		for (FVoxelChunkNode* leaf : leaves)
+		{
+			const double voxelSize = leaf->GetExtent(VolumeExtent) * 2 / ChunkResolution;
+			const FBox box = leaf->GetBox(VolumeExtent).ExpandBy(voxelSize * SampleReach);
+			for (const FBox& bounds : InBounds)
+			{
+				if (bounds.Intersect(box))
+				{
+					dirty.Add(leaf);
+					break;
+				}
+			}
+		}
+
+		return dirty;
+	}
+
+	FVoxelEdit MakeStroke(FRandomStream& InRandom, const FVector& InCenter, double InSpread)
+	{
+		FVoxelEdit edit;
+		edit.Shape = InRandom.FRand() < 0.5f ? EVoxelEditShape::Sphere : EVoxelEditShape::Box;
+		edit.Operation = InRandom.FRand() < 0.5f ? EVoxelEditOperation::Add : EVoxelEditOperation::Remove;
+		edit.Center = InCenter + FVector(InRandom.FRandRange(-InSpread, InSpread), InRandom.FRandRange(-InSpread, InSpread), InRandom.FRandRange(-InSpread, InSpread));
+		edit.Extent = FVector(InRandom.FRandRange(50, 400), InRandom.FRandRange(50, 400), InRandom.FRandRange(50, 400));
+		edit.Smoothness = InRandom.FRand() < 0.5f ? 0.0 : InRandom.FRandRange(10, 100);
+		return edit;
+	}
+
+	/* Applies InEdits in order to a flat ground at z = 0, the distance rising one per unit above it */
+	double ApplyToGround(TConstArrayView<FVoxelEdit> InEdits, const FVector& InLocation, uint8* InOutMaterialId = nullptr)
+	{
+		double distance = InLocation.Z;
+		for (const FVoxelEdit& edit : InEdits)
+		{
+			distance = edit.Apply(InLocation, distance, InOutMaterialId);
+		}
+
+		return distance;
+	}
+}
+
+bool FVoxelEditBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace VoxelEditBenchmark;
+
+	FRandomStream random(1337);
+	const FVector lodCenter(0, 0, VolumeExtent * 0.5);
+
+	FVoxelChunkNode root;
+	Subdivide(&root, lodCenter);
+
+	FVoxelEditLayer layer;
+	layer.Init(VolumeExtent);
+
+	// A frame of strokes around one spot only dirties the leaves around it, each once
+	TArray<FBox> strokeBounds;
+	for (int32 i = 0; i < 200; i++)
+	{
+		const FVoxelEdit edit = MakeStroke(random, lodCenter, 2000);
+		layer.Add(edit);
+		strokeBounds.Add(edit.GetBounds());
+	}
+
+	TArray<FVoxelChunkNode*> dirtyChunks;
+	layer.ConsumeDirtyChunks(&root, ChunkResolution, SampleReach, dirtyChunks);
+	const TSet<FVoxelChunkNode*> expected = GatherDirtyLeaves(&root, strokeBounds);
+	const TSet<FVoxelChunkNode*> dirtySet(dirtyChunks);
+
+	int32 minDepth = MaxDepth;
+	int32 maxDepth = 0;
+	for (const FVoxelChunkNode* chunk : dirtyChunks)
+	{
+		minDepth = FMath::Min<int32>(minDepth, chunk->Depth);
+		maxDepth = FMath::Max<int32>(maxDepth, chunk->Depth);
+	}
+
+	// What remeshing after every stroke would have cost
+	int32 numUncoalesced = 0;
+	for (const FBox& bounds : strokeBounds)
+	{
+		numUncoalesced += GatherDirtyLeaves(&root, { bounds }).Num();
+	}
+
+	AddInfo(FString::Printf(
+		TEXT("200 strokes in one frame | %d chunk remeshes, depths %d to %d | %d remeshing every stroke"),
+		dirtyChunks.Num(), minDepth, maxDepth, numUncoalesced
+	));
+
+	TestEqual(TEXT("Every leaf is remeshed once"), dirtySet.Num(), dirtyChunks.Num());
+	TestTrue(TEXT("Exactly the leaves the strokes reach are dirty"), dirtySet.Num() == expected.Num() && dirtySet.Includes(expected));
+	TestTrue(TEXT("Leaves are remeshed at every depth the strokes reach"), minDepth < maxDepth);
+
+	TArray<FVoxelChunkNode*> nextFrame;
+	layer.ConsumeDirtyChunks(&root, ChunkResolution, SampleReach, nextFrame);
+	TestEqual(TEXT("Consumed strokes are not remeshed again"), nextFrame.Num(), 0);
+
+	// CSG against a flat ground at z = 0
+	FVoxelEdit dig;
+	dig.Operation = EVoxelEditOperation::Remove;
+	dig.Extent = FVector(100);
+
+	FVoxelEdit fill;
+	fill.Center = FVector(0, 0, 300);
+	fill.Extent = FVector(50);
+	fill.MaterialId = 2;
+
+	const TArray<FVoxelEdit> edits = { dig, fill };
+
+	uint8 materialId = 0;
+	TestTrue(TEXT("Removing a sphere digs out the ground"), ApplyToGround(edits, FVector(0, 0, -50)) > 0);
+	TestTrue(TEXT("Ground outside the sphere stays solid"), ApplyToGround(edits, FVector(0, 0, -150)) < 0);
+	TestTrue(TEXT("Adding a sphere fills the air"), ApplyToGround(edits, FVector(0, 0, 300), &materialId) < 0);
+	TestEqual(TEXT("Filled space takes the stroke's material"), (int32)materialId, 2);
+
+	// A smooth stroke blends into the ground instead of meeting it at a crease
+	const auto sampleBlob = [](double InSmoothness, const FVector& InLocation)
+	{
+		FVoxelEdit blob;
+		blob.Center = FVector(0, 0, 60);
+		blob.Extent = FVector(50);
+		blob.Smoothness = InSmoothness;
+		return ApplyToGround(MakeArrayView(&blob, 1), InLocation);
+	};
+
+	const FVector fillet(40, 0, 3);
+	TestTrue(TEXT("A hard stroke leaves the crease where it meets the ground"), sampleBlob(0, fillet) > 0);
+	TestTrue(TEXT("A smooth stroke fills the crease"), sampleBlob(40, fillet) < 0);
+
+	return true;
+}
@@ -0,0 +1,189 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include <limits>
+#include "HAL/PlatformTime.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+#include "VoxelBenchmarkFixtures.h"
+#include "VoxelEdit/VoxelEditLog.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelEditLogBenchmark, "Voxel.Benchmarks.EditLog",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+namespace VoxelEditLogBenchmark
+{
+	using namespace VoxelBenchmarkFixtures;
+
+	static constexpr int32 ChunkSize = 32;
+
+	// Centimeter positions, strokes per batch as a peer might send them
+	static constexpr double PositionStep = 1.0;
+	static constexpr int32 BatchSize = 256;
+
+	// Shape, operation, center, extent, smoothness and material serialized one field at a time
+	static constexpr int32 NaiveRecordBytes = 1 + 1 + 3 * sizeof(double) + 3 * sizeof(double) + sizeof(double) + 1;
+
+	/* One batch holding InEdit, written with InPositionStep */
+	TArray<uint8> WriteBatch(const FVoxelEdit& InEdit, double InPositionStep = PositionStep)
+	{
+		FVoxelEditLogWriter writer(InPositionStep);
+		writer.Add(InEdit);
+
+		TArray<uint8> batch;
+		FMemoryWriter ar(batch);
+		writer.Flush(ar);
+		return batch;
+	}
+
+	bool ReadsBack(const TArray<uint8>& InBatch)
+	{
+		TArray<FVoxelEdit> edits;
+		FMemoryReader reader(InBatch);
+		return FVoxelEditLogReader::ReadBatch(reader, edits) && edits.Num() == 1;
+	}
+
+	bool IsSameEdit(const FVoxelEdit& InA, const FVoxelEdit& InB)
+	{
+		return InA.Shape == InB.Shape && InA.Operation == InB.Operation && InA.Center == InB.Center && InA.Extent == InB.Extent
+			&& InA.Smoothness == InB.Smoothness && InA.MaterialId == InB.MaterialId;
+	}
+}
+
+bool FVoxelEditLogBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace VoxelEditLogBenchmark;
+
+	FRandomStream random(1337);
+
+	TArray<FVoxelEdit> strokes;
+	MakeTunnels(random, 80, 60, strokes);
+
+	TArray<FVoxelEdit> quantized;
+	for (const EVoxelEditCompression compression : { EVoxelEditCompression::LZ4, EVoxelEditCompression::Zlib })
+	{
+		// Written a batch at a time, each appended to the log as a peer would stream it
+		TArray<uint8> log;
+		FVoxelEditLogWriter writer(PositionStep, compression);
+		quantized.Reset();
+
+		int32 numBatches = 0;
+		double start = FPlatformTime::Seconds();
+		for (const FVoxelEdit& stroke : strokes)
+		{
+			quantized.Add(writer.Add(stroke));
+			if (writer.NumPending() == BatchSize)
+			{
+				FMemoryWriter ar(log, false, true);
+				writer.Flush(ar);
+				numBatches++;
+			}
+		}
+		{
+			FMemoryWriter ar(log, false, true);
+			writer.Flush(ar);
+			numBatches++;
+		}
+		const double writeSeconds = FPlatformTime::Seconds() - start;
+
+		TArray<FVoxelEdit> decoded;
+		FMemoryReader reader(log);
+		start = FPlatformTime::Seconds();
+		const int32 numRead = FVoxelEditLogReader::ReadAll(reader, decoded);
+		const double readSeconds = FPlatformTime::Seconds() - start;
+
+		int32 numDifferent = 0;
+		double maxError = 0;
+		for (int32 i = 0; i < FMath::Min(decoded.Num(), strokes.Num()); i++)
+		{
+			numDifferent += !IsSameEdit(decoded[i], quantized[i]);
+			maxError = FMath::Max(maxError, (decoded[i].Center - strokes[i].Center).GetAbsMax());
+		}
+
+		AddInfo(FString::Printf(
+			TEXT("%s | %d strokes in %d batches | %.2f bytes per stroke, %d one field at a time | write %6.2f ms, read %6.2f ms"),
+			compression == EVoxelEditCompression::LZ4 ? TEXT("LZ4 ") : TEXT("Zlib"), strokes.Num(), numBatches,
+			(double)log.Num() / strokes.Num(), NaiveRecordBytes, writeSeconds * 1000.0, readSeconds * 1000.0
+		));
+
+		TestEqual(TEXT("Every stroke reads back"), numRead, strokes.Num());
+		TestEqual(TEXT("Strokes read back as the writer returned them"), numDifferent, 0);
+		TestTrue(TEXT("Positions are within half a step"), maxError <= PositionStep * 0.5);
+		TestTrue(TEXT("The log takes a fraction of serializing every field"), log.Num() * 4 < strokes.Num() * NaiveRecordBytes);
+
+		// A log cut mid batch, as a stream still being appended to, reads up to the last whole batch and resumes once the rest arrives
+		TArray<uint8> partial(log.GetData(), log.Num() - 3);
+		TArray<FVoxelEdit> streamed;
+		FMemoryReader partialReader(partial);
+		FVoxelEditLogReader::ReadAll(partialReader, streamed);
+		const int64 resumeAt = partialReader.Tell();
+
+		TestEqual(TEXT("A cut log reads its whole batches"), streamed.Num(), strokes.Num() - (strokes.Num() - 1) % BatchSize - 1);
+		TestTrue(TEXT("A cut batch is left unread"), !FVoxelEditLogReader::ReadBatch(partialReader, streamed) && partialReader.Tell() == resumeAt);
+
+		FMemoryReader resumedReader(log);
+		resumedReader.Seek(resumeAt);
+		TestTrue(TEXT("The rest of a cut log reads once it arrives"), FVoxelEditLogReader::ReadBatch(resumedReader, streamed) && streamed.Num() == strokes.Num());
+
+		// A batch whose records do not add up is refused rather than applied
+		TArray<uint8> corrupt = log;
+		corrupt[0] ^= 1;
+		FMemoryReader corruptReader(corrupt);
+		TArray<FVoxelEdit> corrupted;
+		TestTrue(TEXT("A corrupt batch is refused"), FVoxelEditLogReader::ReadAll(corruptReader, corrupted) < strokes.Num());
+	}
+
+	// Applying a whole log at once against applying its strokes one by one
+	FVoxelEditOctree oneByOne;
+	InitGround(oneByOne);
+	double start = FPlatformTime::Seconds();
+	for (const FVoxelEdit& stroke : quantized)
+	{
+		oneByOne.ApplyEdit(stroke, SampleRollingGround);
+	}
+	const double oneByOneSeconds = FPlatformTime::Seconds() - start;
+
+	FVoxelEditOctree batched;
+	InitGround(batched);
+	start = FPlatformTime::Seconds();
+	batched.ApplyEdits(quantized, SampleRollingGround);
+	const double batchedSeconds = FPlatformTime::Seconds() - start;
+
+	TArray<FIntVector> chunks;
+	oneByOne.GatherChunks(ChunkSize, chunks);
+
+	AddInfo(FString::Printf(
+		TEXT("Applying %d strokes | one by one %7.1f ms | in one pass %7.1f ms | %d bricks"),
+		quantized.Num(), oneByOneSeconds * 1000.0, batchedSeconds * 1000.0, batched.NumBricks()
+	));
+
+	TestEqual(TEXT("One pass bakes the same bricks"), batched.NumBricks(), oneByOne.NumBricks());
+	TestEqual(TEXT("One pass extracts as applying one by one"), CountMismatches(oneByOne, batched, chunks, ChunkSize), 0);
+
+	// Batches whose step or strokes no volume could hold are refused rather than baked
+	TestTrue(TEXT("A stroke reads back"), ReadsBack(WriteBatch(strokes[0])));
+
+	// A one stroke batch has one byte counts, the format byte then the step follow them
+	const int32 stepOffset = 4;
+	for (const double step : { std::numeric_limits<double>::infinity(), std::numeric_limits<double>::quiet_NaN(), 0.0, -1.0, 1e300 })
+	{
+		TArray<uint8> batch = WriteBatch(strokes[0]);
+		FMemory::Memcpy(batch.GetData() + stepOffset, &step, sizeof(double));
+		TestFalse(FString::Printf(TEXT("A batch with a step of %g is refused"), step), ReadsBack(batch));
+	}
+
+	FVoxelEdit farAway = strokes[0];
+	farAway.Center = FVector(0, 0, 1e12);
+	TestFalse(TEXT("A stroke thousands of kilometers away is refused"), ReadsBack(WriteBatch(farAway, FVoxelEditLogReader::MaxPositionStep)));
+
+	FVoxelEdit huge = strokes[0];
+	huge.Extent = FVector(1e10);
+	TestFalse(TEXT("A stroke larger than any volume is refused"), ReadsBack(WriteBatch(huge)));
+
+	FVoxelEdit blurred = strokes[0];
+	blurred.Smoothness = 1e10;
+	TestFalse(TEXT("A stroke blending over more than any volume is refused"), ReadsBack(WriteBatch(blurred)));
+
+	return true;
+}
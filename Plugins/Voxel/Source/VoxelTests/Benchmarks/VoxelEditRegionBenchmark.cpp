@@ -0,0 +1,152 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/Paths.h"
+
+#include "VoxelBenchmarkFixtures.h"
+#include "VoxelEdit/VoxelEditRegionStore.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelEditRegionBenchmark, "Voxel.Benchmarks.EditRegions",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+namespace VoxelEditRegionBenchmark
+{
+	static constexpr int32 ChunkSize = 32;
+
+	/* Bytes the region files in InDirectory take on disk */
+	int64 GetDiskBytes(const FString& InDirectory)
+	{
+		TArray<FString> files;
+		IFileManager::Get().FindFiles(files, *(InDirectory / TEXT("*.vxr")), true, false);
+
+		int64 bytes = 0;
+		for (const FString& file : files)
+		{
+			bytes += IFileManager::Get().FileSize(*(InDirectory / file));
+		}
+
+		return bytes;
+	}
+}
+
+bool FVoxelEditRegionBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace VoxelEditRegionBenchmark;
+
+	FRandomStream random(1337);
+
+	TArray<FVoxelEdit> strokes;
+	VoxelBenchmarkFixtures::MakeTunnels(random, 40, 60, strokes);
+
+	FVoxelEditOctree octree;
+	VoxelBenchmarkFixtures::InitGround(octree);
+	octree.ApplyEdits(strokes, VoxelBenchmarkFixtures::SampleRollingGround);
+
+	TArray<FIntVector> chunks;
+	octree.GatherChunks(ChunkSize, chunks);
+
+	for (const EVoxelEditCompression compression : { EVoxelEditCompression::LZ4, EVoxelEditCompression::Zlib })
+	{
+		const FString directory = FPaths::AutomationTransientDir() / TEXT("VoxelEditRegions") / (compression == EVoxelEditCompression::LZ4 ? TEXT("LZ4") : TEXT("Zlib"));
+		IFileManager::Get().DeleteDirectory(*directory, false, true);
+
+		TSharedPtr<FVoxelEditRegionStore, ESPMode::ThreadSafe> store = MakeShared<FVoxelEditRegionStore, ESPMode::ThreadSafe>(directory, ChunkSize, VoxelBenchmarkFixtures::GroundVoxelSize, compression);
+
+		// What the game thread spends saving, the compression and file writes run in the background
+		double start = FPlatformTime::Seconds();
+		int64 rawBytes = 0;
+		for (const FIntVector& chunk : chunks)
+		{
+			FVoxelEditRegionChunk regionChunk;
+			regionChunk.Chunk = chunk;
+			octree.SaveChunk(chunk, ChunkSize, regionChunk.Data);
+			rawBytes += regionChunk.Data.Num();
+			store->Write(MoveTemp(regionChunk));
+		}
+		store->Flush();
+		const double saveSeconds = FPlatformTime::Seconds() - start;
+
+		start = FPlatformTime::Seconds();
+		store->WaitForWrites();
+		const double writeSeconds = FPlatformTime::Seconds() - start;
+
+		const int64 diskBytes = GetDiskBytes(directory);
+
+		// Loaded back into an empty octree by a fresh store, as the next session would
+		TSharedPtr<FVoxelEditRegionStore, ESPMode::ThreadSafe> loadStore = MakeShared<FVoxelEditRegionStore, ESPMode::ThreadSafe>(directory, ChunkSize, VoxelBenchmarkFixtures::GroundVoxelSize, compression);
+
+		start = FPlatformTime::Seconds();
+		TArray<FIntVector> regions;
+		loadStore->FindRegions(regions);
+		TArray<TFuture<TArray<FVoxelEditRegionChunk>>> loads;
+		for (const FIntVector& region : regions)
+		{
+			loads.Add(loadStore->LoadRegion(region));
+		}
+		const double requestSeconds = FPlatformTime::Seconds() - start;
+
+		FVoxelEditOctree loaded;
+		VoxelBenchmarkFixtures::InitGround(loaded);
+
+		int32 numLoaded = 0;
+		int32 numFailed = 0;
+		start = FPlatformTime::Seconds();
+		for (const TFuture<TArray<FVoxelEditRegionChunk>>& load : loads)
+		{
+			for (const FVoxelEditRegionChunk& chunk : load.Get())
+			{
+				numLoaded++;
+				numFailed += !loaded.LoadChunk(chunk.Chunk, ChunkSize, chunk.Data);
+			}
+		}
+		const double loadSeconds = FPlatformTime::Seconds() - start;
+
+		AddInfo(FString::Printf(
+			TEXT("%s | %d chunks in %d regions | %.2f MB raw, %.2f MB on disk | save %6.2f ms on the game thread, %7.2f ms writing | load requests %6.3f ms, reads and applying %7.2f ms"),
+			compression == EVoxelEditCompression::LZ4 ? TEXT("LZ4 ") : TEXT("Zlib"), chunks.Num(), regions.Num(), rawBytes / (1024.0 * 1024.0), diskBytes / (1024.0 * 1024.0),
+			saveSeconds * 1000.0, writeSeconds * 1000.0, requestSeconds * 1000.0, loadSeconds * 1000.0
+		));
+
+		TestTrue(TEXT("Compressed regions are smaller than the raw chunks"), diskBytes < rawBytes);
+		TestEqual(TEXT("Every saved chunk loads back"), numLoaded, chunks.Num());
+		TestEqual(TEXT("Loaded chunks are well formed"), numFailed, 0);
+		TestEqual(TEXT("Loaded edits extract as saved"), VoxelBenchmarkFixtures::CountMismatches(octree, loaded, chunks, ChunkSize), 0);
+		TestEqual(TEXT("Loaded edits take the same bricks"), loaded.NumBricks(), octree.NumBricks());
+
+		// A chunk written twice before a flush keeps the last write, and reads of its region see it before it is on disk
+		const FIntVector chunk = chunks[0];
+		const FIntVector region = FVoxelEditRegionStore::GetRegion(chunk);
+		FVoxelEditRegionChunk first;
+		first.Chunk = chunk;
+		octree.SaveChunk(chunks[1], ChunkSize, first.Data);
+		loadStore->Write(MoveTemp(first));
+		loadStore->Write(FVoxelEditRegionChunk{ chunk, TArray<uint8>() });
+
+		auto findChunk = [&chunk](const TArray<FVoxelEditRegionChunk>& InChunks)
+		{
+			return InChunks.FindByPredicate([&chunk](const FVoxelEditRegionChunk& InChunk) { return InChunk.Chunk == chunk; });
+		};
+
+		TFuture<TArray<FVoxelEditRegionChunk>> queuedLoad = loadStore->LoadRegion(region);
+		const FVoxelEditRegionChunk* queuedChunk = findChunk(queuedLoad.Get());
+		TestTrue(TEXT("Queued writes take precedence over the file"), queuedChunk && queuedChunk->Data.IsEmpty());
+
+		TestTrue(TEXT("Queued writes flush"), loadStore->Flush());
+		loadStore->WaitForWrites();
+
+		TFuture<TArray<FVoxelEditRegionChunk>> clearedLoad = loadStore->LoadRegion(region);
+		TestTrue(TEXT("A chunk written empty is removed from its region"), findChunk(clearedLoad.Get()) == nullptr);
+
+		// Clearing removes every region file
+		loadStore->Clear();
+		loadStore->WaitForWrites();
+		loadStore->FindRegions(regions);
+		TestEqual(TEXT("Clearing removes the region files"), regions.Num(), 0);
+
+		IFileManager::Get().DeleteDirectory(*directory, false, true);
+	}
+
+	return true;
+}
@@ -0,0 +1,209 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+
+#include "VoxelBenchmarkFixtures.h"
+#include "VoxelMesher/VoxelMarchingCubes.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelEditStorageBenchmark, "Voxel.Benchmarks.EditStorage",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+namespace VoxelEditStorageBenchmark
+{
+	using namespace VoxelBenchmarkFixtures;
+
+	static constexpr int32 ChunkResolution = 32;
+
+	static constexpr double UnitsPerKm = 100000;
+
+	/* Chunks of ChunkResolution voxels, apron included, that the strokes reach, as dense grids of doubles and material ids */
+	int64 GetDenseBytes(TConstArrayView<FVoxelEdit> InEdits)
+	{
+		const double chunkSize = ChunkResolution * GroundVoxelSize;
+		const int32 apron = VoxelMarchingCubes::Apron;
+
+		TSet<FIntVector> chunks;
+		for (const FVoxelEdit& edit : InEdits)
+		{
+			const FBox bounds = edit.GetBounds().ExpandBy(apron * GroundVoxelSize);
+			const FIntVector min(FMath::FloorToInt(bounds.Min.X / chunkSize), FMath::FloorToInt(bounds.Min.Y / chunkSize), FMath::FloorToInt(bounds.Min.Z / chunkSize));
+			const FIntVector max(FMath::FloorToInt(bounds.Max.X / chunkSize), FMath::FloorToInt(bounds.Max.Y / chunkSize), FMath::FloorToInt(bounds.Max.Z / chunkSize));
+			for (int32 x = min.X; x <= max.X; x++)
+			{
+				for (int32 y = min.Y; y <= max.Y; y++)
+				{
+					for (int32 z = min.Z; z <= max.Z; z++)
+					{
+						chunks.Add(FIntVector(x, y, z));
+					}
+				}
+			}
+		}
+
+		const int64 edgeCount = ChunkResolution + 1 + apron * 2;
+		return chunks.Num() * edgeCount * edgeCount * edgeCount * (sizeof(double) + sizeof(uint8));
+	}
+}
+
+bool FVoxelEditStorageBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace VoxelEditStorageBenchmark;
+
+	FRandomStream random(1337);
+
+	TArray<FVoxelEdit> strokes;
+	MakeTunnels(random, 40, 60, strokes);
+
+	FVoxelEditOctree octree;
+	InitGround(octree);
+
+	double start = FPlatformTime::Seconds();
+	for (const FVoxelEdit& stroke : strokes)
+	{
+		octree.ApplyEdit(stroke, SampleRollingGround);
+	}
+	const double bakeSeconds = FPlatformTime::Seconds() - start;
+
+	const double editedKm3 = FMath::Pow(GroundHalfExtent * 2 * GroundVoxelSize / UnitsPerKm, 3.0);
+	const int64 sparseBytes = octree.GetAllocatedSize();
+	const int64 denseBytes = GetDenseBytes(strokes);
+
+	AddInfo(FString::Printf(
+		TEXT("%d strokes baked in %7.1f ms | %d nodes, %d bricks | %.2f MB per km3 sparse, %.2f MB per km3 as dense chunk grids"),
+		strokes.Num(), bakeSeconds * 1000.0, octree.NumNodes(), octree.NumBricks(),
+		sparseBytes / editedKm3 / (1024.0 * 1024.0), denseBytes / editedKm3 / (1024.0 * 1024.0)
+	));
+
+	TestTrue(TEXT("Bricks and collapsed nodes take a fraction of the dense grids"), sparseBytes * 4 < denseBytes);
+
+	// Extraction at every depth against sampling the procedural density and applying the gathered strokes in order
+	const double range = FVoxelEditOctree::RangeVoxels * GroundVoxelSize;
+	const double tolerance = range / FVoxelQuantizedDensity16::MaxValue;
+
+	for (const int32 stride : { 1, 2, 4, 8 })
+	{
+		const int32 edgeCount = ChunkResolution + 1 + VoxelMarchingCubes::Apron * 2;
+		const FIntVector size(edgeCount);
+
+		TArray<double> densities;
+		TArray<uint8> materialIds;
+		densities.SetNumUninitialized(edgeCount * edgeCount * edgeCount);
+		materialIds.SetNumUninitialized(densities.Num());
+
+		double extractSeconds = 0;
+		double bruteForceSeconds = 0;
+		int32 numEdited = 0;
+		int32 numSignMismatches = 0;
+		int32 numMaterialMismatches = 0;
+		double maxError = 0;
+
+		TArray<const FVoxelEdit*> edits;
+		for (int32 chunk = 0; chunk < 16; chunk++)
+		{
+			// Chunks centered on a stroke so they cut through the tunnels
+			const FIntVector center = octree.GetLatticePoint(strokes[random.RandRange(0, strokes.Num() - 1)].Center);
+			const FIntVector origin = center - FIntVector(edgeCount / 2 * stride);
+
+			for (int32 i = 0; i < densities.Num(); i++)
+			{
+				densities[i] = TNumericLimits<double>::Max();
+			}
+
+			start = FPlatformTime::Seconds();
+			octree.Extract(origin, stride, size, densities, materialIds);
+			extractSeconds += FPlatformTime::Seconds() - start;
+
+			start = FPlatformTime::Seconds();
+			// Digging changes distances in the solid around a stroke as far as the range, the sign only inside its bounds
+			const FVector boxMin = FVector(origin) * GroundVoxelSize;
+			const FBox box = FBox(boxMin, boxMin + FVector(edgeCount * stride * GroundVoxelSize)).ExpandBy(range);
+			edits.Reset();
+			for (const FVoxelEdit& stroke : strokes)
+			{
+				if (stroke.GetBounds().Intersect(box))
+				{
+					edits.Add(&stroke);
+				}
+			}
+
+			int32 index = 0;
+			for (int32 x = 0; x < edgeCount; x++)
+			{
+				for (int32 y = 0; y < edgeCount; y++)
+				{
+					for (int32 z = 0; z < edgeCount; z++, index++)
+					{
+						const FVector location = FVector(origin + FIntVector(x, y, z) * stride) * GroundVoxelSize;
+
+						// The octree clamps distances to its range between strokes, which decides where deep solid takes a fill's material
+						uint8 materialId = 0;
+						double distance = FMath::Clamp((SampleRollingGround(location, materialId) - GroundIsovalue) / GroundDensityPerUnit, -range, range);
+						for (const FVoxelEdit* edit : edits)
+						{
+							distance = FMath::Clamp(edit->Apply(location, distance, &materialId), -range, range);
+						}
+
+						if (densities[index] == TNumericLimits<double>::Max())
+						{
+							continue;
+						}
+
+						numEdited++;
+						numSignMismatches += (distance < 0) != (densities[index] < GroundIsovalue);
+						numMaterialMismatches += distance < 0 && materialId != materialIds[index];
+						maxError = FMath::Max(maxError, FMath::Abs(distance - (densities[index] - GroundIsovalue) / GroundDensityPerUnit));
+					}
+				}
+			}
+			bruteForceSeconds += FPlatformTime::Seconds() - start;
+		}
+
+		AddInfo(FString::Printf(
+			TEXT("Stride %d | %6d edited samples | extract %7.3f ms | sampling strokes %7.3f ms | max error %.4f units"),
+			stride, numEdited, extractSeconds * 1000.0, bruteForceSeconds * 1000.0, maxError
+		));
+
+		TestTrue(TEXT("Chunks overlap edited samples"), numEdited > 0);
+		TestEqual(TEXT("Extracted samples are inside where the strokes leave them inside"), numSignMismatches, 0);
+		TestEqual(TEXT("Extracted solid keeps its material"), numMaterialMismatches, 0);
+		TestTrue(TEXT("Extracted distances are within one quantization step"), maxError <= tolerance);
+	}
+
+	// A cavern dug out of solid stone keeps bricks along its shell only, the air inside collapses
+	FVoxelEditOctree cavern;
+	InitGround(cavern);
+
+	FVoxelEdit dig;
+	dig.Operation = EVoxelEditOperation::Remove;
+	dig.Center = FVector(0, 0, -30000);
+	dig.Extent = FVector(15000);
+	cavern.ApplyEdit(dig, SampleRollingGround);
+
+	const double radiusVoxels = dig.Extent.X / GroundVoxelSize;
+	const double shellBricks = 4 * PI * radiusVoxels * radiusVoxels / (FVoxelEditOctree::BrickSize * FVoxelEditOctree::BrickSize);
+	const double ballBricks = 4.0 / 3.0 * PI * FMath::Pow(radiusVoxels, 3.0) / FVoxelEditOctree::BrickVolume;
+
+	AddInfo(FString::Printf(
+		TEXT("Cavern of %.0f m radius | %d bricks, %.0f over its shell, %.0f over its volume | %d nodes"),
+		dig.Extent.X / 100, cavern.NumBricks(), shellBricks, ballBricks, cavern.NumNodes()
+	));
+
+	TestTrue(TEXT("A cavern's bricks follow its shell"), cavern.NumBricks() < shellBricks * 4);
+
+	double density = 0;
+	uint8 materialId = 1;
+	TestTrue(TEXT("The cavern's inside is edited"), cavern.Sample(cavern.GetLatticePoint(dig.Center), density, &materialId));
+	TestTrue(TEXT("The cavern's inside is air"), density > GroundIsovalue && materialId == 0);
+
+	// Filling it back in collapses the shell to solid too
+	FVoxelEdit fill = dig;
+	fill.Operation = EVoxelEditOperation::Add;
+	fill.Extent = FVector(20000);
+	fill.MaterialId = 1;
+	cavern.ApplyEdit(fill, SampleRollingGround);
+
+	TestEqual(TEXT("A filled cavern holds no bricks"), cavern.NumBricks(), 0);
+
+	return true;
+}
@@ -0,0 +1,99 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+
+#include "VoxelBenchmarkFixtures.h"
+#include "VoxelMesher/VoxelMarchingCubes.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelKernelBenchmark, "Voxel.Benchmarks.SpecializedKernels",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+using namespace RealtimeMesh;
+
+namespace VoxelKernelBenchmark
+{
+	static constexpr int32 NumPasses = 8;
+
+	struct FResult
+	{
+		TArray<FVector3f> Positions;
+		TArray<TIndex3<uint32>> Triangles;
+		double TimeMs = 0;
+	};
+
+	template<typename FuncType>
+	FResult Run(FuncType&& InGenerate)
+	{
+		FResult result;
+		result.TimeMs = TNumericLimits<double>::Max();
+
+		FRealtimeMeshStreamSet streamSet;
+		for (int32 pass = 0; pass < NumPasses; pass++)
+		{
+			streamSet = FRealtimeMeshStreamSet();
+			const double start = FPlatformTime::Seconds();
+			InGenerate(streamSet);
+			result.TimeMs = FMath::Min(result.TimeMs, (FPlatformTime::Seconds() - start) * 1000.0);
+		}
+
+		result.Positions = TArray<FVector3f>(streamSet.FindChecked(FRealtimeMeshStreams::Position).GetArrayView<FVector3f>());
+		result.Triangles = TArray<TIndex3<uint32>>(streamSet.FindChecked(FRealtimeMeshStreams::Triangles).GetArrayView<TIndex3<uint32>>());
+		return result;
+	}
+
+	/* Specialized kernel for InResolution, generic kernel for 0, rolled or unrolled */
+	template<int32 InResolution, bool bInUnrolled>
+	FResult RunKernel(const FArray3D<double>& InGrid, const FVoxelMeshParams& InParams)
+	{
+		return Run([&](FRealtimeMeshStreamSet& OutStreamSet)
+		{
+			TVoxelMarchingCubes<InResolution, bInUnrolled>::GenerateMesh(InGrid, InParams, OutStreamSet);
+		});
+	}
+
+	bool IsSameMesh(const FResult& InA, const FResult& InB)
+	{
+		return InA.Positions == InB.Positions && InA.Triangles == InB.Triangles;
+	}
+
+	template<int32 InResolution>
+	void Measure(FAutomationTestBase& InTest)
+	{
+		const FArray3D<double> grid = VoxelBenchmarkFixtures::SampleSphereGrid(InResolution, VoxelMarchingCubes::Apron);
+
+		FVoxelMeshParams params;
+		params.ChunkOrigin = FVector3f::ZeroVector;
+		params.VoxelSize = 1.0;
+		params.SurfaceIsovalue = 1.0;
+		params.Resolution = InResolution;
+
+		const FResult generic = RunKernel<0, false>(grid, params);
+		const FResult specialized = RunKernel<InResolution, false>(grid, params);
+		const FResult unrolled = RunKernel<InResolution, true>(grid, params);
+
+		InTest.AddInfo(FString::Printf(
+			TEXT("R=%-3d %7d tris | Generic %7.3f ms | Specialized %7.3f ms %.2fx | Specialized unrolled %7.3f ms %.2fx"),
+			InResolution, generic.Triangles.Num(), generic.TimeMs,
+			specialized.TimeMs, specialized.TimeMs > 0 ? generic.TimeMs / specialized.TimeMs : 0.0,
+			unrolled.TimeMs, unrolled.TimeMs > 0 ? generic.TimeMs / unrolled.TimeMs : 0.0
+		));
+
+		InTest.TestTrue(TEXT("The generic kernel meshes the chunk"), generic.Triangles.Num() > 0);
+		InTest.TestTrue(TEXT("The specialized kernel emits the generic kernel's mesh"), IsSameMesh(generic, specialized));
+		InTest.TestTrue(TEXT("The unrolled kernel emits the generic kernel's mesh"), IsSameMesh(generic, unrolled));
+	}
+}
+
+bool FVoxelKernelBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace VoxelKernelBenchmark;
+
+	// Every resolution VoxelMarchingCubes::GenerateMesh has a specialized kernel for
+	Measure<8>(*this);
+	Measure<16>(*this);
+	Measure<32>(*this);
+	Measure<64>(*this);
+
+	return true;
+}
@@ -0,0 +1,182 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "Algo/IsSorted.h"
+#include "HAL/PlatformTime.h"
+
+#include "VoxelMesher/VoxelMarchingCubes.h"
+#include "VoxelMesher/VoxelSurfaceNets.h"
+#include "VoxelUtilities/Array3D.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelMaterialBenchmark, "Voxel.Benchmarks.Materials",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+using namespace RealtimeMesh;
+
+namespace VoxelMaterialBenchmark
+{
+	static constexpr int32 NumMaterials = 4;
+
+	/* Density of a rippled sphere of InRadius around the origin at InLocation, below 1 inside */
+	double SampleDensity(const FVector& InLocation, double InRadius)
+	{
+		return InLocation.Length() / InRadius + 0.05 * FMath::Sin(InLocation.X * 0.3) * FMath::Cos(InLocation.Y * 0.2);
+	}
+
+	/* Latitude bands like AVoxelVolume::GetMaterialId over the upper half of the sphere, the lower half is material 0 */
+	uint8 SampleMaterial(const FVector& InLocation)
+	{
+		const double latitude = FMath::Clamp(InLocation.Z / FMath::Max(InLocation.Length(), UE_SMALL_NUMBER), 0.0, 1.0);
+		return (uint8)FMath::Min((int32)(latitude * NumMaterials), NumMaterials - 1);
+	}
+
+	/* Location of a grid corner relative to the centre of a chunk of InResolution cells, sampled InApron corners past every face */
+	FVector GetSampleLocation(int32 InX, int32 InY, int32 InZ, int32 InResolution, int32 InApron)
+	{
+		return FVector(InX, InY, InZ) - (InApron + InResolution * 0.5);
+	}
+
+	struct FResult
+	{
+		int32 NumTriangles = 0;
+		int32 NumDraws = 0;
+		bool bGrouped = false;
+		TArray<uint16> Materials;
+		double FinalizeMs = 0;
+	};
+
+	/* Checks every material's triangles form one range, read back from the segments or the per-triangle polygroups */
+	bool IsGrouped(const FRealtimeMeshStreamSet& InStreamSet, int32 InNumTriangles)
+	{
+		if (const FRealtimeMeshStream* segments = InStreamSet.Find(FRealtimeMeshStreams::PolyGroupSegments))
+		{
+			int32 nextTriangle = 0;
+			TSet<int32> seen;
+			for (const FRealtimeMeshPolygonGroupRange& segment : segments->GetArrayView<FRealtimeMeshPolygonGroupRange>())
+			{
+				bool bAlreadySeen;
+				seen.Add(segment.PolygonGroupIndex, &bAlreadySeen);
+				if (segment.StartIndex != nextTriangle || bAlreadySeen)
+				{
+					return false;
+				}
+				nextTriangle += segment.Count;
+			}
+
+			return nextTriangle == InNumTriangles;
+		}
+
+		const FRealtimeMeshStream* polyGroups = InStreamSet.Find(FRealtimeMeshStreams::PolyGroups);
+		return polyGroups && polyGroups->Num() == InNumTriangles && Algo::IsSorted(polyGroups->GetArrayView<uint16>());
+	}
+
+	/* Meshes the chunk with material ids, the way AVoxelVolume::GenerateChunkMesh does */
+	FResult Measure(int32 InResolution, bool bInSurfaceNets, bool bInLean, bool bInMaterials)
+	{
+		const int32 apron = bInSurfaceNets ? FVoxelSurfaceNets::Apron : VoxelMarchingCubes::Apron;
+		const FIntVector size(InResolution + 1 + apron * 2);
+		const double radius = InResolution * 0.4;
+
+		FArray3D<double> grid(size, NoInit);
+		FArray3D<uint8> materialIds(size, NoInit);
+		grid.ForEachElement([&](int32 InX, int32 InY, int32 InZ, double& OutDensity)
+		{
+			const FVector location = GetSampleLocation(InX, InY, InZ, InResolution, apron);
+			OutDensity = SampleDensity(location, radius);
+			materialIds(InX, InY, InZ) = SampleMaterial(location);
+		});
+
+		FVoxelMeshParams params;
+		params.ChunkOrigin = FVector3f::ZeroVector;
+		params.VoxelSize = 1.0;
+		params.SurfaceIsovalue = 1.0;
+		params.Resolution = InResolution;
+		params.bLeanLayout = bInLean;
+		params.MaterialIds = bInMaterials ? &materialIds : nullptr;
+
+		FRealtimeMeshStreamSet streamSet;
+		if (bInSurfaceNets)
+		{
+			FVoxelSurfaceNets::GenerateMesh(grid, params, streamSet);
+		}
+		else
+		{
+			VoxelMarchingCubes::GenerateMesh(grid, params, false, streamSet);
+		}
+
+		const double start = FPlatformTime::Seconds();
+		FinalizeVoxelMeshStreams(params, streamSet);
+
+		FResult result;
+		result.FinalizeMs = (FPlatformTime::Seconds() - start) * 1000.0;
+		result.NumTriangles = streamSet.FindChecked(FRealtimeMeshStreams::Triangles).Num();
+		result.bGrouped = IsGrouped(streamSet, result.NumTriangles);
+
+		// The section group makes one section, and so one draw, per polygroup it finds
+		GetVoxelMeshMaterials(streamSet, result.Materials);
+		result.NumDraws = result.Materials.Num();
+		return result;
+	}
+
+	/* Meshes the chunk slab by slab, the material planes follow the density planes */
+	TArray<uint16> MeasureSlabs(int32 InResolution)
+	{
+		const int32 apron = VoxelMarchingCubes::Apron;
+		const int32 edgeCount = InResolution + 1 + apron * 2;
+		const double radius = InResolution * 0.4;
+
+		FVoxelMeshParams params;
+		params.ChunkOrigin = FVector3f::ZeroVector;
+		params.VoxelSize = 1.0;
+		params.SurfaceIsovalue = 1.0;
+		params.Resolution = InResolution;
+
+		FRealtimeMeshStreamSet streamSet;
+		VoxelMarchingCubes::GenerateMeshSlabs(params, [&](int32 InX, TArrayView<double> OutPlane, TArrayView<uint8> OutMaterialPlane)
+		{
+			for (int32 i = 0; i < OutPlane.Num(); i++)
+			{
+				const FVector location = GetSampleLocation(InX, i / edgeCount, i % edgeCount, InResolution, apron);
+				OutPlane[i] = SampleDensity(location, radius);
+				OutMaterialPlane[i] = SampleMaterial(location);
+			}
+		}, false, streamSet);
+		FinalizeVoxelMeshStreams(params, streamSet);
+
+		TArray<uint16> materials;
+		GetVoxelMeshMaterials(streamSet, materials);
+		return materials;
+	}
+}
+
+bool FVoxelMaterialBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace VoxelMaterialBenchmark;
+
+	for (const int32 resolution : { 16, 32, 64 })
+	{
+		for (const bool bSurfaceNets : { false, true })
+		{
+			for (const bool bLean : { false, true })
+			{
+				const FResult single = Measure(resolution, bSurfaceNets, bLean, false);
+				const FResult result = Measure(resolution, bSurfaceNets, bLean, true);
+
+				AddInfo(FString::Printf(
+					TEXT("R=%-3d %-14s %-4s %6d tris | %d draws | grouped in %6.3f ms"),
+					resolution, bSurfaceNets ? TEXT("SurfaceNets") : TEXT("MarchingCubes"), bLean ? TEXT("Lean") : TEXT("Full"),
+					result.NumTriangles, result.NumDraws, result.FinalizeMs
+				));
+
+				TestEqual(TEXT("Materials do not change the surface"), result.NumTriangles, single.NumTriangles);
+				TestEqual(TEXT("A single material is a single draw"), single.NumDraws, 1);
+				TestTrue(TEXT("Triangles come out grouped by material"), result.bGrouped);
+				TestEqual(TEXT("Every material band the sphere crosses gets one draw"), result.NumDraws, NumMaterials);
+			}
+		}
+
+		TestTrue(TEXT("Slab meshing finds the same materials"), MeasureSlabs(resolution) == Measure(resolution, false, false, true).Materials);
+	}
+
+	return true;
+}
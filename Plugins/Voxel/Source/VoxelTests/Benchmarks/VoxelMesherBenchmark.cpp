@@ -0,0 +1,113 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+
+#include "VoxelMesher/VoxelMarchingCubes.h"
+#include "VoxelMesher/VoxelSurfaceNets.h"
+#include "VoxelUtilities/Array3D.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelMesherBenchmark, "Voxel.Benchmarks.Meshers",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+using namespace RealtimeMesh;
+
+namespace VoxelMesherBenchmark
+{
+	static constexpr int32 NumPasses = 8;
+
+	/* Sphere with a few octaves of ripples on it, so the surface is not one smooth case over and over */
+	double SampleDensity(const FVector& InLocation, double InRadius)
+	{
+		const double ripples =
+			0.06 * FMath::Sin(InLocation.X * 0.21) * FMath::Cos(InLocation.Y * 0.17)
+			+ 0.03 * FMath::Sin(InLocation.Z * 0.43 + InLocation.X * 0.11);
+
+		return InLocation.Length() / InRadius + ripples;
+	}
+
+	/* Grid of InEdgeCount samples per edge starting InApron voxels before the corner of a chunk centered on the sphere */
+	FArray3D<double> SampleGrid(int32 InResolution, int32 InApron)
+	{
+		const int32 edgeCount = InResolution + 1 + InApron * 2;
+		const double radius = InResolution * 0.4;
+
+		FArray3D<double> grid(FIntVector(edgeCount), NoInit);
+		grid.ForEachElement([&](int32 InX, int32 InY, int32 InZ, double& OutDensity)
+		{
+			const FVector location = FVector(InX, InY, InZ) - (InApron + InResolution * 0.5);
+			OutDensity = SampleDensity(location, radius);
+		});
+
+		return grid;
+	}
+
+	struct FResult
+	{
+		int32 NumVertices = 0;
+		int32 NumTriangles = 0;
+		double TimeMs = 0;
+	};
+
+	template<typename FuncType>
+	FResult Run(FuncType&& InGenerate)
+	{
+		FResult result;
+		result.TimeMs = TNumericLimits<double>::Max();
+
+		for (int32 pass = 0; pass < NumPasses; pass++)
+		{
+			FRealtimeMeshStreamSet streamSet;
+
+			const double start = FPlatformTime::Seconds();
+			InGenerate(streamSet);
+			result.TimeMs = FMath::Min(result.TimeMs, (FPlatformTime::Seconds() - start) * 1000.0);
+
+			const FRealtimeMeshStream* positions = streamSet.Find(FRealtimeMeshStreams::Position);
+			const FRealtimeMeshStream* triangles = streamSet.Find(FRealtimeMeshStreams::Triangles);
+			result.NumVertices = positions ? positions->Num() : 0;
+			result.NumTriangles = triangles ? triangles->Num() : 0;
+		}
+
+		return result;
+	}
+}
+
+bool FVoxelMesherBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace VoxelMesherBenchmark;
+
+	for (const int32 resolution : { 16, 32, 64 })
+	{
+		FVoxelMeshParams params;
+		params.ChunkOrigin = FVector3f::ZeroVector;
+		params.VoxelSize = 1.0;
+		params.SurfaceIsovalue = 1.0;
+		params.Resolution = resolution;
+
+		const FArray3D<double> marchingCubesGrid = SampleGrid(resolution, VoxelMarchingCubes::Apron);
+		const FArray3D<double> surfaceNetsGrid = SampleGrid(resolution, FVoxelSurfaceNets::Apron);
+
+		const FResult marchingCubes = Run([&](FRealtimeMeshStreamSet& OutStreamSet)
+		{
+			VoxelMarchingCubes::GenerateMesh(marchingCubesGrid, params, false, OutStreamSet);
+		});
+
+		const FResult surfaceNets = Run([&](FRealtimeMeshStreamSet& OutStreamSet)
+		{
+			FVoxelSurfaceNets::GenerateMesh(surfaceNetsGrid, params, OutStreamSet);
+		});
+
+		AddInfo(FString::Printf(
+			TEXT("R=%-3d MarchingCubes %7d tris %7d verts %7.3f ms | SurfaceNets %7d tris %7d verts %7.3f ms"),
+			resolution,
+			marchingCubes.NumTriangles, marchingCubes.NumVertices, marchingCubes.TimeMs,
+			surfaceNets.NumTriangles, surfaceNets.NumVertices, surfaceNets.TimeMs
+		));
+
+		TestTrue(TEXT("Both meshers produce a surface"), marchingCubes.NumTriangles > 0 && surfaceNets.NumTriangles > 0);
+		TestTrue(TEXT("Both meshers share their vertices"), marchingCubes.NumVertices < marchingCubes.NumTriangles && surfaceNets.NumVertices < surfaceNets.NumTriangles);
+	}
+
+	return true;
+}
@@ -0,0 +1,104 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#include "VoxelMesher/VoxelMarchingCubes.h"
+#include "VoxelUtilities/Array3D.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelNormalsBenchmark, "Voxel.Benchmarks.Normals",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+using namespace RealtimeMesh;
+
+namespace VoxelNormalsBenchmark
+{
+	struct FResult
+	{
+		int32 NumTriangles = 0;
+
+		// Mean angle between the mesh normals and the sphere's, in degrees
+		double GradientError = 0;
+		double FacetError = 0;
+	};
+
+	/* Meshes a sphere filling most of a chunk of InResolution cells and compares its vertex and face normals to the true ones */
+	FResult MeasureSphere(int32 InResolution)
+	{
+		const double radius = InResolution * 0.4;
+		const FVector3f center(InResolution * 0.5f);
+		const int32 apron = VoxelMarchingCubes::Apron;
+
+		FArray3D<double> grid(FIntVector(VoxelMarchingCubes::GetGridEdgeCount(InResolution)), NoInit);
+		grid.ForEachElement([&](int32 InX, int32 InY, int32 InZ, double& OutDensity)
+		{
+			OutDensity = (FVector(InX - apron, InY - apron, InZ - apron) - FVector(center)).Length() / radius;
+		});
+
+		FVoxelMeshParams params;
+		params.ChunkOrigin = FVector3f::ZeroVector;
+		params.VoxelSize = 1.0;
+		params.SurfaceIsovalue = 1.0;
+		params.Resolution = InResolution;
+
+		FRealtimeMeshStreamSet streamSet;
+		VoxelMarchingCubes::GenerateMesh(grid, params, false, streamSet);
+
+		const TConstArrayView<const FVector3f> positions = streamSet.Find(FRealtimeMeshStreams::Position)->GetArrayView<FVector3f>();
+		const TConstArrayView<const TIndex3<uint32>> triangles = streamSet.Find(FRealtimeMeshStreams::Triangles)->GetArrayView<TIndex3<uint32>>();
+
+		const auto getAngle = [](const FVector3f& InA, const FVector3f& InB)
+		{
+			return FMath::RadiansToDegrees(FMath::Acos(FMath::Min(FVector3f::DotProduct(InA, InB), 1.0f)));
+		};
+
+		// Gradient normals are read back from the tangent stream, so the error includes their 8 bit packing
+		const TConstArrayView<const TRealtimeMeshTangents<FPackedNormal>> tangents =
+			streamSet.Find(FRealtimeMeshStreams::Tangents)->GetArrayView<TRealtimeMeshTangents<FPackedNormal>>();
+
+		FResult result;
+		result.NumTriangles = triangles.Num();
+
+		for (int32 i = 0; i < positions.Num(); i++)
+		{
+			result.GradientError += getAngle(tangents[i].GetNormal().GetSafeNormal(), (positions[i] - center).GetSafeNormal());
+		}
+		result.GradientError /= positions.Num();
+
+		// What the per-triangle cross product normals gave before
+		for (const TIndex3<uint32>& triangle : triangles)
+		{
+			const FVector3f& vertexA = positions[triangle.V0];
+			const FVector3f& vertexB = positions[triangle.V1];
+			const FVector3f& vertexC = positions[triangle.V2];
+
+			const FVector3f facetNormal = FVector3f::CrossProduct(vertexC - vertexA, vertexB - vertexA).GetSafeNormal();
+			result.FacetError += getAngle(facetNormal, ((vertexA + vertexB + vertexC) / 3.0f - center).GetSafeNormal());
+		}
+		result.FacetError /= triangles.Num();
+
+		return result;
+	}
+}
+
+bool FVoxelNormalsBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace VoxelNormalsBenchmark;
+
+	TMap<int32, FResult> results;
+	for (const int32 resolution : { 8, 16, 32, 64 })
+	{
+		const FResult& result = results.Add(resolution, MeasureSphere(resolution));
+
+		AddInfo(FString::Printf(
+			TEXT("R=%-3d %6d tris | gradient normals %6.3f deg | facet normals %6.3f deg"),
+			resolution, result.NumTriangles, result.GradientError, result.FacetError
+		));
+
+		TestTrue(TEXT("Gradient normals are closer to the surface than facet normals"), result.GradientError < result.FacetError);
+	}
+
+	// The point of the gradient: a coarse chunk shades at least as well as a chunk of twice its resolution did
+	TestTrue(TEXT("Gradient normals at R=16 beat facet normals at R=32"), results[16].GradientError < results[32].FacetError);
+
+	return true;
+}
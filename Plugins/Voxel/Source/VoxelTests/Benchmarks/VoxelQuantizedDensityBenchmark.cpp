@@ -0,0 +1,100 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#include "VoxelBenchmarkFixtures.h"
+#include "VoxelMesher/VoxelMarchingCubes.h"
+#include "VoxelUtilities/VoxelQuantizedDensity.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelQuantizedDensityBenchmark, "Voxel.Benchmarks.QuantizedDensity",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+using namespace RealtimeMesh;
+
+namespace VoxelQuantizedDensityBenchmark
+{
+	static constexpr int32 Resolution = 32;
+
+	struct FResult
+	{
+		TArray<FVector3f> Positions;
+		int32 NumTriangles = 0;
+	};
+
+	template<typename InSampleType>
+	FResult Mesh(const FArray3D<InSampleType>& InGrid)
+	{
+		FVoxelMeshParams params;
+		params.ChunkOrigin = FVector3f::ZeroVector;
+		params.VoxelSize = 1.0;
+		params.SurfaceIsovalue = 1.0;
+		params.Resolution = Resolution;
+
+		FRealtimeMeshStreamSet streamSet;
+		VoxelMarchingCubes::GenerateMesh(InGrid, params, false, streamSet);
+
+		FResult result;
+		result.Positions = TArray<FVector3f>(streamSet.FindChecked(FRealtimeMeshStreams::Position).GetArrayView<FVector3f>());
+		result.NumTriangles = streamSet.FindChecked(FRealtimeMeshStreams::Triangles).Num();
+		return result;
+	}
+
+	/* Quantizes InGrid, meshes it and compares with InExact, the mesh of the full precision densities */
+	template<typename InStorageType>
+	void Measure(FAutomationTestBase& InTest, const FArray3D<double>& InGrid, const FResult& InExact, double InTolerance)
+	{
+		const TVoxelQuantizedDensity<InStorageType> quantization(1.0, 1.0 / VoxelBenchmarkFixtures::GetSphereRadius(Resolution));
+
+		FArray3D<InStorageType> samples(InGrid.GetSize3D(), NoInit);
+		quantization.Encode(InGrid.InternalArray, samples.InternalArray);
+
+		// Samples within the quantized range decode to within half a step of their density
+		const double halfStep = 0.5 / quantization.Scale;
+		double maxDecodeError = 0;
+		for (int32 i = 0; i < InGrid.InternalArray.Num(); i++)
+		{
+			const double density = InGrid.InternalArray[i];
+			if (FMath::Abs(density - quantization.Isovalue) * quantization.Scale < TVoxelQuantizedDensity<InStorageType>::MaxValue)
+			{
+				maxDecodeError = FMath::Max(maxDecodeError, FMath::Abs(quantization.Decode(samples.InternalArray[i]) - density));
+			}
+		}
+
+		const FResult quantized = Mesh(samples);
+
+		double maxVertexError = TNumericLimits<double>::Max();
+		if (quantized.Positions.Num() == InExact.Positions.Num())
+		{
+			maxVertexError = 0;
+			for (int32 i = 0; i < quantized.Positions.Num(); i++)
+			{
+				maxVertexError = FMath::Max(maxVertexError, (double)FVector3f::Distance(quantized.Positions[i], InExact.Positions[i]));
+			}
+		}
+
+		InTest.AddInfo(FString::Printf(
+			TEXT("int%-2d %d bytes per sample, %.1fx smaller | %7d tris | max vertex error %.5f voxels | max decode error %.2e"),
+			(int32)sizeof(InStorageType) * 8, (int32)sizeof(InStorageType), (double)sizeof(double) / sizeof(InStorageType),
+			quantized.NumTriangles, maxVertexError, maxDecodeError
+		));
+
+		InTest.TestEqual(TEXT("Quantized samples keep every corner's side of the surface, so the cells mesh the same triangles"), quantized.NumTriangles, InExact.NumTriangles);
+		InTest.TestTrue(TEXT("Quantized vertices stay close to the exact ones"), maxVertexError < InTolerance);
+		InTest.TestTrue(TEXT("Quantized samples decode to within half a step"), maxDecodeError <= halfStep * 1.0001);
+	}
+}
+
+bool FVoxelQuantizedDensityBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace VoxelQuantizedDensityBenchmark;
+
+	const FArray3D<double> grid = VoxelBenchmarkFixtures::SampleSphereGrid(Resolution, VoxelMarchingCubes::Apron);
+	const FResult exact = Mesh(grid);
+	TestTrue(TEXT("The exact densities mesh the chunk"), exact.NumTriangles > 0);
+
+	// 8 bit keeps 1/63 voxel steps, 16 bit 1/2047, a vertex moves by a few steps at most
+	Measure<int8>(*this, grid, exact, 0.1);
+	Measure<int16>(*this, grid, exact, 0.01);
+
+	return true;
+}
@@ -0,0 +1,166 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Math/RandomStream.h"
+#include "Chaos/TriangleMeshImplicitObject.h"
+
+#include "VoxelCollisionFixtures.h"
+#include "VoxelQuery/VoxelDensityQuery.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelQueryBenchmark, "Voxel.Benchmarks.Query",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+using namespace RealtimeMesh;
+
+namespace VoxelQueryBenchmark
+{
+	using namespace VoxelCollisionFixtures;
+
+	static constexpr int32 Resolution = 64;
+	static constexpr int32 NumRays = 20000;
+	static constexpr double Radius = Resolution * 0.4;
+
+	/* Bumpy sphere in the middle of the chunk, densities change by 1 / Radius per voxel near its surface */
+	void SampleGrid(FArray3D<double>& OutGrid)
+	{
+		const int32 apron = FVoxelSurfaceNets::Apron;
+		OutGrid.Init(FIntVector(FVoxelSurfaceNets::GetGridEdgeCount(Resolution)), NoInit);
+		OutGrid.ForEachElement([&](int32 InX, int32 InY, int32 InZ, double& OutDensity)
+		{
+			const FVector location = FVector(InX, InY, InZ) - (apron + Resolution * 0.5);
+			OutDensity = location.Length() / Radius + 0.05 * FMath::Sin(location.X * 6.0 / Resolution) * FMath::Cos(location.Y * 6.0 / Resolution);
+		});
+	}
+
+	/* Grid density at InLocation, interpolated between its corners the way AVoxelVolume::GetDensity interpolates the finest voxels */
+	double SampleInterpolated(const FArray3D<double>& InGrid, const FVector& InLocation)
+	{
+		const FVector maxCorner(InGrid.GetSizeX() - 1.001);
+		const FVector lattice = (InLocation + FVoxelSurfaceNets::Apron).ComponentMax(FVector::ZeroVector).ComponentMin(maxCorner);
+		const FIntVector minCorner(FMath::FloorToInt(lattice.X), FMath::FloorToInt(lattice.Y), FMath::FloorToInt(lattice.Z));
+		const FVector alpha = lattice - FVector(minCorner);
+
+		const auto corner = [&](int32 InX, int32 InY, int32 InZ) { return InGrid(minCorner.X + InX, minCorner.Y + InY, minCorner.Z + InZ); };
+		const double x00 = FMath::Lerp(corner(0, 0, 0), corner(1, 0, 0), alpha.X);
+		const double x01 = FMath::Lerp(corner(0, 0, 1), corner(1, 0, 1), alpha.X);
+		const double x10 = FMath::Lerp(corner(0, 1, 0), corner(1, 1, 0), alpha.X);
+		const double x11 = FMath::Lerp(corner(0, 1, 1), corner(1, 1, 1), alpha.X);
+		return FMath::Lerp(FMath::Lerp(x00, x10, alpha.Y), FMath::Lerp(x01, x11, alpha.Y), alpha.Z);
+	}
+
+	struct FRay
+	{
+		FVector Start;
+		FVector End;
+	};
+}
+
+bool FVoxelQueryBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace VoxelQueryBenchmark;
+
+	FArray3D<double> grid;
+	SampleGrid(grid);
+
+	FRealtimeMeshTriMeshData triMeshData;
+	GenerateTriMesh(grid, Resolution, triMeshData);
+
+	const UBodySetup* bodySetup = Cook(triMeshData);
+	if (!TestTrue(TEXT("The chunk cooks"), bodySetup->TriMeshGeometries.Num() == 1))
+	{
+		return false;
+	}
+	const auto& triMesh = bodySetup->TriMeshGeometries[0];
+
+	// Rays from just inside the chunk's box towards points around the center, every one of them crosses the surface
+	FRandomStream random(1337);
+	const FVector center(Resolution * 0.5);
+	TArray<FRay> rays;
+	for (int32 i = 0; i < NumRays; i++)
+	{
+		const FVector start = center + random.GetUnitVector() * Resolution * 0.49;
+		const FVector target = center + random.GetUnitVector() * Radius * 0.3;
+		rays.Add({ start, start + (target - start).GetSafeNormal() * Resolution });
+	}
+
+	const auto sampleDensity = [&grid](const FVector& InLocation) { return SampleInterpolated(grid, InLocation); };
+	const FVoxelDensityQuery query(sampleDensity, 1.0, 1.0 / Radius, 1.0);
+
+	TArray<double> densityHits, meshHits;
+	densityHits.Init(-1, NumRays);
+	meshHits.Init(-1, NumRays);
+
+	double start = FPlatformTime::Seconds();
+	for (int32 i = 0; i < NumRays; i++)
+	{
+		FVoxelRaycastHit hit;
+		if (query.Raycast(rays[i].Start, rays[i].End, hit))
+		{
+			densityHits[i] = hit.Distance;
+		}
+	}
+	const double densityMs = (FPlatformTime::Seconds() - start) * 1000.0;
+
+	// What a line trace against the chunk's body runs once the broadphase found it
+	start = FPlatformTime::Seconds();
+	for (int32 i = 0; i < NumRays; i++)
+	{
+		const FVector direction = (rays[i].End - rays[i].Start).GetSafeNormal();
+		Chaos::FReal time;
+		Chaos::FVec3 position, normal;
+		int32 faceIndex;
+		if (triMesh->Raycast(rays[i].Start, direction, Resolution, 0, time, position, normal, faceIndex))
+		{
+			meshHits[i] = time;
+		}
+	}
+	const double meshMs = (FPlatformTime::Seconds() - start) * 1000.0;
+
+	// The queries only read the grid, so they spread over the workers as they are
+	start = FPlatformTime::Seconds();
+	ParallelFor(NumRays, [&](int32 i)
+	{
+		FVoxelRaycastHit hit;
+		query.Raycast(rays[i].Start, rays[i].End, hit);
+	});
+	const double parallelMs = (FPlatformTime::Seconds() - start) * 1000.0;
+
+	int32 numDisagreements = 0;
+	int32 numDensityHits = 0;
+	for (int32 i = 0; i < NumRays; i++)
+	{
+		numDensityHits += densityHits[i] >= 0 ? 1 : 0;
+		numDisagreements += (densityHits[i] < 0) != (meshHits[i] < 0) || FMath::Abs(densityHits[i] - meshHits[i]) > DensityHitTolerance ? 1 : 0;
+	}
+
+	AddInfo(FString::Printf(TEXT("%d rays | density %7.2f ms, %7.2f ms on %d workers | cooked trimesh %7.2f ms | %d hits, %d disagree by over %.1f voxels"),
+		NumRays, densityMs, parallelMs, FTaskGraphInterface::Get().GetNumWorkerThreads(), meshMs, numDensityHits, numDisagreements, DensityHitTolerance));
+
+	// Spheres around a point outside the surface, one reaching past it and one falling short
+	const FVector outward(1, 0, 0);
+	const bool bOverlapsReaching = query.SphereOverlap(center + outward * (Radius + 4), 6);
+	const bool bOverlapsShort = query.SphereOverlap(center + outward * (Radius + 4), 2);
+
+	TestEqual(TEXT("Every ray hits the surface"), numDensityHits, NumRays);
+	TestTrue(TEXT("Density hits land within a voxel of the cooked mesh's"), numDisagreements <= NumRays / 100);
+	TestTrue(TEXT("A sphere reaching the surface overlaps it"), bOverlapsReaching);
+	TestFalse(TEXT("A sphere short of the surface does not"), bOverlapsShort);
+
+	// Rays grazing flat ground closer than MinStep take a MinStep at a time, far more steps than an overlap gets
+	const double wallX = FVoxelDensityQuery::MaxSteps * 4;
+	const auto sampleGround = [wallX](const FVector& InLocation) { return FMath::Min(InLocation.Z, wallX - InLocation.X); };
+	const FVoxelDensityQuery groundQuery(sampleGround, 0.0, 1.0, 1.0);
+
+	FVoxelRaycastHit grazingHit;
+	const bool bGrazingHits = groundQuery.Raycast(FVector(0, 0, 0.5), FVector(wallX + 10, 0, 0.5), grazingHit);
+	TestTrue(TEXT("A long grazing ray reaches the wall at its end"), bGrazingHits && FMath::Abs(grazingHit.Distance - wallX) < 0.01);
+
+	FVoxelRaycastHit endlessHit;
+	const bool bEndlessHits = groundQuery.Raycast(FVector(-FVoxelDensityQuery::MaxRaySteps * 2.0, 0, 0.5), FVector(0, 0, 0.5), endlessHit);
+	TestTrue(TEXT("A ray too long to trace reports that it gave up"), !bEndlessHits && endlessHit.bIncomplete);
+
+	return true;
+}
@@ -0,0 +1,107 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+
+#include "VoxelBenchmarkFixtures.h"
+#include "VoxelMesher/VoxelMarchingCubes.h"
+#include "VoxelUtilities/VoxelSignMask.h"
+#include "VoxelUtilities/VoxelStatics.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelSignMaskBenchmark, "Voxel.Benchmarks.SignMask",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+namespace VoxelSignMaskBenchmark
+{
+	static constexpr int32 NumPasses = 8;
+
+	/* Cell and case packed together, so two classifications compare as sets */
+	int64 GetCellKey(int32 InX, int32 InY, int32 InZ, uint8 InCase)
+	{
+		return ((((int64)InX << 16 | InY) << 16 | InZ) << 8) | InCase;
+	}
+
+	/* Classifies every cell of the chunk one by one the way the marching loop did before the sign mask, returns the triangle count */
+	int32 GatherActiveCellsPerCell(const FArray3D<double>& InGrid, int32 InResolution, double InIsovalue, TSet<int64>& OutCells)
+	{
+		const int32 apron = VoxelMarchingCubes::Apron;
+		int32 numTris = 0;
+		for (int32 x = 0; x < InResolution; x++)
+		{
+			for (int32 y = 0; y < InResolution; y++)
+			{
+				for (int32 z = 0; z < InResolution; z++)
+				{
+					uint8 idxCase = 0;
+					for (int32 i = 0; i < 8; i++)
+					{
+						const double density = InGrid(
+							x + apron + (int32)VoxelStatics::a2fVertexOffset[i][0],
+							y + apron + (int32)VoxelStatics::a2fVertexOffset[i][1],
+							z + apron + (int32)VoxelStatics::a2fVertexOffset[i][2]
+						);
+						idxCase |= uint8(density < InIsovalue) << i;
+					}
+
+					if (idxCase != 0 && idxCase != 0xff)
+					{
+						OutCells.Add(GetCellKey(x, y, z, idxCase));
+						numTris += VoxelStatics::aiCubeTriangleCount[idxCase];
+					}
+				}
+			}
+		}
+
+		return numTris;
+	}
+}
+
+bool FVoxelSignMaskBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace VoxelSignMaskBenchmark;
+
+	// 70 cells take two words per row, the second one partly used
+	for (const int32 resolution : { 16, 32, 70 })
+	{
+		const FArray3D<double> grid = VoxelBenchmarkFixtures::SampleSphereGrid(resolution, VoxelMarchingCubes::Apron);
+
+		double maskMs = TNumericLimits<double>::Max();
+		double perCellMs = TNumericLimits<double>::Max();
+		TArray<FVoxelActiveCell> activeCells;
+		TSet<int64> perCellCells;
+		int32 maskTris = 0;
+		int32 perCellTris = 0;
+		for (int32 pass = 0; pass < NumPasses; pass++)
+		{
+			double start = FPlatformTime::Seconds();
+			FVoxelSignMask signMask;
+			signMask.Build(grid, 1.0, VoxelMarchingCubes::Apron);
+			activeCells.Reset();
+			maskTris = signMask.GatherActiveCells(activeCells);
+			maskMs = FMath::Min(maskMs, (FPlatformTime::Seconds() - start) * 1000.0);
+
+			start = FPlatformTime::Seconds();
+			perCellCells.Reset();
+			perCellTris = GatherActiveCellsPerCell(grid, resolution, 1.0, perCellCells);
+			perCellMs = FMath::Min(perCellMs, (FPlatformTime::Seconds() - start) * 1000.0);
+		}
+
+		bool bSameCells = activeCells.Num() == perCellCells.Num();
+		for (const FVoxelActiveCell& cell : activeCells)
+		{
+			bSameCells &= perCellCells.Contains(GetCellKey(cell.X, cell.Y, cell.Z, cell.Case));
+		}
+
+		const int32 numCells = resolution * resolution * resolution;
+		AddInfo(FString::Printf(
+			TEXT("R=%-3d %6d of %7d cells active | Sign mask %7.3f ms | Per cell %7.3f ms | %.1fx faster"),
+			resolution, activeCells.Num(), numCells, maskMs, perCellMs, maskMs > 0 ? perCellMs / maskMs : 0.0
+		));
+
+		TestTrue(TEXT("The sign mask finds exactly the cells with inside and outside corners, with their cases"), bSameCells);
+		TestEqual(TEXT("The sign mask counts the triangles of its active cells"), maskTris, perCellTris);
+		TestTrue(TEXT("Most cells of the chunk are skipped"), activeCells.Num() < numCells / 4);
+	}
+
+	return true;
+}
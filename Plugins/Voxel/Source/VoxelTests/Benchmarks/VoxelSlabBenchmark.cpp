@@ -0,0 +1,113 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+
+#include "VoxelBenchmarkFixtures.h"
+#include "VoxelMesher/VoxelMarchingCubes.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelSlabBenchmark, "Voxel.Benchmarks.SlabMeshing",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+using namespace RealtimeMesh;
+
+namespace VoxelSlabBenchmark
+{
+	static constexpr int32 NumPasses = 4;
+
+	struct FResult
+	{
+		TArray<FVector3f> Positions;
+		TArray<TIndex3<uint32>> Triangles;
+		double TimeMs = 0;
+	};
+
+	template<typename FuncType>
+	FResult Run(FuncType&& InGenerate)
+	{
+		FResult result;
+		result.TimeMs = TNumericLimits<double>::Max();
+
+		FRealtimeMeshStreamSet streamSet;
+		for (int32 pass = 0; pass < NumPasses; pass++)
+		{
+			streamSet = FRealtimeMeshStreamSet();
+			const double start = FPlatformTime::Seconds();
+			InGenerate(streamSet);
+			result.TimeMs = FMath::Min(result.TimeMs, (FPlatformTime::Seconds() - start) * 1000.0);
+		}
+
+		result.Positions = TArray<FVector3f>(streamSet.FindChecked(FRealtimeMeshStreams::Position).GetArrayView<FVector3f>());
+		result.Triangles = TArray<TIndex3<uint32>>(streamSet.FindChecked(FRealtimeMeshStreams::Triangles).GetArrayView<TIndex3<uint32>>());
+		return result;
+	}
+
+	/* Largest distance between the corners of the same triangle in both meshes, the largest double if their triangle counts differ */
+	double GetMaxCornerDistance(const FResult& InA, const FResult& InB)
+	{
+		if (InA.Triangles.Num() != InB.Triangles.Num())
+		{
+			return TNumericLimits<double>::Max();
+		}
+
+		double maxDistance = 0;
+		for (int32 i = 0; i < InA.Triangles.Num(); i++)
+		{
+			for (int32 k = 0; k < 3; k++)
+			{
+				const FVector3f& a = InA.Positions[InA.Triangles[i][k]];
+				const FVector3f& b = InB.Positions[InB.Triangles[i][k]];
+				maxDistance = FMath::Max(maxDistance, (double)FVector3f::Distance(a, b));
+			}
+		}
+
+		return maxDistance;
+	}
+}
+
+bool FVoxelSlabBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace VoxelSlabBenchmark;
+
+	for (const int32 resolution : { 32, 64, 96 })
+	{
+		const FArray3D<double> grid = VoxelBenchmarkFixtures::SampleSphereGrid(resolution, VoxelMarchingCubes::Apron);
+		const int32 gridEdgeCount = VoxelMarchingCubes::GetGridEdgeCount(resolution);
+
+		FVoxelMeshParams params;
+		params.ChunkOrigin = FVector3f::ZeroVector;
+		params.VoxelSize = 1.0;
+		params.SurfaceIsovalue = 1.0;
+		params.Resolution = resolution;
+
+		const FResult full = Run([&](FRealtimeMeshStreamSet& OutStreamSet)
+		{
+			VoxelMarchingCubes::GenerateMesh(grid, params, false, OutStreamSet);
+		});
+
+		// Planes are copied out of the same grid, so both paths mesh the same samples
+		const FResult slabs = Run([&](FRealtimeMeshStreamSet& OutStreamSet)
+		{
+			VoxelMarchingCubes::GenerateMeshSlabs(params, [&](int32 InX, TArrayView<double> OutPlane, TArrayView<uint8> OutMaterialPlane)
+			{
+				FMemory::Memcpy(OutPlane.GetData(), grid.GetSliceX(InX).GetData(), OutPlane.Num() * sizeof(double));
+			}, false, OutStreamSet);
+		});
+
+		const int64 gridBytes = int64(gridEdgeCount) * gridEdgeCount * gridEdgeCount * sizeof(double);
+		const int64 slabBytes = int64(gridEdgeCount) * gridEdgeCount * 4 * (sizeof(double) + sizeof(uint8));
+		const double maxDistance = GetMaxCornerDistance(full, slabs);
+
+		AddInfo(FString::Printf(
+			TEXT("R=%-3d %7d tris | Full grid %7.3f ms %9.1f KB | Slabs %7.3f ms %9.1f KB | max corner distance %g"),
+			resolution, full.Triangles.Num(), full.TimeMs, gridBytes / 1024.0, slabs.TimeMs, slabBytes / 1024.0, maxDistance
+		));
+
+		TestTrue(TEXT("The full grid path meshes the chunk"), full.Triangles.Num() > 0);
+		TestEqual(TEXT("Slabs emit the same vertices as the full grid"), slabs.Positions.Num(), full.Positions.Num());
+		TestTrue(TEXT("Slabs emit the same triangles as the full grid"), maxDistance < 1e-4);
+		TestTrue(TEXT("Slabs keep less density data resident than the full grid"), slabBytes < gridBytes);
+	}
+
+	return true;
+}
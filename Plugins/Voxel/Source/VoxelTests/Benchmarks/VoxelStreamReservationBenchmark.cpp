@@ -0,0 +1,82 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+
+#include "VoxelBenchmarkFixtures.h"
+#include "VoxelMesher/VoxelMarchingCubes.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelStreamReservationBenchmark, "Voxel.Benchmarks.StreamReservation",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+using namespace RealtimeMesh;
+
+namespace VoxelStreamReservationBenchmark
+{
+	static constexpr int32 NumPasses = 8;
+
+	/* Grid edges of the chunk between an inside and an outside corner, found one edge at a time */
+	int32 CountCrossedEdges(const FArray3D<double>& InGrid, int32 InResolution, double InIsovalue)
+	{
+		const int32 apron = VoxelMarchingCubes::Apron;
+		const auto isInside = [&](int32 InX, int32 InY, int32 InZ) { return InGrid(InX + apron, InY + apron, InZ + apron) < InIsovalue; };
+
+		int32 numCrossed = 0;
+		for (int32 x = 0; x <= InResolution; x++)
+		{
+			for (int32 y = 0; y <= InResolution; y++)
+			{
+				for (int32 z = 0; z <= InResolution; z++)
+				{
+					const bool bInside = isInside(x, y, z);
+					numCrossed += x < InResolution && isInside(x + 1, y, z) != bInside;
+					numCrossed += y < InResolution && isInside(x, y + 1, z) != bInside;
+					numCrossed += z < InResolution && isInside(x, y, z + 1) != bInside;
+				}
+			}
+		}
+
+		return numCrossed;
+	}
+}
+
+bool FVoxelStreamReservationBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace VoxelStreamReservationBenchmark;
+
+	for (const int32 resolution : { 16, 32, 48 })
+	{
+		const FArray3D<double> grid = VoxelBenchmarkFixtures::SampleSphereGrid(resolution, VoxelMarchingCubes::Apron);
+
+		FVoxelMeshParams params;
+		params.ChunkOrigin = FVector3f::ZeroVector;
+		params.VoxelSize = 1.0;
+		params.SurfaceIsovalue = 1.0;
+		params.Resolution = resolution;
+
+		double timeMs = TNumericLimits<double>::Max();
+		FRealtimeMeshStreamSet streamSet;
+		for (int32 pass = 0; pass < NumPasses; pass++)
+		{
+			streamSet = FRealtimeMeshStreamSet();
+			const double start = FPlatformTime::Seconds();
+			VoxelMarchingCubes::GenerateMesh(grid, params, false, streamSet);
+			timeMs = FMath::Min(timeMs, (FPlatformTime::Seconds() - start) * 1000.0);
+		}
+
+		const FRealtimeMeshStream& positions = streamSet.FindChecked(FRealtimeMeshStreams::Position);
+		const FRealtimeMeshStream& triangles = streamSet.FindChecked(FRealtimeMeshStreams::Triangles);
+
+		AddInfo(FString::Printf(
+			TEXT("R=%-3d %7d tris %7d verts %7.3f ms | reserved %7d tris %7d verts"),
+			resolution, triangles.Num(), positions.Num(), timeMs, triangles.Max(), positions.Max()
+		));
+
+		// Reserving once from the counts leaves no slack, a stream that grew while emitting would have some
+		TestEqual(TEXT("The vertex stream is reserved once, at its final size"), positions.Max(), positions.Num());
+		TestEqual(TEXT("The triangle stream is reserved once, at its final size"), triangles.Max(), triangles.Num());
+		TestEqual(TEXT("Every crossed grid edge gets one shared vertex"), positions.Num(), CountCrossedEdges(grid, resolution, 1.0));
+	}
+
+	return true;
+}
@@ -0,0 +1,200 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#include "VoxelMesher/VoxelMarchingCubes.h"
+#include "VoxelMesher/VoxelTransitionCells.h"
+#include "VoxelUtilities/Array3D.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelTransitionBenchmark, "Voxel.Benchmarks.TransitionCells",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+using namespace RealtimeMesh;
+
+namespace VoxelTransitionBenchmark
+{
+	/* Rippled sphere of InRadius around InCenter, crossing the seam between the fine and coarse chunks */
+	double SampleDensity(const FVector& InLocation, const FVector& InCenter, double InRadius)
+	{
+		const double ripples =
+			0.05 * FMath::Sin(InLocation.X * 0.7) * FMath::Cos(InLocation.Y * 0.5)
+			+ 0.04 * FMath::Sin(InLocation.Z * 0.9 + InLocation.X * 0.3);
+
+		return (InLocation - InCenter).Length() / InRadius + ripples;
+	}
+
+	struct FScene
+	{
+		FVector Center;
+		double Radius;
+
+		/*
+		 * Meshes one chunk with marching cubes and, if it has any, the transition cells of InTransitionFaces the way
+		 * AVoxelVolume::GenerateChunkMeshFromGrid does, returns false if its streams grew past what was reserved
+		 */
+		bool AddChunk(const FVector& InOrigin, double InVoxelSize, int32 InResolution, uint8 InTransitionFaces, TArray<FVector3f>& OutTriangles) const
+		{
+			FVoxelMeshParams params;
+			params.ChunkOrigin = FVector3f(InOrigin);
+			params.VoxelSize = InVoxelSize;
+			params.SurfaceIsovalue = 1.0;
+			params.Resolution = InResolution;
+			params.TransitionFaces = InTransitionFaces;
+
+			const auto sample = [&](int32 InX, int32 InY, int32 InZ)
+			{
+				return SampleDensity(InOrigin + FVector(InX, InY, InZ) * InVoxelSize, Center, Radius);
+			};
+
+			const int32 apron = VoxelMarchingCubes::Apron;
+			FArray3D<double> grid(FIntVector(VoxelMarchingCubes::GetGridEdgeCount(InResolution)), NoInit);
+			grid.ForEachElement([&](int32 InX, int32 InY, int32 InZ, double& OutDensity) { OutDensity = sample(InX - apron, InY - apron, InZ - apron); });
+
+			FVoxelTransitionMesh transitionMesh;
+			if (InTransitionFaces != 0)
+			{
+				FVoxelTransitionCells::BuildMesh(params, 1.0, sample, sample, [](int32, int32, int32) { return uint8(0); }, transitionMesh);
+				params.NumExtraVertices = transitionMesh.NumVertices();
+				params.NumExtraTriangles = transitionMesh.NumTriangles();
+			}
+
+			FRealtimeMeshStreamSet streamSet;
+			VoxelMarchingCubes::GenerateMesh(grid, params, false, streamSet);
+			FVoxelTransitionCells::EmitMesh(params, transitionMesh, streamSet);
+
+			const FRealtimeMeshStream* positions = streamSet.Find(FRealtimeMeshStreams::Position);
+			const FRealtimeMeshStream* triangles = streamSet.Find(FRealtimeMeshStreams::Triangles);
+			if (!positions || !triangles)
+			{
+				return true;
+			}
+
+			const TArrayView<const FVector3f> positionData = positions->GetArrayView<FVector3f>();
+			for (const TIndex3<uint32>& triangle : triangles->GetArrayView<TIndex3<uint32>>())
+			{
+				OutTriangles.Add(positionData[triangle.V0]);
+				OutTriangles.Add(positionData[triangle.V1]);
+				OutTriangles.Add(positionData[triangle.V2]);
+			}
+
+			// Reserving exactly once leaves no slack, a stream that grew again would have some
+			return positions->Max() == positions->Num() && triangles->Max() == triangles->Num();
+		}
+	};
+
+	/* Welds the triangles by position and counts the directed edges no other triangle walks back along */
+	int32 CountOpenEdges(const TArray<FVector3f>& InTriangles)
+	{
+		TMap<FIntVector, int32> pointIds;
+		const auto getPointId = [&](const FVector3f& InLocation)
+		{
+			// Chunks compute shared vertices with slightly different float rounding, weld at 1/200 voxel
+			const FIntVector key(FMath::RoundToInt(InLocation.X * 200), FMath::RoundToInt(InLocation.Y * 200), FMath::RoundToInt(InLocation.Z * 200));
+			return pointIds.FindOrAdd(key, pointIds.Num());
+		};
+
+		TSet<TPair<int32, int32>> edges;
+		for (int32 i = 0; i < InTriangles.Num(); i += 3)
+		{
+			const int32 ids[3] = { getPointId(InTriangles[i]), getPointId(InTriangles[i + 1]), getPointId(InTriangles[i + 2]) };
+			if (ids[0] == ids[1] || ids[1] == ids[2] || ids[2] == ids[0])
+			{
+				continue;
+			}
+
+			for (int32 k = 0; k < 3; k++)
+			{
+				edges.Add(TPair<int32, int32>(ids[k], ids[(k + 1) % 3]));
+			}
+		}
+
+		int32 numOpen = 0;
+		for (const TPair<int32, int32>& edge : edges)
+		{
+			numOpen += !edges.Contains(TPair<int32, int32>(edge.Value, edge.Key));
+		}
+
+		return numOpen;
+	}
+}
+
+bool FVoxelTransitionBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace VoxelTransitionBenchmark;
+
+	for (const int32 resolution : { 16, 32 })
+	{
+		// Four fine chunks against one chunk twice their size on +x, the sphere sits on the seam
+		FScene scene;
+		scene.Center = FVector(resolution, resolution, resolution);
+		scene.Radius = resolution * 0.6;
+
+		const uint8 seamFace = FVoxelTransitionCells::GetFaceBit(0, true);
+
+		TArray<FVector3f> cracked;
+		TArray<FVector3f> stitched;
+		TArray<FVector3f> uniform;
+		bool bReservedOnce = true;
+		for (int32 y = 0; y < 2; y++)
+		{
+			for (int32 z = 0; z < 2; z++)
+			{
+				const FVector fineOrigin(0, y * resolution, z * resolution);
+				scene.AddChunk(fineOrigin, 1.0, resolution, 0, cracked);
+				bReservedOnce &= scene.AddChunk(fineOrigin, 1.0, resolution, seamFace, stitched);
+				scene.AddChunk(fineOrigin, 1.0, resolution, 0, uniform);
+			}
+		}
+
+		// Mixed LOD keeps the coarse chunk, raising LodFactor instead splits it into eight fine ones
+		scene.AddChunk(FVector(resolution, 0, 0), 2.0, resolution, 0, cracked);
+		scene.AddChunk(FVector(resolution, 0, 0), 2.0, resolution, 0, stitched);
+		for (int32 i = 0; i < 8; i++)
+		{
+			const FVector fineOrigin = FVector(resolution + (i >> 2 & 1) * resolution, (i >> 1 & 1) * resolution, (i & 1) * resolution);
+			scene.AddChunk(fineOrigin, 1.0, resolution, 0, uniform);
+		}
+
+		const int32 numCracked = CountOpenEdges(cracked);
+		const int32 numStitched = CountOpenEdges(stitched);
+		const int32 numUniform = CountOpenEdges(uniform);
+
+		AddInfo(FString::Printf(
+			TEXT("R=%-3d Mixed LOD %6d tris %4d open edges | Transition cells %6d tris %4d open edges | Uniform fine %6d tris %4d open edges | %.1f%% fewer tris than uniform"),
+			resolution,
+			cracked.Num() / 3, numCracked,
+			stitched.Num() / 3, numStitched,
+			uniform.Num() / 3, numUniform,
+			100.0 * (1.0 - (double)stitched.Num() / uniform.Num())
+		));
+
+		TestTrue(TEXT("The LOD seam cracks without transition cells"), numCracked > 0);
+		TestEqual(TEXT("Transition cells close the LOD seam"), numStitched, 0);
+		TestTrue(TEXT("Chunks with transition cells reserve their streams once for both"), bReservedOnce);
+		TestEqual(TEXT("Uniform chunks are watertight"), numUniform, 0);
+		TestTrue(TEXT("Transition cells cost fewer triangles than uniform fine chunks"), stitched.Num() < uniform.Num());
+
+		// Sixteen fine chunks against one chunk four times their size, which transition cells do not stitch. This is why
+		// AVoxelVolume::GetTransitionFaces only flags neighbours one depth coarser
+		FScene farScene;
+		farScene.Center = FVector(resolution, resolution * 2, resolution * 2);
+		farScene.Radius = resolution * 0.9;
+
+		TArray<FVector3f> farStitched;
+		for (int32 y = 0; y < 4; y++)
+		{
+			for (int32 z = 0; z < 4; z++)
+			{
+				farScene.AddChunk(FVector(0, y * resolution, z * resolution), 1.0, resolution, seamFace, farStitched);
+			}
+		}
+		farScene.AddChunk(FVector(resolution, 0, 0), 4.0, resolution, 0, farStitched);
+
+		const int32 numFarStitched = CountOpenEdges(farStitched);
+		AddInfo(FString::Printf(TEXT("R=%-3d 4:1 seam with transition cells %6d tris %4d open edges"), resolution, farStitched.Num() / 3, numFarStitched));
+
+		TestTrue(TEXT("Transition cells do not close a seam against a neighbour two depths coarser"), numFarStitched > 0);
+	}
+
+	return true;
+}
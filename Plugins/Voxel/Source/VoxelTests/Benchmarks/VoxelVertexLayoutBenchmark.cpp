@@ -0,0 +1,103 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#include "VoxelMesher/VoxelMarchingCubes.h"
+#include "VoxelMesher/VoxelSurfaceNets.h"
+#include "VoxelUtilities/Array3D.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelVertexLayoutBenchmark, "Voxel.Benchmarks.VertexLayout",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+using namespace RealtimeMesh;
+
+namespace VoxelVertexLayoutBenchmark
+{
+	/* Rippled sphere filling most of a chunk of InResolution cells, sampled InApron corners past every face */
+	FArray3D<double> SampleGrid(int32 InResolution, int32 InApron)
+	{
+		const double radius = InResolution * 0.4;
+
+		FArray3D<double> grid(FIntVector(InResolution + 1 + InApron * 2), NoInit);
+		grid.ForEachElement([&](int32 InX, int32 InY, int32 InZ, double& OutDensity)
+		{
+			const FVector location = FVector(InX, InY, InZ) - (InApron + InResolution * 0.5);
+			OutDensity = location.Length() / radius + 0.05 * FMath::Sin(location.X * 0.3) * FMath::Cos(location.Y * 0.2);
+		});
+
+		return grid;
+	}
+
+	struct FResult
+	{
+		int32 NumVertices = 0;
+		int32 NumTriangles = 0;
+		int64 NumBytes = 0;
+		bool bSixteenBitIndices = false;
+	};
+
+	/* Meshes InGrid with the selected mesher and layout, the way AVoxelVolume::GenerateChunkMesh does */
+	FResult Measure(const FArray3D<double>& InGrid, int32 InResolution, bool bInSurfaceNets, bool bInLean)
+	{
+		FVoxelMeshParams params;
+		params.ChunkOrigin = FVector3f::ZeroVector;
+		params.VoxelSize = 1.0;
+		params.SurfaceIsovalue = 1.0;
+		params.Resolution = InResolution;
+		params.bLeanLayout = bInLean;
+
+		FRealtimeMeshStreamSet streamSet;
+		if (bInSurfaceNets)
+		{
+			FVoxelSurfaceNets::GenerateMesh(InGrid, params, streamSet);
+		}
+		else
+		{
+			VoxelMarchingCubes::GenerateMesh(InGrid, params, false, streamSet);
+		}
+		FinalizeVoxelMeshStreams(params, streamSet);
+
+		const FRealtimeMeshStream& triangles = streamSet.FindChecked(FRealtimeMeshStreams::Triangles);
+
+		FResult result;
+		result.NumVertices = streamSet.FindChecked(FRealtimeMeshStreams::Position).Num();
+		result.NumTriangles = triangles.Num();
+		result.NumBytes = GetVoxelMeshStreamBytes(streamSet);
+		result.bSixteenBitIndices = triangles.GetLayout() == GetRealtimeMeshBufferLayout<TIndex3<uint16>>();
+		return result;
+	}
+}
+
+bool FVoxelVertexLayoutBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace VoxelVertexLayoutBenchmark;
+
+	for (const int32 resolution : { 16, 32, 64 })
+	{
+		const FArray3D<double> marchingCubesGrid = SampleGrid(resolution, VoxelMarchingCubes::Apron);
+		const FArray3D<double> surfaceNetsGrid = SampleGrid(resolution, FVoxelSurfaceNets::Apron);
+
+		for (const bool bSurfaceNets : { false, true })
+		{
+			const FArray3D<double>& grid = bSurfaceNets ? surfaceNetsGrid : marchingCubesGrid;
+			const FResult full = Measure(grid, resolution, bSurfaceNets, false);
+			const FResult lean = Measure(grid, resolution, bSurfaceNets, true);
+
+			AddInfo(FString::Printf(
+				TEXT("R=%-3d %-14s %6d verts %6d tris | Full %8.1f KB %5.1f B/vert | Lean %8.1f KB %5.1f B/vert | %.1f%% smaller"),
+				resolution, bSurfaceNets ? TEXT("SurfaceNets") : TEXT("MarchingCubes"), full.NumVertices, full.NumTriangles,
+				full.NumBytes / 1024.0, (double)full.NumBytes / full.NumVertices,
+				lean.NumBytes / 1024.0, (double)lean.NumBytes / lean.NumVertices,
+				100.0 * (1.0 - (double)lean.NumBytes / full.NumBytes)
+			));
+
+			TestEqual(TEXT("Both layouts hold the same vertices"), lean.NumVertices, full.NumVertices);
+			TestEqual(TEXT("Both layouts hold the same triangles"), lean.NumTriangles, full.NumTriangles);
+			TestTrue(TEXT("The lean layout takes fewer bytes per chunk"), lean.NumBytes < full.NumBytes);
+			TestEqual(TEXT("The lean layout narrows indices below 65536 vertices"), lean.bSixteenBitIndices, lean.NumVertices <= 65536);
+			TestFalse(TEXT("The full layout keeps 32 bit indices"), full.bSixteenBitIndices);
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,116 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/RandomStream.h"
+#include "VoxelEdit/VoxelEditLayer.h"
+#include "VoxelEdit/VoxelEditOctree.h"
+#include "VoxelUtilities/Array3D.h"
+
+/* Scenes shared by the benchmarks, so the ones measuring the same part of the plugin mesh and edit the same data */
+namespace VoxelBenchmarkFixtures
+{
+	/* Sphere of InRadius around the origin with a few octaves of ripples on it, so the surface is not one smooth case over and over */
+	inline double SampleRippledSphere(const FVector& InLocation, double InRadius)
+	{
+		const double ripples =
+			0.06 * FMath::Sin(InLocation.X * 0.21) * FMath::Cos(InLocation.Y * 0.17)
+			+ 0.03 * FMath::Sin(InLocation.Z * 0.43 + InLocation.X * 0.11);
+
+		return InLocation.Length() / InRadius + ripples;
+	}
+
+	/* Radius of the sphere SampleSphereGrid puts in a chunk of InResolution voxels, its density changes by about 1 / radius per voxel */
+	constexpr double GetSphereRadius(int32 InResolution) { return InResolution * 0.4; }
+
+	/* Rippled sphere filling most of a chunk of InResolution one unit voxels, sampled InApron corners past every face, surface at 1 */
+	inline FArray3D<double> SampleSphereGrid(int32 InResolution, int32 InApron)
+	{
+		const double radius = GetSphereRadius(InResolution);
+
+		FArray3D<double> grid(FIntVector(InResolution + 1 + InApron * 2), NoInit);
+		grid.ForEachElement([&](int32 InX, int32 InY, int32 InZ, double& OutDensity)
+		{
+			OutDensity = SampleRippledSphere(FVector(InX, InY, InZ) - (InApron + InResolution * 0.5), radius);
+		});
+
+		return grid;
+	}
+
+	// Edited ground, one meter voxels over a cube of 1 km with the ground at z = 0
+	static constexpr double GroundVoxelSize = 100;
+	static constexpr int32 GroundHalfExtent = 512;
+	static constexpr double GroundIsovalue = 1.0;
+	static constexpr double GroundDensityPerUnit = 1.0 / GroundVoxelSize;
+
+	/* Empties InOutOctree for the edited ground's lattice */
+	inline void InitGround(FVoxelEditOctree& InOutOctree)
+	{
+		InOutOctree.Init(GroundVoxelSize, GroundHalfExtent, GroundIsovalue, GroundDensityPerUnit);
+	}
+
+	/* Rolling ground, stone below 20 m of dirt */
+	inline double SampleRollingGround(const FVector& InLocation, uint8& OutMaterialId)
+	{
+		const double height = 800 * FMath::Sin(InLocation.X * 0.0001) * FMath::Cos(InLocation.Y * 0.00013);
+		OutMaterialId = InLocation.Z < height - 2000 ? 1 : 0;
+		return GroundIsovalue + (InLocation.Z - height) * GroundDensityPerUnit;
+	}
+
+	/* Tunnels dug as random walks of spheres through the ground, with the odd smoothed pillar of another material */
+	inline void MakeTunnels(FRandomStream& InRandom, int32 InNumTunnels, int32 InStrokesPerTunnel, TArray<FVoxelEdit>& OutEdits)
+	{
+		for (int32 i = 0; i < InNumTunnels; i++)
+		{
+			FVector location(InRandom.FRandRange(-40000, 40000), InRandom.FRandRange(-40000, 40000), InRandom.FRandRange(-40000, -2000));
+			FVector direction = FVector(InRandom.FRandRange(-1, 1), InRandom.FRandRange(-1, 1), InRandom.FRandRange(-0.2, 0.2)).GetSafeNormal();
+
+			for (int32 j = 0; j < InStrokesPerTunnel; j++)
+			{
+				FVoxelEdit& edit = OutEdits.AddDefaulted_GetRef();
+				edit.Operation = InRandom.FRand() < 0.9f ? EVoxelEditOperation::Remove : EVoxelEditOperation::Add;
+				edit.Shape = edit.Operation == EVoxelEditOperation::Remove ? EVoxelEditShape::Sphere : EVoxelEditShape::Box;
+				edit.Center = location;
+				edit.Extent = FVector(InRandom.FRandRange(200, 800), InRandom.FRandRange(100, 300), InRandom.FRandRange(200, 500));
+				edit.Smoothness = edit.Operation == EVoxelEditOperation::Add ? InRandom.FRandRange(0, 200) : 0;
+				edit.MaterialId = edit.Operation == EVoxelEditOperation::Add ? 2 : 0;
+
+				direction = (direction + FVector(InRandom.FRandRange(-0.3, 0.3), InRandom.FRandRange(-0.3, 0.3), InRandom.FRandRange(-0.1, 0.1))).GetSafeNormal();
+				location += direction * 400;
+			}
+		}
+	}
+
+	/* Samples of InChunks, InChunkSize lattice points along an edge, that differ between the two octrees, edited or not */
+	inline int32 CountMismatches(const FVoxelEditOctree& InA, const FVoxelEditOctree& InB, const TArray<FIntVector>& InChunks, int32 InChunkSize)
+	{
+		const int32 numSamples = InChunkSize * InChunkSize * InChunkSize;
+		TArray<double> densitiesA, densitiesB;
+		TArray<uint8> materialIdsA, materialIdsB;
+		densitiesA.SetNumUninitialized(numSamples);
+		densitiesB.SetNumUninitialized(numSamples);
+		materialIdsA.SetNumUninitialized(numSamples);
+		materialIdsB.SetNumUninitialized(numSamples);
+
+		int32 numMismatches = 0;
+		for (const FIntVector& chunk : InChunks)
+		{
+			for (int32 i = 0; i < numSamples; i++)
+			{
+				densitiesA[i] = densitiesB[i] = TNumericLimits<double>::Max();
+				materialIdsA[i] = materialIdsB[i] = 0;
+			}
+
+			InA.Extract(chunk * InChunkSize, 1, FIntVector(InChunkSize), densitiesA, materialIdsA);
+			InB.Extract(chunk * InChunkSize, 1, FIntVector(InChunkSize), densitiesB, materialIdsB);
+
+			for (int32 i = 0; i < numSamples; i++)
+			{
+				numMismatches += densitiesA[i] != densitiesB[i] || materialIdsA[i] != materialIdsB[i];
+			}
+		}
+
+		return numMismatches;
+	}
+}
@@ -0,0 +1,66 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "RealtimeMesh.h"
+#include "RealtimeMeshSimple.h"
+
+#include "VoxelMesher/VoxelSurfaceNets.h"
+#include "VoxelUtilities/Array3D.h"
+
+/* Chunk collision built the way the volume builds it, shared by the benchmarks that cook, cache, refit or trace it */
+namespace VoxelCollisionFixtures
+{
+	// Hits further apart than this, in voxels, count as a disagreement between two bodies cooked from the same triangles
+	static constexpr double SameMeshHitTolerance = 0.01;
+
+	// Hits further apart than this, in voxels, count as a disagreement between a mesh and the density it was meshed from
+	static constexpr double DensityHitTolerance = 1.0;
+
+	/* Collision triangles of a grid of InResolution one unit voxels, meshed and gathered the way URealtimeMeshSimple gathers them for its section groups */
+	inline void GenerateTriMesh(const FArray3D<double>& InGrid, int32 InResolution, FRealtimeMeshTriMeshData& OutTriMeshData)
+	{
+		using namespace RealtimeMesh;
+
+		FVoxelMeshParams params;
+		params.ChunkOrigin = FVector3f::ZeroVector;
+		params.VoxelSize = 1.0;
+		params.SurfaceIsovalue = 1.0;
+		params.Resolution = InResolution;
+
+		FRealtimeMeshStreamSet streamSet;
+		FVoxelSurfaceNets::GenerateMesh(InGrid, params, streamSet);
+		FinalizeVoxelMeshStreams(params, streamSet);
+
+		URealtimeMeshSimple* realtimeMesh = NewObject<URealtimeMeshSimple>(GetTransientPackage());
+		const FRealtimeMeshSectionGroupKey groupKey = FRealtimeMeshSectionGroupKey::Create(0, FName("Chunk"));
+		realtimeMesh->CreateSectionGroup(groupKey, streamSet);
+		realtimeMesh->UpdateSectionConfig(FRealtimeMeshSectionKey::CreateForPolyGroup(groupKey, 0), FRealtimeMeshSectionConfig(ERealtimeMeshSectionDrawType::Static, 0), true);
+		realtimeMesh->GetMeshData()->GenerateCollisionMesh(OutTriMeshData);
+	}
+
+	/* Body setup for a chunk's triangles, set up the way URealtimeMesh sets up a section group's, deformable ones cook to be refit */
+	inline UBodySetup* CreateBodySetup(const FRealtimeMeshTriMeshData& InTriMeshData, bool bInDeformable = false)
+	{
+		URealtimeMeshCollisionBody* body = NewObject<URealtimeMeshCollisionBody>(GetTransientPackage());
+		body->PendingTriMeshData = InTriMeshData;
+		body->bPendingDeformableMesh = bInDeformable;
+
+		UBodySetup* bodySetup = NewObject<UBodySetup>(body);
+		bodySetup->BodySetupGuid = FGuid::NewGuid();
+		bodySetup->bGenerateMirroredCollision = false;
+		bodySetup->bDoubleSidedGeometry = true;
+		bodySetup->CollisionTraceFlag = CTF_UseComplexAsSimple;
+		return bodySetup;
+	}
+
+	/* CreateBodySetup cooked synchronously */
+	inline UBodySetup* Cook(const FRealtimeMeshTriMeshData& InTriMeshData, bool bInDeformable = false)
+	{
+		UBodySetup* bodySetup = CreateBodySetup(InTriMeshData, bInDeformable);
+		bodySetup->CreatePhysicsMeshes();
+		return bodySetup;
+	}
+}
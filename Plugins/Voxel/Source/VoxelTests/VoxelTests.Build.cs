@@ -0,0 +1,30 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+
+public class VoxelTests : ModuleRules
+{
+	public VoxelTests(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PrivateIncludePaths.Add(ModuleDirectory);
+
+		PublicDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"Core",
+				"Voxel",
+			}
+			);
+
+
+		PrivateDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"CoreUObject",
+				"Engine",
+				"Chaos",
+				"RealtimeMeshComponent",
+			}
+			);
+	}
+}
@@ -0,0 +1,15 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "VoxelTestsModule.h"
+
+void FVoxelTestsModule::StartupModule()
+{
+	
+}
+
+void FVoxelTestsModule::ShutdownModule()
+{
+	
+}
+
+IMPLEMENT_MODULE(FVoxelTestsModule, VoxelTests)